@@ -159,6 +159,8 @@ double GpuTimer::getElapsedTime()
         result[1] = pRes[1];
         mpResolveStagingBuffer->unmap();
 
+        mStartTimestamp = result[0];
+        mEndTimestamp = result[1];
         double start = (double)result[0];
         double end = (double)result[1];
         double range = end - start;
@@ -168,6 +170,13 @@ double GpuTimer::getElapsedTime()
     return mElapsedTime;
 }
 
+void GpuTimer::getTimestamps(uint64_t& start, uint64_t& end)
+{
+    getElapsedTime();
+    start = mStartTimestamp;
+    end = mEndTimestamp;
+}
+
 void GpuTimer::breakStrongReferenceToDevice()
 {
     mpDevice.breakStrongReference();
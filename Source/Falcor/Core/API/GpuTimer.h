@@ -80,6 +80,14 @@ public:
      */
     double getElapsedTime();
 
+    /**
+     * Get the GPU timestamps of the last resolved pair of begin()/end() calls.
+     * The same rules as for getElapsedTime() apply.
+     * @param[out] start Timestamp of the begin() call in GPU ticks.
+     * @param[out] end Timestamp of the end() call in GPU ticks.
+     */
+    void getTimestamps(uint64_t& start, uint64_t& end);
+
     void breakStrongReferenceToDevice();
 
 private:
@@ -97,6 +105,8 @@ private:
     uint32_t mStart = 0;
     uint32_t mEnd = 0;
     double mElapsedTime = 0.0;
+    uint64_t mStartTimestamp = 0;
+    uint64_t mEndTimestamp = 0;
     bool mDataPending = false; ///< Set to true when resolved timings are available for readback.
 
     ref<Buffer> mpResolveBuffer;        ///< GPU memory used as destination for resolving timestamp queries.
@@ -33,11 +33,14 @@
 
 #include <gtk/gtk.h>
 
+#include <fstream>
 #include <iostream>
 #include <unistd.h>
 #include <signal.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
+#include <malloc.h>
 #include <pwd.h>
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE // needed for dladdr()
@@ -579,13 +582,53 @@ void OSServices::stop() {}
 
 size_t getCurrentRSS()
 {
-    FALCOR_UNIMPLEMENTED();
-    return 0;
+    // The second field of /proc/self/statm is the resident set size in pages.
+    std::ifstream statm("/proc/self/statm");
+    size_t pageCount = 0;
+    size_t residentPageCount = 0;
+    if (!(statm >> pageCount >> residentPageCount))
+        return 0;
+    return residentPageCount * (size_t)sysconf(_SC_PAGESIZE);
 }
 
 size_t getPeakRSS()
 {
-    FALCOR_UNIMPLEMENTED();
+    // VmHWM is reported in kilobytes and, unlike ru_maxrss, is cleared by resetPeakRSS().
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return (size_t)std::stoull(line.substr(6)) * 1024;
+    }
+
+    // ru_maxrss is reported in kilobytes on Linux.
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return (size_t)usage.ru_maxrss * 1024;
+}
+
+bool resetPeakRSS()
+{
+    // Writing 5 to clear_refs resets VmHWM to the current RSS (Linux 4.0+).
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (!clearRefs)
+        return false;
+    clearRefs << "5";
+    clearRefs.flush();
+    return clearRefs.good();
+}
+
+uint64_t getHeapAllocatedBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    // Bytes in use in the heap plus bytes in separately mmap'ed blocks.
+    // mallinfo2 is only documented to cover the main arena, so allocations made from other threads' arenas may be missed.
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
     return 0;
+#endif
 }
 } // namespace Falcor
@@ -484,6 +484,19 @@ FALCOR_API uint64_t getCurrentRSS();
  */
 FALCOR_API uint64_t getPeakRSS();
 
+/**
+ * Resets the peak resident set size to the current resident set size, so that getPeakRSS() reports the peak since this call.
+ * The peak is process-wide, so all other users of getPeakRSS() lose the lifetime peak of the process. SceneBuilder calls this
+ * at the start of every build stage.
+ * @return True if the peak was reset, false if this is not supported by the platform.
+ */
+FALCOR_API bool resetPeakRSS();
+
+/**
+ * Returns the number of bytes currently allocated from the heap by the process, or 0 if this is not supported.
+ */
+FALCOR_API uint64_t getHeapAllocatedBytes();
+
 /**
  * Returns index of most significant set bit, or 0 if no bits were set.
  */
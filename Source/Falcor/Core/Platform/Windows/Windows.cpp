@@ -970,4 +970,20 @@ size_t getPeakRSS()
         return memoryCounter.PeakWorkingSetSize;
     return 0;
 }
+
+bool resetPeakRSS()
+{
+    // The peak working set size cannot be reset on Windows.
+    return false;
+}
+
+uint64_t getHeapAllocatedBytes()
+{
+    // The CRT allocates from the process heap.
+    HEAP_SUMMARY summary = {};
+    summary.cb = sizeof(summary);
+    if (HeapSummary(GetProcessHeap(), 0, &summary))
+        return summary.cbAllocated;
+    return 0;
+}
 } // namespace Falcor
@@ -34,6 +34,7 @@
 #include "Utils/Math/Vector.h"
 #include "Utils/UI/Gui.h"
 #include "Utils/InternalDictionary.h"
+#include "Utils/Timing/Profiler.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -103,10 +104,13 @@ private:
     {
         std::string name;
         ref<RenderPass> pPass;
+        Profiler::NameID profilerNameID; ///< Interned pass name for profiling.
 
     private:
         friend class RenderGraphExe; // Force RenderGraphCompiler to use insertPass() by hiding this Ctor from it
-        Pass(const std::string& name_, const ref<RenderPass>& pPass_) : name(name_), pPass(pPass_) {}
+        Pass(const std::string& name_, const ref<RenderPass>& pPass_)
+            : name(name_), pPass(pPass_), profilerNameID(Profiler::internName(name_))
+        {}
     };
 
     std::vector<Pass> mExecutionList;
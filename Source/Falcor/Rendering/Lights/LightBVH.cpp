@@ -133,6 +133,9 @@ namespace Falcor
     {
         // Reset all CPU data.
         mNodes.clear();
+        mTriangleIndices.clear();
+        mTriangleBitmasks.clear();
+        mNodeCosts.clear();
         mNodeIndices.clear();
         mPerDepthRefitEntryInfo.clear();
         mMaxTriangleCountPerLeaf = 0;
@@ -303,6 +306,13 @@ namespace Falcor
         mIsCpuDataValid = true;
     }
 
+    void LightBVH::uploadNodes()
+    {
+        FALCOR_ASSERT(mpBVHNodesBuffer && mpBVHNodesBuffer->getElementCount() >= mNodes.size());
+        mpBVHNodesBuffer->setBlob(mNodes.data(), 0, mNodes.size() * sizeof(mNodes[0]));
+        mIsCpuDataValid = true;
+    }
+
     void LightBVH::syncDataToCPU() const
     {
         if (!mIsValid || mIsCpuDataValid) return;
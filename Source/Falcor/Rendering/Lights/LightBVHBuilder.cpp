@@ -30,8 +30,12 @@
 #include "Core/Errors.h"
 #include "Utils/Logger.h"
 #include "Utils/Timing/Profiler.h"
+#include "Utils/NumericRange.h"
 #include "Utils/Math/MathConstants.slangh"
 #include <algorithm>
+#include <array>
+#include <exception>
+#include <execution>
 
 namespace
 {
@@ -45,6 +49,15 @@ namespace
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
 
+    // Triangle ranges with at least this many triangles are reduced, binned and partitioned in chunks,
+    // and their two subtrees are built as separate tasks. Which code path is taken depends only on the
+    // range size and never on the number of threads, so the parallel build produces the same BVH as a
+    // single-threaded one.
+    const uint32_t kParallelBuildThreshold = 1 << 14;
+
+    // Number of triangles per chunk when processing large triangle ranges.
+    const uint32_t kChunkSize = 1 << 12;
+
     inline float safeACos(float v)
     {
         return std::acos(std::clamp(v, -1.0f, 1.0f));
@@ -216,6 +229,115 @@ namespace
         const float3 dims = max(float3(epsilon), bb.extent());
         return dims.x * dims.y * dims.z;
     }
+
+    uint32_t getChunkCount(uint32_t begin, uint32_t end)
+    {
+        return (end - begin + kChunkSize - 1) / kChunkSize;
+    }
+
+    /** Calls func(chunkIndex, chunkBegin, chunkEnd) for each chunk of the range [begin, end).
+    */
+    template<typename F>
+    void forEachChunk(bool parallel, uint32_t begin, uint32_t end, F func)
+    {
+        NumericRange<uint32_t> range(0, getChunkCount(begin, end));
+        auto processChunk = [&](uint32_t chunk)
+        {
+            uint32_t chunkBegin = begin + chunk * kChunkSize;
+            func(chunk, chunkBegin, std::min(chunkBegin + kChunkSize, end));
+        };
+        if (parallel) std::for_each(std::execution::par, range.begin(), range.end(), processChunk);
+        else std::for_each(range.begin(), range.end(), processChunk);
+    }
+
+    /** Reduces the range [begin, end) by calling accumulate(result, begin, end).
+        Large ranges are accumulated per chunk and the partial results are then merged in chunk order by
+        calling merge(result, partial). This keeps floating-point sums independent of the thread scheduling.
+    */
+    template<typename T, typename AccumulateFunc, typename MergeFunc>
+    T reduceRange(bool parallel, uint32_t begin, uint32_t end, const T& init, AccumulateFunc accumulate, MergeFunc merge)
+    {
+        T result = init;
+        if (end - begin < kParallelBuildThreshold)
+        {
+            accumulate(result, begin, end);
+            return result;
+        }
+
+        std::vector<T> partials(getChunkCount(begin, end), init);
+        forEachChunk(parallel, begin, end, [&](uint32_t chunk, uint32_t chunkBegin, uint32_t chunkEnd) { accumulate(partials[chunk], chunkBegin, chunkEnd); });
+        for (const T& partial : partials) merge(result, partial);
+        return result;
+    }
+
+    /** Maps points inside a node's bounds to bins along all three axes at once.
+    */
+    struct BinMapping
+    {
+        float3 origin;
+        float3 scale;
+        uint3 maxBinId;
+
+        BinMapping(const AABB& nodeBounds, uint32_t binCount) : origin(nodeBounds.minPoint), maxBinId(binCount - 1)
+        {
+            const float3 w = nodeBounds.extent();
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                FALCOR_ASSERT(w[i] >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
+                scale[i] = w[i] > FLT_MIN ? (float)binCount / w[i] : 0.f;
+            }
+        }
+
+        uint3 getBinIds(const float3& p) const
+        {
+            FALCOR_ASSERT(all(p >= origin));
+            return min(uint3((p - origin) * scale), maxBinId);
+        }
+    };
+
+    /** Combines the cosine of two cone angles bounding the same cone direction, see computeCosConeAngle().
+    */
+    float combineCosConeAngles(float cosA, float cosB)
+    {
+        return cosA == kInvalidCosConeAngle || cosB == kInvalidCosConeAngle ? kInvalidCosConeAngle : std::min(cosA, cosB);
+    }
+
+    /** Appends a subtree that was built into a separate list to the node list, offsetting its child indices accordingly.
+        \param[in] triangleOffset Offset to add to the triangle offsets of the subtree's leaf nodes.
+        \return Index of the subtree's root node in 'nodes'.
+    */
+    uint32_t appendSubtree(const std::vector<PackedNode>& subtreeNodes, uint32_t triangleOffset, std::vector<PackedNode>& nodes)
+    {
+        FALCOR_ASSERT(nodes.size() + subtreeNodes.size() < std::numeric_limits<uint32_t>::max());
+        const uint32_t nodeOffset = (uint32_t)nodes.size();
+
+        // The right child index of internal nodes and the triangle offset of leaf nodes are stored in the low bits of
+        // the first dword. Patch them in place rather than unpacking and repacking the node, which would be lossy.
+        for (PackedNode node : subtreeNodes)
+        {
+            FALCOR_ASSERT(!node.isLeaf() || node.getLeafNode().triangleOffset + triangleOffset < kMaxLeafTriangleOffset);
+            node.data[0].x += node.isLeaf() ? triangleOffset : nodeOffset;
+            nodes.push_back(node);
+        }
+        return nodeOffset;
+    }
+
+    /** Refitted node data, in full precision.
+    */
+    struct RefitNodeInfo
+    {
+        AABB bounds;
+        float flux = 0.f;
+        float3 coneDirection = float3(0.f);
+        float cosConeAngle = kInvalidCosConeAngle;
+        uint32_t triangleOffset = 0;    ///< Offset of the subtree's first triangle in the triangle index list.
+        uint32_t triangleCount = 0;     ///< Number of triangles in the subtree.
+        float cost = 0.f;               ///< Current cost of the subtree.
+        float referenceCost = 0.f;      ///< Cost of the subtree's nodes when they were built.
+    };
+
+    // Marks node costs that have not been recorded yet. Valid costs are non-negative.
+    const float kUnsetCost = -1.f;
 }
 
 namespace Falcor
@@ -238,27 +360,42 @@ namespace Falcor
         const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles(pRenderContext);
         if (triangles.empty()) return;
 
+        buildNodes(triangles, bvh.mNodes, bvh.mTriangleIndices, bvh.mTriangleBitmasks);
+
+        // If there are no non-culled triangles, we're done.
+        if (bvh.mNodes.empty()) return;
+
+        // Record the node costs for detecting degraded subtrees in the CPU refit.
+        if (mOptions.allowRefitting && mOptions.useCpuRefit)
+        {
+            refitNodes(triangles, bvh.mNodes, bvh.mTriangleIndices, bvh.mTriangleBitmasks, bvh.mNodeCosts);
+        }
+
+        // The BVH is ready, mark it as valid and upload the data.
+        bvh.mIsValid = true;
+        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
+        bvh.uploadCPUBuffers(bvh.mTriangleIndices, bvh.mTriangleBitmasks);
+
+        // Computate metadata.
+        bvh.finalize();
+    }
+
+    void LightBVHBuilder::buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks)
+    {
+        nodes.clear();
+        triangleIndices.clear();
+        triangleBitmasks.clear();
+
         // Create list of triangles that should be included in BVH.
         // For each triangle, precompute data we need for the build.
-        BuildingData data(bvh.mNodes);
+        BuildingData data(nodes);
         data.trianglesData.reserve(triangles.size());
 
         for (size_t i = 0; i < triangles.size(); i++)
         {
             if (!mOptions.usePreintegration || triangles[i].flux > 0.f)
             {
-                LightBVHBuilder::TriangleSortData tri;
-                for (uint32_t j = 0; j < 3; j++)
-                {
-                    tri.bounds |= triangles[i].vtx[j].pos;
-                }
-                tri.center = triangles[i].getCenter();
-                tri.coneDirection = triangles[i].normal;
-                tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
-                tri.flux = triangles[i].flux;
-                tri.triangleIndex = static_cast<uint32_t>(i);
-
-                data.trianglesData.push_back(tri);
+                data.trianglesData.push_back(createTriangleSortData(triangles[i], static_cast<uint32_t>(i)));
             }
         }
 
@@ -279,7 +416,6 @@ namespace Falcor
         // To be grossly conservative, assume each triangle requires two nodes.
         // This is only system RAM and shouldn't be that much, so it's not worth being more careful about it.
         // TODO: Better estimate of how many nodes we will need.
-        data.nodes.clear();
         data.nodes.reserve(2 * data.trianglesData.size());
         data.triangleIndices.reserve(data.trianglesData.size());
 
@@ -288,7 +424,7 @@ namespace Falcor
 
         // Build the tree.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
+        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data, data.nodes, data.triangleIndices);
         FALCOR_ASSERT(!data.nodes.empty());
 
         size_t numValid = 0;
@@ -300,13 +436,8 @@ namespace Falcor
         float cosConeAngle;
         computeLightingConesInternal(0, data, cosConeAngle);
 
-        // The BVH is ready, mark it as valid and upload the data.
-        bvh.mIsValid = true;
-        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
-
-        // Computate metadata.
-        bvh.finalize();
+        triangleIndices = std::move(data.triangleIndices);
+        triangleBitmasks = std::move(data.triangleBitmasks);
     }
 
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
@@ -320,6 +451,15 @@ namespace Falcor
         bool optionsChanged = false;
 
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
+        if (options.allowRefitting)
+        {
+            optionsChanged |= widget.checkbox("Refit on CPU", options.useCpuRefit);
+            widget.tooltip("Refit the BVH on the CPU and rebuild the subtrees whose cost grew by more than the rebuild cost threshold since they were built.");
+            if (options.useCpuRefit)
+            {
+                optionsChanged |= widget.var("Rebuild cost threshold", options.rebuildCostThreshold, 0.f, std::numeric_limits<float>::max(), 0.1f);
+            }
+        }
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u, kMaxLeafTriangleCount);
         optionsChanged |= widget.dropdown("Split heuristic", options.splitHeuristicSelection);
 
@@ -347,27 +487,41 @@ namespace Falcor
             }
         }
 
+        optionsChanged |= widget.checkbox("Parallel build", options.useParallelBuild);
+
         return optionsChanged;
     }
 
-    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, SplitHeuristicFunction splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices)
     {
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
 
         // Compute the AABB and total flux of the node.
-        float nodeFlux = 0.f;
-        AABB nodeBounds;
-        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
+        struct NodeData
         {
-            nodeBounds |= data.trianglesData[dataIndex].bounds;
-            nodeFlux += data.trianglesData[dataIndex].flux;
-        }
+            AABB bounds;
+            float flux = 0.f;
+        };
+        const NodeData nodeData = reduceRange(options.useParallelBuild, triangleRange.begin, triangleRange.end, NodeData(),
+            [&data](NodeData& result, uint32_t begin, uint32_t end)
+            {
+                for (uint32_t dataIndex = begin; dataIndex < end; ++dataIndex)
+                {
+                    result.bounds |= data.trianglesData[dataIndex].bounds;
+                    result.flux += data.trianglesData[dataIndex].flux;
+                }
+            },
+            [](NodeData& result, const NodeData& partial)
+            {
+                result.bounds |= partial.bounds;
+                result.flux += partial.flux;
+            });
+        const AABB& nodeBounds = nodeData.bounds;
+        const float nodeFlux = nodeData.flux;
         FALCOR_ASSERT(nodeBounds.valid());
 
-        data.currentNodeFlux = nodeFlux;
-
         bool trySplitting = triangleRange.length() > (options.createLeavesASAP ? options.maxTriangleCountPerLeaf : 1);
-        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, options) : SplitResult();
+        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, nodeFlux, options) : SplitResult();
 
         // If we should split, then create an internal node and split.
         if (splitResult.isValid())
@@ -375,13 +529,12 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.begin < splitResult.triangleIndex && splitResult.triangleIndex < triangleRange.end);
 
             // Sort the centroids and update the lists accordingly.
-            auto comp = [dim = splitResult.axis](const TriangleSortData& d1, const TriangleSortData& d2) { return d1.bounds.center()[dim] < d2.bounds.center()[dim]; };
-            std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
+            partitionTriangles(data, triangleRange, splitResult, options.useParallelBuild);
 
             // Allocate internal node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -395,13 +548,62 @@ namespace Falcor
                 throw RuntimeError("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            const std::array<Range, 2> childRanges = { Range(triangleRange.begin, splitResult.triangleIndex), Range(splitResult.triangleIndex, triangleRange.end) };
+            uint32_t leftIndex = 0;
+            uint32_t rightIndex = 0;
+
+            if (triangleRange.length() >= kParallelBuildThreshold)
+            {
+                // Build the two subtrees as separate tasks into their own lists, then append them in left-to-right order.
+                // This yields the same depth-first node layout as building them one after the other.
+                struct Subtree
+                {
+                    std::vector<PackedNode> nodes;
+                    std::vector<uint32_t> triangleIndices;
+                    std::exception_ptr error;
+                };
+                std::array<Subtree, 2> subtrees;
+
+                auto buildSubtree = [&](uint32_t child)
+                {
+                    Subtree& subtree = subtrees[child];
+                    try
+                    {
+                        subtree.nodes.reserve(2 * childRanges[child].length());
+                        subtree.triangleIndices.reserve(childRanges[child].length());
+                        buildInternal(options, splitHeuristic, bitmask | ((uint64_t)child << depth), depth + 1, childRanges[child], data, subtree.nodes, subtree.triangleIndices);
+                    }
+                    catch (...)
+                    {
+                        // Exceptions must not escape a parallel algorithm. Rethrow them after both tasks have finished.
+                        subtree.error = std::current_exception();
+                    }
+                };
+
+                NumericRange<uint32_t> children(0, 2);
+                if (options.useParallelBuild) std::for_each(std::execution::par, children.begin(), children.end(), buildSubtree);
+                else std::for_each(children.begin(), children.end(), buildSubtree);
+
+                for (const Subtree& subtree : subtrees)
+                {
+                    if (subtree.error) std::rethrow_exception(subtree.error);
+                }
+
+                leftIndex = appendSubtree(subtrees[0].nodes, (uint32_t)triangleIndices.size(), nodes);
+                triangleIndices.insert(triangleIndices.end(), subtrees[0].triangleIndices.begin(), subtrees[0].triangleIndices.end());
+                rightIndex = appendSubtree(subtrees[1].nodes, (uint32_t)triangleIndices.size(), nodes);
+                triangleIndices.insert(triangleIndices.end(), subtrees[1].triangleIndices.begin(), subtrees[1].triangleIndices.end());
+            }
+            else
+            {
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, childRanges[0], data, nodes, triangleIndices);
+                rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, childRanges[1], data, nodes, triangleIndices);
+            }
 
             FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
             node.rightChildIdx = rightIndex;
 
-            data.nodes[nodeIndex].setInternalNode(node);
+            nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
         }
         else // No split => create leaf node
@@ -409,9 +611,9 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.length() <= options.maxTriangleCountPerLeaf);
 
             // Allocate leaf node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -421,23 +623,115 @@ namespace Falcor
             node.attribs.cosConeAngle = cosTheta;
 
             node.triangleCount = triangleRange.length();
-            node.triangleOffset = (uint32_t)data.triangleIndices.size();
+            node.triangleOffset = (uint32_t)triangleIndices.size();
             FALCOR_ASSERT(node.triangleCount < kMaxLeafTriangleCount);
             FALCOR_ASSERT(node.triangleOffset < kMaxLeafTriangleOffset);
 
             for (uint32_t triangleIdx = triangleRange.begin, index = 0; triangleIdx < triangleRange.end; ++triangleIdx, ++index)
             {
                 uint32_t globalTriangleIndex = data.trianglesData[triangleIdx].triangleIndex;
-                data.triangleIndices.push_back(globalTriangleIndex);
-                data.triangleBitmasks[globalTriangleIndex] = bitmask;
+                triangleIndices.push_back(globalTriangleIndex);
+                data.triangleBitmasks[globalTriangleIndex] = bitmask; // Each triangle is written by exactly one leaf, so concurrent subtree builds don't conflict.
             }
-            FALCOR_ASSERT(data.triangleIndices.size() == node.triangleOffset + node.triangleCount);
+            FALCOR_ASSERT(triangleIndices.size() == node.triangleOffset + node.triangleCount);
 
-            data.nodes[nodeIndex].setLeafNode(node);
+            nodes[nodeIndex].setLeafNode(node);
             return nodeIndex;
         }
     }
 
+    void LightBVHBuilder::partitionTriangles(BuildingData& data, const Range& triangleRange, const SplitResult& split, bool parallel)
+    {
+        auto getCenter = [axis = split.axis](const TriangleSortData& td) { return td.bounds.center()[axis]; };
+        const uint32_t splitCount = split.triangleIndex - triangleRange.begin;
+
+        if (triangleRange.length() < kParallelBuildThreshold)
+        {
+            auto comp = [&getCenter](const TriangleSortData& d1, const TriangleSortData& d2) { return getCenter(d1) < getCenter(d2); };
+            std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + split.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
+            return;
+        }
+
+        // Gather the sort keys and find the pivot, i.e., the key of the first triangle in the right partition.
+        std::vector<float> keys(triangleRange.length());
+        forEachChunk(parallel, triangleRange.begin, triangleRange.end, [&](uint32_t, uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i) keys[i - triangleRange.begin] = getCenter(data.trianglesData[i]);
+        });
+        std::vector<float> sortedKeys = keys;
+        std::nth_element(sortedKeys.begin(), sortedKeys.begin() + splitCount, sortedKeys.end());
+        const float pivot = sortedKeys[splitCount];
+
+        // Count the triangles below and at the pivot in each chunk.
+        const uint32_t chunkCount = getChunkCount(triangleRange.begin, triangleRange.end);
+        std::vector<uint32_t> lessCount(chunkCount, 0);
+        std::vector<uint32_t> equalCount(chunkCount, 0);
+        forEachChunk(parallel, triangleRange.begin, triangleRange.end, [&](uint32_t chunk, uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const float key = keys[i - triangleRange.begin];
+                lessCount[chunk] += key < pivot ? 1 : 0;
+                equalCount[chunk] += key == pivot ? 1 : 0;
+            }
+        });
+
+        // The left partition gets all triangles below the pivot, and then triangles at the pivot in their original order until it's full.
+        // Compute how many triangles at the pivot go left in each chunk and where each chunk's left triangles start.
+        uint32_t equalBudget = splitCount;
+        for (uint32_t count : lessCount) equalBudget -= count;
+        std::vector<uint32_t> leftEqualCount(chunkCount);
+        std::vector<uint32_t> leftOffset(chunkCount);
+        uint32_t leftTotal = 0;
+        for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            leftEqualCount[chunk] = std::min(equalCount[chunk], equalBudget);
+            equalBudget -= leftEqualCount[chunk];
+            leftOffset[chunk] = leftTotal;
+            leftTotal += lessCount[chunk] + leftEqualCount[chunk];
+        }
+        FALCOR_ASSERT(leftTotal == splitCount);
+
+        // Scatter the triangles to their partition. This is a stable partition, so the result doesn't depend on the scheduling.
+        std::vector<TriangleSortData> partitioned(triangleRange.length());
+        forEachChunk(parallel, triangleRange.begin, triangleRange.end, [&](uint32_t chunk, uint32_t begin, uint32_t end)
+        {
+            uint32_t left = leftOffset[chunk];
+            uint32_t right = splitCount + (begin - triangleRange.begin) - leftOffset[chunk];
+            uint32_t equalLeft = leftEqualCount[chunk];
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const float key = keys[i - triangleRange.begin];
+                bool isLeft = key < pivot;
+                if (key == pivot && equalLeft > 0)
+                {
+                    isLeft = true;
+                    --equalLeft;
+                }
+                partitioned[isLeft ? left++ : right++] = data.trianglesData[i];
+            }
+        });
+        forEachChunk(parallel, triangleRange.begin, triangleRange.end, [&](uint32_t, uint32_t begin, uint32_t end)
+        {
+            std::copy(partitioned.begin() + (begin - triangleRange.begin), partitioned.begin() + (end - triangleRange.begin), data.trianglesData.begin() + begin);
+        });
+    }
+
+    LightBVHBuilder::TriangleSortData LightBVHBuilder::createTriangleSortData(const LightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex)
+    {
+        TriangleSortData tri;
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            tri.bounds |= triangle.vtx[j].pos;
+        }
+        tri.center = triangle.getCenter();
+        tri.coneDirection = triangle.normal;
+        tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
+        tri.flux = triangle.flux;
+        tri.triangleIndex = triangleIndex;
+        return tri;
+    }
+
     float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle)
     {
         if (!data.nodes[nodeIndex].isLeaf())
@@ -498,7 +792,7 @@ namespace Falcor
         return coneDirection;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/)
     {
         // Find the largest dimension.
         float3 dimensions = nodeBounds.extent();
@@ -525,7 +819,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -545,36 +839,45 @@ namespace Falcor
             }
         };
 
+        // Find the largest dimension.
+        float3 dimensions = nodeBounds.extent();
+        uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
+            2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
+        const uint32_t firstDimension = parameters.splitAlongLargest ? largestDimension : 0;
+        const uint32_t lastDimension = parameters.splitAlongLargest ? largestDimension : 2;
+
         FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
+        const uint32_t binCount = parameters.binCount;
+        std::vector<float> costs(binCount - 1);
+
+        // Fill the bins for all dimensions in a single pass over the triangles.
+        // The bins for dimension d are stored at [d * binCount, (d + 1) * binCount).
+        const BinMapping binMapping(nodeBounds, binCount);
+        std::vector<Bin> allBins = reduceRange(parameters.useParallelBuild, triangleRange.begin, triangleRange.end, std::vector<Bin>(3 * binCount),
+            [&](std::vector<Bin>& result, uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    const auto& td = data.trianglesData[i];
+                    const uint3 binIds = binMapping.getBinIds(td.bounds.center());
+                    for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
+                    {
+                        result[dimension * binCount + binIds[dimension]] |= td;
+                    }
+                }
+            },
+            [](std::vector<Bin>& result, const std::vector<Bin>& partial)
+            {
+                for (size_t i = 0; i < result.size(); ++i) result[i] |= partial[i];
+            });
 
         /** Helper function that computes the best split along the given dimension using the SAH metric.
-            The triangles are binned to n bins, storing only the aggregate parameters (triangle count and bounds).
+            The triangles have been binned to n bins, storing only the aggregate parameters (triangle count and bounds).
             Then the cost metric is evaluated for each of the n-1 potential splits.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds](uint32_t dimension)
+        const auto binAlongDimension = [&allBins, binCount, &costs, &triangleRange, &parameters, &overallBestSplit](uint32_t dimension)
         {
-            // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
-            {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                FALCOR_ASSERT(bmin < bmax);
-                float scale = (float)parameters.binCount / (bmax - bmin);
-                float p = td.bounds.center()[dimension];
-                FALCOR_ASSERT(bmin <= p && p <= bmax);
-                return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
-            };
-
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
-            // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            const Bin* bins = allBins.data() + dimension * binCount;
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -616,21 +919,9 @@ namespace Falcor
             }
         };
 
-        if (parameters.splitAlongLargest)
+        for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
         {
-            // Find the largest dimension.
-            float3 dimensions = nodeBounds.extent();
-            uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
-                2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
-
-            binAlongDimension(largestDimension);
-        }
-        else
-        {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
-            {
-                binAlongDimension(dimension);
-            }
+            binAlongDimension(dimension);
         }
 
         // If we couldn't find a valid split, create leaf node immediately if possible or revert to equal splitting.
@@ -638,7 +929,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -680,7 +971,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -711,56 +1002,77 @@ namespace Falcor
             }
         };
 
+        const uint32_t firstDimension = parameters.splitAlongLargest ? largestDimension : 0;
+        const uint32_t lastDimension = parameters.splitAlongLargest ? largestDimension : 2;
+
         FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
+        const uint32_t binCount = parameters.binCount;
+        std::vector<float> costs(binCount - 1);
+
+        // Fill the bins for all dimensions in a single pass over the triangles.
+        // The bins for dimension d are stored at [d * binCount, (d + 1) * binCount).
+        const BinMapping binMapping(nodeBounds, binCount);
+        std::vector<Bin> allBins = reduceRange(parameters.useParallelBuild, triangleRange.begin, triangleRange.end, std::vector<Bin>(3 * binCount),
+            [&](std::vector<Bin>& result, uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    const auto& td = data.trianglesData[i];
+                    const uint3 binIds = binMapping.getBinIds(td.bounds.center());
+                    for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
+                    {
+                        result[dimension * binCount + binIds[dimension]] |= td;
+                    }
+                }
+            },
+            [](std::vector<Bin>& result, const std::vector<Bin>& partial)
+            {
+                for (size_t i = 0; i < result.size(); ++i) result[i] |= partial[i];
+            });
+
+        // Compute the lighting cones for each bin.
+        // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
+        // If the vector is zero length (no lights or if all directions cancelled out), the cone is marked as invalid.
+        // TODO: Switch to a more sophisticated algorithm to get narrower cones.
+        std::vector<float> cosConeAngles(allBins.size());
+        for (size_t i = 0; i < allBins.size(); ++i)
+        {
+            Bin& bin = allBins[i];
+            bin.cosConeAngle = length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
+            bin.coneDirection = normalize(bin.coneDirection);
+            cosConeAngles[i] = bin.cosConeAngle;
+        }
+        cosConeAngles = reduceRange(parameters.useParallelBuild, triangleRange.begin, triangleRange.end, cosConeAngles,
+            [&](std::vector<float>& result, uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    const auto& td = data.trianglesData[i];
+                    const uint3 binIds = binMapping.getBinIds(td.bounds.center());
+                    for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
+                    {
+                        const uint32_t binIndex = dimension * binCount + binIds[dimension];
+                        result[binIndex] = computeCosConeAngle(allBins[binIndex].coneDirection, result[binIndex], td.coneDirection, td.cosConeAngle);
+                    }
+                }
+            },
+            [](std::vector<float>& result, const std::vector<float>& partial)
+            {
+                // Growing a cone to include another is order independent, so the partial results can simply be combined.
+                for (size_t i = 0; i < result.size(); ++i) result[i] = combineCosConeAngles(result[i], partial[i]);
+            });
+        for (size_t i = 0; i < allBins.size(); ++i) allBins[i].cosConeAngle = cosConeAngles[i];
 
         /** Helper function that computes the best split along the given dimension using the SAOH metric.
-            The triangles are binned to n bins, storing only the aggregate parameters (triangle count, bounds, flux, and cone direction).
+            The triangles have been binned to n bins, storing only the aggregate parameters (triangle count, bounds, flux, and cone direction).
             Then the cost metric is evaluated for each of the n-1 potential splits.
             Note that while the bounds and flux are accurately represented by the aggregated parameters,
             the bounding cones are approximates based on the bins' bounding cones. This is less expensive,
             but also less precise than computing them directly from the triangles.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds, largestDimension, dimensions](uint32_t dimension)
+        const auto binAlongDimension = [&allBins, binCount, &costs, &triangleRange, &parameters, &overallBestSplit, largestDimension, dimensions](uint32_t dimension)
         {
-            // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
-            {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                float w = bmax - bmin;
-                FALCOR_ASSERT(w >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
-                float scale = w > FLT_MIN ? (float)parameters.binCount / w : 0.f;
-                float p = td.bounds.center()[dimension];
-                FALCOR_ASSERT(bmin <= p && p <= bmax);
-                return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
-            };
-
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
-            // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
-
-            // Compute the lighting cones for each bin.
-            // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
-            // If the vector is zero length (no lights or if all directions cancelled out), the cone is marked as invalid.
-            // TODO: Switch to a more sophisticated algorithm to get narrower cones.
-            for (Bin& bin : bins)
-            {
-                bin.cosConeAngle = length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
-                bin.coneDirection = normalize(bin.coneDirection);
-            }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
-            }
+            const Bin* bins = allBins.data() + dimension * binCount;
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -832,16 +1144,9 @@ namespace Falcor
         };
 
         // Compute the best split.
-        if (parameters.splitAlongLargest)
+        for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
         {
-            binAlongDimension(largestDimension);
-        }
-        else
-        {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
-            {
-                binAlongDimension(dimension);
-            }
+            binAlongDimension(dimension);
         }
 
         // If we couldn't find a valid split, create leaf node immediately if possible or revert to equal splitting.
@@ -849,7 +1154,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAOH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -859,13 +1164,226 @@ namespace Falcor
             // Evaluate the cost metric for the node. This requires us to first compute the cone angle.
             float cosTheta = kInvalidCosConeAngle;
             computeLightingCone(triangleRange, data, cosTheta);
-            float leafCost = evalSAOH(nodeBounds, data.currentNodeFlux, cosTheta, parameters);
+            float leafCost = evalSAOH(nodeBounds, nodeFlux, cosTheta, parameters);
             if (leafCost <= overallBestSplit.first) return SplitResult();
         }
 
         return overallBestSplit.second;
     }
 
+    /** Evaluates the cost metric of a single node for the selected split heuristic.
+        This is the SAOH cost for BinnedSAOH and the SAH cost otherwise.
+    */
+    static float evalNodeCost(const AABB& bounds, const uint32_t triangleCount, const float flux, const float cosTheta, const LightBVHBuilder::Options& parameters)
+    {
+        return parameters.splitHeuristicSelection == LightBVHBuilder::SplitHeuristic::BinnedSAOH ?
+            evalSAOH(bounds, flux, cosTheta, parameters) : evalSAH(bounds, triangleCount, parameters);
+    }
+
+    LightBVHBuilder::RefitStats LightBVHBuilder::refit(RenderContext* pRenderContext, LightBVH& bvh)
+    {
+        FALCOR_PROFILE(pRenderContext, "LightBVHBuilder::refit()");
+
+        FALCOR_ASSERT(bvh.isValid());
+        FALCOR_ASSERT(bvh.mpLightCollection);
+        const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles(pRenderContext);
+
+        // The hierarchy references the triangles by index, so it can only be refitted if the triangle list has the same layout.
+        if (triangles.size() != bvh.mTriangleBitmasks.size())
+        {
+            build(pRenderContext, bvh);
+            return {};
+        }
+
+        // Fetch the nodes in case they were refitted on the GPU.
+        bvh.syncDataToCPU();
+
+        RefitStats stats = refitNodes(triangles, bvh.mNodes, bvh.mTriangleIndices, bvh.mTriangleBitmasks, bvh.mNodeCosts);
+
+        if (stats.rebuiltSubtreeCount > 0)
+        {
+            // The hierarchy has changed, upload all data and recompute the metadata.
+            bvh.uploadCPUBuffers(bvh.mTriangleIndices, bvh.mTriangleBitmasks);
+            bvh.finalize();
+        }
+        else
+        {
+            bvh.uploadNodes();
+        }
+
+        return stats;
+    }
+
+    LightBVHBuilder::RefitStats LightBVHBuilder::refitNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks, std::vector<float>& nodeCosts)
+    {
+        RefitStats stats;
+        if (nodes.empty()) return stats;
+
+        checkArgument(triangleBitmasks.size() == triangles.size(), "Triangle count ({}) does not match the BVH ({}).", triangles.size(), triangleBitmasks.size());
+        checkArgument(nodeCosts.empty() || nodeCosts.size() == nodes.size(), "'nodeCosts' must be empty or have one entry per node.");
+
+        const bool initCosts = nodeCosts.empty();
+        if (initCosts) nodeCosts.resize(nodes.size(), kUnsetCost);
+
+        // Recursively refit the nodes bottom-up. The bounds, flux and bounding cones are computed the same way as in the build.
+        // Costs that are not set yet are initialized with the refitted node cost.
+        std::vector<RefitNodeInfo> nodeInfos;
+        auto refitSubtree = [&](auto&& self, uint32_t nodeIndex) -> void
+        {
+            RefitNodeInfo info;
+            float childrenCost = 0.f;
+            float childrenReferenceCost = 0.f;
+
+            if (nodes[nodeIndex].isLeaf())
+            {
+                LeafNode node = nodes[nodeIndex].getLeafNode();
+                info.triangleOffset = node.triangleOffset;
+                info.triangleCount = node.triangleCount;
+                FALCOR_ASSERT(info.triangleOffset + info.triangleCount <= triangleIndices.size());
+
+                float3 coneDirectionSum = float3(0.f);
+                for (uint32_t i = 0; i < node.triangleCount; ++i)
+                {
+                    const auto& triangle = triangles[triangleIndices[node.triangleOffset + i]];
+                    for (uint32_t j = 0; j < 3; ++j) info.bounds |= triangle.vtx[j].pos;
+                    info.flux += triangle.flux;
+                    coneDirectionSum += triangle.normal;
+                }
+
+                // Same bounding cone as computeLightingCone().
+                if (length(coneDirectionSum) >= FLT_MIN)
+                {
+                    info.coneDirection = normalize(coneDirectionSum);
+                    info.cosConeAngle = 1.f;
+                    for (uint32_t i = 0; i < node.triangleCount; ++i)
+                    {
+                        const auto& triangle = triangles[triangleIndices[node.triangleOffset + i]];
+                        info.cosConeAngle = computeCosConeAngle(info.coneDirection, info.cosConeAngle, triangle.normal, 1.f);
+                    }
+                }
+
+                node.attribs.setAABB(info.bounds.minPoint, info.bounds.maxPoint);
+                node.attribs.flux = info.flux;
+                node.attribs.coneDirection = info.coneDirection;
+                node.attribs.cosConeAngle = info.cosConeAngle;
+                nodes[nodeIndex].setLeafNode(node);
+            }
+            else
+            {
+                InternalNode node = nodes[nodeIndex].getInternalNode();
+                const uint32_t leftIndex = nodeIndex + 1;
+                const uint32_t rightIndex = node.rightChildIdx;
+                self(self, leftIndex);
+                self(self, rightIndex);
+
+                const RefitNodeInfo& left = nodeInfos[leftIndex];
+                const RefitNodeInfo& right = nodeInfos[rightIndex];
+                info.bounds = left.bounds;
+                info.bounds |= right.bounds;
+                info.flux = left.flux + right.flux;
+                info.coneDirection = coneUnionOld(left.coneDirection, left.cosConeAngle, right.coneDirection, right.cosConeAngle, info.cosConeAngle);
+                info.triangleOffset = left.triangleOffset;
+                info.triangleCount = left.triangleCount + right.triangleCount;
+                FALCOR_ASSERT(left.triangleOffset + left.triangleCount == right.triangleOffset);
+                childrenCost = left.cost + right.cost;
+                childrenReferenceCost = left.referenceCost + right.referenceCost;
+
+                node.attribs.setAABB(info.bounds.minPoint, info.bounds.maxPoint);
+                node.attribs.flux = info.flux;
+                node.attribs.coneDirection = info.coneDirection;
+                node.attribs.cosConeAngle = info.cosConeAngle;
+                nodes[nodeIndex].setInternalNode(node);
+            }
+
+            const float nodeCost = evalNodeCost(info.bounds, info.triangleCount, info.flux, info.cosConeAngle, mOptions);
+            if (nodeCosts[nodeIndex] == kUnsetCost) nodeCosts[nodeIndex] = nodeCost;
+            info.cost = childrenCost + nodeCost;
+            info.referenceCost = childrenReferenceCost + nodeCosts[nodeIndex];
+            nodeInfos[nodeIndex] = info;
+        };
+
+        nodeInfos.resize(nodes.size());
+        refitSubtree(refitSubtree, 0);
+
+        stats.referenceCost = nodeInfos[0].referenceCost;
+        stats.refitCost = nodeInfos[0].cost;
+        stats.finalCost = stats.refitCost;
+        if (initCosts || mOptions.rebuildCostThreshold <= 0.f) return stats;
+
+        auto isDegraded = [&](uint32_t nodeIndex)
+        {
+            return !nodes[nodeIndex].isLeaf() && nodeInfos[nodeIndex].cost > mOptions.rebuildCostThreshold * nodeInfos[nodeIndex].referenceCost;
+        };
+        bool hasDegradedNodes = false;
+        for (uint32_t nodeIndex = 0; nodeIndex < nodes.size() && !hasDegradedNodes; ++nodeIndex) hasDegradedNodes = isDegraded(nodeIndex);
+        if (!hasDegradedNodes) return stats;
+
+        // Rebuild the topmost internal nodes whose subtree cost degraded past the threshold.
+        // The nodes are copied to a new list in depth-first order, replacing degraded subtrees by new ones built over the same triangles.
+        // The triangles of a subtree are contiguous in the triangle index list, and keep their place there when rebuilt.
+        std::vector<PackedNode> scratchNodes;
+        BuildingData data(scratchNodes);
+        data.triangleBitmasks = std::move(triangleBitmasks);
+        const SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
+
+        std::vector<PackedNode> newNodes;
+        std::vector<float> newNodeCosts;
+        newNodes.reserve(nodes.size());
+        newNodeCosts.reserve(nodes.size());
+
+        auto copySubtree = [&](auto&& self, uint32_t nodeIndex, uint32_t depth, uint64_t bitmask) -> uint32_t
+        {
+            const RefitNodeInfo& info = nodeInfos[nodeIndex];
+            if (isDegraded(nodeIndex))
+            {
+                data.trianglesData.clear();
+                for (uint32_t i = info.triangleOffset; i < info.triangleOffset + info.triangleCount; ++i)
+                {
+                    data.trianglesData.push_back(createTriangleSortData(triangles[triangleIndices[i]], triangleIndices[i]));
+                }
+
+                std::vector<PackedNode> subtreeNodes;
+                std::vector<uint32_t> subtreeTriangleIndices;
+                buildInternal(mOptions, splitFunc, bitmask, depth, Range(0, info.triangleCount), data, subtreeNodes, subtreeTriangleIndices);
+                FALCOR_ASSERT(subtreeTriangleIndices.size() == info.triangleCount);
+                std::copy(subtreeTriangleIndices.begin(), subtreeTriangleIndices.end(), triangleIndices.begin() + info.triangleOffset);
+
+                stats.rebuiltSubtreeCount++;
+                stats.rebuiltTriangleCount += info.triangleCount;
+
+                // The costs of the new nodes are recorded when refitting the new hierarchy below.
+                newNodeCosts.resize(newNodeCosts.size() + subtreeNodes.size(), kUnsetCost);
+                return appendSubtree(subtreeNodes, info.triangleOffset, newNodes);
+            }
+
+            const uint32_t newIndex = (uint32_t)newNodes.size();
+            newNodes.push_back(nodes[nodeIndex]);
+            newNodeCosts.push_back(nodeCosts[nodeIndex]);
+            if (!nodes[nodeIndex].isLeaf())
+            {
+                const uint32_t rightIndex = nodes[nodeIndex].getInternalNode().rightChildIdx;
+                [[maybe_unused]] const uint32_t newLeftIndex = self(self, nodeIndex + 1, depth + 1, bitmask);
+                FALCOR_ASSERT(newLeftIndex == newIndex + 1);
+                const uint32_t newRightIndex = self(self, rightIndex, depth + 1, bitmask | (1ull << depth));
+                newNodes[newIndex].data[0].x = newRightIndex; // Internal nodes store the right child index in the first dword, see appendSubtree().
+            }
+            return newIndex;
+        };
+        copySubtree(copySubtree, 0, 0, 0ull);
+        FALCOR_ASSERT(stats.rebuiltSubtreeCount > 0);
+        triangleBitmasks = std::move(data.triangleBitmasks);
+
+        // Refit the new hierarchy to compute the lighting cones of the new nodes and record their costs.
+        nodes = std::move(newNodes);
+        nodeCosts = std::move(newNodeCosts);
+        nodeInfos.clear();
+        nodeInfos.resize(nodes.size());
+        refitSubtree(refitSubtree, 0);
+        stats.finalCost = nodeInfos[0].cost;
+
+        return stats;
+    }
+
     LightBVHBuilder::SplitHeuristicFunction LightBVHBuilder::getSplitFunction(SplitHeuristic heuristic)
     {
         switch (heuristic)
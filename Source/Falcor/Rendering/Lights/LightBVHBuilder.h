@@ -32,7 +32,6 @@
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/UI/Gui.h"
-#include <functional>
 #include <limits>
 #include <memory>
 #include <vector>
@@ -78,6 +77,9 @@ namespace Falcor
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            bool           useCpuRefit = false;                                  ///< Refit the BVH on the CPU and rebuild subtrees whose cost degraded, rather than refitting on the GPU. Only used when 'allowRefitting' is enabled.
+            float          rebuildCostThreshold = 1.5f;                          ///< Subtrees whose SAH/SAOH cost grew by more than this factor since they were built are rebuilt during a CPU refit. Set to zero to never rebuild.
+            bool           useParallelBuild = true;                              ///< Build large subtrees concurrently and bin/partition large triangle ranges on multiple threads. The resulting BVH is identical to a single-threaded build.
 
             template<typename Archive>
             void serialize(Archive& ar)
@@ -93,9 +95,28 @@ namespace Falcor
                 ar("allowRefitting", allowRefitting);
                 ar("usePreintegration", usePreintegration);
                 ar("useLightingCones", useLightingCones);
+                ar("useCpuRefit", useCpuRefit);
+                ar("rebuildCostThreshold", rebuildCostThreshold);
+                ar("useParallelBuild", useParallelBuild);
             }
         };
 
+        /** Statistics of a CPU refit.
+            The costs are sums of the per node SAOH cost for the BinnedSAOH split heuristic and of the per node SAH cost otherwise.
+        */
+        struct RefitStats
+        {
+            float referenceCost = 0.f;          ///< Cost of the tree when its nodes were built.
+            float refitCost = 0.f;              ///< Cost of the refitted tree, before rebuilding degraded subtrees.
+            float finalCost = 0.f;              ///< Cost of the tree after rebuilding degraded subtrees.
+            uint32_t rebuiltSubtreeCount = 0;   ///< Number of subtrees that were rebuilt.
+            uint32_t rebuiltTriangleCount = 0;  ///< Number of triangles in the rebuilt subtrees.
+
+            /** Returns the cost change caused by refitting the hierarchy to the updated triangles.
+            */
+            float getCostDelta() const { return refitCost - referenceCost; }
+        };
+
         /** Constructor.
             \param[in] options The options to use for building the BVH.
         */
@@ -106,6 +127,35 @@ namespace Falcor
         */
         void build(RenderContext* pRenderContext, LightBVH& bvh);
 
+        /** Build the BVH nodes on the CPU for a list of emissive triangles.
+            This is the CPU part of build(); the output is not uploaded to the GPU.
+            \param[in] triangles Emissive triangles to build the BVH over.
+            \param[out] nodes BVH nodes in depth-first order. Empty if all triangles were culled.
+            \param[out] triangleIndices Triangle indices sorted by leaf node.
+            \param[out] triangleBitmasks Per triangle bit pattern retracing the tree traversal to reach the triangle, indexed by triangle index.
+        */
+        void buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks);
+
+        /** Refit the BVH on the CPU to the current emissive triangles and rebuild degraded subtrees.
+            This is an alternative to LightBVH::refit() that measures the tree quality. If the triangle count has changed, the BVH is rebuilt instead.
+            \param[in,out] bvh The light BVH to refit. It must have been built with build().
+            \return Refit statistics.
+        */
+        RefitStats refit(RenderContext* pRenderContext, LightBVH& bvh);
+
+        /** Refit BVH nodes on the CPU and rebuild degraded subtrees.
+            The node bounds, flux and lighting cones are recomputed bottom-up from the triangles without changing the hierarchy.
+            Then the cost of each subtree is compared to its cost when it was built, and the topmost subtrees whose cost
+            grew by more than Options::rebuildCostThreshold are rebuilt over the same triangles.
+            \param[in] triangles Emissive triangles. The list must match the one the nodes were built from, except for the triangle data.
+            \param[in,out] nodes BVH nodes from buildNodes().
+            \param[in,out] triangleIndices Triangle indices from buildNodes().
+            \param[in,out] triangleBitmasks Triangle bitmasks from buildNodes().
+            \param[in,out] nodeCosts Cost of each node when it was built. If empty, it is initialized from the current triangles and no subtree is rebuilt.
+            \return Refit statistics.
+        */
+        RefitStats refitNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks, std::vector<float>& nodeCosts);
+
         bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -149,18 +199,22 @@ namespace Falcor
             std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
             std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
             std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
-            float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
 
             BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
         };
 
+        /** Precompute the data needed for the build for an emissive triangle.
+        */
+        static TriangleSortData createTriangleSortData(const LightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex);
+
         /** Compute the split according to a specified heuristic.
             \param[in] data Prepared light data.
             \param[in] triangleRange Range of triangles to process.
             \param[in] nodeBounds Bounds for the node to be splitted.
+            \param[in] nodeFlux Total flux of the node to be splitted. Used as the leaf creation cost by computeSplitWithBinnedSAOH().
             \param[in] parameters Various parameters defining how the building should occur.
         */
-        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)>;
+        using SplitHeuristicFunction = SplitResult(*)(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters);
 
         /** Renders the UI with builder options.
         */
@@ -172,9 +226,20 @@ namespace Falcor
             \param[in] depth Depth of the node to be built
             \param[in] triangleRange Range of triangles to process.
             \param[in,out] data Prepared light data.
-            \return Index of the allocated node.
+            \param[in,out] nodes Node list the subtree is appended to.
+            \param[in,out] triangleIndices Triangle index list the subtree's leaf triangles are appended to.
+            \return Index of the allocated node in 'nodes'.
+        */
+        uint32_t buildInternal(const Options& options, SplitHeuristicFunction splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices);
+
+        /** Partition a range of triangles along an axis so that the triangles before the split index have bounds centers no larger than those after it.
+            Small ranges are partitioned with std::nth_element. Large ranges are partitioned in chunks, which is deterministic and can run in parallel.
+            \param[in,out] data Prepared light data.
+            \param[in] triangleRange Range of triangles to process.
+            \param[in] split The split to apply.
+            \param[in] parallel Process the chunks in parallel.
         */
-        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+        static void partitionTriangles(BuildingData& data, const Range& triangleRange, const SplitResult& split, bool parallel);
 
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodeIndex Index of the current node.
@@ -193,9 +258,9 @@ namespace Falcor
         static float3 computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta);
 
         // See the documentation of SplitHeuristicFunction.
-        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/);
-        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
-        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
+        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/);
+        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& parameters);
+        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters);
 
         static SplitHeuristicFunction getSplitFunction(SplitHeuristic heuristic);
 
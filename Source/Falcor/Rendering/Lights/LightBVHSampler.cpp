@@ -57,7 +57,8 @@ namespace Falcor
         }
         else if (needsRefit)
         {
-            mpBVH->refit(pRenderContext);
+            if (mOptions.buildOptions.useCpuRefit) mRefitStats = mpBVHBuilder->refit(pRenderContext, *mpBVH);
+            else mpBVH->refit(pRenderContext);
             samplerChanged = true;
         }
 
@@ -124,6 +125,18 @@ namespace Falcor
         if (auto statGroup = widgets.group("BVH statistics"))
         {
             mpBVH->renderUI(statGroup);
+
+            if (mOptions.buildOptions.allowRefitting && mOptions.buildOptions.useCpuRefit)
+            {
+                const std::string refitStr =
+                    "Last CPU refit:\n"
+                    "  Reference cost:      " + std::to_string(mRefitStats.referenceCost) + "\n" +
+                    "  Refit cost delta:    " + std::to_string(mRefitStats.getCostDelta()) + "\n" +
+                    "  Final cost:          " + std::to_string(mRefitStats.finalCost) + "\n" +
+                    "  Rebuilt subtrees:    " + std::to_string(mRefitStats.rebuiltSubtreeCount) + "\n" +
+                    "  Rebuilt triangles:   " + std::to_string(mRefitStats.rebuiltTriangleCount);
+                statGroup.text(refitStr);
+            }
         }
 
         return optionsChanged;
@@ -123,6 +123,7 @@ namespace Falcor
         // Internal state
         std::unique_ptr<LightBVHBuilder> mpBVHBuilder;
         std::unique_ptr<LightBVH> mpBVH;
+        LightBVHBuilder::RefitStats mRefitStats;    ///< Statistics of the last CPU refit.
 
         /// Trigger rebuild on the next call to update(). We should always build on the first call, so the initial value is true.
         bool mNeedsRebuild = true;
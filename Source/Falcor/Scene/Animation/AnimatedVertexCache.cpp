@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "AnimatedVertexCache.h"
 #include "Animation.h"
+#include "CpuVertexAnimation.h"
 #include "Core/API/RenderContext.h"
 #include "Scene/Scene.h"
 #include "Utils/Timing/Profiler.h"
@@ -179,6 +180,25 @@ namespace Falcor
         executeMeshVertexUpdatePass(pRenderContext, 0.0f, true);
     }
 
+    void AnimatedVertexCache::bakeMeshVertexData(double time, fstd::span<PackedStaticVertexData> vertexData) const
+    {
+        auto postInfinityBehavior = mLoopAnimations ? Animation::Behavior::Cycle : Animation::Behavior::Constant;
+
+        for (const auto& cache : mCachedMeshes)
+        {
+            InterpolationInfo interp = calculateInterpolation(time, cache.timeSamples, mPreInfinityBehavior, postInfinityBehavior);
+            uint32_t vbOffset = mpScene->getMesh(cache.meshID).vbOffset;
+            size_t vertexCount = cache.vertexData.front().size();
+            FALCOR_ASSERT(vbOffset + vertexCount <= vertexData.size());
+
+            CpuVertexAnimation::interpolateVertices(
+                cache.vertexData[interp.keyframeIndices.x],
+                cache.vertexData[interp.keyframeIndices.y],
+                interp.t,
+                vertexData.subspan(vbOffset, vertexCount));
+        }
+    }
+
     bool AnimatedVertexCache::hasAnimations() const
     {
         return hasMeshAnimations() || hasCurveAnimations();
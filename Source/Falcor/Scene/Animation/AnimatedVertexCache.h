@@ -34,6 +34,7 @@
 #include "Scene/SceneTypes.slang"
 #include "Scene/SceneIDs.h"
 #include "Utils/Sampling/SampleGenerator.h"
+#include <fstd/span.h>
 
 #include <algorithm>
 #include <limits>
@@ -94,6 +95,13 @@ namespace Falcor
 
         void copyToPrevVertices(RenderContext* pContext);
 
+        /** Interpolate the animated meshes at a given time on the CPU.
+            This is the CPU equivalent of the mesh vertex update pass. Animated curves are not handled.
+            \param[in] time Time in seconds.
+            \param[in,out] vertexData Vertex data for all meshes in the scene. Only the vertices of animated meshes are written.
+        */
+        void bakeMeshVertexData(double time, fstd::span<PackedStaticVertexData> vertexData) const;
+
         ref<Buffer> getPrevCurveVertexData() const { return mpPrevCurveVertexBuffer; }
 
         uint64_t getMemoryUsageInBytes() const;
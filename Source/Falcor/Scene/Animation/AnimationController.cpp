@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "AnimationController.h"
+#include "CpuVertexAnimation.h"
 #include "Core/API/RenderContext.h"
 #include "Utils/Timing/Profiler.h"
 #include "Scene/Scene.h"
@@ -84,6 +85,8 @@ namespace Falcor
         }
 
         createSkinningPass(staticVertexData, skinningVertexData);
+        mSkinningVertexData = skinningVertexData;
+        mStaticVertexCount = staticVertexData.size();
 
         // Determine length of global animation loop.
         for (const auto& pAnimation : mAnimations)
@@ -195,6 +198,7 @@ namespace Falcor
         FALCOR_PROFILE(pRenderContext, "animate");
 
         std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), false);
+        mChangedMatrices.clear();
 
         // Check for edited scene nodes and update local matrices.
         const auto& sceneGraph = mpScene->mSceneGraph;
@@ -301,6 +305,8 @@ namespace Falcor
     {
         const auto& sceneGraph = mpScene->mSceneGraph;
 
+        mChangedMatrices.clear();
+
         for (size_t i = 0; i < mGlobalMatrices.size(); i++)
         {
             // Propagate matrix change flag to children.
@@ -309,7 +315,11 @@ namespace Falcor
                 mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
             }
 
-            if (!mMatricesChanged[i] && !updateAll) continue;
+            // When updating all matrices they all count as changed, as the local matrices may have been reset.
+            if (updateAll) mMatricesChanged[i] = true;
+            if (!mMatricesChanged[i]) continue;
+
+            mChangedMatrices.push_back(NodeID{ i });
 
             mGlobalMatrices[i] = mLocalMatrices[i];
 
@@ -466,6 +476,84 @@ namespace Falcor
         mpSkinningPass->execute(pRenderContext, mSkinningDispatchSize, 1, 1);
     }
 
+    void AnimationController::bakeVertexData(double time, std::vector<PackedStaticVertexData>& vertexData) const
+    {
+        checkArgument(vertexData.size() == mStaticVertexCount, "'vertexData' has {} vertices, expected {}.", vertexData.size(), mStaticVertexCount);
+
+        const auto& sceneGraph = mpScene->mSceneGraph;
+        double animationTime = mLoopAnimations ? std::fmod(time, mGlobalAnimationLength) : time;
+
+        // Evaluate the local and global matrices at the given time in temporary storage.
+        std::vector<float4x4> localMatrices(sceneGraph.size());
+        for (size_t i = 0; i < sceneGraph.size(); i++) localMatrices[i] = sceneGraph[i].transform;
+        for (const auto& pAnimation : mAnimations)
+        {
+            localMatrices[pAnimation->getNodeID().get()] = pAnimation->animate(animationTime);
+        }
+
+        std::vector<float4x4> globalMatrices(sceneGraph.size());
+        std::vector<float4x4> invTransposeGlobalMatrices(sceneGraph.size());
+        for (size_t i = 0; i < sceneGraph.size(); i++)
+        {
+            globalMatrices[i] = localMatrices[i];
+            if (sceneGraph[i].parent != NodeID::Invalid())
+            {
+                globalMatrices[i] = mul(globalMatrices[sceneGraph[i].parent.get()], globalMatrices[i]);
+            }
+            invTransposeGlobalMatrices[i] = transpose(inverse(globalMatrices[i]));
+        }
+
+        if (!mSkinningVertexData.empty())
+        {
+            std::vector<float4x4> skinningMatrices(sceneGraph.size());
+            std::vector<float4x4> invTransposeSkinningMatrices(sceneGraph.size());
+            std::vector<float4x4> meshBindMatrices(sceneGraph.size());
+            std::vector<float4x4> meshInvBindMatrices(sceneGraph.size());
+            for (size_t i = 0; i < sceneGraph.size(); i++)
+            {
+                skinningMatrices[i] = mul(globalMatrices[i], sceneGraph[i].localToBindSpace);
+                invTransposeSkinningMatrices[i] = transpose(inverse(skinningMatrices[i]));
+                meshBindMatrices[i] = sceneGraph[i].meshBind;
+                meshInvBindMatrices[i] = inverse(meshBindMatrices[i]);
+            }
+
+            CpuVertexAnimation::SkinningTransforms transforms;
+            transforms.boneMatrices = skinningMatrices;
+            transforms.inverseTransposeBoneMatrices = invTransposeSkinningMatrices;
+            transforms.worldMatrices = globalMatrices;
+            transforms.inverseTransposeWorldMatrices = invTransposeGlobalMatrices;
+            transforms.meshBindMatrices = meshBindMatrices;
+            transforms.meshInvBindMatrices = meshInvBindMatrices;
+
+            // Each skinned vertex reads and writes only its own static vertex, so skinning can be done in place.
+            CpuVertexAnimation::skinVertices(transforms, mSkinningVertexData, vertexData, vertexData);
+        }
+
+        if (mpVertexCache && mpVertexCache->hasMeshAnimations())
+        {
+            double vertexCacheTime = (mGlobalAnimationLength == 0) ? time : animationTime;
+            mpVertexCache->bakeMeshVertexData(vertexCacheTime, vertexData);
+        }
+    }
+
+    std::vector<PackedStaticVertexData> AnimationController::bakeVertexData(double time) const
+    {
+        std::vector<PackedStaticVertexData> vertexData(mStaticVertexCount);
+        if (vertexData.empty()) return vertexData;
+
+        // The skinning pass keeps a copy of the bind pose, as the scene's vertex buffer is overwritten by skinning.
+        // Without skinning, the scene's vertex buffer holds the unanimated data except for vertex-cached meshes,
+        // which are fully overwritten by bakeVertexData().
+        const ref<Buffer>& pBuffer = mpStaticVertexData ? mpStaticVertexData : mpScene->getMeshVao()->getVertexBuffer(Scene::kStaticDataBufferIndex);
+        FALCOR_ASSERT(pBuffer && pBuffer->getSize() >= vertexData.size() * sizeof(PackedStaticVertexData));
+        const auto* pData = reinterpret_cast<const PackedStaticVertexData*>(pBuffer->map(Buffer::MapType::Read));
+        std::copy(pData, pData + vertexData.size(), vertexData.begin());
+        pBuffer->unmap();
+
+        bakeVertexData(time, vertexData);
+        return vertexData;
+    }
+
     void AnimationController::renderUI(Gui::Widgets& widget)
     {
         if (widget.checkbox("Loop Animations", mLoopAnimations))
@@ -110,6 +110,11 @@ namespace Falcor
         */
         bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()]; }
 
+        /** Get the list of matrices that changed since last frame, in ascending order.
+            This is the same set as queried by isMatrixChanged(), but allows iterating over it without visiting all nodes.
+        */
+        const std::vector<NodeID>& getChangedMatrices() const { return mChangedMatrices; }
+
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
         */
@@ -142,6 +147,22 @@ namespace Falcor
         */
         uint64_t getMemoryUsageInBytes() const;
 
+        /** Compute the posed vertex data at a given time on the CPU.
+            This evaluates the animations, skinning and animated mesh caches the same way as animate() does,
+            but without modifying the controller state or using the GPU. It is intended for offline export of
+            posed meshes and for validating the animation output. Animated curve caches are not applied.
+            \param[in] time Global time in seconds. Looping is applied the same way as in animate().
+            \param[in,out] vertexData Vertex data for all meshes. On input this must hold the unanimated static vertex data of the scene.
+        */
+        void bakeVertexData(double time, std::vector<PackedStaticVertexData>& vertexData) const;
+
+        /** Compute the posed vertex data at a given time on the CPU.
+            Same as above, but the unanimated vertex data is read back from the GPU. This stalls the GPU.
+            \param[in] time Global time in seconds.
+            \return Vertex data for all meshes.
+        */
+        std::vector<PackedStaticVertexData> bakeVertexData(double time) const;
+
     private:
         friend class SceneBuilder;
 
@@ -164,6 +185,7 @@ namespace Falcor
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
         std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<NodeID> mChangedMatrices;       ///< List of matrices that changed since last frame, in ascending order.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
@@ -186,6 +208,8 @@ namespace Falcor
         std::vector<float4x4> mSkinningMatrices;
         std::vector<float4x4> mInvTransposeSkinningMatrices;
         uint32_t mSkinningDispatchSize = 0;
+        SkinningVertexVector mSkinningVertexData;   ///< CPU copy of the skinning data, used by bakeVertexData().
+        size_t mStaticVertexCount = 0;              ///< Number of vertices in the static vertex data.
 
         ref<Buffer> mpMeshBindMatricesBuffer;
         ref<Buffer> mpMeshInvBindMatricesBuffer;
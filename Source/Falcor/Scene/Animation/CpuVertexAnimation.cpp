@@ -0,0 +1,154 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CpuVertexAnimation.h"
+#include "Core/Assert.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <execution>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Number of vertices processed per task.
+        const size_t kChunkSize = 4096;
+
+        template<typename F>
+        void forEachChunk(size_t count, F func)
+        {
+            size_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+            NumericRange<size_t> range(0, chunkCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t chunk)
+            {
+                size_t begin = chunk * kChunkSize;
+                size_t end = std::min(begin + kChunkSize, count);
+                func(begin, end);
+            });
+        }
+
+        // Weighted sum of four matrices, computed row by row on float4 vectors.
+        float4x4 blendMatrices(fstd::span<const float4x4> matrices, const uint4& ids, const float4& weights)
+        {
+            const float4x4& m0 = matrices[ids.x];
+            const float4x4& m1 = matrices[ids.y];
+            const float4x4& m2 = matrices[ids.z];
+            const float4x4& m3 = matrices[ids.w];
+
+            float4x4 result;
+            for (int r = 0; r < 4; r++)
+            {
+                result[r] = m0[r] * weights.x + m1[r] * weights.y + m2[r] * weights.z + m3[r] * weights.w;
+            }
+            return result;
+        }
+
+        float3 transformVector3x3(const float4x4& m, const float3& v)
+        {
+            return float3(dot(m[0].xyz(), v), dot(m[1].xyz(), v), dot(m[2].xyz(), v));
+        }
+    }
+
+    namespace CpuVertexAnimation
+    {
+        void skinVertices(
+            const SkinningTransforms& transforms,
+            fstd::span<const SkinningVertexData> skinningData,
+            fstd::span<const PackedStaticVertexData> staticData,
+            fstd::span<PackedStaticVertexData> skinnedVertices,
+            fstd::span<PrevVertexData> prevVertices,
+            bool initPrev)
+        {
+            FALCOR_ASSERT(prevVertices.empty() || prevVertices.size() == skinningData.size());
+            FALCOR_ASSERT(staticData.size() == skinnedVertices.size());
+
+            forEachChunk(skinningData.size(), [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    const SkinningVertexData& s = skinningData[i];
+                    FALCOR_ASSERT(s.staticIndex < staticData.size());
+
+                    // Same sequence of transforms as SkinningData::getBlendedMatrix() in Skinning.slang.
+                    float4x4 boneMat = blendMatrices(transforms.boneMatrices, s.boneID, s.boneWeight);
+                    boneMat = mul(boneMat, transforms.meshBindMatrices[s.bindMatrixID]);
+                    boneMat = mul(transpose(transforms.inverseTransposeWorldMatrices[s.skeletonMatrixID]), boneMat);
+                    boneMat = mul(transforms.meshInvBindMatrices[s.bindMatrixID], boneMat);
+
+                    float4x4 invTransposeMat = blendMatrices(transforms.inverseTransposeBoneMatrices, s.boneID, s.boneWeight);
+                    invTransposeMat = mul(transpose(transforms.worldMatrices[s.skeletonMatrixID]), invTransposeMat);
+
+                    StaticVertexData v = staticData[s.staticIndex].unpack();
+                    v.position = transformPoint(boneMat, v.position);
+                    float3 tangent = transformVector3x3(boneMat, v.tangent.xyz());
+                    v.tangent = float4(tangent, v.tangent.w);
+                    v.normal = transformVector3x3(invTransposeMat, v.normal);
+
+                    if (!prevVertices.empty())
+                    {
+                        prevVertices[i].position = initPrev ? v.position : skinnedVertices[s.staticIndex].position;
+                    }
+
+                    skinnedVertices[s.staticIndex].pack(v);
+                }
+            });
+        }
+
+        void interpolateVertices(
+            fstd::span<const PackedStaticVertexData> keyframeA,
+            fstd::span<const PackedStaticVertexData> keyframeB,
+            float t,
+            fstd::span<PackedStaticVertexData> vertices,
+            fstd::span<PrevVertexData> prevVertices)
+        {
+            FALCOR_ASSERT(keyframeA.size() == vertices.size() && keyframeB.size() == vertices.size());
+            FALCOR_ASSERT(prevVertices.empty() || prevVertices.size() == vertices.size());
+
+            forEachChunk(vertices.size(), [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    // Same interpolation as MeshVertexUpdater::interpolateVertex() in UpdateMeshVertices.slang.
+                    StaticVertexData v0 = keyframeA[i].unpack();
+                    StaticVertexData v1 = keyframeB[i].unpack();
+                    StaticVertexData orig = vertices[i].unpack();
+
+                    StaticVertexData result = {};
+                    result.position = lerp(v0.position, v1.position, t);
+                    result.normal = normalize(lerp(v0.normal, v1.normal, t));
+                    result.tangent = lerp(v0.tangent, v1.tangent, t);
+                    result.tangent = float4(normalize(result.tangent.xyz()), result.tangent.w);
+                    result.texCrd = orig.texCrd;
+
+                    if (!prevVertices.empty()) prevVertices[i].position = orig.position;
+
+                    vertices[i].pack(result);
+                }
+            });
+        }
+    }
+}
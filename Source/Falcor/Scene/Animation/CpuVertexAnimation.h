@@ -0,0 +1,90 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "SharedTypes.slang"
+#include "Core/Macros.h"
+#include "Scene/SceneTypes.slang"
+#include "Utils/Math/Matrix.h"
+#include <fstd/span.h>
+
+namespace Falcor
+{
+    /** CPU implementation of the vertex animation compute passes.
+
+        The functions compute the same results as Skinning.slang and UpdateMeshVertices.slang, up to
+        floating-point rounding, and don't require a GPU device. They are used for validating animation
+        output in unit tests and for baking posed meshes for offline export.
+        Vertices are processed in parallel in chunks.
+    */
+    namespace CpuVertexAnimation
+    {
+        /** Transforms used for skinning. All arrays are indexed by scene graph node ID.
+        */
+        struct SkinningTransforms
+        {
+            fstd::span<const float4x4> boneMatrices;                    ///< Global matrix times local-to-bind-space matrix.
+            fstd::span<const float4x4> inverseTransposeBoneMatrices;    ///< Inverse transpose of the bone matrices.
+            fstd::span<const float4x4> worldMatrices;                   ///< Global matrices.
+            fstd::span<const float4x4> inverseTransposeWorldMatrices;   ///< Inverse transpose of the global matrices.
+            fstd::span<const float4x4> meshBindMatrices;                ///< Mesh bind matrices.
+            fstd::span<const float4x4> meshInvBindMatrices;             ///< Inverse mesh bind matrices.
+        };
+
+        /** Apply linear-blend skinning to all skinned vertices. This is the CPU equivalent of Skinning.slang.
+            \param[in] transforms Skinning transforms.
+            \param[in] skinningData Bone IDs and weights for all skinned vertices.
+            \param[in] staticData Original vertex data, indexed by SkinningVertexData::staticIndex.
+            \param[in,out] skinnedVertices Skinned vertex data. Only the vertices referenced by skinningData are written.
+                The buffer may be the same as staticData, in which case the skinned vertices are updated in place.
+            \param[out] prevVertices Previous frame positions, one per skinned vertex. Pass an empty span to skip.
+            \param[in] initPrev If true, the previous positions are set to the new positions, otherwise to the positions in skinnedVertices before the update.
+        */
+        FALCOR_API void skinVertices(
+            const SkinningTransforms& transforms,
+            fstd::span<const SkinningVertexData> skinningData,
+            fstd::span<const PackedStaticVertexData> staticData,
+            fstd::span<PackedStaticVertexData> skinnedVertices,
+            fstd::span<PrevVertexData> prevVertices = {},
+            bool initPrev = false);
+
+        /** Interpolate the vertices of a mesh between two keyframes. This is the CPU equivalent of UpdateMeshVertices.slang.
+            Positions, normals and tangents are interpolated, texture coordinates are kept.
+            \param[in] keyframeA Vertex data of the first keyframe.
+            \param[in] keyframeB Vertex data of the second keyframe.
+            \param[in] t Interpolation factor in [0,1].
+            \param[in,out] vertices Mesh vertex data to update.
+            \param[out] prevVertices Previous frame positions, one per vertex. Pass an empty span to skip.
+        */
+        FALCOR_API void interpolateVertices(
+            fstd::span<const PackedStaticVertexData> keyframeA,
+            fstd::span<const PackedStaticVertexData> keyframeB,
+            float t,
+            fstd::span<PackedStaticVertexData> vertices,
+            fstd::span<PrevVertexData> prevVertices = {});
+    }
+}
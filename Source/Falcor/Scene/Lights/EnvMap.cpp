@@ -130,7 +130,7 @@ namespace Falcor
 
         pybind11::class_<EnvMap, ref<EnvMap>> envMap(m, "EnvMap");
         auto createFromFile = [](const std::filesystem::path &path) {
-            return EnvMap::createFromFile(accessActivePythonSceneBuilder().getDevice(), path);
+            return EnvMap::createFromFile(accessActivePythonSceneBuilder().requireDevice("Loading an environment map"), path);
         };
         envMap.def(pybind11::init(createFromFile), "path"_a); // PYTHONDEPRECATED
         envMap.def_static("createFromFile", createFromFile, "path"_a);
@@ -164,7 +164,7 @@ namespace Falcor
         pybind11::class_<MERLMaterial, Material, ref<MERLMaterial>> material(m, "MERLMaterial");
         auto create = [] (const std::string& name, const std::filesystem::path& path)
         {
-            return MERLMaterial::create(accessActivePythonSceneBuilder().getDevice(), name, path);
+            return MERLMaterial::create(accessActivePythonSceneBuilder().requireDevice("Loading a measured material"), name, path);
         };
         material.def(pybind11::init(create), "name"_a, "path"_a); // PYTHONDEPRECATED
     }
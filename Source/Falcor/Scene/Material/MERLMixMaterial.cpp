@@ -317,7 +317,7 @@ namespace Falcor
         pybind11::class_<MERLMixMaterial, Material, ref<MERLMixMaterial>> material(m, "MERLMixMaterial");
         auto create = [](const std::string& name, const std::vector<std::filesystem::path>& paths)
         {
-            return MERLMixMaterial::create(accessActivePythonSceneBuilder().getDevice(), name, paths);
+            return MERLMixMaterial::create(accessActivePythonSceneBuilder().requireDevice("Loading a measured material"), name, paths);
         };
         material.def(pybind11::init(create), "name"_a, "paths"_a); // PYTHONDEPRECATED
     }
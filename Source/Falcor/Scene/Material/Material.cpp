@@ -178,7 +178,7 @@ namespace Falcor
     bool Material::hasTextureSlotData(const TextureSlot slot) const
     {
         FALCOR_ASSERT((size_t)slot < mTextureSlotInfo.size());
-        return mTextureSlotData[(size_t)slot].pTexture != nullptr;
+        return mTextureSlotData[(size_t)slot].hasData();
     }
 
     bool Material::setTexture(const TextureSlot slot, const ref<Texture>& pTexture)
@@ -189,15 +189,45 @@ namespace Falcor
             return false;
         }
 
-        if (pTexture == getTexture(slot)) return false;
+        FALCOR_ASSERT((size_t)slot < mTextureSlotInfo.size());
+        auto& slotData = mTextureSlotData[(size_t)slot];
+        if (pTexture == slotData.pTexture && slotData.deferredPath.empty()) return false;
+
+        slotData.pTexture = pTexture;
+        slotData.deferredPath.clear();
+
+        markUpdates(UpdateFlags::ResourcesChanged);
+        return true;
+    }
+
+    bool Material::setDeferredTexture(const TextureSlot slot, const std::filesystem::path& path)
+    {
+        if (!hasTextureSlot(slot))
+        {
+            logWarning("Material '{}' does not have texture slot '{}'. Ignoring call to setDeferredTexture().", getName(), to_string(slot));
+            return false;
+        }
 
         FALCOR_ASSERT((size_t)slot < mTextureSlotInfo.size());
-        mTextureSlotData[(size_t)slot].pTexture = pTexture;
+        auto& slotData = mTextureSlotData[(size_t)slot];
+        if (slotData.pTexture == nullptr && slotData.deferredPath == path) return false;
+
+        slotData.pTexture = nullptr;
+        slotData.deferredPath = path;
 
         markUpdates(UpdateFlags::ResourcesChanged);
         return true;
     }
 
+    const std::filesystem::path& Material::getDeferredTexturePath(const TextureSlot slot) const
+    {
+        static const std::filesystem::path kEmptyPath;
+        if (!hasTextureSlot(slot)) return kEmptyPath;
+
+        FALCOR_ASSERT((size_t)slot < mTextureSlotInfo.size());
+        return mTextureSlotData[(size_t)slot].deferredPath;
+    }
+
     ref<Texture> Material::getTexture(const TextureSlot slot) const
     {
         if (!hasTextureSlot(slot)) return nullptr;
@@ -217,6 +247,13 @@ namespace Falcor
         std::filesystem::path fullPath;
         if (findFileInDataDirectories(path, fullPath))
         {
+            // Without a device only the texture path is recorded.
+            if (!mpDevice)
+            {
+                setDeferredTexture(slot, fullPath);
+                return true;
+            }
+
             auto texture = Texture::createFromFile(mpDevice, fullPath, true, useSrgb && getTextureSlotInfo(slot).srgb);
             if (texture)
             {
@@ -98,9 +98,10 @@ namespace Falcor
         struct TextureSlotData
         {
             ref<Texture>  pTexture;                           ///< Texture bound to texture slot.
+            std::filesystem::path deferredPath;               ///< Texture file to load when a device is available. Only used by materials created without a device.
 
-            bool hasData() const { return pTexture != nullptr; }
-            bool operator==(const TextureSlotData& rhs) const { return pTexture == rhs.pTexture; }
+            bool hasData() const { return pTexture != nullptr || !deferredPath.empty(); }
+            bool operator==(const TextureSlotData& rhs) const { return pTexture == rhs.pTexture && deferredPath == rhs.deferredPath; }
             bool operator!=(const TextureSlotData& rhs) const { return !((*this) == rhs); }
         };
 
@@ -241,6 +242,23 @@ namespace Falcor
         */
         virtual bool loadTexture(const TextureSlot slot, const std::filesystem::path& path, bool useSrgb = true);
 
+        /** Bind a texture file to one of the available texture slots without loading it.
+            This is used by materials created without a device (see SceneBuilder::getSceneData()).
+            The texture is referenced by its path only and is loaded when the scene data is used with a device.
+            Material properties that depend on texture contents are not updated.
+            The call is ignored with a warning if the slot doesn't exist.
+            \param[in] slot The texture slot.
+            \param[in] path Path of the texture file.
+            \return True if the texture slot was changed, false otherwise.
+        */
+        bool setDeferredTexture(const TextureSlot slot, const std::filesystem::path& path);
+
+        /** Get the deferred texture path of one of the available texture slots.
+            \param[in] slot The texture slot.
+            \return Path of the texture file, or an empty path if no deferred texture is bound or the slot doesn't exist.
+        */
+        const std::filesystem::path& getDeferredTexturePath(const TextureSlot slot) const;
+
         /** Clear one of the available texture slots.
             The call is ignored with a warning if the slot doesn't exist.
             \param[in] The texture slot.
@@ -32,6 +32,7 @@
 #include "Utils/StringUtils.h"
 #include "MaterialTypeRegistry.h"
 #include <numeric>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -63,10 +64,14 @@ namespace Falcor
     MaterialSystem::MaterialSystem(ref<Device> pDevice)
         : mpDevice(pDevice)
     {
+        mpTextureManager = std::make_unique<TextureManager>(mpDevice, kMaxTextureCount);
+
+        // Without a device the material system only holds material data (see SceneBuilder::getSceneData()).
+        if (!mpDevice) return;
+
         FALCOR_ASSERT(kMaxSamplerCount <= mpDevice->getLimits().maxShaderVisibleSamplers);
 
         mpFence = GpuFence::create(mpDevice);
-        mpTextureManager = std::make_unique<TextureManager>(mpDevice, kMaxTextureCount);
 
         // Create a default texture sampler.
         Sampler::Desc desc;
@@ -404,6 +409,15 @@ namespace Falcor
     {
         Material::UpdateFlags flags = Material::UpdateFlags::None;
 
+        // Reset the texture upload budget and update texture residency.
+        // Materials referencing textures that were evicted or reloaded are switched to the new textures.
+        auto textureSwaps = mpTextureManager->beginFrame();
+        if (!textureSwaps.empty())
+        {
+            applyTextureSwaps(textureSwaps);
+            flags |= Material::UpdateFlags::ResourcesChanged;
+        }
+
         // If materials were added/removed since last update, we update all metadata
         // and trigger re-creation of the parameter block.
         if (forceUpdate || mMaterialsChanged)
@@ -561,6 +575,38 @@ namespace Falcor
         checkInvariant(mMaterialTypes.find(MaterialType::Unknown) == mMaterialTypes.end(), "Unknown material type found. Make sure all material types are registered.");
     }
 
+    void MaterialSystem::markMaterialUsed(const MaterialID materialID)
+    {
+        const auto& pMaterial = getMaterial(materialID);
+        for (const auto& slotData : pMaterial->mTextureSlotData)
+        {
+            if (slotData.pTexture) mpTextureManager->markTextureUsed(slotData.pTexture.get());
+        }
+    }
+
+    void MaterialSystem::applyTextureSwaps(const std::vector<TextureManager::TextureSwap>& swaps)
+    {
+        std::unordered_map<const Texture*, ref<Texture>> replacements;
+        for (const auto& swap : swaps) replacements[swap.pOldTexture.get()] = swap.pNewTexture;
+
+        // The slot data is replaced directly instead of calling setTexture(), as the texture content is unchanged
+        // and setTexture() would reset metadata derived from the texture (e.g. the alpha range of basic materials).
+        for (const auto& pMaterial : mMaterials)
+        {
+            bool changed = false;
+            for (auto& slotData : pMaterial->mTextureSlotData)
+            {
+                if (!slotData.pTexture) continue;
+                if (auto it = replacements.find(slotData.pTexture.get()); it != replacements.end())
+                {
+                    slotData.pTexture = it->second;
+                    changed = true;
+                }
+            }
+            if (changed) pMaterial->markUpdates(Material::UpdateFlags::ResourcesChanged);
+        }
+    }
+
     MaterialSystem::MaterialStats MaterialSystem::getStats() const
     {
         checkInvariant(!mMaterialsChanged, "Materials have changed. Call update() first.");
@@ -583,6 +629,8 @@ namespace Falcor
         s.textureTexelCount = textureStats.textureTexelCount;
         s.textureTexelChannelCount = textureStats.textureTexelChannelCount;
         s.textureMemoryInBytes = textureStats.textureMemoryInBytes;
+        s.textureDeduplicatedCount = textureStats.textureDeduplicatedCount;
+        s.textureDeduplicatedMemoryInBytes = textureStats.textureDeduplicatedMemoryInBytes;
 
         return s;
     }
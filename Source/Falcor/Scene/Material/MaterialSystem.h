@@ -59,18 +59,21 @@ namespace Falcor
     public:
         struct MaterialStats
         {
-            uint64_t materialTypeCount = 0;             ///< Number of material types.
-            uint64_t materialCount = 0;                 ///< Number of materials.
-            uint64_t materialOpaqueCount = 0;           ///< Number of materials that are opaque.
-            uint64_t materialMemoryInBytes = 0;         ///< Total memory in bytes used by the material data.
-            uint64_t textureCount = 0;                  ///< Number of unique textures. A texture can be referenced by multiple materials.
-            uint64_t textureCompressedCount = 0;        ///< Number of unique compressed textures.
-            uint64_t textureTexelCount = 0;             ///< Total number of texels in all textures.
-            uint64_t textureTexelChannelCount = 0;      ///< Total number of texel channels in all textures.
-            uint64_t textureMemoryInBytes = 0;          ///< Total memory in bytes used by the textures.
+            uint64_t materialTypeCount = 0;                ///< Number of material types.
+            uint64_t materialCount = 0;                    ///< Number of materials.
+            uint64_t materialOpaqueCount = 0;              ///< Number of materials that are opaque.
+            uint64_t materialMemoryInBytes = 0;            ///< Total memory in bytes used by the material data.
+            uint64_t textureCount = 0;                     ///< Number of unique textures. A texture can be referenced by multiple materials.
+            uint64_t textureCompressedCount = 0;           ///< Number of unique compressed textures.
+            uint64_t textureTexelCount = 0;                ///< Total number of texels in all textures.
+            uint64_t textureTexelChannelCount = 0;         ///< Total number of texel channels in all textures.
+            uint64_t textureMemoryInBytes = 0;             ///< Total memory in bytes used by the textures.
+            uint64_t textureDeduplicatedCount = 0;         ///< Number of textures sharing the texture of another file with identical contents.
+            uint64_t textureDeduplicatedMemoryInBytes = 0; ///< Memory in bytes saved by sharing textures with identical contents.
         };
 
         /** Constructor. Throws an exception if creation failed.
+            \param[in] pDevice GPU device. If nullptr, the material system only holds material data and cannot be updated or bound.
         */
         MaterialSystem(ref<Device> pDevice);
 
@@ -221,6 +224,13 @@ namespace Falcor
         */
         MaterialStats getStats() const;
 
+        /** Mark all textures of a material as used in the current frame.
+            When a texture memory budget is set, this keeps the textures resident and reloads them if they were evicted.
+            See TextureManager::setMemoryBudget().
+            \param[in] materialID The material ID.
+        */
+        void markMaterialUsed(const MaterialID materialID);
+
         /** Get texture manager. This holds all textures.
         */
         TextureManager& getTextureManager() { return *mpTextureManager; }
@@ -231,6 +241,7 @@ namespace Falcor
         void updateUI();
         void createParameterBlock();
         void uploadMaterial(const uint32_t materialID);
+        void applyTextureSwaps(const std::vector<TextureManager::TextureSwap>& swaps);
 
         ref<Device> mpDevice;
 
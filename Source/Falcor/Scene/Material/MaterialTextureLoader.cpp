@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "MaterialTextureLoader.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 
 namespace Falcor
@@ -34,6 +35,8 @@ namespace Falcor
         : mUseSrgb(useSrgb)
         , mTextureManager(textureManager)
     {
+        // Defer loading to load all textures in parallel when assigning them (see TextureManager::endDeferredLoading()).
+        if (mTextureManager.getDevice()) mTextureManager.beginDeferredLoading();
     }
 
     MaterialTextureLoader::~MaterialTextureLoader()
@@ -50,6 +53,16 @@ namespace Falcor
             return;
         }
 
+        // Without a device the texture path is stored in the material instead of loading the texture.
+        if (!mTextureManager.getDevice())
+        {
+            // Paths that can't be resolved (e.g. containing <UDIM> or <MIP> tokens) are stored as given.
+            std::filesystem::path fullPath;
+            if (!findFileInDataDirectories(path, fullPath)) fullPath = path;
+            pMaterial->setDeferredTexture(slot, fullPath);
+            return;
+        }
+
         bool srgb = mUseSrgb && pMaterial->getTextureSlotInfo(slot).srgb;
 
         // Request texture to be loaded.
@@ -61,6 +74,9 @@ namespace Falcor
 
     void MaterialTextureLoader::assignTextures()
     {
+        if (!mTextureManager.getDevice()) return;
+
+        mTextureManager.endDeferredLoading();
         mTextureManager.waitForAllTexturesLoading();
 
         // Assign textures to materials.
@@ -37,10 +37,14 @@ namespace Falcor
     /** Helper class to load material textures using the texture manager.
 
         Calling `loadTexture` does not assign the texture to the material right away.
-        Instead, an asynchronous texture load request is issued and a reference for the
+        Instead, a deferred texture load request is issued and a reference for the
         material assignment is stored. When the client destroys the instance of the
-        `MaterialTextureLoader`, it blocks until all textures are loaded and assigns
-        them to the materials.
+        `MaterialTextureLoader`, all requested textures are loaded in parallel and
+        assigned to the materials. The texture manager is in deferred loading mode
+        for the lifetime of the instance (see TextureManager::beginDeferredLoading()).
+
+        If the texture manager has no device, textures are not loaded. Instead the
+        texture paths are stored in the materials (see Material::setDeferredTexture()).
     */
     class MaterialTextureLoader
     {
@@ -313,7 +313,7 @@ namespace Falcor
         pybind11::class_<RGLMaterial, Material, ref<RGLMaterial>> material(m, "RGLMaterial");
         auto create = [] (const std::string& name, const std::filesystem::path& path)
         {
-            return RGLMaterial::create(accessActivePythonSceneBuilder().getDevice(), name, path);
+            return RGLMaterial::create(accessActivePythonSceneBuilder().requireDevice("Loading a measured material"), name, path);
         };
         material.def(pybind11::init(create), "name"_a, "path"_a); // PYTHONDEPRECATED
         material.def(kLoadFile.c_str(), &RGLMaterial::loadBRDF, "path"_a);
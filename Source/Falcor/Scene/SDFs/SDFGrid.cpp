@@ -530,14 +530,14 @@ namespace Falcor
                     compressed = pybind11::cast<bool>(value);
                 }
             }
-            return static_ref_cast<SDFGrid>(SDFSBS::create(accessActivePythonSceneBuilder().getDevice(), brickWidth, compressed, defaultGridWidth));
+            return static_ref_cast<SDFGrid>(SDFSBS::create(accessActivePythonSceneBuilder().requireDevice("Creating an SDF grid"), brickWidth, compressed, defaultGridWidth));
         };
 
         pybind11::class_<SDFGrid, ref<SDFGrid>> sdfGrid(m, "SDFGrid");
-        sdfGrid.def_static("createNDGrid", [](float narrowBandThickness) { return static_ref_cast<SDFGrid>(NDSDFGrid::create(accessActivePythonSceneBuilder().getDevice(), narrowBandThickness)); }, "narrowBandThickness"_a); // PYTHONDEPRECATED
-        sdfGrid.def_static("createSVS", [](){ return static_ref_cast<SDFGrid>(SDFSVS::create(accessActivePythonSceneBuilder().getDevice())); }); // PYTHONDEPRECATED
+        sdfGrid.def_static("createNDGrid", [](float narrowBandThickness) { return static_ref_cast<SDFGrid>(NDSDFGrid::create(accessActivePythonSceneBuilder().requireDevice("Creating an SDF grid"), narrowBandThickness)); }, "narrowBandThickness"_a); // PYTHONDEPRECATED
+        sdfGrid.def_static("createSVS", [](){ return static_ref_cast<SDFGrid>(SDFSVS::create(accessActivePythonSceneBuilder().requireDevice("Creating an SDF grid"))); }); // PYTHONDEPRECATED
         sdfGrid.def_static("createSBS", createSBS); // PYTHONDEPRECATED
-        sdfGrid.def_static("createSVO", [](){ return static_ref_cast<SDFGrid>(SDFSVO::create(accessActivePythonSceneBuilder().getDevice())); }); // PYTHONDEPRECATED
+        sdfGrid.def_static("createSVO", [](){ return static_ref_cast<SDFGrid>(SDFSVO::create(accessActivePythonSceneBuilder().requireDevice("Creating an SDF grid"))); }); // PYTHONDEPRECATED
         sdfGrid.def("loadValuesFromFile", &SDFGrid::loadValuesFromFile, "path"_a);
         sdfGrid.def("loadPrimitivesFromFile", &SDFGrid::loadPrimitivesFromFile, "path"_a, "gridWidth"_a, "dir"_a = "");
         sdfGrid.def("generateCheeseValues", &SDFGrid::generateCheeseValues, "gridWidth"_a, "seed"_a);
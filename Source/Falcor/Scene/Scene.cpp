@@ -84,6 +84,7 @@ namespace Falcor
         const std::string kBounds = "bounds";
         const std::string kAnimations = "animations";
         const std::string kLoopAnimations = "loopAnimations";
+        const std::string kAnimationTimeOverride = "animationTimeOverride";
         const std::string kCamera = "camera";
         const std::string kCameras = "cameras";
         const std::string kCameraSpeed = "cameraSpeed";
@@ -161,6 +162,7 @@ namespace Falcor
         mpLightProfile = sceneData.pLightProfile;
         mSceneGraph = std::move(sceneData.sceneGraph);
         mMetadata = std::move(sceneData.metadata);
+        mSceneStats.buildStats = std::move(sceneData.buildStats);
 
         // Merge all geometry instance lists into one.
         mGeometryInstanceData.reserve(sceneData.meshInstanceData.size() + sceneData.curveInstanceData.size() + sceneData.sdfGridInstances.size());
@@ -168,6 +170,15 @@ namespace Falcor
         mGeometryInstanceData.insert(std::end(mGeometryInstanceData), std::begin(sceneData.curveInstanceData), std::end(sceneData.curveInstanceData));
         mGeometryInstanceData.insert(std::end(mGeometryInstanceData), std::begin(sceneData.sdfGridInstances), std::end(sceneData.sdfGridInstances));
 
+        // Build mapping from global matrices to the instances using them, so that animation updates only touch moved instances.
+        mMatrixIdToInstanceIds.resize(mSceneGraph.size());
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); instanceID++)
+        {
+            uint32_t matrixID = mGeometryInstanceData[instanceID].globalMatrixID;
+            FALCOR_ASSERT(matrixID < mMatrixIdToInstanceIds.size());
+            mMatrixIdToInstanceIds[matrixID].push_back(instanceID);
+        }
+
         mMeshDesc = std::move(sceneData.meshDesc);
         mMeshNames = std::move(sceneData.meshNames);
         mMeshBBs = std::move(sceneData.meshBBs);
@@ -1083,44 +1094,57 @@ namespace Falcor
         getCamera()->setShaderData(mpSceneBlock->getRootVar()[kCamera]);
     }
 
-    void Scene::updateBounds()
+    AABB Scene::computeInstanceBounds(const GeometryInstanceData& instance, const float4x4& transform) const
     {
-        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+        switch (instance.getType())
+        {
+        case GeometryType::TriangleMesh:
+        case GeometryType::DisplacedTriangleMesh:
+            return mMeshBBs[instance.geometryID].transform(transform);
+        case GeometryType::Curve:
+            return mCurveBBs[instance.geometryID].transform(transform);
+        case GeometryType::SDFGrid:
+        {
+            float3x3 transform3x3 = float3x3(transform);
+            transform3x3[0] = abs(transform3x3[0]);
+            transform3x3[1] = abs(transform3x3[1]);
+            transform3x3[2] = abs(transform3x3[2]);
+            float3 center = transform.getCol(3).xyz();
+            float3 halfExtent = transformVector(transform3x3, float3(0.5f));
+            return AABB(center - halfExtent, center + halfExtent);
+        }
+        default:
+            return AABB();
+        }
+    }
 
-        mSceneBB = AABB();
+    void Scene::updateBounds(bool forceUpdate)
+    {
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
-        for (const auto& inst : mGeometryInstanceData)
+        if (forceUpdate)
         {
-            const float4x4& transform = globalMatrices[inst.globalMatrixID];
-            switch (inst.getType())
+            mInstanceBoundsTree.reset(mGeometryInstanceData.size());
+            for (size_t instanceID = 0; instanceID < mGeometryInstanceData.size(); instanceID++)
             {
-            case GeometryType::TriangleMesh:
-            case GeometryType::DisplacedTriangleMesh:
-            {
-                const AABB& meshBB = mMeshBBs[inst.geometryID];
-                mSceneBB |= meshBB.transform(transform);
-                break;
-            }
-            case GeometryType::Curve:
-            {
-                const AABB& curveBB = mCurveBBs[inst.geometryID];
-                mSceneBB |= curveBB.transform(transform);
-                break;
+                const auto& inst = mGeometryInstanceData[instanceID];
+                mInstanceBoundsTree.setLeaf(instanceID, computeInstanceBounds(inst, globalMatrices[inst.globalMatrixID]));
             }
-            case GeometryType::SDFGrid:
+            mInstanceBoundsTree.rebuild();
+        }
+        else
+        {
+            // Only recompute moved instances and the tree paths above them.
+            for (uint32_t instanceID : mMovedInstances)
             {
-                float3x3 transform3x3 = float3x3(transform);
-                transform3x3[0] = abs(transform3x3[0]);
-                transform3x3[1] = abs(transform3x3[1]);
-                transform3x3[2] = abs(transform3x3[2]);
-                float3 center = transform.getCol(3).xyz();
-                float3 halfExtent = transformVector(transform3x3, float3(0.5f));
-                mSceneBB |= AABB(center - halfExtent, center + halfExtent);
-                break;
-            }
+                const auto& inst = mGeometryInstanceData[instanceID];
+                mInstanceBoundsTree.setLeaf(instanceID, computeInstanceBounds(inst, globalMatrices[inst.globalMatrixID]));
             }
+            mInstanceBoundsTree.update();
         }
 
+        mSceneBB = mInstanceBoundsTree.getBounds();
+
         for (const auto& aabb : mCustomPrimitiveAABBs)
         {
             mSceneBB |= aabb;
@@ -1132,43 +1156,85 @@ namespace Falcor
         }
     }
 
+    void Scene::updateMovedInstances()
+    {
+        mMovedInstances.clear();
+
+        for (NodeID matrixID : mpAnimationController->getChangedMatrices())
+        {
+            const auto& instanceIDs = mMatrixIdToInstanceIds[matrixID.get()];
+            mMovedInstances.insert(mMovedInstances.end(), instanceIDs.begin(), instanceIDs.end());
+        }
+
+        // Each instance uses exactly one matrix, so there are no duplicates to remove.
+        std::sort(mMovedInstances.begin(), mMovedInstances.end());
+    }
+
+    bool Scene::updateGeometryInstanceFlags(GeometryInstanceData& inst, const float4x4& transform) const
+    {
+        if (inst.getType() != GeometryType::TriangleMesh && inst.getType() != GeometryType::DisplacedTriangleMesh) return false;
+
+        uint32_t prevFlags = inst.flags;
+
+        bool isTransformFlipped = doesTransformFlip(transform);
+        bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
+        bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
+
+        if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
+        else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
+
+        if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+        else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+
+        if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+        else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+
+        return inst.flags != prevFlags;
+    }
+
     void Scene::updateGeometryInstances(bool forceUpdate)
     {
         if (mGeometryInstanceData.empty()) return;
 
-        bool dataChanged = false;
         const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
-        for (auto& inst : mGeometryInstanceData)
+        if (forceUpdate)
         {
-            if (inst.getType() == GeometryType::TriangleMesh || inst.getType() == GeometryType::DisplacedTriangleMesh)
+            for (auto& inst : mGeometryInstanceData)
             {
-                uint32_t prevFlags = inst.flags;
-
                 FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
-                const float4x4& transform = globalMatrices[inst.globalMatrixID];
-                bool isTransformFlipped = doesTransformFlip(transform);
-                bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
-                bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
+                updateGeometryInstanceFlags(inst, globalMatrices[inst.globalMatrixID]);
+            }
 
-                if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
+            uint32_t byteSize = (uint32_t)(mGeometryInstanceData.size() * sizeof(GeometryInstanceData));
+            mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data(), 0, byteSize);
+            return;
+        }
 
-                if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+        // Update moved instances only and upload ranges of consecutive instances whose flags changed.
+        uint32_t rangeBegin = 0;
+        uint32_t rangeEnd = 0;
+        auto uploadRange = [&]()
+        {
+            if (rangeEnd == rangeBegin) return;
+            mpGeometryInstancesBuffer->setBlob(&mGeometryInstanceData[rangeBegin], rangeBegin * sizeof(GeometryInstanceData), (rangeEnd - rangeBegin) * sizeof(GeometryInstanceData));
+        };
 
-                if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+        for (uint32_t instanceID : mMovedInstances)
+        {
+            auto& inst = mGeometryInstanceData[instanceID];
+            FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
+            if (!updateGeometryInstanceFlags(inst, globalMatrices[inst.globalMatrixID])) continue;
 
-                dataChanged |= (inst.flags != prevFlags);
+            if (instanceID != rangeEnd)
+            {
+                uploadRange();
+                rangeBegin = instanceID;
             }
+            rangeEnd = instanceID + 1;
         }
 
-        if (forceUpdate || dataChanged)
-        {
-            uint32_t byteSize = (uint32_t)(mGeometryInstanceData.size() * sizeof(GeometryInstanceData));
-            mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data(), 0, byteSize);
-        }
+        uploadRange();
     }
 
     Scene::UpdateFlags Scene::updateRaytracingAABBData(bool forceUpdate)
@@ -1476,7 +1542,7 @@ namespace Falcor
             mpLightProfile->setShaderData(mpSceneBlock->getRootVar()[kLightProfile]);
         }
 
-        updateBounds();
+        updateBounds(true);
         createDrawList();
         if (mCameras.size() == 0)
         {
@@ -2026,6 +2092,8 @@ namespace Falcor
 
     Scene::UpdateFlags Scene::update(RenderContext* pRenderContext, double currentTime)
     {
+        if (mAnimationTimeOverride) currentTime = *mAnimationTimeOverride;
+
         // Run scene update callback.
         if (mUpdateCallback) mUpdateCallback(ref<Scene>(this), currentTime);
 
@@ -2056,13 +2124,8 @@ namespace Falcor
             mUpdates |= UpdateFlags::SceneGraphChanged;
             if (mpAnimationController->hasSkinnedMeshes()) mUpdates |= UpdateFlags::MeshesChanged;
 
-            for (const auto& inst : mGeometryInstanceData)
-            {
-                if (mpAnimationController->isMatrixChanged(NodeID{ inst.globalMatrixID }))
-                {
-                    mUpdates |= UpdateFlags::GeometryMoved;
-                }
-            }
+            updateMovedInstances();
+            if (!mMovedInstances.empty()) mUpdates |= UpdateFlags::GeometryMoved;
 
             // We might end up setting the flag even if curves haven't changed (if looping is disabled for example).
             if (mpAnimationController->hasAnimatedCurveCaches()) mUpdates |= UpdateFlags::CurvesMoved;
@@ -2086,6 +2149,7 @@ namespace Falcor
         {
             invalidateTlasCache();
             updateGeometryInstances(false);
+            updateBounds(false);
         }
 
         //Signal Fence for this frame
@@ -2389,6 +2453,8 @@ namespace Falcor
                 << "  Texture count (compressed): " << s.materials.textureCompressedCount << std::endl
                 << "  Texture texel count: " << s.materials.textureTexelCount << std::endl
                 << "  Texture memory: " << formatByteSize(s.materials.textureMemoryInBytes) << std::endl
+                << "  Texture count (deduplicated): " << s.materials.textureDeduplicatedCount << std::endl
+                << "  Texture memory saved by deduplication: " << formatByteSize(s.materials.textureDeduplicatedMemoryInBytes) << std::endl
                 << "  Bytes/texel (average): " << std::fixed << std::setprecision(2) << bytesPerTexel << std::endl
                 << "  Channels/texel (average): " << std::fixed << std::setprecision(2) << channelsPerTexel << std::endl
                 << std::endl;
@@ -4407,6 +4473,28 @@ namespace Falcor
         mpAnimationController->setNodeEdited(nodeID);
     }
 
+    inline pybind11::dict toPython(const Scene::BuildStats& stats)
+    {
+        pybind11::dict d;
+
+        pybind11::list stages;
+        for (const auto& stage : stats.stages)
+        {
+            pybind11::dict s;
+            s["name"] = stage.name;
+            s["timeInSeconds"] = stage.timeInSeconds;
+            s["rssInBytes"] = stage.rssInBytes;
+            s["peakRSSGrowthInBytes"] = stage.peakRSSGrowthInBytes;
+            s["heapGrowthInBytes"] = stage.heapGrowthInBytes;
+            stages.append(s);
+        }
+        d["stages"] = stages;
+        d["totalTimeInSeconds"] = stats.totalTimeInSeconds;
+        d["peakRSSInBytes"] = stats.peakRSSInBytes;
+
+        return d;
+    }
+
     inline pybind11::dict toPython(const Scene::SceneStats& stats)
     {
         pybind11::dict d;
@@ -4453,6 +4541,8 @@ namespace Falcor
         d["textureTexelCount"] = stats.materials.textureTexelCount;
         d["textureTexelChannelCount"] = stats.materials.textureTexelChannelCount;
         d["textureMemoryInBytes"] = stats.materials.textureMemoryInBytes;
+        d["textureDeduplicatedCount"] = stats.materials.textureDeduplicatedCount;
+        d["textureDeduplicatedMemoryInBytes"] = stats.materials.textureDeduplicatedMemoryInBytes;
 
         // Raytracing stats
         d["blasGroupCount"] = stats.blasGroupCount;
@@ -4489,6 +4579,23 @@ namespace Falcor
         d["gridVoxelCount"] = stats.gridVoxelCount;
         d["gridMemoryInBytes"] = stats.gridMemoryInBytes;
 
+        // Build stats
+        d["buildStats"] = toPython(stats.buildStats);
+
+        return d;
+    }
+
+    inline pybind11::dict toPython(const TextureManager::ResidencyStats& stats)
+    {
+        pybind11::dict d;
+        d["memoryBudget"] = stats.memoryBudget;
+        d["residentMemoryInBytes"] = stats.residentMemoryInBytes;
+        d["fullMemoryInBytes"] = stats.fullMemoryInBytes;
+        d["residentTextureCount"] = stats.residentTextureCount;
+        d["evictedTextureCount"] = stats.evictedTextureCount;
+        d["pendingReloadCount"] = stats.pendingReloadCount;
+        d["evictionCount"] = stats.evictionCount;
+        d["reloadCount"] = stats.reloadCount;
         return d;
     }
 
@@ -4548,6 +4655,7 @@ namespace Falcor
         scene.def_property(kCameraSpeed.c_str(), &Scene::getCameraSpeed, &Scene::setCameraSpeed);
         scene.def_property(kAnimated.c_str(), &Scene::isAnimated, &Scene::setIsAnimated);
         scene.def_property(kLoopAnimations.c_str(), &Scene::isLooped, &Scene::setIsLooped);
+        scene.def_property_readonly(kAnimationTimeOverride.c_str(), &Scene::getAnimationTimeOverride);
         scene.def_property(kRenderSettings.c_str(), pybind11::overload_cast<>(&Scene::getRenderSettings, pybind11::const_), &Scene::setRenderSettings);
         scene.def_property(kUpdateCallback.c_str(), &Scene::getUpdateCallback, &Scene::setUpdateCallback);
 
@@ -4562,6 +4670,27 @@ namespace Falcor
             pScene->setCameraBounds(AABB(minPoint, maxPoint));
             }, "minPoint"_a, "maxPoint"_a);
         scene.def("getGeometryUVTiles", &Scene::getGeometryUVTiles, "geometryID"_a);
+        scene.def("bakeMeshVertices", [](const Scene* pScene, MeshID meshID, double time)
+            {
+                checkArgument(meshID.get() < pScene->getMeshCount(), "'meshID' ({}) is out of range.", meshID.get());
+                const auto& mesh = pScene->getMesh(meshID);
+                auto vertexData = pScene->getAnimationController()->bakeVertexData(time);
+
+                pybind11::list positions, normals, texCoords;
+                for (uint32_t i = 0; i < mesh.vertexCount; i++)
+                {
+                    StaticVertexData v = vertexData[mesh.vbOffset + i].unpack();
+                    positions.append(v.position);
+                    normals.append(v.normal);
+                    texCoords.append(v.texCrd);
+                }
+
+                pybind11::dict d;
+                d["positions"] = positions;
+                d["normals"] = normals;
+                d["texCoords"] = texCoords;
+                return d;
+            }, "meshID"_a, "time"_a);
 
         // Materials
         scene.def_property_readonly(kMaterials.c_str(), &Scene::getMaterials);
@@ -4573,6 +4702,16 @@ namespace Falcor
             return scene->getGeometryIDs(pMaterial.get());
         }, "material"_a);
 
+        // Texture residency
+        scene.def_property("textureMemoryBudget",
+            [](const Scene* pScene) { return pScene->getMaterialSystem().getTextureManager().getMemoryBudget(); },
+            [](const Scene* pScene, uint64_t bytes) { pScene->getMaterialSystem().getTextureManager().setMemoryBudget(bytes); });
+        scene.def_property("textureUploadBudget",
+            [](const Scene* pScene) { return pScene->getMaterialSystem().getTextureManager().getUploadBudget(); },
+            [](const Scene* pScene, uint64_t bytes) { pScene->getMaterialSystem().getTextureManager().setUploadBudget(bytes); });
+        scene.def_property_readonly("textureResidencyStats", [](const Scene* pScene) { return toPython(pScene->getMaterialSystem().getTextureManager().getResidencyStats()); });
+        scene.def("markMaterialUsed", [](const Scene* pScene, const MaterialID materialID) { pScene->getMaterialSystem().markMaterialUsed(materialID); }, "materialID"_a);
+
 
         // Viewpoints
         scene.def(kAddViewpoint.c_str(), pybind11::overload_cast<>(&Scene::addViewpoint)); // add current camera as viewpoint
@@ -49,6 +49,7 @@
 #include "Core/API/VAO.h"
 #include "Core/API/RtAccelerationStructure.h"
 #include "Core/API/GpuFence.h"
+#include "Utils/Algorithm/AABBReductionTree.h"
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Rectangle.h"
 #include "Utils/Math/Vector.h"
@@ -302,6 +303,26 @@ namespace Falcor
             float4x4 localToBindSpace;  ///< For bones. Skeleton to bind space transformation. AKA the inverse-bind transform.
         };
 
+        /** Statistics of a single scene build stage (see SceneBuilder).
+        */
+        struct BuildStageStats
+        {
+            std::string name;                           ///< Name of the stage.
+            double timeInSeconds = 0.0;                 ///< Wall-clock time spent in the stage.
+            uint64_t rssInBytes = 0;                    ///< Resident set size of the process at the end of the stage.
+            int64_t peakRSSGrowthInBytes = 0;           ///< Peak resident set size during the stage minus the resident set size at its start. Where the peak cannot be reset (Windows), only growth of the process-wide peak is seen.
+            int64_t heapGrowthInBytes = 0;              ///< Change of the heap memory allocated by the process during the stage. Zero if not supported by the platform. On Linux this uses mallinfo2, which is only documented to cover the main malloc arena.
+        };
+
+        /** Statistics of the scene build.
+        */
+        struct BuildStats
+        {
+            std::vector<BuildStageStats> stages;        ///< Stages in the order they were run.
+            double totalTimeInSeconds = 0.0;            ///< Total time spent in all stages.
+            uint64_t peakRSSInBytes = 0;                ///< Peak resident set size of the process during the build stages.
+        };
+
         /** Full set of required data to create a scene object.
             This data is typically prepared by SceneBuilder before creating a Scene object.
         */
@@ -321,6 +342,7 @@ namespace Falcor
             std::vector<Node> sceneGraph;                           ///< Scene graph nodes.
             std::vector<ref<Animation>> animations;                 ///< List of animations.
             Metadata metadata;                                      ///< Scene meadata.
+            BuildStats buildStats;                                  ///< Statistics of the scene build.
 
             // Mesh data
             std::vector<MeshDesc> meshDesc;                         ///< List of mesh descriptors.
@@ -436,6 +458,9 @@ namespace Falcor
             uint64_t gridVoxelCount = 0;                ///< Total number of voxels in all grids.
             uint64_t gridMemoryInBytes = 0;             ///< Total memory in bytes used by the grids.
 
+            // Build stats
+            BuildStats buildStats;                      ///< Time and memory spent in each stage of the scene build.
+
             /** Get the total memory usage.
             */
             uint64_t getTotalMemory() const
@@ -542,6 +567,16 @@ namespace Falcor
         */
         void setUpdateCallback(UpdateCallback updateCallback) { mUpdateCallback = updateCallback; }
 
+        /** Lock the time used by update() to a fixed value.
+            This is used for deterministic replay, where the animation time is derived from the frame index instead of the application clock.
+            \param[in] time Time in seconds, or an empty optional to use the time passed to update() again.
+        */
+        void setAnimationTimeOverride(std::optional<double> time) { mAnimationTimeOverride = time; }
+
+        /** Get the locked animation time, if any.
+        */
+        std::optional<double> getAnimationTimeOverride() const { return mAnimationTimeOverride; }
+
         /** Access the scene's currently selected camera to change properties or to use elsewhere.
         */
         const ref<Camera>& getCamera() { return mCameras[mSelectedCamera]; }
@@ -1171,6 +1206,7 @@ namespace Falcor
     private:
         friend class AnimationController;
         friend class AnimatedVertexCache;
+        friend class SceneBuilder;
 
         static constexpr uint32_t kStaticDataBufferIndex = 0;
         static constexpr uint32_t kDrawIdBufferIndex = kStaticDataBufferIndex + 1;
@@ -1204,13 +1240,29 @@ namespace Falcor
         void uploadSelectedCamera();
 
         /** Update the scene's global bounding box.
+            \param[in] forceUpdate If true, the bounds of all instances are recomputed. Otherwise only the instances in mMovedInstances are.
         */
-        void updateBounds();
+        void updateBounds(bool forceUpdate);
 
         /** Update geometry instances.
+            \param[in] forceUpdate If true, all instances are updated and uploaded. Otherwise only the instances in mMovedInstances are
+            updated and only ranges of changed instances are uploaded.
         */
         void updateGeometryInstances(bool forceUpdate);
 
+        /** Collect the geometry instances whose global matrix changed in the last animation update into mMovedInstances.
+        */
+        void updateMovedInstances();
+
+        /** Update the transform-dependent flags of a geometry instance.
+            \return True if the flags changed.
+        */
+        bool updateGeometryInstanceFlags(GeometryInstanceData& instance, const float4x4& transform) const;
+
+        /** Compute the world-space bounding box of a geometry instance.
+        */
+        AABB computeInstanceBounds(const GeometryInstanceData& instance, const float4x4& transform) const;
+
         /** Update geometry type flags.
         */
         void updateGeometryTypes();
@@ -1311,6 +1363,8 @@ namespace Falcor
         GeometryTypeFlags mGeometryTypes;                           ///< Set of geometry types that exist in the scene.
 
         std::vector<GeometryInstanceData> mGeometryInstanceData;    ///< Geometry instance data (for all types of geometry).
+        std::vector<std::vector<uint32_t>> mMatrixIdToInstanceIds;  ///< Mapping of what instances use which global matrix. The instanceIDs are sorted in ascending order.
+        std::vector<uint32_t> mMovedInstances;                      ///< Instances whose global matrix changed in the last update, sorted in ascending order.
 
         bool mUseCompressedHitInfo = false;                         ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
         bool mHas16BitIndices = false;                              ///< True if any meshes use 16-bit indices.
@@ -1394,6 +1448,7 @@ namespace Falcor
         std::vector<std::vector<uint32_t>> mCurveIdToInstanceIds;   ///< Mapping of what instances belong to which curve.
         HitInfo mHitInfo;                                           ///< Geometry hit info requirements.
         AABB mSceneBB;                                              ///< Bounding boxes of the entire scene in world space.
+        AABBReductionTree mInstanceBoundsTree;                      ///< Reduction tree over the world-space bounding boxes of all geometry instances.
         SceneStats mSceneStats;                                     ///< Scene statistics.
         Metadata mMetadata;                                         ///< Importer-provided metadata.
         RenderSettings mRenderSettings;                             ///< Render settings.
@@ -1403,6 +1458,7 @@ namespace Falcor
         Program::TypeConformanceList mTypeConformances;             ///< Current list of type conformances that need to be set on any program accessing the scene.
 
         UpdateCallback mUpdateCallback;                             ///< Scene update callback.
+        std::optional<double> mAnimationTimeOverride;               ///< Time used by update() instead of the application time, if set.
 
         // Scene block resources
         ref<Buffer> mpGeometryInstancesBuffer;
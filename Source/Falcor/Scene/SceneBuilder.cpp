@@ -30,16 +30,19 @@
 #include "Importer.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/TextureAnalyzer.h"
-#include "Utils/Timing/TimeReport.h"
+#include "Utils/Timing/CpuTimer.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/NumericRange.h"
 #include "Utils/ObjectIDPython.h"
 #include <mikktspace.h>
 #include <filesystem>
 #include <cmath>
+#include <execution>
 
 namespace Falcor
 {
@@ -189,15 +192,60 @@ namespace Falcor
             return indexData;
         }
 
-        SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
+        /** Records the time and memory use of a scene build stage when it goes out of scope.
+        */
+        class BuildStageScope
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
-            SHA1 sha1;
-            auto pathStr = path.string();
-            sha1.update(pathStr.data(), pathStr.size());
-            sha1.update(&cacheFlags, sizeof(cacheFlags));
-            return sha1.finalize();
+        public:
+            BuildStageScope(Scene::BuildStats& stats, std::string name)
+                : mStats(stats)
+                , mName(std::move(name))
+                , mStartRSSBytes(getCurrentRSS())
+                , mPeakReset(resetPeakRSS())
+                , mStartPeakBytes(getPeakRSS())
+                , mStartHeapBytes(getHeapAllocatedBytes())
+                , mStartTime(CpuTimer::getCurrentTimePoint())
+            {}
+
+            ~BuildStageScope()
+            {
+                Scene::BuildStageStats stage;
+                stage.name = std::move(mName);
+                stage.timeInSeconds = CpuTimer::calcDuration(mStartTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+                stage.rssInBytes = getCurrentRSS();
+                uint64_t peakBytes = getPeakRSS();
+                // Without a reset the peak is process-wide, so only count how much the stage raised it.
+                uint64_t baseBytes = mPeakReset ? mStartRSSBytes : std::max(mStartRSSBytes, mStartPeakBytes);
+                stage.peakRSSGrowthInBytes = (int64_t)std::max(peakBytes, baseBytes) - (int64_t)baseBytes;
+                stage.heapGrowthInBytes = (int64_t)getHeapAllocatedBytes() - (int64_t)mStartHeapBytes;
+
+                mStats.totalTimeInSeconds += stage.timeInSeconds;
+                mStats.peakRSSInBytes = std::max(mStats.peakRSSInBytes, peakBytes);
+                mStats.stages.push_back(std::move(stage));
+            }
+
+        private:
+            Scene::BuildStats& mStats;
+            std::string mName;
+            uint64_t mStartRSSBytes;
+            bool mPeakReset;
+            uint64_t mStartPeakBytes;
+            uint64_t mStartHeapBytes;
+            CpuTimer::TimePoint mStartTime;
+        };
 
+        void logBuildStats(const Scene::BuildStats& stats)
+        {
+            const double kMB = 1024.0 * 1024.0;
+            logInfo("{:<28} {:>10} {:>7} {:>10} {:>10} {:>10}", "Scene build stage", "Time (s)", "Time", "RSS (MB)", "Peak +(MB)", "Heap (MB)");
+            for (const auto& stage : stats.stages)
+            {
+                double percent = stats.totalTimeInSeconds > 0.0 ? 100.0 * stage.timeInSeconds / stats.totalTimeInSeconds : 0.0;
+                logInfo("{:<28} {:>10.3f} {:>6.1f}% {:>10.1f} {:>+10.1f} {:>+10.1f}", stage.name, stage.timeInSeconds, percent,
+                    stage.rssInBytes / kMB, stage.peakRSSGrowthInBytes / kMB, stage.heapGrowthInBytes / kMB);
+            }
+            logInfo("{:<28} {:>10.3f}", "Total", stats.totalTimeInSeconds);
+            logInfo("Peak RSS during the build: {:.1f} MB", stats.peakRSSInBytes / kMB);
         }
     }
 
@@ -206,8 +254,10 @@ namespace Falcor
         , mSettings(settings)
         , mFlags(flags)
     {
-        mpFence = GpuFence::create(mpDevice);
+        if (mpDevice) mpFence = GpuFence::create(mpDevice);
         mSceneData.pMaterials = std::make_unique<MaterialSystem>(mpDevice);
+        mSceneData.pMaterials->getTextureManager().setUseTextureCache(is_set(flags, Flags::UseTextureCache));
+        mSceneData.pMaterials->getTextureManager().setUseContentHashing(is_set(flags, Flags::DeduplicateTextures));
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& path, const Settings& settings, Flags flags)
@@ -219,8 +269,8 @@ namespace Falcor
             throw ImporterError(path, "Can't find scene file '{}'.", path);
         }
 
-        // Compute scene cache key based on absolute scene path and build flags.
-        mSceneCacheKey = computeSceneCacheKey(fullPath, flags);
+        // Compute scene cache key based on absolute scene path, build flags and headless mode.
+        mSceneCacheKey = computeSceneCacheKey(fullPath, flags, isHeadless());
 
         // Determine if scene cache should be written after import.
         bool useCache = is_set(flags, Flags::UseCache);
@@ -232,7 +282,22 @@ namespace Falcor
         {
             try
             {
-                mpScene = Scene::create(pDevice, SceneCache::readCache(pDevice, mSceneCacheKey));
+                Scene::SceneData sceneData;
+                {
+                    BuildStageScope stage(mBuildStats, "readCache");
+                    sceneData = SceneCache::readCache(pDevice, mSceneCacheKey, is_set(flags, Flags::UseTextureCache), is_set(flags, Flags::DeduplicateTextures));
+                }
+                if (pDevice)
+                {
+                    createScene(std::move(sceneData));
+                }
+                else
+                {
+                    // Headless builders keep the cached data for getSceneData().
+                    mSceneData = std::move(sceneData);
+                    mSceneDataFinalized = true;
+                    mWriteSceneCache = false;
+                }
                 return;
             }
             catch (const std::exception& e)
@@ -241,12 +306,14 @@ namespace Falcor
             }
         }
 
+        BuildStageScope stage(mBuildStats, "import");
         import(path);
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const void* buffer, size_t byteSize, std::string_view extension, const Settings& settings, Flags flags)
         : SceneBuilder(pDevice, settings, flags)
     {
+        BuildStageScope stage(mBuildStats, "import");
         importFromMemory(buffer, byteSize, extension);
     }
 
@@ -291,8 +358,77 @@ namespace Falcor
     {
         if (mpScene) return mpScene;
 
+        requireDevice("Creating a scene");
+
+        finalizeSceneData();
+        createScene(std::move(mSceneData));
+        mSceneData = {};
+
+        return mpScene;
+    }
+
+    Scene::SceneData SceneBuilder::getSceneData()
+    {
+        if (mpScene || !mSceneData.pMaterials) throw RuntimeError("Scene data was already retrieved from this scene builder.");
+
+        if (!mSceneDataFinalized) finalizeSceneData();
+
+        mSceneData.buildStats = mBuildStats;
+        logBuildStats(mBuildStats);
+
+        Scene::SceneData sceneData = std::move(mSceneData);
+        mSceneData = {};
+        return sceneData;
+    }
+
+    SceneCache::Key SceneBuilder::computeSceneCacheKey(const std::filesystem::path& path, Flags flags, bool headless)
+    {
+        // The texture cache and texture deduplication only affect how textures are loaded, not the cached scene data.
+        Flags cacheFlags = flags & (~(Flags::UseCache | Flags::RebuildCache | Flags::UseTextureCache | Flags::DeduplicateTextures));
+        SHA1 sha1;
+        auto pathStr = path.string();
+        sha1.update(pathStr.data(), pathStr.size());
+        sha1.update(&cacheFlags, sizeof(cacheFlags));
+        // Headless builds skip assets that need a device, so they use separate cache entries.
+        if (headless)
+        {
+            const char kHeadlessTag[] = "headless";
+            sha1.update(kHeadlessTag, sizeof(kHeadlessTag));
+        }
+        return sha1.finalize();
+    }
+
+    const ref<Device>& SceneBuilder::requireDevice(std::string_view feature) const
+    {
+        if (!mpDevice) throw RuntimeError("{} requires a GPU device, which is not available in a headless scene builder.", feature);
+        return mpDevice;
+    }
+
+    void SceneBuilder::createScene(Scene::SceneData&& sceneData)
+    {
+        {
+            BuildStageScope stage(mBuildStats, "createScene");
+            mpScene = Scene::create(mpDevice, std::move(sceneData));
+        }
+
+        mpScene->mSceneStats.buildStats = mBuildStats;
+        logBuildStats(mBuildStats);
+    }
+
+    void SceneBuilder::finalizeSceneData()
+    {
+        // Each post-processing stage is recorded in the build stats.
+        auto runStage = [this](const char* name, void (SceneBuilder::*func)())
+        {
+            BuildStageScope stage(mBuildStats, name);
+            (this->*func)();
+        };
+
         // Finish loading textures. This blocks until all textures are loaded and assigned.
-        mpMaterialTextureLoader.reset();
+        {
+            BuildStageScope stage(mBuildStats, "loadTextures");
+            mpMaterialTextureLoader.reset();
+        }
 
         // If no meshes were added, we create a dummy mesh to keep the scene generation working.
         // Scenes with no meshes can be useful for example when using volumes in isolation.
@@ -308,68 +444,56 @@ namespace Falcor
             addMeshInstance(nodeID, meshID);
         }
 
-        // Post-process the scene data.
-        TimeReport timeReport;
-
         // Prepare displacement maps. This either removes them (if requested in build flags)
         // or makes sure that normal maps are removed if displacement is in use.
-        prepareDisplacementMaps();
-
-        prepareSceneGraph();
-        prepareMeshes();
-        removeUnusedMeshes();
-        flattenStaticMeshInstances();
-        pretransformStaticMeshes();
-        unifyTriangleWinding();
-        optimizeSceneGraph();
-        calculateMeshBoundingBoxes();
-        createMeshGroups();
-        optimizeGeometry();
-        sortMeshes();
-        createGlobalBuffers();
-        createCurveGlobalBuffers();
-        collectVolumeGrids();
-        removeDuplicateSDFGrids();
-
-        timeReport.measure("Post processing geometry");
-
-        optimizeMaterials();
-        removeDuplicateMaterials();
-        quantizeTexCoords();
-
-        timeReport.measure("Optimizing materials");
+        runStage("prepareDisplacementMaps", &SceneBuilder::prepareDisplacementMaps);
+
+        // Post-process the scene data.
+        runStage("prepareSceneGraph", &SceneBuilder::prepareSceneGraph);
+        runStage("prepareMeshes", &SceneBuilder::prepareMeshes);
+        runStage("removeUnusedMeshes", &SceneBuilder::removeUnusedMeshes);
+        runStage("flattenStaticMeshInstances", &SceneBuilder::flattenStaticMeshInstances);
+        runStage("pretransformStaticMeshes", &SceneBuilder::pretransformStaticMeshes);
+        runStage("unifyTriangleWinding", &SceneBuilder::unifyTriangleWinding);
+        runStage("optimizeSceneGraph", &SceneBuilder::optimizeSceneGraph);
+        runStage("calculateMeshBoundingBoxes", &SceneBuilder::calculateMeshBoundingBoxes);
+        runStage("createMeshGroups", &SceneBuilder::createMeshGroups);
+        runStage("optimizeGeometry", &SceneBuilder::optimizeGeometry);
+        runStage("sortMeshes", &SceneBuilder::sortMeshes);
+        runStage("createGlobalBuffers", &SceneBuilder::createGlobalBuffers);
+        runStage("createCurveGlobalBuffers", &SceneBuilder::createCurveGlobalBuffers);
+        runStage("collectVolumeGrids", &SceneBuilder::collectVolumeGrids);
+        runStage("removeDuplicateSDFGrids", &SceneBuilder::removeDuplicateSDFGrids);
+
+        runStage("optimizeMaterials", &SceneBuilder::optimizeMaterials);
+        runStage("removeDuplicateMaterials", &SceneBuilder::removeDuplicateMaterials);
+        runStage("quantizeTexCoords", &SceneBuilder::quantizeTexCoords);
 
         // Prepare scene resources.
-        createSceneGraph();
-        createMeshData();
-        createMeshBoundingBoxes();
-        createCurveData();
-        calculateCurveBoundingBoxes();
+        runStage("createSceneGraph", &SceneBuilder::createSceneGraph);
+        runStage("createMeshData", &SceneBuilder::createMeshData);
+        runStage("createMeshBoundingBoxes", &SceneBuilder::createMeshBoundingBoxes);
+        runStage("createCurveData", &SceneBuilder::createCurveData);
+        runStage("calculateCurveBoundingBoxes", &SceneBuilder::calculateCurveBoundingBoxes);
 
         // Create instance data.
-        uint32_t tlasInstanceIndex = 0;
-        createMeshInstanceData(tlasInstanceIndex);
-        createCurveInstanceData(tlasInstanceIndex);
-        // Adjust instance indices of SDF grid instances.
-        for (auto& sdfInstanceData : mSceneData.sdfGridInstances) sdfInstanceData.instanceIndex = tlasInstanceIndex++;
+        {
+            BuildStageScope stage(mBuildStats, "createInstanceData");
+            uint32_t tlasInstanceIndex = 0;
+            createMeshInstanceData(tlasInstanceIndex);
+            createCurveInstanceData(tlasInstanceIndex);
+            // Adjust instance indices of SDF grid instances.
+            for (auto& sdfInstanceData : mSceneData.sdfGridInstances) sdfInstanceData.instanceIndex = tlasInstanceIndex++;
+        }
 
         mSceneData.useCompressedHitInfo = is_set(mFlags, Flags::UseCompressedHitInfo);
 
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
+            BuildStageScope stage(mBuildStats, "writeCache");
             SceneCache::writeCache(mSceneData, mSceneCacheKey);
-            timeReport.measure("Writing cache");
         }
-
-        // Create the scene object.
-        mpScene = Scene::create(mpDevice, std::move(mSceneData));
-        mSceneData = {};
-
-        timeReport.measure("Creating resources");
-        timeReport.printToLog();
-
-        return mpScene;
     }
 
     // Meshes
@@ -380,6 +504,42 @@ namespace Falcor
     }
 
     MeshID SceneBuilder::addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial)
+    {
+        return addProcessedMesh(processTriangleMesh(pTriangleMesh, pMaterial));
+    }
+
+    std::vector<MeshID> SceneBuilder::addTriangleMeshes(const std::vector<std::pair<ref<TriangleMesh>, ref<Material>>>& triangleMeshes)
+    {
+        // Pre-process meshes in parallel. An exception thrown inside the parallel algorithm would terminate
+        // the process, so errors are recorded per mesh and the first one is rethrown below.
+        std::vector<ProcessedMesh> processedMeshes(triangleMeshes.size());
+        std::vector<std::exception_ptr> exceptions(triangleMeshes.size());
+        auto range = NumericRange<size_t>(0, triangleMeshes.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            try
+            {
+                processedMeshes[i] = processTriangleMesh(triangleMeshes[i].first, triangleMeshes[i].second);
+            }
+            catch (...)
+            {
+                exceptions[i] = std::current_exception();
+            }
+        });
+
+        for (const auto& exception : exceptions)
+        {
+            if (exception) std::rethrow_exception(exception);
+        }
+
+        // Add meshes sequentially to retain a deterministic order in the global scene buffers.
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(processedMeshes.size());
+        for (const auto& mesh : processedMeshes) meshIDs.push_back(addProcessedMesh(mesh));
+        return meshIDs;
+    }
+
+    SceneBuilder::ProcessedMesh SceneBuilder::processTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial) const
     {
         checkArgument(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
@@ -409,7 +569,7 @@ namespace Falcor
         mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
         mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
 
-        return addMesh(mesh);
+        return processMesh(mesh);
     }
 
     SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices) const
@@ -942,7 +1102,7 @@ namespace Falcor
 
     void SceneBuilder::loadLightProfile(const std::string& filename, bool normalize)
     {
-        mSceneData.pLightProfile = LightProfile::createFromIesProfile(mpDevice, std::filesystem::path(filename), normalize);
+        mSceneData.pLightProfile = LightProfile::createFromIesProfile(requireDevice("Loading a light profile"), std::filesystem::path(filename), normalize);
     }
 
     // Cameras
@@ -1262,7 +1422,9 @@ namespace Falcor
     {
         for (const auto& pMaterial : mSceneData.pMaterials->getMaterials())
         {
-            if (pMaterial->getTexture(Material::TextureSlot::Displacement) != nullptr)
+            bool hasDisplacement = pMaterial->getTexture(Material::TextureSlot::Displacement) != nullptr ||
+                !pMaterial->getDeferredTexturePath(Material::TextureSlot::Displacement).empty();
+            if (hasDisplacement)
             {
                 // Remove displacement maps if requested by scene flags.
                 if (is_set(mFlags, Flags::DontUseDisplacement))
@@ -2897,12 +3059,15 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("DeduplicateTextures", SceneBuilder::Flags::DeduplicateTextures);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
+        flags.value("UseTextureCache", SceneBuilder::Flags::UseTextureCache);
         ScriptBindings::addEnumBinaryOperators(flags);
 
         pybind11::class_<SceneBuilder> sceneBuilder(m, "SceneBuilder");
         sceneBuilder.def_property_readonly("flags", &SceneBuilder::getFlags);
+        sceneBuilder.def_property_readonly("headless", &SceneBuilder::isHeadless);
         sceneBuilder.def_property_readonly("materials", &SceneBuilder::getMaterials);
         sceneBuilder.def_property_readonly("gridVolumes", &SceneBuilder::getGridVolumes);
         sceneBuilder.def_property_readonly("volumes", &SceneBuilder::getGridVolumes); // PYTHONDEPRECATED
@@ -2915,6 +3080,18 @@ namespace Falcor
         sceneBuilder.def_property("cameraSpeed", &SceneBuilder::getCameraSpeed, &SceneBuilder::setCameraSpeed);
         sceneBuilder.def("importScene", &SceneBuilder::import, "path"_a, "dict"_a = pybind11::dict());
         sceneBuilder.def("addTriangleMesh", &SceneBuilder::addTriangleMesh, "triangleMesh"_a, "material"_a);
+        sceneBuilder.def("addTriangleMeshes", [] (SceneBuilder* pSceneBuilder, const pybind11::list& triangleMeshes, const pybind11::object& material)
+        {
+            // Accepts a list of triangle meshes with a single material, or a list of (triangleMesh, material) pairs.
+            std::vector<std::pair<ref<TriangleMesh>, ref<Material>>> meshes;
+            meshes.reserve(triangleMeshes.size());
+            for (const auto& item : triangleMeshes)
+            {
+                if (material.is_none()) meshes.push_back(item.cast<std::pair<ref<TriangleMesh>, ref<Material>>>());
+                else meshes.emplace_back(item.cast<ref<TriangleMesh>>(), material.cast<ref<Material>>());
+            }
+            return pSceneBuilder->addTriangleMeshes(meshes);
+        }, "triangleMeshes"_a, "material"_a = pybind11::none());
         sceneBuilder.def("addSDFGrid", &SceneBuilder::addSDFGrid, "sdfGrid"_a, "material"_a);
         sceneBuilder.def("addMaterial", &SceneBuilder::addMaterial, "material"_a);
         sceneBuilder.def("replaceMaterial", &SceneBuilder::replaceMaterial, "material"_a, "replacement"_a);
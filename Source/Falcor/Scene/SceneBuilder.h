@@ -76,9 +76,11 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            DeduplicateTextures             = 0x20000,  ///< Share one texture between texture files with identical contents, detected by hashing the file contents.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
+            UseTextureCache                 = 0x40000000, ///< Enable texture caching. This stores material textures as block-compressed DDS files with prebuilt mips on disk to reduce load time and memory use.
 
             Default = None
         };
@@ -325,6 +327,8 @@ namespace Falcor
         };
 
         /** Constructor.
+            If pDevice is nullptr, the builder runs headless. It imports and post-processes the scene without creating
+            GPU resources, and the result can only be retrieved with getSceneData(). See isHeadless() for the limitations.
         */
         SceneBuilder(ref<Device> pDevice, const Settings& settings, Flags flags = Flags::Default);
 
@@ -356,12 +360,42 @@ namespace Falcor
         void importFromMemory(const void* buffer, size_t byteSize, std::string_view extension, const pybind11::dict& dict = pybind11::dict());
 
         /** Get the scene. Make sure to add all the objects before calling this function
+            Throws a RuntimeError if the builder is headless.
             \return nullptr if something went wrong, otherwise a new Scene object
         */
         ref<Scene> getScene();
 
+        /** Get the post-processed scene data without creating a scene.
+            This runs the same post-processing as getScene() and writes the scene cache if requested, but creates no GPU resources.
+            It is the only way to retrieve the result of a headless builder. The scene data is moved out of the builder,
+            so this function can only be called once, and not after getScene().
+            \return The scene data. Materials built without a device reference their textures by path (see Material::getDeferredTexturePath()).
+        */
+        Scene::SceneData getSceneData();
+
+        /** Compute the scene cache key of a scene file.
+            \param[in] path Absolute path of the scene file.
+            \param[in] flags Build flags. Flags that don't affect the cached scene data are ignored.
+            \param[in] headless True for headless builders, which use separate cache entries.
+            \return The scene cache key.
+        */
+        static SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, Flags flags, bool headless);
+
         const ref<Device>& getDevice() const { return mpDevice; }
 
+        /** Check if the builder runs without a device.
+            Headless builders reference material textures by path instead of loading them. Assets that need GPU resources at
+            import time (environment maps, volume grids, SDF grids, light profiles and measured materials) are not supported.
+        */
+        bool isHeadless() const { return mpDevice == nullptr; }
+
+        /** Get the device for creating GPU resources.
+            Throws a RuntimeError if the builder is headless.
+            \param[in] feature Description of what needs the device. Used in the error message.
+            \return The device.
+        */
+        const ref<Device>& requireDevice(std::string_view feature) const;
+
         const Settings& getSettings() const { return mSettings; }
         Settings& getSettings() { return mSettings; }
 
@@ -409,6 +443,23 @@ namespace Falcor
         */
         MeshID addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial);
 
+        /** Add a list of triangle meshes.
+            The meshes are pre-processed in parallel and added in the order given, so the mesh IDs are deterministic.
+            Throws an exception if something went wrong.
+            \param triangleMeshes List of triangle meshes and the materials to use for them.
+            \return The IDs of the meshes in the scene, in the same order as the input.
+        */
+        std::vector<MeshID> addTriangleMeshes(const std::vector<std::pair<ref<TriangleMesh>, ref<Material>>>& triangleMeshes);
+
+        /** Pre-process a triangle mesh into the data format that is used in the global scene buffers.
+            This function is thread safe and can be used to process meshes in parallel before adding them with addProcessedMesh().
+            Throws an exception if something went wrong.
+            \param pTriangleMesh The triangle mesh to pre-process.
+            \param pMaterial The material to use for the mesh.
+            \return The pre-processed mesh.
+        */
+        ProcessedMesh processTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial) const;
+
         /** Pre-process a mesh into the data format that is used in the global scene buffers.
             Throws an exception if something went wrong.
             \param mesh The mesh to pre-process.
@@ -759,6 +810,8 @@ namespace Falcor
         const Flags mFlags;
 
         Scene::SceneData mSceneData;
+        bool mSceneDataFinalized = false;   ///< True if mSceneData is post-processed already (headless builder loaded from the scene cache).
+        Scene::BuildStats mBuildStats;      ///< Time and memory use of the build stages run so far.
         ref<Scene> mpScene;
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
@@ -798,6 +851,8 @@ namespace Falcor
         MeshGroupList splitMeshGroupMidpointMeshes(MeshGroup& meshGroup);
 
         // Post processing
+        void finalizeSceneData();
+        void createScene(Scene::SceneData&& sceneData);
         void prepareDisplacementMaps();
         void prepareSceneGraph();
         void prepareMeshes();
@@ -233,7 +233,7 @@ namespace Falcor
         if (fs.bad()) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
     }
 
-    Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key)
+    Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key, bool useTextureCache, bool deduplicateTextures)
     {
         auto cachePath = getCachePath(key);
 
@@ -251,7 +251,7 @@ namespace Falcor
         // Read cache (compressed).
         lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
         InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
+        auto sceneData = readSceneData(stream, pDevice, useTextureCache, deduplicateTextures);
         if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
         return sceneData;
     }
@@ -376,10 +376,12 @@ namespace Falcor
         writeMarker(stream, "End");
     }
 
-    Scene::SceneData SceneCache::readSceneData(InputStream& stream, ref<Device> pDevice)
+    Scene::SceneData SceneCache::readSceneData(InputStream& stream, ref<Device> pDevice, bool useTextureCache, bool deduplicateTextures)
     {
         Scene::SceneData sceneData;
         sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
+        sceneData.pMaterials->getTextureManager().setUseTextureCache(useTextureCache);
+        sceneData.pMaterials->getTextureManager().setUseContentHashing(deduplicateTextures);
 
         readMarker(stream, "Path");
         stream.read(sceneData.path);
@@ -399,14 +401,17 @@ namespace Falcor
 
         readMarker(stream, "Grids");
         sceneData.grids.resize(stream.read<uint32_t>());
+        if (!pDevice && !sceneData.grids.empty()) throw RuntimeError("Scene cache contains volume grids, which can't be read without a device.");
         for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
 
         readMarker(stream, "GridVolumes");
         sceneData.gridVolumes.resize(stream.read<uint32_t>());
+        if (!pDevice && !sceneData.gridVolumes.empty()) throw RuntimeError("Scene cache contains grid volumes, which can't be read without a device.");
         for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids, pDevice);
 
         readMarker(stream, "EnvMap");
         auto hasEnvMap = stream.read<bool>();
+        if (hasEnvMap && !pDevice) throw RuntimeError("Scene cache contains an environment map, which can't be read without a device.");
         if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream, pDevice);
 
         // Material textures are loaded asynchronously to allow loading other data
@@ -672,12 +677,14 @@ namespace Falcor
 
         auto writeTextureSlot = [&stream, &pMaterial](Material::TextureSlot slot)
         {
+            // Materials built without a device reference their textures by path only.
             auto pTexture = pMaterial->getTexture(slot);
-            bool hasTexture = pTexture != nullptr;
+            const auto& path = pTexture ? pTexture->getSourcePath() : pMaterial->getDeferredTexturePath(slot);
+            bool hasTexture = !path.empty();
             stream.write(hasTexture);
             if (hasTexture)
             {
-                stream.write(pTexture->getSourcePath());
+                stream.write(path);
             }
         };
 
@@ -797,7 +804,8 @@ namespace Falcor
         if (valid)
         {
             auto desc = stream.read<Sampler::Desc>();
-            return Sampler::create(pDevice, desc);
+            // Without a device the material system assigns no samplers.
+            return pDevice ? Sampler::create(pDevice, desc) : nullptr;
         }
         return nullptr;
     }
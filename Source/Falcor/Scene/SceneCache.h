@@ -69,20 +69,28 @@ namespace Falcor
         static void writeCache(const Scene::SceneData& sceneData, const Key& key);
 
         /** Read a scene cache.
-            \param[in] pDevice GPU device.
+            If no device is given, material textures are referenced by path only (see Material::getDeferredTexturePath()).
+            Caches containing volume grids or an environment map can't be read without a device.
+            \param[in] pDevice GPU device, or nullptr to read the scene data without creating GPU resources.
             \param[in] key Cache key.
+            \param[in] useTextureCache Load material textures through the texture cache (see TextureCache).
+            \param[in] deduplicateTextures Share textures between texture files with identical contents (see TextureManager::setUseContentHashing()).
             \return Returns the loaded scene data.
         */
-        static Scene::SceneData readCache(ref<Device> pDevice, const Key& key);
+        static Scene::SceneData readCache(ref<Device> pDevice, const Key& key, bool useTextureCache = false, bool deduplicateTextures = false);
+
+        /** Get the path of the scene cache file for a given cache key.
+            \param[in] key Cache key.
+            \return Returns the path of the cache file, which may not exist.
+        */
+        static std::filesystem::path getCachePath(const Key& key);
 
     private:
         class OutputStream;
         class InputStream;
 
-        static std::filesystem::path getCachePath(const Key& key);
-
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
-        static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
+        static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice, bool useTextureCache, bool deduplicateTextures);
 
         static void writeMetadata(OutputStream& stream, const Scene::Metadata& metadata);
         static Scene::Metadata readMetadata(InputStream& stream);
@@ -29,11 +29,13 @@
 #include "Core/Assert.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <cmath>
+#include <execution>
 
 namespace Falcor
 {
@@ -272,6 +274,32 @@ namespace Falcor
         return create(vertices, indices);
     }
 
+    std::vector<ref<TriangleMesh>> TriangleMesh::createFromFiles(const std::vector<std::filesystem::path>& paths, bool smoothNormals)
+    {
+        // Exceptions are not allowed to escape the parallel algorithm, so we store them and rethrow the first one in input order.
+        std::vector<ref<TriangleMesh>> meshes(paths.size());
+        std::vector<std::exception_ptr> exceptions(paths.size());
+        auto range = NumericRange<size_t>(0, paths.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            try
+            {
+                meshes[i] = createFromFile(paths[i], smoothNormals);
+            }
+            catch (...)
+            {
+                exceptions[i] = std::current_exception();
+            }
+        });
+
+        for (const auto& exception : exceptions)
+        {
+            if (exception) std::rethrow_exception(exception);
+        }
+
+        return meshes;
+    }
+
     uint32_t TriangleMesh::addVertex(float3 position, float3 normal, float2 texCoord)
     {
         mVertices.emplace_back(Vertex{position, normal, texCoord});
@@ -338,5 +366,6 @@ namespace Falcor
         triangleMesh.def_static("createCube", &TriangleMesh::createCube, "size"_a = float3(1.f));
         triangleMesh.def_static("createSphere", &TriangleMesh::createSphere, "radius"_a = 1.f, "segmentsU"_a = 32, "segmentsV"_a = 32);
         triangleMesh.def_static("createFromFile", &TriangleMesh::createFromFile, "path"_a, "smoothNormals"_a = false);
+        triangleMesh.def_static("createFromFiles", &TriangleMesh::createFromFiles, "paths"_a, "smoothNormals"_a = false);
     }
 }
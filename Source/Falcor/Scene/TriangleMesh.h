@@ -109,6 +109,14 @@ namespace Falcor
         */
         static ref<TriangleMesh> createFromFile(const std::filesystem::path& path, bool smoothNormals = false);
 
+        /** Creates triangle meshes from a list of files.
+            The files are loaded in parallel. See createFromFile() for details.
+            \param[in] paths File paths to load meshes from.
+            \param[in] smoothNormals If no normals are defined in the model, generate smooth instead of facet normals.
+            \return Returns the triangle meshes in the same order as the paths. Entries are nullptr for meshes that failed to load.
+        */
+        static std::vector<ref<TriangleMesh>> createFromFiles(const std::vector<std::filesystem::path>& paths, bool smoothNormals = false);
+
         /** Get the name of the triangle mesh.
             \return Returns the name.
         */
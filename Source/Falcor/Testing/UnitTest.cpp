@@ -42,13 +42,23 @@
 #include <fmt/format.h>
 #include <fmt/color.h>
 #include <pugixml.hpp>
+#include <nlohmann/json.hpp>
 #include <BS_thread_pool_light.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <fstream>
 #include <regex>
 #include <cstdint>
 
+#if FALCOR_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace Falcor
 {
 namespace unittest
@@ -61,6 +71,7 @@ struct TestDesc
     unittest::Options options;
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    BenchmarkFunc benchmarkFunc;
 };
 
 struct TestResult
@@ -76,8 +87,12 @@ struct TestResult
     std::vector<std::string> messages;
     std::string extraMessage;
     uint64_t elapsedMS = 0;
+    std::vector<BenchmarkResult> benchmarks;
 };
 
+/// Baseline benchmark results, keyed by "<suite>:<test>[/<label>]".
+using BenchmarkBaseline = std::map<std::string, BenchmarkResult>;
+
 static std::vector<TestDesc>& getTestRegistry()
 {
     static std::vector<TestDesc> registry;
@@ -154,6 +169,16 @@ void registerGPUTest(std::filesystem::path path, std::string name, unittest::Opt
     getTestRegistry().push_back(desc);
 }
 
+void registerBenchmark(std::filesystem::path path, std::string name, unittest::Options options, BenchmarkFunc func)
+{
+    TestDesc desc;
+    desc.path = std::move(path);
+    desc.name = std::move(name);
+    desc.options = std::move(options);
+    desc.benchmarkFunc = std::move(func);
+    getTestRegistry().push_back(desc);
+}
+
 /// Prints the UnitTest report line, making sure it is always printed to the console once.
 template<typename... Args>
 void reportLine(const std::string_view format, Args&&... args)
@@ -222,7 +247,159 @@ inline void writeXmlReport(const std::filesystem::path& path, const std::vector<
     doc.save_file(path.native().c_str());
 }
 
-inline TestResult runTest(const Test& test, DevicePool& devicePool)
+inline std::string getBenchmarkKey(const Test& test, const BenchmarkResult& benchmark)
+{
+    std::string key = fmt::format("{}:{}", test.suiteName, test.name);
+    if (!benchmark.label.empty())
+        key += "/" + benchmark.label;
+    return key;
+}
+
+inline std::string formatBenchmarkTime(double ns)
+{
+    if (ns < 1e3)
+        return fmt::format("{:.2f} ns", ns);
+    if (ns < 1e6)
+        return fmt::format("{:.2f} us", ns * 1e-3);
+    if (ns < 1e9)
+        return fmt::format("{:.2f} ms", ns * 1e-6);
+    return fmt::format("{:.2f} s", ns * 1e-9);
+}
+
+/**
+ * Write benchmark results in JSON format.
+ * @param[in] path File path.
+ * @param[in] report List of tests/results.
+ * @param[in] options Benchmark options used for the run.
+ */
+inline void writeBenchmarkReport(
+    const std::filesystem::path& path,
+    const std::vector<std::pair<Test, TestResult>>& report,
+    const BenchmarkOptions& options
+)
+{
+    nlohmann::json benchmarks = nlohmann::json::array();
+    for (const auto& [test, result] : report)
+    {
+        for (const auto& benchmark : result.benchmarks)
+        {
+            nlohmann::json entry = {
+                {"name", getBenchmarkKey(test, benchmark)},
+                {"suite", test.suiteName},
+                {"test", test.name},
+                {"label", benchmark.label},
+                {"iterations", benchmark.iterations},
+                {"samples", benchmark.samples},
+                {"median_ns", benchmark.medianNs},
+                {"mad_ns", benchmark.madNs},
+                {"mean_ns", benchmark.meanNs},
+                {"min_ns", benchmark.minNs},
+                {"max_ns", benchmark.maxNs},
+            };
+            if (!benchmark.counters.empty())
+                entry["counters"] = benchmark.counters;
+            benchmarks.push_back(std::move(entry));
+        }
+    }
+
+    nlohmann::json json = {
+        {"version", getLongVersionString()},
+        {"hardware_concurrency", std::thread::hardware_concurrency()},
+        {"options",
+         {
+             {"warmup_time", options.warmupTime},
+             {"min_time", options.minTime},
+             {"min_sample_time", options.minSampleTime},
+             {"min_samples", options.minSamples},
+             {"max_samples", options.maxSamples},
+         }},
+        {"benchmarks", std::move(benchmarks)},
+    };
+
+    std::ofstream ofs(path);
+    if (!ofs.good())
+    {
+        logError("Failed to write benchmark report to '{}'.", path);
+        return;
+    }
+    ofs << json.dump(4);
+}
+
+/**
+ * Read benchmark results of a previous run written by writeBenchmarkReport().
+ * @param[in] path File path.
+ * @return Baseline results keyed by benchmark name.
+ */
+inline BenchmarkBaseline readBenchmarkBaseline(const std::filesystem::path& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs.good())
+        throw RuntimeError("Failed to open benchmark baseline '{}'.", path);
+
+    BenchmarkBaseline baseline;
+    try
+    {
+        nlohmann::json json = nlohmann::json::parse(ifs);
+        for (const auto& entry : json.at("benchmarks"))
+        {
+            BenchmarkResult result;
+            result.label = entry.at("label").get<std::string>();
+            result.iterations = entry.at("iterations").get<uint64_t>();
+            result.samples = entry.at("samples").get<uint32_t>();
+            result.medianNs = entry.at("median_ns").get<double>();
+            result.madNs = entry.at("mad_ns").get<double>();
+            result.meanNs = entry.at("mean_ns").get<double>();
+            result.minNs = entry.at("min_ns").get<double>();
+            result.maxNs = entry.at("max_ns").get<double>();
+            baseline[entry.at("name").get<std::string>()] = result;
+        }
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        throw RuntimeError("Failed to parse benchmark baseline '{}': {}", path, e.what());
+    }
+    return baseline;
+}
+
+/**
+ * Report the benchmark results of a test and compare them to the baseline.
+ * A benchmark regressed if its median exceeds the baseline median by more than the relative tolerance
+ * and by more than three times the larger of the two MADs, which guards against flagging noise.
+ * Regressions are added as failure messages to the test result.
+ */
+inline void reportBenchmarks(const Test& test, TestResult& result, const BenchmarkBaseline& baseline, const BenchmarkOptions& options)
+{
+    for (const auto& benchmark : result.benchmarks)
+    {
+        std::string key = getBenchmarkKey(test, benchmark);
+        std::string counters;
+        for (const auto& [name, value] : benchmark.counters)
+            counters += fmt::format(", {} {:.1f}", name, value);
+        reportLine(
+            "[  BENCH   ] {}: median {} (MAD {}), {} iterations in {} samples{}", key, formatBenchmarkTime(benchmark.medianNs),
+            formatBenchmarkTime(benchmark.madNs), benchmark.iterations, benchmark.samples, counters
+        );
+
+        auto it = baseline.find(key);
+        if (it == baseline.end())
+            continue;
+        const BenchmarkResult& base = it->second;
+        double delta = benchmark.medianNs - base.medianNs;
+        double noise = 3.0 * std::max(benchmark.madNs, base.madNs);
+        if (delta > options.tolerance * base.medianNs && delta > noise)
+        {
+            std::string message = fmt::format(
+                "Benchmark '{}' regressed: median {} vs. baseline {} ({:+.1f}%).", key, formatBenchmarkTime(benchmark.medianNs),
+                formatBenchmarkTime(base.medianNs), 100.0 * delta / base.medianNs
+            );
+            reportLine("{}", message);
+            result.messages.push_back(message);
+            result.status = TestResult::Status::Failed;
+        }
+    }
+}
+
+inline TestResult runTest(const Test& test, DevicePool& devicePool, const BenchmarkOptions& benchmarkOptions)
 {
     if (!test.skipMessage.empty())
         return {TestResult::Status::Skipped, {test.skipMessage}};
@@ -235,6 +412,7 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
 
     CPUUnitTestContext cpuCtx;
     GPUUnitTestContext gpuCtx(pDevice);
+    BenchmarkContext benchmarkCtx(benchmarkOptions);
 
     auto startTime = std::chrono::steady_clock::now();
 
@@ -242,6 +420,8 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
     {
         if (test.cpuFunc)
             test.cpuFunc(cpuCtx);
+        else if (test.benchmarkFunc)
+            test.benchmarkFunc(benchmarkCtx);
         else
             test.gpuFunc(gpuCtx);
     }
@@ -271,7 +451,13 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
         result.extraMessage = e.what();
     }
 
-    result.messages = test.cpuFunc ? cpuCtx.getFailureMessages() : gpuCtx.getFailureMessages();
+    if (test.cpuFunc)
+        result.messages = cpuCtx.getFailureMessages();
+    else if (test.benchmarkFunc)
+        result.messages = benchmarkCtx.getFailureMessages();
+    else
+        result.messages = gpuCtx.getFailureMessages();
+    result.benchmarks = benchmarkCtx.getResults();
 
     if (!result.messages.empty())
         result.status = TestResult::Status::Failed;
@@ -293,7 +479,7 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
     return result;
 }
 
-inline int32_t runTestsParallel(const RunOptions& options)
+inline int32_t runTestsParallel(const RunOptions& options, const BenchmarkBaseline& baseline)
 {
     // Abort on Ctrl-C.
     std::atomic<bool> abort{false};
@@ -318,11 +504,13 @@ inline int32_t runTestsParallel(const RunOptions& options)
     BS::thread_pool_light threadPool(options.parallel);
 
     reportLine("[==========] Running {} test{}.", tests.size(), plural(tests.size(), "s"));
+    if (options.benchmark.enabled)
+        reportLine("Warning: Running benchmarks in parallel, timings will be unreliable.");
 
     for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
     {
         threadPool.push_task(
-            [&abort, &tests, &results, &devicePool, testIndex]()
+            [&abort, &tests, &results, &devicePool, &options, &baseline, testIndex]()
             {
                 if (abort)
                     return;
@@ -333,7 +521,8 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
                 reportLine("[ RUN      ] {}:{}{}", test.suiteName, test.name, repeats);
 
-                result = runTest(test, devicePool);
+                result = runTest(test, devicePool, options.benchmark);
+                reportBenchmarks(test, result, baseline, options.benchmark);
 
                 std::string statusTag;
                 switch (result.status)
@@ -366,6 +555,14 @@ inline int32_t runTestsParallel(const RunOptions& options)
     auto endTime = std::chrono::steady_clock::now();
     uint64_t totalMS = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
 
+    if (!options.benchmark.reportPath.empty())
+    {
+        std::vector<std::pair<Test, TestResult>> report;
+        for (size_t i = 0; i < tests.size(); ++i)
+            report.emplace_back(tests[i], results[i]);
+        writeBenchmarkReport(options.benchmark.reportPath, report, options.benchmark);
+    }
+
     int32_t failureCount = 0;
     for (const auto& result : results)
         failureCount += result.status == TestResult::Status::Failed ? 1 : 0;
@@ -385,7 +582,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
     return failureCount;
 }
 
-inline int32_t runTestsSerial(const RunOptions& options)
+inline int32_t runTestsSerial(const RunOptions& options, const BenchmarkBaseline& baseline)
 {
     // Abort on Ctrl-C.
     std::atomic<bool> abort{false};
@@ -441,7 +638,8 @@ inline int32_t runTestsSerial(const RunOptions& options)
                 if (options.repeat > 1)
                     repeats = fmt::format("[{}/{}]", repeatIndex + 1, options.repeat);
                 reportLine("[ RUN      ] {}:{}{}", suiteName, test.name, repeats);
-                TestResult result = runTest(test, devicePool);
+                TestResult result = runTest(test, devicePool, options.benchmark);
+                reportBenchmarks(test, result, baseline, options.benchmark);
                 report.emplace_back(test, result);
 
                 std::string statusTag;
@@ -484,6 +682,8 @@ inline int32_t runTestsSerial(const RunOptions& options)
 
     if (!options.xmlReportPath.empty())
         writeXmlReport(options.xmlReportPath, report);
+    if (!options.benchmark.reportPath.empty())
+        writeBenchmarkReport(options.benchmark.reportPath, report, options.benchmark);
 
     reportLine(
         "[==========] {} test{} from {} test suite{} ran. ({} ms total)", testCount, plural(testCount, "s"), suiteCount,
@@ -510,11 +710,15 @@ int32_t runTests(const RunOptions& options)
 
     logInfo("Falcor {}", getLongVersionString());
 
+    BenchmarkBaseline baseline;
+    if (!options.benchmark.baselinePath.empty())
+        baseline = readBenchmarkBaseline(options.benchmark.baselinePath);
+
     OSServices::start();
     Threading::start();
     Scripting::start();
 
-    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options) : runTestsSerial(options);
+    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options, baseline) : runTestsSerial(options, baseline);
 
     Scripting::shutdown();
     Threading::shutdown();
@@ -538,8 +742,9 @@ std::vector<Test> enumerateTests()
         test.deviceType = Device::Type::Default;
         test.cpuFunc = desc.cpuFunc;
         test.gpuFunc = desc.gpuFunc;
+        test.benchmarkFunc = desc.benchmarkFunc;
 
-        if (test.cpuFunc)
+        if (test.cpuFunc || test.benchmarkFunc)
         {
             tests.push_back(test);
         }
@@ -727,6 +932,219 @@ void GPUUnitTestContext::runProgram(const uint3& dimensions)
     mpDevice->getRenderContext()->dispatch(mpState.get(), mpVars.get(), groups);
 }
 
+///////////////////////////////////////////////////////////////////////////
+
+/**
+ * Hardware performance counters of the calling thread.
+ * On Linux the counters are sampled with perf_event_open() and opened as a single group so that
+ * they are scheduled onto the PMU together. On other platforms no counters are available.
+ */
+class HardwareCounters
+{
+public:
+    HardwareCounters()
+    {
+#if FALCOR_LINUX
+        struct CounterDesc
+        {
+            const char* name;
+            uint64_t config;
+        };
+        const CounterDesc kCounters[] = {
+            {"cycles", PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_COUNT_HW_INSTRUCTIONS},
+            {"cache_misses", PERF_COUNT_HW_CACHE_MISSES},
+            {"branch_misses", PERF_COUNT_HW_BRANCH_MISSES},
+        };
+
+        for (const auto& counter : kCounters)
+        {
+            perf_event_attr attr = {};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = counter.config;
+            attr.disabled = mFds.empty() ? 1 : 0; // Group members follow the leader.
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+
+            int groupFd = mFds.empty() ? -1 : mFds.front();
+            int fd = (int)syscall(SYS_perf_event_open, &attr, 0 /* calling thread */, -1 /* any cpu */, groupFd, 0);
+            if (fd < 0)
+            {
+                // Without a group leader no counters are available, otherwise skip unsupported counters.
+                if (mFds.empty())
+                    return;
+                continue;
+            }
+            mFds.push_back(fd);
+            mNames.push_back(counter.name);
+        }
+#endif
+    }
+
+    ~HardwareCounters()
+    {
+#if FALCOR_LINUX
+        for (int fd : mFds)
+            close(fd);
+#endif
+    }
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    bool isValid() const { return !mFds.empty(); }
+
+    void reset()
+    {
+#if FALCOR_LINUX
+        ioctl(mFds.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    void enable()
+    {
+#if FALCOR_LINUX
+        ioctl(mFds.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    void disable()
+    {
+#if FALCOR_LINUX
+        ioctl(mFds.front(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    /// Read the accumulated counter values.
+    std::vector<std::pair<std::string, uint64_t>> read() const
+    {
+        std::vector<std::pair<std::string, uint64_t>> values;
+#if FALCOR_LINUX
+        // With PERF_FORMAT_GROUP the leader returns the number of counters followed by the values.
+        std::vector<uint64_t> data(1 + mFds.size());
+        if (::read(mFds.front(), data.data(), data.size() * sizeof(uint64_t)) < 0)
+            return values;
+        for (size_t i = 0; i < std::min<size_t>(data[0], mNames.size()); ++i)
+            values.emplace_back(mNames[i], data[1 + i]);
+#endif
+        return values;
+    }
+
+private:
+    std::vector<int> mFds;
+    std::vector<std::string> mNames;
+};
+
+void computeBenchmarkStatistics(std::vector<double> samples, BenchmarkResult& result)
+{
+    if (samples.empty())
+        return;
+
+    auto median = [](std::vector<double>& values)
+    {
+        size_t mid = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + mid, values.end());
+        double value = values[mid];
+        // For an even count, average with the largest value of the lower half.
+        if (values.size() % 2 == 0)
+            value = 0.5 * (value + *std::max_element(values.begin(), values.begin() + mid));
+        return value;
+    };
+
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += sample;
+    result.meanNs = sum / samples.size();
+    result.minNs = *std::min_element(samples.begin(), samples.end());
+    result.maxNs = *std::max_element(samples.begin(), samples.end());
+    result.medianNs = median(samples);
+
+    for (double& sample : samples)
+        sample = std::abs(sample - result.medianNs);
+    result.madNs = median(samples);
+}
+
+void useCharPointer(const volatile char* p) {}
+
+void BenchmarkContext::measureBatches(std::string_view label, const std::function<void(uint64_t)>& runBatch)
+{
+    // Run a single iteration as smoke test if benchmarking is not enabled.
+    if (!mOptions.enabled)
+    {
+        runBatch(1);
+        return;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto secondsSince = [](Clock::time_point start) { return std::chrono::duration<double>(Clock::now() - start).count(); };
+
+    // Warm up caches, branch predictors and lazily initialized state.
+    auto warmupStart = Clock::now();
+    do
+    {
+        runBatch(1);
+    } while (secondsSince(warmupStart) < mOptions.warmupTime);
+
+    // Grow the number of iterations per sample until a sample takes at least the minimum sample time.
+    // The growth per step is limited to avoid overshooting based on a single noisy measurement.
+    uint64_t batchSize = 1;
+    while (true)
+    {
+        auto start = Clock::now();
+        runBatch(batchSize);
+        double elapsed = secondsSince(start);
+        if (elapsed >= mOptions.minSampleTime)
+            break;
+        double scale = elapsed > 0.0 ? std::clamp(1.2 * mOptions.minSampleTime / elapsed, 1.0, 10.0) : 10.0;
+        batchSize = std::max(batchSize + 1, uint64_t(batchSize * scale));
+    }
+
+    std::unique_ptr<HardwareCounters> pCounters;
+    if (mOptions.hardwareCounters)
+    {
+        pCounters = std::make_unique<HardwareCounters>();
+        if (pCounters->isValid())
+        {
+            pCounters->reset();
+        }
+        else
+        {
+            static std::once_flag flag;
+            std::call_once(flag, []() { reportLine("Warning: Hardware counters are not available, running benchmarks without them."); });
+            pCounters.reset();
+        }
+    }
+
+    std::vector<double> samples;
+    samples.reserve(mOptions.minSamples);
+    auto measureStart = Clock::now();
+    while (samples.size() < mOptions.minSamples || (samples.size() < mOptions.maxSamples && secondsSince(measureStart) < mOptions.minTime))
+    {
+        if (pCounters)
+            pCounters->enable();
+        auto start = Clock::now();
+        runBatch(batchSize);
+        auto end = Clock::now();
+        if (pCounters)
+            pCounters->disable();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / batchSize);
+    }
+
+    BenchmarkResult result;
+    result.label = label;
+    result.samples = (uint32_t)samples.size();
+    result.iterations = batchSize * samples.size();
+    if (pCounters)
+    {
+        for (const auto& [name, value] : pCounters->read())
+            result.counters[name] = double(value) / result.iterations;
+    }
+    computeBenchmarkStatistics(std::move(samples), result);
+    mResults.push_back(std::move(result));
+}
+
 } // namespace unittest
 
 /**
@@ -797,4 +1215,26 @@ CPU_TEST(TestTags, TAGS("tag1", "tag2", "tag3"))
     EXPECT(true);
 }
 
+CPU_TEST(TestBenchmarkStatistics)
+{
+    unittest::BenchmarkResult result;
+    unittest::computeBenchmarkStatistics({5.0, 1.0, 3.0, 2.0, 100.0}, result);
+    EXPECT_EQ(result.medianNs, 3.0);
+    EXPECT_EQ(result.madNs, 2.0);
+    EXPECT_EQ(result.meanNs, 22.2);
+    EXPECT_EQ(result.minNs, 1.0);
+    EXPECT_EQ(result.maxNs, 100.0);
+
+    unittest::computeBenchmarkStatistics({4.0, 1.0, 3.0, 2.0}, result);
+    EXPECT_EQ(result.medianNs, 2.5);
+    EXPECT_EQ(result.madNs, 1.0);
+}
+
+CPU_BENCHMARK(TestBenchmark)
+{
+    uint32_t value = 1;
+    ctx.measure([&]() { ctx.doNotOptimize(value *= 3); });
+    EXPECT_NE(value, 0u);
+}
+
 } // namespace Falcor
@@ -85,6 +85,20 @@ public:
     SkippingTestException(const std::string& what) : std::runtime_error(what.c_str()) {}
 };
 
+struct BenchmarkOptions
+{
+    bool enabled = false;                ///< Run full measurements. If false, each benchmark runs a single iteration as a smoke test.
+    double warmupTime = 0.1;             ///< Warmup time per measurement in seconds.
+    double minTime = 0.5;                ///< Minimum measured time per measurement in seconds.
+    double minSampleTime = 0.001;        ///< Minimum time per sample in seconds. Determines the number of iterations per sample.
+    uint32_t minSamples = 10;            ///< Minimum number of samples per measurement.
+    uint32_t maxSamples = 1000;          ///< Maximum number of samples per measurement.
+    bool hardwareCounters = false;       ///< Sample hardware performance counters (Linux only).
+    std::filesystem::path reportPath;    ///< JSON report output file.
+    std::filesystem::path baselinePath;  ///< JSON report of a previous run to compare against.
+    double tolerance = 0.1;              ///< Relative increase of the median over the baseline that is reported as regression.
+};
+
 struct RunOptions
 {
     Device::Desc deviceDesc;
@@ -94,15 +108,18 @@ struct RunOptions
     std::filesystem::path xmlReportPath;
     uint32_t parallel = 1;
     uint32_t repeat = 1;
+    BenchmarkOptions benchmark;
 };
 
 FALCOR_API int32_t runTests(const RunOptions& options);
 
 class CPUUnitTestContext;
 class GPUUnitTestContext;
+class BenchmarkContext;
 
 using CPUTestFunc = std::function<void(CPUUnitTestContext& ctx)>;
 using GPUTestFunc = std::function<void(GPUUnitTestContext& ctx)>;
+using BenchmarkFunc = std::function<void(BenchmarkContext& ctx)>;
 
 struct Test
 {
@@ -114,6 +131,7 @@ struct Test
 
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    BenchmarkFunc benchmarkFunc;
 };
 
 /// Enumerate all tests.
@@ -154,6 +172,91 @@ private:
 class FALCOR_API CPUUnitTestContext : public UnitTestContext
 {};
 
+/**
+ * Summary statistics of a single benchmark measurement.
+ * All times are per iteration in nanoseconds.
+ */
+struct BenchmarkResult
+{
+    std::string label;                      ///< Measurement label (empty for unlabeled measurements).
+    uint64_t iterations = 0;                ///< Total number of timed iterations.
+    uint32_t samples = 0;                   ///< Number of timed samples.
+    double medianNs = 0.0;                  ///< Median of the per-iteration sample times.
+    double madNs = 0.0;                     ///< Median absolute deviation of the per-iteration sample times.
+    double meanNs = 0.0;                    ///< Mean of the per-iteration sample times.
+    double minNs = 0.0;                     ///< Minimum of the per-iteration sample times.
+    double maxNs = 0.0;                     ///< Maximum of the per-iteration sample times.
+    std::map<std::string, double> counters; ///< Hardware counters per iteration (only if enabled and supported).
+};
+
+/**
+ * Compute the summary statistics of a list of samples.
+ * @param[in] samples Per-iteration sample times in nanoseconds.
+ * @param[out] result Result with median, MAD, mean, min and max filled in.
+ */
+FALCOR_API void computeBenchmarkStatistics(std::vector<double> samples, BenchmarkResult& result);
+
+/// Opaque sink used by BenchmarkContext::doNotOptimize() on compilers without inline assembly.
+FALCOR_API void useCharPointer(const volatile char* p);
+
+class FALCOR_API BenchmarkContext : public CPUUnitTestContext
+{
+public:
+    BenchmarkContext(const BenchmarkOptions& options) : mOptions(options) {}
+
+    /**
+     * Measure the run time of a function.
+     * The function is run repeatedly: first for a warmup period, then in samples of an adaptively chosen number of iterations.
+     * Code outside of the function (e.g. setting up inputs) is not timed. When benchmarks are not enabled in the run options,
+     * the function is run only once.
+     * @param[in] label Measurement label, used to distinguish multiple measurements in one benchmark.
+     * @param[in] func Function to measure.
+     */
+    template<typename Func>
+    void measure(std::string_view label, Func&& func)
+    {
+        measureBatches(
+            label,
+            [&func](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                    func();
+            }
+        );
+    }
+
+    /**
+     * Measure the run time of a function.
+     * @param[in] func Function to measure.
+     */
+    template<typename Func>
+    void measure(Func&& func)
+    {
+        measure("", std::forward<Func>(func));
+    }
+
+    /**
+     * Prevent the compiler from optimizing away the computation of a value.
+     */
+    template<typename T>
+    static void doNotOptimize(const T& value)
+    {
+#if FALCOR_GCC || FALCOR_CLANG
+        asm volatile("" : : "m"(value) : "memory");
+#else
+        useCharPointer(&reinterpret_cast<const volatile char&>(value));
+#endif
+    }
+
+    const std::vector<BenchmarkResult>& getResults() const { return mResults; }
+
+private:
+    void measureBatches(std::string_view label, const std::function<void(uint64_t)>& runBatch);
+
+    const BenchmarkOptions& mOptions;
+    std::vector<BenchmarkResult> mResults;
+};
+
 class FALCOR_API GPUUnitTestContext : public UnitTestContext
 {
 public:
@@ -350,6 +453,7 @@ void applyArgs(Options& options, Args&&... args)
 
 FALCOR_API void registerCPUTest(std::filesystem::path path, std::string name, unittest::Options options, CPUTestFunc func);
 FALCOR_API void registerGPUTest(std::filesystem::path path, std::string name, unittest::Options options, GPUTestFunc func);
+FALCOR_API void registerBenchmark(std::filesystem::path path, std::string name, unittest::Options options, BenchmarkFunc func);
 
 /**
  * StreamSink is a utility class used by the testing framework that either
@@ -524,6 +628,7 @@ inline std::optional<std::string> createBinaryMessage(std::string_view lhsStr, s
 using UnitTestContext = unittest::UnitTestContext;
 using CPUUnitTestContext = unittest::CPUUnitTestContext;
 using GPUUnitTestContext = unittest::GPUUnitTestContext;
+using BenchmarkContext = unittest::BenchmarkContext;
 
 /**
  * Macro to define a CPU unit test. The optional arguments include:
@@ -600,6 +705,38 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
     } RegisterGPUTest##name;                                                    \
     static void GPUUnitTest##name(GPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/**
+ * Macro to define a CPU benchmark. Takes the same optional arguments as CPU_TEST.
+ * The benchmark body uses ctx.measure() to time code and may use the regular
+ * EXPECT/ASSERT macros to check results:
+ *
+ * CPU_BENCHMARK(Bench1)
+ * {
+ *     std::vector<float> data = createData(); // Not timed
+ *     ctx.measure([&]() { ctx.doNotOptimize(sum(data)); });
+ * }
+ *
+ * Benchmarks run a single iteration unless benchmarking is enabled
+ * (FalcorTest --benchmark), so they also serve as smoke tests.
+ *
+ * Note: All benchmarks are implicitly tagged with "cpu" and "benchmark".
+ */
+#define CPU_BENCHMARK(name, ...)                                                   \
+    static void CPUBenchmark##name(BenchmarkContext& ctx);                         \
+    struct CPUBenchmarkRegisterer##name                                            \
+    {                                                                              \
+        CPUBenchmarkRegisterer##name()                                             \
+        {                                                                          \
+            std::filesystem::path path = __FILE__;                                 \
+            unittest::Options options;                                             \
+            applyArgs(options, ##__VA_ARGS__);                                     \
+            options.tags.insert("cpu");                                            \
+            options.tags.insert("benchmark");                                      \
+            unittest::registerBenchmark(path, #name, options, CPUBenchmark##name); \
+        }                                                                          \
+    } RegisterCPUBenchmark##name;                                                  \
+    static void CPUBenchmark##name(BenchmarkContext& ctx) /* over to the user for the braces */
+
 // clang-format off
 
 /// Used as an argument of CPU_TEST/GPU_TEST to tag a test with a set of strings.
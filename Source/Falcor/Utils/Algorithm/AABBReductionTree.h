@@ -0,0 +1,141 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Assert.h"
+#include "Utils/Math/AABB.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+
+/**
+ * Binary reduction tree over a fixed number of bounding boxes.
+ *
+ * The tree is stored implicitly in an array with the leaves at the bottom level,
+ * padded to a power of two. Each interior node holds the union of its two children,
+ * so the root holds the union of all leaves. Changing a leaf marks it dirty, and
+ * update() only recomputes the interior nodes on the paths from the dirty leaves
+ * to the root, i.e. O(k log n) work for k changed leaves.
+ */
+class AABBReductionTree
+{
+public:
+    AABBReductionTree() { reset(0); }
+    AABBReductionTree(size_t leafCount) { reset(leafCount); }
+
+    /**
+     * Reset the tree to the given number of leaves. All leaves are set to invalid boxes.
+     */
+    void reset(size_t leafCount)
+    {
+        mLeafCount = leafCount;
+        mLeafOffset = 1;
+        while (mLeafOffset < leafCount)
+            mLeafOffset <<= 1;
+        mNodes.assign(2 * mLeafOffset, AABB());
+        mDirtyNodes.clear();
+    }
+
+    /**
+     * Set the bounds of a leaf. The change is not visible in the interior nodes until update() is called.
+     */
+    void setLeaf(size_t leafIndex, const AABB& bounds)
+    {
+        FALCOR_ASSERT(leafIndex < mLeafCount);
+        size_t nodeIndex = mLeafOffset + leafIndex;
+        if (mNodes[nodeIndex] == bounds)
+            return;
+        mNodes[nodeIndex] = bounds;
+        mDirtyNodes.push_back((uint32_t)nodeIndex);
+    }
+
+    /**
+     * Recompute the interior nodes on the paths from all dirty leaves to the root.
+     * @return True if any node changed.
+     */
+    bool update()
+    {
+        if (mDirtyNodes.empty())
+            return false;
+
+        // All leaves are on the same level, so we can walk up one level at a time.
+        // Sorting the dirty nodes lets us drop shared parents with a single compare.
+        std::sort(mDirtyNodes.begin(), mDirtyNodes.end());
+        mDirtyNodes.erase(std::unique(mDirtyNodes.begin(), mDirtyNodes.end()), mDirtyNodes.end());
+
+        while (mDirtyNodes.front() > 1)
+        {
+            size_t parentCount = 0;
+            for (uint32_t nodeIndex : mDirtyNodes)
+            {
+                uint32_t parentIndex = nodeIndex >> 1;
+                if (parentCount > 0 && mDirtyNodes[parentCount - 1] == parentIndex)
+                    continue;
+                mNodes[parentIndex] = mNodes[2 * parentIndex] | mNodes[2 * parentIndex + 1];
+                mDirtyNodes[parentCount++] = parentIndex;
+            }
+            mDirtyNodes.resize(parentCount);
+        }
+
+        mDirtyNodes.clear();
+        return true;
+    }
+
+    /**
+     * Rebuild all interior nodes from the leaves.
+     */
+    void rebuild()
+    {
+        for (size_t i = mLeafOffset - 1; i > 0; --i)
+            mNodes[i] = mNodes[2 * i] | mNodes[2 * i + 1];
+        mDirtyNodes.clear();
+    }
+
+    /// Returns the number of leaves.
+    size_t getLeafCount() const { return mLeafCount; }
+
+    /// Returns the bounds of a leaf.
+    const AABB& getLeaf(size_t leafIndex) const
+    {
+        FALCOR_ASSERT(leafIndex < mLeafCount);
+        return mNodes[mLeafOffset + leafIndex];
+    }
+
+    /// Returns the union of all leaves. Only valid after update() or rebuild().
+    const AABB& getBounds() const { return mNodes[1]; }
+
+private:
+    size_t mLeafCount = 0;              ///< Number of leaves.
+    size_t mLeafOffset = 1;             ///< Index of the first leaf node. This is the leaf count rounded up to a power of two.
+    std::vector<AABB> mNodes;           ///< Tree nodes. Node 1 is the root, the children of node i are 2i and 2i+1.
+    std::vector<uint32_t> mDirtyNodes;  ///< Dirty nodes on the level currently being processed.
+};
+
+} // namespace Falcor
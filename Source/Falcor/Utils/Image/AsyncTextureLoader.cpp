@@ -26,14 +26,58 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "AsyncTextureLoader.h"
+#include "TextureCache.h"
+#include "Core/Assert.h"
 #include "Core/API/Device.h"
 #include "Utils/Threading.h"
 
+#include <algorithm>
+
 namespace Falcor
 {
 namespace
 {
-constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
+/// Number of bytes uploaded before issuing a flush when there is no per-frame upload budget (to keep upload heap from growing).
+constexpr uint64_t kMaxPendingUploadBytes = 256ull << 20;
+}
+
+void AsyncTextureLoader::LoadToken::cancel()
+{
+    mCancelled.store(true, std::memory_order_relaxed);
+
+    std::vector<std::shared_ptr<WakeState>> wakeStates;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto& pWeakState : mWakeStates)
+        {
+            if (auto pWakeState = pWeakState.lock())
+                wakeStates.push_back(std::move(pWakeState));
+        }
+    }
+
+    // Acquire the worker mutex before notifying so that a worker cannot miss the cancellation between checking and waiting.
+    for (const auto& pWakeState : wakeStates)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pWakeState->mutex);
+        }
+        pWakeState->condition.notify_all();
+    }
+}
+
+void AsyncTextureLoader::LoadToken::attach(const std::shared_ptr<WakeState>& pWakeState)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mWakeStates.erase(
+        std::remove_if(mWakeStates.begin(), mWakeStates.end(), [](const auto& pWeakState) { return pWeakState.expired(); }),
+        mWakeStates.end()
+    );
+    for (const auto& pWeakState : mWakeStates)
+    {
+        if (pWeakState.lock() == pWakeState)
+            return;
+    }
+    mWakeStates.push_back(pWakeState);
 }
 
 AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t threadCount) : mpDevice(pDevice)
@@ -45,20 +89,26 @@ AsyncTextureLoader::~AsyncTextureLoader()
 {
     terminateWorkers();
 
-    mpDevice->flushAndSync();
+    if (mpDevice)
+        mpDevice->flushAndSync();
 }
 
 std::future<ref<Texture>> AsyncTextureLoader::loadMippedFromFiles(
     fstd::span<const std::filesystem::path> paths,
     bool loadAsSrgb,
     Resource::BindFlags bindFlags,
-    LoadCallback callback
+    LoadCallback callback,
+    std::shared_ptr<LoadToken> pToken
 )
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, callback});
-    mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    LoadRequest request;
+    request.paths = {paths.begin(), paths.end()};
+    request.generateMipLevels = false;
+    request.loadAsSRGB = loadAsSrgb;
+    request.bindFlags = bindFlags;
+    request.callback = std::move(callback);
+    request.pToken = std::move(pToken);
+    return enqueueRequest(std::move(request));
 }
 
 std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
@@ -66,13 +116,127 @@ std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
     bool generateMipLevels,
     bool loadAsSrgb,
     Resource::BindFlags bindFlags,
-    LoadCallback callback
+    LoadCallback callback,
+    std::shared_ptr<LoadToken> pToken
 )
+{
+    LoadRequest request;
+    request.paths = {path};
+    request.generateMipLevels = generateMipLevels;
+    request.loadAsSRGB = loadAsSrgb;
+    request.bindFlags = bindFlags;
+    request.callback = std::move(callback);
+    request.pToken = std::move(pToken);
+    return enqueueRequest(std::move(request));
+}
+
+void AsyncTextureLoader::setTextureCache(std::shared_ptr<const TextureCache> pTextureCache)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mpTextureCache = std::move(pTextureCache);
+}
+
+void AsyncTextureLoader::setUploadBudget(uint64_t bytesPerFrame)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mUploadBudget = bytesPerFrame;
+    mCondition.notify_all();
+}
+
+uint64_t AsyncTextureLoader::getUploadBudget()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mUploadBudget;
+}
+
+void AsyncTextureLoader::suspendUploadBudget()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBudgetSuspendCount++;
+    mCondition.notify_all();
+}
+
+void AsyncTextureLoader::resumeUploadBudget()
 {
     std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, callback});
+    FALCOR_ASSERT(mBudgetSuspendCount > 0);
+    mBudgetSuspendCount--;
+}
+
+void AsyncTextureLoader::beginFrame()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFrameUploadBytes = 0;
+    mCondition.notify_all();
+}
+
+size_t AsyncTextureLoader::getPendingRequestCount()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLoadRequests.size();
+}
+
+std::future<ref<Texture>> AsyncTextureLoader::enqueueRequest(LoadRequest request)
+{
+    if (request.pToken)
+        request.pToken->attach(mpWakeState);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    request.pTextureCache = mpTextureCache;
+    request.sequence = mNextSequence++;
+    auto future = request.promise.get_future();
+    mLoadRequests.push_back(std::move(request));
     mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    return future;
+}
+
+bool AsyncTextureLoader::hasUploadBudget() const
+{
+    // The budget is ignored when terminating or suspended so that the remaining requests are drained.
+    return mTerminate || mBudgetSuspendCount > 0 || mUploadBudget == 0 || mFrameUploadBytes < mUploadBudget;
+}
+
+bool AsyncTextureLoader::hasCancelledRequests() const
+{
+    return std::any_of(mLoadRequests.begin(), mLoadRequests.end(), [](const LoadRequest& request) { return request.isCancelled(); });
+}
+
+bool AsyncTextureLoader::popRequest(LoadRequest& request, std::vector<LoadRequest>& cancelledRequests, bool takeRequest)
+{
+    // Remove cancelled requests and find the request with the highest priority.
+    // Priorities can change at any time, so the requests are searched linearly instead of being kept in a heap.
+    // This is negligible compared to the cost of loading a texture.
+    size_t bestIndex = 0;
+    float bestPriority = 0.f;
+    bool found = false;
+    for (size_t i = 0; i < mLoadRequests.size();)
+    {
+        if (mLoadRequests[i].isCancelled())
+        {
+            cancelledRequests.push_back(std::move(mLoadRequests[i]));
+            mLoadRequests[i] = std::move(mLoadRequests.back());
+            mLoadRequests.pop_back();
+            continue;
+        }
+
+        float priority = mLoadRequests[i].getPriority();
+        if (!found || priority > bestPriority ||
+            (priority == bestPriority && mLoadRequests[i].sequence < mLoadRequests[bestIndex].sequence))
+        {
+            bestIndex = i;
+            bestPriority = priority;
+            found = true;
+        }
+        ++i;
+    }
+
+    if (!found || !takeRequest)
+        return false;
+
+    request = std::move(mLoadRequests[bestIndex]);
+    mLoadRequests[bestIndex] = std::move(mLoadRequests.back());
+    mLoadRequests.pop_back();
+    return true;
 }
 
 void AsyncTextureLoader::runWorkers(size_t threadCount)
@@ -84,7 +248,7 @@ void AsyncTextureLoader::runWorkers(size_t threadCount)
         {
             mpDevice->flushAndSync();
             mFlushPending = false;
-            mUploadCounter = 0;
+            mPendingUploadBytes = 0;
         }
     );
 
@@ -97,15 +261,18 @@ void AsyncTextureLoader::runWorkers(size_t threadCount)
 void AsyncTextureLoader::runWorker()
 {
     // This function is the entry point for worker threads.
-    // The workers wait on the load request queue and load a texture when woken up.
-    // To avoid the upload heap growing too large, we synchronize the threads and
-    // issue a global GPU flush at regular intervals.
+    // The workers wait on the load requests and load the texture with the highest priority when woken up.
+    // Without an upload budget, we synchronize the threads and issue a global GPU flush whenever a certain
+    // amount of data has been uploaded, to avoid the upload heap growing too large. With an upload budget,
+    // the upload heap is bounded by the budget and its pages are recycled by the regular frame flow.
 
     while (true)
     {
         // Wait on condition until more work is ready.
         std::unique_lock<std::mutex> lock(mMutex);
-        mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty() || mFlushPending; });
+        mCondition.wait(
+            lock, [&]() { return mTerminate || (!mLoadRequests.empty() && hasUploadBudget()) || mFlushPending || hasCancelledRequests(); }
+        );
 
         // Sync thread if a flush is pending.
         if (mFlushPending)
@@ -117,22 +284,41 @@ void AsyncTextureLoader::runWorker()
         }
 
         // Terminate thread unless there is more work to do.
-        if (mTerminate && mLoadRequestQueue.empty() && !mFlushPending)
+        if (mTerminate && mLoadRequests.empty() && !mFlushPending)
             break;
 
-        // Go back waiting if queue is currently empty.
-        if (mLoadRequestQueue.empty())
+        // Go back waiting if there is currently no work or budget. Cancelled requests are completed regardless of the budget.
+        const bool canLoad = !mLoadRequests.empty() && hasUploadBudget();
+        if (!canLoad && !hasCancelledRequests())
             continue;
 
-        // Pop next load request from queue.
-        auto request = std::move(mLoadRequestQueue.front());
-        mLoadRequestQueue.pop();
+        // Pop the next load request.
+        LoadRequest request;
+        std::vector<LoadRequest> cancelledRequests;
+        bool hasRequest = popRequest(request, cancelledRequests, canLoad);
 
         lock.unlock();
 
+        // Complete cancelled requests.
+        for (auto& cancelled : cancelledRequests)
+        {
+            cancelled.promise.set_value(nullptr);
+            if (cancelled.callback)
+                cancelled.callback(nullptr);
+        }
+
+        if (!hasRequest)
+            continue;
+
         // Load the textures (this part is running in parallel).
         ref<Texture> pTexture;
-        if (request.paths.size() == 1)
+        if (request.paths.size() == 1 && request.pTextureCache)
+        {
+            pTexture = request.pTextureCache->loadTexture(
+                mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags
+            );
+        }
+        else if (request.paths.size() == 1)
         {
             pTexture =
                 Texture::createFromFile(mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
@@ -142,6 +328,13 @@ void AsyncTextureLoader::runWorker()
             pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags);
         }
 
+        // Account for the upload before completing the request, so that the budget is up to date once the future is ready.
+        uint64_t uploadBytes = pTexture ? pTexture->getTextureSizeInBytes() : 0;
+        lock.lock();
+        mFrameUploadBytes += uploadBytes;
+        mPendingUploadBytes += uploadBytes;
+        lock.unlock();
+
         request.promise.set_value(pTexture);
 
         if (request.callback)
@@ -151,9 +344,8 @@ void AsyncTextureLoader::runWorker()
 
         lock.lock();
 
-        // Issue a global flush if necessary.
-        // TODO: It would be better to check the size of the upload heap instead.
-        if (!mTerminate && pTexture != nullptr && ++mUploadCounter >= kUploadsPerFlush)
+        // Issue a global flush if necessary. While the budget is suspended, uploads are not bounded by it.
+        if (!mTerminate && (mUploadBudget == 0 || mBudgetSuspendCount > 0) && mPendingUploadBytes >= kMaxPendingUploadBytes)
         {
             mFlushPending = true;
             mCondition.notify_all();
@@ -162,7 +354,6 @@ void AsyncTextureLoader::runWorker()
         mCondition.notify_one();
     }
 }
-
 void AsyncTextureLoader::terminateWorkers()
 {
     {
@@ -30,12 +30,13 @@
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
+#include <atomic>
 #include <condition_variable>
 #include <filesystem>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 #include <fstd/span.h>
@@ -43,15 +44,54 @@
 namespace Falcor
 {
 class Barrier;
+class TextureCache;
 
 /**
  * Utility class to load textures asynchronously using multiple worker threads.
+ *
+ * Pending requests are served in order of priority, and in the order they were issued for equal priority.
+ * An optional per-frame upload budget limits how many bytes are uploaded each frame, which avoids frame time spikes
+ * when streaming textures while rendering.
  */
 class FALCOR_API AsyncTextureLoader
 {
+    struct WakeState;
+
 public:
     using LoadCallback = std::function<void(ref<Texture> pTexture)>;
 
+    /**
+     * Token to control pending load requests.
+     * A token can be shared by multiple requests, for example all textures of an object.
+     * The priority can be updated while requests are pending. Requests with higher priority are loaded first.
+     * Cancelling a token discards its pending requests, their futures return nullptr and their callbacks are called with nullptr.
+     * Requests that are already being loaded complete normally.
+     */
+    class FALCOR_API LoadToken
+    {
+    public:
+        LoadToken(float priority = 0.f) : mPriority(priority) {}
+
+        void setPriority(float priority) { mPriority.store(priority, std::memory_order_relaxed); }
+        float getPriority() const { return mPriority.load(std::memory_order_relaxed); }
+
+        /**
+         * Cancel all pending requests using this token.
+         * Wakes up the workers of the loaders the token was used with, so the requests complete even without upload budget.
+         */
+        void cancel();
+        bool isCancelled() const { return mCancelled.load(std::memory_order_relaxed); }
+
+    private:
+        friend class AsyncTextureLoader;
+        void attach(const std::shared_ptr<WakeState>& pWakeState);
+
+        std::atomic<float> mPriority;
+        std::atomic<bool> mCancelled{false};
+        std::mutex mMutex;                                ///< Mutex protecting mWakeStates.
+        std::vector<std::weak_ptr<WakeState>> mWakeStates; ///< Wake states of the loaders that have requests using this token.
+    };
+
     /**
      * Constructor.
      * @param[in] threadCount Number of worker threads.
@@ -70,13 +110,15 @@ public:
      * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] pToken Token for updating the priority or cancelling the request (optional). Requests without a token have priority 0.
+     * @return A future to a new texture, or nullptr if the texture failed to load or the request was cancelled.
      */
     std::future<ref<Texture>> loadMippedFromFiles(
         fstd::span<const std::filesystem::path> paths,
         bool loadAsSRGB,
         Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
-        LoadCallback callback = {}
+        LoadCallback callback = {},
+        std::shared_ptr<LoadToken> pToken = nullptr
     );
 
     /**
@@ -86,16 +128,61 @@ public:
      * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] pToken Token for updating the priority or cancelling the request (optional). Requests without a token have priority 0.
+     * @return A future to a new texture, or nullptr if the texture failed to load or the request was cancelled.
      */
     std::future<ref<Texture>> loadFromFile(
         const std::filesystem::path& path,
         bool generateMipLevels,
         bool loadAsSRGB,
         Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
-        LoadCallback callback = {}
+        LoadCallback callback = {},
+        std::shared_ptr<LoadToken> pToken = nullptr
     );
 
+    /**
+     * Set the texture cache used for loading textures from single files.
+     * Only affects requests issued after the call.
+     * @param[in] pTextureCache Texture cache, or nullptr to load textures directly.
+     */
+    void setTextureCache(std::shared_ptr<const TextureCache> pTextureCache);
+
+    /**
+     * Set the per-frame upload budget.
+     * Once the bytes uploaded in the current frame reach the budget, workers don't start new loads until beginFrame() is called.
+     * A texture that is already being loaded may exceed the budget. With a budget, upload staging memory is recycled by the
+     * regular frame flow instead of by GPU flushes.
+     * @param[in] bytesPerFrame Upload budget in bytes per frame, or 0 for no limit (default).
+     */
+    void setUploadBudget(uint64_t bytesPerFrame);
+
+    /**
+     * Get the per-frame upload budget in bytes, 0 means no limit.
+     */
+    uint64_t getUploadBudget();
+
+    /**
+     * Suspend the upload budget until resumeUploadBudget() is called.
+     * Used while blocking on loads, as requests held back by the budget would otherwise only start after the next beginFrame().
+     * Calls can be nested.
+     */
+    void suspendUploadBudget();
+
+    /**
+     * Resume the upload budget after suspendUploadBudget().
+     */
+    void resumeUploadBudget();
+
+    /**
+     * Start a new frame for the upload budget. Call once per frame after Device::endFrame().
+     */
+    void beginFrame();
+
+    /**
+     * Get the number of requests that have not started loading yet.
+     */
+    size_t getPendingRequestCount();
+
 private:
     void runWorkers(size_t threadCount);
     void runWorker();
@@ -108,21 +195,45 @@ private:
         bool loadAsSRGB;
         Resource::BindFlags bindFlags;
         LoadCallback callback;
+        std::shared_ptr<const TextureCache> pTextureCache;
+        std::shared_ptr<LoadToken> pToken;
+        uint64_t sequence = 0;
         std::promise<ref<Texture>> promise;
+
+        float getPriority() const { return pToken ? pToken->getPriority() : 0.f; }
+        bool isCancelled() const { return pToken && pToken->isCancelled(); }
+    };
+
+    std::future<ref<Texture>> enqueueRequest(LoadRequest request);
+    bool hasUploadBudget() const;
+    bool hasCancelledRequests() const;
+    bool popRequest(LoadRequest& request, std::vector<LoadRequest>& cancelledRequests, bool takeRequest);
+
+    /// Mutex and condition variable of the workers. Shared with load tokens so that cancelling can wake up the workers.
+    struct WakeState
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
     };
 
     ref<Device> mpDevice;
 
-    std::mutex mMutex;                      ///< Mutex for synchronizing access to shared resources.
-    std::condition_variable mCondition;     ///< Condition variable for workers to wait on.
+    std::shared_ptr<WakeState> mpWakeState = std::make_shared<WakeState>();
+    std::mutex& mMutex = mpWakeState->mutex;                        ///< Mutex for synchronizing access to shared resources.
+    std::condition_variable& mCondition = mpWakeState->condition;   ///< Condition variable for workers to wait on.
     std::shared_ptr<Barrier> mFlushBarrier; ///< Barrier for flushing the GPU to upload textures.
     std::vector<std::thread> mThreads;      ///< Worker threads.
 
     // Internal state. Do not access outside of critical section.
-    std::queue<LoadRequest> mLoadRequestQueue; ///< Texture loading request queue.
+    std::vector<LoadRequest> mLoadRequests;             ///< Pending texture loading requests.
+    std::shared_ptr<const TextureCache> mpTextureCache; ///< Texture cache used for new requests (optional).
+    uint64_t mNextSequence = 0;                         ///< Sequence number of the next request.
 
-    bool mTerminate = false;     ///< Flag to terminate worker threads.
-    bool mFlushPending = false;  ///< Flag to indicate a GPU flush is pending.
-    uint32_t mUploadCounter = 0; ///< Counter to issue a flush every few uploads.
+    bool mTerminate = false;          ///< Flag to terminate worker threads.
+    bool mFlushPending = false;       ///< Flag to indicate a GPU flush is pending.
+    uint64_t mPendingUploadBytes = 0; ///< Bytes uploaded since the last flush.
+    uint64_t mUploadBudget = 0;       ///< Upload budget in bytes per frame, or 0 for no limit.
+    uint64_t mFrameUploadBytes = 0;   ///< Bytes uploaded in the current frame.
+    uint32_t mBudgetSuspendCount = 0; ///< Number of active suspendUploadBudget() calls.
 };
 } // namespace Falcor
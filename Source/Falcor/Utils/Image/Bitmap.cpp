@@ -29,8 +29,10 @@
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Math/Common.h"
 #include "Utils/Math/ScalarMath.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 #include "Utils/StringUtils.h"
 
 #if FALCOR_WINDOWS
@@ -40,9 +42,30 @@
 #include <windows.h>
 #endif
 #include <FreeImage.h>
+#include <ImfChannelList.h>
+#include <ImfCompressor.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfIO.h>
+#include <ImfInputFile.h>
+#include <IexBaseExc.h>
+
+#include <execution>
+#include <mutex>
 
 namespace Falcor
 {
+/// Minimum number of scanlines decoded per task when loading scanline EXR files.
+/// The actual count is rounded up to a multiple of the compression block height (e.g. 256 lines for DWAB).
+static const uint32_t kEXRMinScanlinesPerTask = 32;
+
+template<typename Func>
+static void forEachRow(uint32_t height, Func func)
+{
+    NumericRange<uint32_t> range(0, height);
+    std::for_each(std::execution::par, range.begin(), range.end(), func);
+}
+
 static bool isRGB32fSupported()
 {
     return false; // FIX THIS
@@ -67,17 +90,23 @@ static bool isConvertibleToRGBA32Float(ResourceFormat format)
 static std::vector<float> convertHalfToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
 {
     std::vector<float> newData(width * height * 4u, 0.f);
-    const float16_t* pSrc = reinterpret_cast<const float16_t*>(pData);
-    float* pDst = newData.data();
 
-    for (uint32_t i = 0; i < width * height; ++i)
-    {
-        for (uint32_t c = 0; c < channelCount; ++c)
+    forEachRow(
+        height,
+        [&](uint32_t y)
         {
-            *pDst++ = float(*pSrc++);
+            const float16_t* pSrc = reinterpret_cast<const float16_t*>(pData) + (size_t)y * width * channelCount;
+            float* pDst = newData.data() + (size_t)y * width * 4;
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                for (uint32_t c = 0; c < channelCount; ++c)
+                {
+                    *pDst++ = float(*pSrc++);
+                }
+                pDst += (4 - channelCount);
+            }
         }
-        pDst += (4 - channelCount);
-    }
+    );
 
     return newData;
 }
@@ -90,17 +119,23 @@ template<typename SrcT>
 static std::vector<float> convertIntToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
 {
     std::vector<float> newData(width * height * 4u, 0.f);
-    const SrcT* pSrc = reinterpret_cast<const SrcT*>(pData);
-    float* pDst = newData.data();
 
-    for (uint32_t i = 0; i < width * height; ++i)
-    {
-        for (uint32_t c = 0; c < channelCount; ++c)
+    forEachRow(
+        height,
+        [&](uint32_t y)
         {
-            *pDst++ = float(*pSrc++) / float(std::numeric_limits<SrcT>::max());
+            const SrcT* pSrc = reinterpret_cast<const SrcT*>(pData) + (size_t)y * width * channelCount;
+            float* pDst = newData.data() + (size_t)y * width * 4;
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                for (uint32_t c = 0; c < channelCount; ++c)
+                {
+                    *pDst++ = float(*pSrc++) / float(std::numeric_limits<SrcT>::max());
+                }
+                pDst += (4 - channelCount);
+            }
         }
-        pDst += (4 - channelCount);
-    }
+    );
 
     return newData;
 }
@@ -154,40 +189,132 @@ static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t w
 }
 
 /**
- * Converts 96bpp to 128bpp RGBA without clamping.
- * Note that we can't use FreeImage_ConvertToRGBAF() as it clamps to [0,1].
+ * OpenEXR input stream reading from a memory-mapped file.
+ * Each decoding task uses its own stream since the stream holds the read position.
  */
-static FIBITMAP* convertToRGBAF(FIBITMAP* pDib)
+class MemoryMappedEXRStream : public Imf::IStream
 {
-    const unsigned width = FreeImage_GetWidth(pDib);
-    const unsigned height = FreeImage_GetHeight(pDib);
+public:
+    MemoryMappedEXRStream(const MemoryMappedFile& file, const std::string& name)
+        : Imf::IStream(name.c_str()), mpData(static_cast<const char*>(file.getData())), mSize(file.getSize())
+    {}
 
-    auto pNew = FreeImage_AllocateT(FIT_RGBAF, width, height);
-    FreeImage_CloneMetadata(pNew, pDib);
+    bool isMemoryMapped() const override { return true; }
 
-    const unsigned src_pitch = FreeImage_GetPitch(pDib);
-    const unsigned dst_pitch = FreeImage_GetPitch(pNew);
+    char* readMemoryMapped(int n) override
+    {
+        checkRange(n);
+        char* pData = const_cast<char*>(mpData + mPos);
+        mPos += n;
+        return pData;
+    }
 
-    const BYTE* src_bits = (BYTE*)FreeImage_GetBits(pDib);
-    BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
+    bool read(char c[], int n) override
+    {
+        checkRange(n);
+        std::memcpy(c, mpData + mPos, n);
+        mPos += n;
+        return mPos < mSize;
+    }
 
-    for (unsigned y = 0; y < height; y++)
+    uint64_t tellg() override { return mPos; }
+    void seekg(uint64_t pos) override { mPos = pos; }
+
+private:
+    void checkRange(int n)
+    {
+        if (n < 0 || mPos + n > mSize)
+            throw Iex::InputExc("Unexpected end of file.");
+    }
+
+    const char* mpData;
+    uint64_t mSize;
+    uint64_t mPos = 0;
+};
+
+Bitmap::UniquePtr Bitmap::createFromEXR(const MemoryMappedFile& file, const std::filesystem::path& path, bool isTopDown)
+{
+    const std::string name = path.string();
+    MemoryMappedEXRStream headerStream(file, name);
+    Imf::InputFile headerFile(headerStream, 0);
+    const Imf::Header& header = headerFile.header();
+    const Imf::ChannelList& channels = header.channels();
+    if (!channels.findChannel("R") || !channels.findChannel("G") || !channels.findChannel("B"))
+        return nullptr;
+
+    const Imath::Box2i dataWindow = header.dataWindow();
+    const uint32_t width = dataWindow.max.x - dataWindow.min.x + 1;
+    const uint32_t height = dataWindow.max.y - dataWindow.min.y + 1;
+    UniquePtr pBmp = UniquePtr(new Bitmap(width, height, ResourceFormat::RGBA32Float));
+
+    // Align the tasks to tile rows or compressed scanline blocks so that no tile or block is decoded twice.
+    uint32_t rowsPerTask = 0;
+    if (header.hasTileDescription())
+    {
+        rowsPerTask = header.tileDescription().ySize;
+    }
+    else
     {
-        const FIRGBF* src_pixel = (FIRGBF*)src_bits;
-        FIRGBAF* dst_pixel = (FIRGBAF*)dst_bits;
+        const uint32_t linesPerBlock = (uint32_t)std::max(1, Imf::numLinesInBuffer(header.compression()));
+        rowsPerTask = align_to(linesPerBlock, kEXRMinScanlinesPerTask);
+    }
+    const uint32_t taskCount = div_round_up(height, rowsPerTask);
+    const size_t rowPitch = pBmp->getRowPitch();
+    char* pBase = reinterpret_cast<char*>(pBmp->getData()) - dataWindow.min.x * sizeof(float4) - dataWindow.min.y * rowPitch;
 
-        for (unsigned x = 0; x < width; x++)
+    std::mutex errorMutex;
+    std::exception_ptr pError;
+    forEachRow(
+        taskCount,
+        [&](uint32_t task)
         {
-            // Convert pixels directly, while adding a "dummy" alpha of 1.0
-            dst_pixel[x].red = src_pixel[x].red;
-            dst_pixel[x].green = src_pixel[x].green;
-            dst_pixel[x].blue = src_pixel[x].blue;
-            dst_pixel[x].alpha = 1.0F;
+            try
+            {
+                MemoryMappedEXRStream stream(file, name);
+                Imf::InputFile input(stream, 0);
+
+                Imf::FrameBuffer frameBuffer;
+                const char* kChannels[] = {"R", "G", "B", "A"};
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    // Missing alpha is filled with 1.
+                    frameBuffer.insert(
+                        kChannels[c],
+                        Imf::Slice(Imf::FLOAT, pBase + c * sizeof(float), sizeof(float4), rowPitch, 1, 1, c == 3 ? 1.0 : 0.0)
+                    );
+                }
+                input.setFrameBuffer(frameBuffer);
+
+                int y0 = dataWindow.min.y + int(task * rowsPerTask);
+                int y1 = std::min(dataWindow.max.y, y0 + int(rowsPerTask) - 1);
+                input.readPixels(y0, y1);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!pError)
+                    pError = std::current_exception();
+            }
         }
-        src_bits += src_pitch;
-        dst_bits += dst_pitch;
+    );
+    if (pError)
+        std::rethrow_exception(pError);
+
+    // EXR stores the top row first. Flip in place if the bottom row should come first.
+    if (!isTopDown)
+    {
+        forEachRow(
+            height / 2,
+            [&](uint32_t y)
+            {
+                uint8_t* pTop = pBmp->getData() + y * rowPitch;
+                uint8_t* pBottom = pBmp->getData() + (height - 1 - y) * rowPitch;
+                std::swap_ranges(pTop, pTop + rowPitch, pBottom);
+            }
+        );
     }
-    return pNew;
+
+    return pBmp;
 }
 
 Bitmap::UniqueConstPtr Bitmap::create(uint32_t width, uint32_t height, ResourceFormat format, const uint8_t* pData)
@@ -195,6 +322,32 @@ Bitmap::UniqueConstPtr Bitmap::create(uint32_t width, uint32_t height, ResourceF
     return Bitmap::UniqueConstPtr(new Bitmap(width, height, format, pData));
 }
 
+Bitmap::UniqueConstPtr Bitmap::createFromMappedFile(
+    std::shared_ptr<const MemoryMappedFile> pFile,
+    size_t offset,
+    uint32_t width,
+    uint32_t height,
+    ResourceFormat format
+)
+{
+    checkArgument(pFile && pFile->isOpen(), "'pFile' must be an open memory-mapped file.");
+
+    Bitmap* pBitmap = new Bitmap();
+    pBitmap->mWidth = width;
+    pBitmap->mHeight = height;
+    pBitmap->mRowPitch = getFormatRowPitch(format, width);
+    pBitmap->mSize = pBitmap->mRowPitch * (height / getFormatHeightCompressionRatio(format));
+    pBitmap->mFormat = format;
+    Bitmap::UniqueConstPtr pResult(pBitmap);
+
+    if (offset > pFile->getMappedSize() || pBitmap->mSize > pFile->getMappedSize() - offset)
+        throw RuntimeError("Memory-mapped file is too small for a {}x{} {} image.", width, height, to_string(format));
+
+    pBitmap->mpMappedData = const_cast<uint8_t*>(static_cast<const uint8_t*>(pFile->getData()) + offset);
+    pBitmap->mpMappedFile = std::move(pFile);
+    return pResult;
+}
+
 Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path, bool isTopDown)
 {
     std::filesystem::path fullPath;
@@ -233,6 +386,21 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         genWarning("Can't open image file {}", path);
         return nullptr;
     }
+
+    // Decode RGB(A) EXR files in parallel directly into the destination format.
+    if (fifFormat == FIF_EXR)
+    {
+        try
+        {
+            if (auto pBmp = createFromEXR(file, fullPath, isTopDown))
+                return pBmp;
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to decode EXR file '{}' in parallel, falling back to FreeImage: {}", path, e.what());
+        }
+    }
+
     FIMEMORY* memory = FreeImage_OpenMemory((BYTE*)file.getData(), file.getSize());
     FIBITMAP* pDib = FreeImage_LoadFromMemory(fifFormat, memory);
     FreeImage_CloseMemory(memory);
@@ -299,29 +467,50 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         return nullptr;
     }
 
-    // Convert the image to RGBX image
-    if (bpp == 24)
-    {
-        bpp = 32;
-        auto pNew = FreeImage_ConvertTo32Bits(pDib);
-        FreeImage_Unload(pDib);
-        pDib = pNew;
-    }
-    else if (bpp == 96 && (isRGB32fSupported() == false))
-    {
-        bpp = 128;
-        auto pNew = convertToRGBAF(pDib);
-        FreeImage_Unload(pDib);
-        pDib = pNew;
-    }
-
     // PFM images are loaded y-flipped, fix this by inverting the isTopDown flag.
     if (fifFormat == FIF_PFM)
         isTopDown = !isTopDown;
 
+    // Copy the rows into the bitmap in parallel. RGB images are expanded to RGBX and RGB float images to RGBA float
+    // (without clamping, unlike FreeImage_ConvertToRGBAF) as part of the copy, which avoids an intermediate full-size image.
     UniqueConstPtr pBmp = UniqueConstPtr(new Bitmap(width, height, format));
-    FreeImage_ConvertToRawBits(
-        pBmp->getData(), pDib, pBmp->getRowPitch(), bpp, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown
+    const uint32_t rowPitch = pBmp->getRowPitch();
+    const bool expandRGB = bpp == 24;
+    const bool expandRGBF = bpp == 96 && getFormatBytesPerBlock(format) == 16;
+    forEachRow(
+        height,
+        [&](uint32_t y)
+        {
+            // FreeImage stores the bottom row first.
+            const BYTE* pSrc = FreeImage_GetScanLine(pDib, isTopDown ? height - 1 - y : y);
+            uint8_t* pDst = pBmp->getData() + (size_t)y * rowPitch;
+            if (expandRGB)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    pDst[4 * x + 0] = pSrc[3 * x + 0];
+                    pDst[4 * x + 1] = pSrc[3 * x + 1];
+                    pDst[4 * x + 2] = pSrc[3 * x + 2];
+                    pDst[4 * x + 3] = 0xff;
+                }
+            }
+            else if (expandRGBF)
+            {
+                const FIRGBF* pSrcPixels = reinterpret_cast<const FIRGBF*>(pSrc);
+                float* pDstPixels = reinterpret_cast<float*>(pDst);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    pDstPixels[4 * x + 0] = pSrcPixels[x].red;
+                    pDstPixels[4 * x + 1] = pSrcPixels[x].green;
+                    pDstPixels[4 * x + 2] = pSrcPixels[x].blue;
+                    pDstPixels[4 * x + 3] = 1.f;
+                }
+            }
+            else
+            {
+                std::memcpy(pDst, pSrc, rowPitch);
+            }
+        }
     );
     FreeImage_Unload(pDib);
     return pBmp;
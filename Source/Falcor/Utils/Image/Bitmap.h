@@ -35,6 +35,7 @@
 namespace Falcor
 {
 class Texture;
+class MemoryMappedFile;
 
 /**
  * A class representing a memory bitmap
@@ -75,6 +76,25 @@ public:
      */
     static UniqueConstPtr create(uint32_t width, uint32_t height, ResourceFormat format, const uint8_t* pData);
 
+    /**
+     * Create from a memory-mapped file without copying the data.
+     * The bitmap keeps the file mapped for its lifetime. The mapped data is read-only and must not be written through getData().
+     * Throws an exception if the file is too small to hold the image.
+     * @param[in] pFile Memory-mapped file.
+     * @param[in] offset Offset of the image data in bytes from the start of the file.
+     * @param[in] width Width in pixels.
+     * @param[in] height Height in pixels
+     * @param[in] format Resource format.
+     * @return A new bitmap object.
+     */
+    static UniqueConstPtr createFromMappedFile(
+        std::shared_ptr<const MemoryMappedFile> pFile,
+        size_t offset,
+        uint32_t width,
+        uint32_t height,
+        ResourceFormat format
+    );
+
     /**
      * Create a new object from file.
      * @param[in] path Path to load from. If the file can't be found relative to the current directory, Falcor will search for it in the
@@ -85,6 +105,19 @@ public:
      */
     static UniqueConstPtr createFromFile(const std::filesystem::path& path, bool isTopDown);
 
+    /**
+     * Load an RGB(A) EXR file into an RGBA32Float bitmap. createFromFile() uses this for EXR files and falls back to FreeImage if it fails.
+     * Blocks of scanlines, or rows of tiles for tiled files, are decoded in parallel directly into the bitmap without an
+     * intermediate full-size image. Missing alpha is filled with 1.
+     * Throws an exception if the file can't be decoded.
+     * @param[in] file Memory-mapped EXR file.
+     * @param[in] path Path of the file, used in error messages.
+     * @param[in] isTopDown Control the memory layout of the image. If true, the top-left pixel is the first pixel in the buffer, otherwise
+     * the bottom-left pixel is first.
+     * @return A new bitmap object, or nullptr if the file doesn't have RGB channels.
+     */
+    static UniquePtr createFromEXR(const MemoryMappedFile& file, const std::filesystem::path& path, bool isTopDown);
+
     /**
      * Store a memory buffer to a file.
      * @param[in] path Path to write to.
@@ -115,7 +148,10 @@ public:
     static void saveImageDialog(Texture* pTexture);
 
     /// Get a pointer to the bitmap's data store
-    uint8_t* getData() const { return mpData.get(); }
+    uint8_t* getData() const { return mpMappedFile ? mpMappedData : mpData.get(); }
+
+    /// Check if the bitmap references data in a memory-mapped file instead of owning it.
+    bool isMemoryMapped() const { return mpMappedFile != nullptr; }
 
     /// Get the width of the bitmap
     uint32_t getWidth() const { return mWidth; }
@@ -156,6 +192,8 @@ protected:
     Bitmap(uint32_t width, uint32_t height, ResourceFormat format, const uint8_t* pData);
 
     std::unique_ptr<uint8_t[]> mpData;
+    std::shared_ptr<const MemoryMappedFile> mpMappedFile; ///< Memory-mapped file holding the data (optional).
+    uint8_t* mpMappedData = nullptr;                      ///< Pointer to the data in the memory-mapped file.
     uint32_t mWidth = 0;
     uint32_t mHeight = 0;
     uint32_t mRowPitch = 0;
@@ -30,13 +30,22 @@
 #include "Core/API/CopyContext.h"
 #include "Core/API/NativeFormats.h"
 #include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Math/Common.h"
 #include "Utils/Math/ScalarMath.h"
+#include "Utils/Timing/CpuTimer.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 
 #include <dds_header/DDSHeader.h>
 #include <nvtt/nvtt.h>
 
+#include <atomic>
+#include <cmath>
+#include <execution>
 #include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
 
 namespace Falcor
 {
@@ -54,8 +63,13 @@ struct ImportData
     uint32_t mipLevels;
     bool hasDX10Header = false;
 
-    // Data to be imported
-    std::vector<uint8_t> imageData;
+    // Data to be imported. The image data points directly into the memory-mapped file, which is kept
+    // open for as long as the import data is alive.
+    std::shared_ptr<const MemoryMappedFile> pFile;
+    size_t imageOffset = 0;
+    size_t imageSize = 0;
+
+    const uint8_t* getImageData() const { return static_cast<const uint8_t*>(pFile->getData()) + imageOffset; }
 };
 
 struct ExportData
@@ -101,6 +115,67 @@ ImageIO::CompressionMode convertFormatToMode(ResourceFormat format)
     }
 }
 
+// Number of block rows compressed per task when splitting an image into strips.
+const uint32_t kBlockRowsPerTask = 16;
+
+nvtt::Quality convertQualityToNvttQuality(ImageIO::CompressionQuality quality)
+{
+    switch (quality)
+    {
+    case ImageIO::CompressionQuality::Fastest:
+        return nvtt::Quality::Quality_Fastest;
+    case ImageIO::CompressionQuality::Normal:
+        return nvtt::Quality::Quality_Normal;
+    case ImageIO::CompressionQuality::Production:
+        return nvtt::Quality::Quality_Production;
+    case ImageIO::CompressionQuality::Highest:
+        return nvtt::Quality::Quality_Highest;
+    default:
+        FALCOR_UNREACHABLE();
+        return nvtt::Quality::Quality_Normal;
+    }
+}
+
+// NVTT output handler collecting the compressed data in memory.
+class MemoryOutputHandler : public nvtt::OutputHandler
+{
+public:
+    void beginImage(int size, int width, int height, int depth, int face, int miplevel) override {}
+    bool writeData(const void* data, int size) override
+    {
+        const uint8_t* pBytes = static_cast<const uint8_t*>(data);
+        mData.insert(mData.end(), pBytes, pBytes + size);
+        return true;
+    }
+    void endImage() override {}
+
+    const std::vector<uint8_t>& getData() const { return mData; }
+
+private:
+    std::vector<uint8_t> mData;
+};
+
+// NVTT output handler writing to a file.
+class FileOutputHandler : public nvtt::OutputHandler
+{
+public:
+    FileOutputHandler(const std::filesystem::path& path) : mStream(path, std::ios::binary)
+    {
+        if (!mStream)
+            throw RuntimeError("Failed to open file for writing.");
+    }
+    void beginImage(int size, int width, int height, int depth, int face, int miplevel) override {}
+    bool writeData(const void* data, int size) override
+    {
+        mStream.write(static_cast<const char*>(data), size);
+        return mStream.good();
+    }
+    void endImage() override {}
+
+private:
+    std::ofstream mStream;
+};
+
 // Returns the corresponding NVTT compression format for the provided compression mode.
 nvtt::Format convertModeToNvttFormat(ImageIO::CompressionMode mode)
 {
@@ -329,12 +404,13 @@ void setImage(
         fillAlphaChannel(surface);
 }
 
-// Saves image data to a DDS file using the specified compression mode. Optionally generates mips.
-void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::CompressionMode mode, bool generateMips)
+// Returns the NVTT compression options for exporting the image with the specified compression mode and quality.
+nvtt::CompressionOptions getCompressionOptions(const ExportData& image, ImageIO::CompressionMode mode, ImageIO::CompressionQuality quality)
 {
     nvtt::CompressionOptions compressionOptions;
     nvtt::Format format = convertModeToNvttFormat(mode);
     compressionOptions.setFormat(format);
+    compressionOptions.setQuality(convertQualityToNvttQuality(quality));
     if (format == nvtt::Format::Format_RGBA && !isCompressedFormat(image.format))
     {
         if (getFormatType(image.format) == FormatType::Float)
@@ -355,10 +431,90 @@ void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::Co
     {
         compressionOptions.setPixelType(nvtt::PixelType::PixelType_Float);
     }
+    return compressionOptions;
+}
+
+// Compresses a single surface and writes the result to the output handler.
+// Block compressed 2D surfaces are split into strips of block rows that are compressed concurrently on the CPU.
+// Since BC blocks are encoded independently, concatenating the strips yields the same data as compressing the whole surface.
+// If the context has CUDA acceleration enabled (the default context in exportDDS does when a GPU is available), the surface
+// is compressed in a single call on the GPU instead and the strip path is skipped.
+void compressSurface(
+    const nvtt::Context& context,
+    const nvtt::Surface& surface,
+    uint32_t face,
+    uint32_t mip,
+    const nvtt::CompressionOptions& compressionOptions,
+    nvtt::Format format,
+    const nvtt::OutputOptions& outputOptions,
+    nvtt::OutputHandler& outputHandler,
+    bool splitIntoStrips = true
+)
+{
+    const uint32_t width = (uint32_t)surface.width();
+    const uint32_t height = (uint32_t)surface.height();
+    const uint32_t blockRows = div_round_up(height, 4u);
+    const uint32_t taskCount = div_round_up(blockRows, kBlockRowsPerTask);
+
+    // Uncompressed data, volumes and small images are not worth splitting. The GPU encoder is preferred when available.
+    if (!splitIntoStrips || format == nvtt::Format::Format_RGBA || surface.depth() > 1 || taskCount <= 1 ||
+        context.isCudaAccelerationEnabled())
+    {
+        if (!context.compress(surface, face, mip, compressionOptions, outputOptions))
+        {
+            throw RuntimeError("Failed to compress file.");
+        }
+        return;
+    }
+
+    std::vector<MemoryOutputHandler> strips(taskCount);
+    std::atomic<bool> failed = false;
+    NumericRange<uint32_t> range(0, taskCount);
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](uint32_t task)
+        {
+            // Each task uses its own CPU context, the context is not safe to share between threads.
+            nvtt::Context stripContext(false);
+            nvtt::OutputOptions stripOptions;
+            stripOptions.setOutputHandler(&strips[task]);
+            stripOptions.setOutputHeader(false);
+
+            uint32_t y0 = task * kBlockRowsPerTask * 4;
+            uint32_t y1 = std::min(height, y0 + kBlockRowsPerTask * 4);
+            nvtt::Surface strip = surface.createSubImage(0, (int)width - 1, (int)y0, (int)y1 - 1, 0, 0);
+            if (!stripContext.compress(strip, 0, 0, compressionOptions, stripOptions))
+                failed = true;
+        }
+    );
+
+    if (failed)
+        throw RuntimeError("Failed to compress file.");
+
+    for (const auto& strip : strips)
+    {
+        if (!outputHandler.writeData(strip.getData().data(), (int)strip.getData().size()))
+            throw RuntimeError("Failed to write compressed data.");
+    }
+}
 
+// Saves image data to a DDS file using the specified compression mode. Optionally generates mips.
+void exportDDS(
+    const std::filesystem::path& path,
+    ExportData& image,
+    ImageIO::CompressionMode mode,
+    bool generateMips,
+    ImageIO::CompressionQuality quality
+)
+{
+    nvtt::Format format = convertModeToNvttFormat(mode);
+    nvtt::CompressionOptions compressionOptions = getCompressionOptions(image, mode, quality);
+
+    FileOutputHandler outputHandler(path);
     nvtt::OutputOptions outputOptions;
-    std::string pathStr = path.string();
-    outputOptions.setFileName(pathStr.c_str());
+    outputOptions.setOutputHandler(&outputHandler);
     if (format == nvtt::Format::Format_BC6S || format == nvtt::Format::Format_BC7)
     {
         outputOptions.setContainer(nvtt::Container::Container_DDS10);
@@ -378,10 +534,7 @@ void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::Co
     {
         size_t faceIndex = f * image.mipLevels;
         nvtt::Surface tmp = image.images[faceIndex];
-        if (!context.compress(tmp, f, 0, compressionOptions, outputOptions))
-        {
-            throw RuntimeError("Failed to compress file.");
-        }
+        compressSurface(context, tmp, f, 0, compressionOptions, format, outputOptions, outputHandler);
         for (uint32_t m = 1; m < image.mipLevels; ++m)
         {
             if (generateMips)
@@ -393,14 +546,76 @@ void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::Co
                 tmp = image.images[faceIndex + m];
             }
 
-            if (!context.compress(tmp, f, m, compressionOptions, outputOptions))
-            {
-                throw RuntimeError("Failed to compress file.");
-            }
+            compressSurface(context, tmp, f, m, compressionOptions, format, outputOptions, outputHandler);
         }
     }
 }
 
+// Prepares the export data for saving a bitmap. Updates the compression mode if the bitmap is already compressed.
+ExportData prepareBitmapExport(const std::filesystem::path& path, const Bitmap& bitmap, ImageIO::CompressionMode& mode, bool generateMips)
+{
+    ExportData image;
+    image.type = nvtt::TextureType::TextureType_2D;
+    image.width = bitmap.getWidth();
+    image.height = bitmap.getHeight();
+    image.depth = 1;
+    image.format = bitmap.getFormat();
+    image.faceCount = 1;
+    image.mipLevels = generateMips ? nvtt::countMipmaps(image.width, image.height, image.depth) : 1;
+
+    if (getFormatChannelCount(image.format) == 2 && mode != ImageIO::CompressionMode::BC5)
+    {
+        throw RuntimeError("Only BC5 compression is supported for two channel images.");
+    }
+
+    // The DX spec requires the dimensions of BC encoded textures to be a multiple of 4 at the base resolution.
+    // If the texture has already been rescaled to meet this requirement, skip clamping.
+    if (generateMips && (mode != ImageIO::CompressionMode::None))
+    {
+        bool clamped = clampIfNeeded(image);
+        if (clamped)
+        {
+            logWarning("Saving DDS image to '{}' with clamped image dimensions to accomodate mipmaps and compression.", path);
+        }
+    }
+
+    uint32_t srcWidth = bitmap.getWidth();
+    uint32_t srcHeight = bitmap.getHeight();
+
+    nvtt::Surface surface;
+    FormatType type = getFormatType(image.format);
+    if (type == FormatType::Sint || type == FormatType::Snorm)
+    {
+        setImage<int8_t>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+    }
+    else if (type == FormatType::Uint || type == FormatType::Unorm || type == FormatType::UnormSrgb)
+    {
+        setImage<uint8_t>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+    }
+    else if (type == FormatType::Float)
+    {
+        if (getNumChannelBits(image.format, 0) == 16)
+        {
+            setImage<float16_t>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+        }
+        else if (getNumChannelBits(image.format, 0) == 32)
+        {
+            setImage<float>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+        }
+    }
+
+    image.images.push_back(surface);
+
+    // NVTT's Surface is designed to only hold uncompressed data, which means saving a compressed image as-is
+    // requires the data be re-compressed. The selected compression mode is updated here to reflect this.
+    if (isCompressedFormat(image.format) && mode == ImageIO::CompressionMode::None)
+    {
+        mode = convertFormatToMode(image.format);
+    }
+
+    return image;
+}
+
 // Reads image information from the DDS header data contained in pHeaderData.
 void readDDSHeader(ImportData& data, const void* pHeaderData, size_t& headerSize, bool loadAsSrgb)
 {
@@ -515,7 +730,8 @@ void readDDSHeader(ImportData& data, const void* pHeaderData, size_t& headerSize
 // Loads the information and data for the specified image. This function does not handle creation of the texture for the image.
 void loadDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& data)
 {
-    MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    auto pFile = std::make_shared<MemoryMappedFile>(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    const MemoryMappedFile& file = *pFile;
     if (!file.isOpen())
     {
         throw RuntimeError("Failed to open file.");
@@ -540,10 +756,10 @@ void loadDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& dat
         throw RuntimeError("No image data after DDS header.");
     }
 
-    // Read image data.
-    size_t imageSize = file.getSize() - headerSize;
-    data.imageData.resize(imageSize);
-    std::memcpy(data.imageData.data(), reinterpret_cast<const uint8_t*>(file.getData()) + headerSize, imageSize);
+    // Reference image data in the mapped file. Resources are created straight from the mapped pages.
+    data.pFile = std::move(pFile);
+    data.imageOffset = headerSize;
+    data.imageSize = file.getSize() - headerSize;
 }
 } // namespace
 
@@ -566,8 +782,16 @@ Bitmap::UniqueConstPtr ImageIO::loadBitmapFromDDS(const std::filesystem::path& p
         return nullptr;
     }
 
-    // Create from first image
-    return Bitmap::create(data.width, data.height, data.format, data.imageData.data());
+    // Create from first image, referencing the mapped file.
+    try
+    {
+        return Bitmap::createFromMappedFile(std::move(data.pFile), data.imageOffset, data.width, data.height, data.format);
+    }
+    catch (const RuntimeError& e)
+    {
+        logWarning("Failed to load DDS image from '{}': {}", path, e.what());
+        return nullptr;
+    }
 }
 
 ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb)
@@ -583,22 +807,23 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
         return nullptr;
     }
 
+    // Subresources are uploaded directly from the mapped file. The file is unmapped when 'data' goes out of scope.
     ref<Texture> pTex;
     // TODO: Automatic mip generation
     switch (data.type)
     {
     case Resource::Type::Texture1D:
-        pTex = Texture::create1D(pDevice, data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data());
+        pTex = Texture::create1D(pDevice, data.width, data.format, data.arraySize, data.mipLevels, data.getImageData());
         break;
     case Resource::Type::Texture2D:
-        pTex = Texture::create2D(pDevice, data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data());
+        pTex = Texture::create2D(pDevice, data.width, data.height, data.format, data.arraySize, data.mipLevels, data.getImageData());
         break;
     case Resource::Type::TextureCube:
         pTex =
-            Texture::createCube(pDevice, data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data());
+            Texture::createCube(pDevice, data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.getImageData());
         break;
     case Resource::Type::Texture3D:
-        pTex = Texture::create3D(pDevice, data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data());
+        pTex = Texture::create3D(pDevice, data.width, data.height, data.depth, data.format, data.mipLevels, data.getImageData());
         break;
     default:
         logWarning("Failed to load DDS image from '{}': Unrecognized texture type.", path);
@@ -613,7 +838,13 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
     return pTex;
 }
 
-void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap, CompressionMode mode, bool generateMips)
+void ImageIO::saveToDDS(
+    const std::filesystem::path& path,
+    const Bitmap& bitmap,
+    CompressionMode mode,
+    bool generateMips,
+    CompressionQuality quality
+)
 {
     if (!hasExtension(path, "dds"))
     {
@@ -622,71 +853,166 @@ void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap,
 
     try
     {
-        ExportData image;
-        image.type = nvtt::TextureType::TextureType_2D;
-        image.width = bitmap.getWidth();
-        image.height = bitmap.getHeight();
-        image.depth = 1;
-        image.format = bitmap.getFormat();
-        image.faceCount = 1;
-        image.mipLevels = generateMips ? nvtt::countMipmaps(image.width, image.height, image.depth) : 1;
+        ExportData image = prepareBitmapExport(path, bitmap, mode, generateMips);
+        exportDDS(path, image, mode, generateMips, quality);
+    }
+    catch (const RuntimeError& e)
+    {
+        throw RuntimeError("Failed to save DDS image to '{}': {}", path, e.what());
+    }
+}
 
-        if (getFormatChannelCount(image.format) == 2 && mode != CompressionMode::BC5)
-        {
-            throw RuntimeError("Only BC5 compression is supported for two channel images.");
-        }
+void ImageIO::saveMipChainToDDS(
+    const std::filesystem::path& path,
+    fstd::span<const Bitmap* const> mipChain,
+    CompressionMode mode,
+    CompressionQuality quality
+)
+{
+    if (!hasExtension(path, "dds"))
+    {
+        logWarning("Saving DDS image to '{}' which does not have 'dds' file extension.", path);
+    }
 
-        // The DX spec requires the dimensions of BC encoded textures to be a multiple of 4 at the base resolution.
-        // If the texture has already been rescaled to meet this requirement, skip clamping.
-        if (generateMips && (mode != CompressionMode::None))
+    try
+    {
+        checkArgument(!mipChain.empty() && mipChain[0] != nullptr, "Mip chain must contain a base level.");
+        const Bitmap& base = *mipChain[0];
+        CompressionMode baseMode = mode;
+        ExportData image = prepareBitmapExport(path, base, baseMode, false);
+        image.mipLevels = (uint32_t)mipChain.size();
+
+        for (uint32_t m = 1; m < image.mipLevels; ++m)
         {
-            bool clamped = clampIfNeeded(image);
-            if (clamped)
-            {
-                logWarning("Saving DDS image to '{}' with clamped image dimensions to accomodate mipmaps and compression.", path);
-            }
+            const Bitmap* pLevel = mipChain[m];
+            checkArgument(pLevel != nullptr, "Mip level {} is null.", m);
+            checkArgument(pLevel->getFormat() == base.getFormat(), "Mip level {} has a different format than the base level.", m);
+            checkArgument(
+                pLevel->getWidth() == std::max(1u, base.getWidth() >> m) && pLevel->getHeight() == std::max(1u, base.getHeight() >> m),
+                "Mip level {} has invalid dimensions.", m
+            );
+            CompressionMode levelMode = mode;
+            image.images.push_back(prepareBitmapExport(path, *pLevel, levelMode, false).images[0]);
         }
 
-        uint32_t srcWidth = bitmap.getWidth();
-        uint32_t srcHeight = bitmap.getHeight();
+        exportDDS(path, image, baseMode, false, quality);
+    }
+    catch (const RuntimeError& e)
+    {
+        throw RuntimeError("Failed to save DDS image to '{}': {}", path, e.what());
+    }
+    catch (const ArgumentError& e)
+    {
+        throw RuntimeError("Failed to save DDS image to '{}': {}", path, e.what());
+    }
+}
 
-        nvtt::Surface surface;
-        FormatType type = getFormatType(image.format);
-        if (type == FormatType::Sint || type == FormatType::Snorm)
-        {
-            setImage<int8_t>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
-        }
-        else if (type == FormatType::Uint || type == FormatType::Unorm || type == FormatType::UnormSrgb)
-        {
-            setImage<uint8_t>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
-        }
-        else if (type == FormatType::Float)
+void ImageIO::saveToDDS(fstd::span<const DDSSaveRequest> requests, CompressionQuality quality)
+{
+    std::mutex errorMutex;
+    std::vector<std::string> errors;
+
+    NumericRange<size_t> range(0, requests.size());
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](size_t i)
         {
-            if (getNumChannelBits(image.format, 0) == 16)
+            const DDSSaveRequest& request = requests[i];
+            try
             {
-                setImage<float16_t>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+                checkArgument(request.pBitmap != nullptr, "Bitmap for '{}' is null.", request.path);
+                saveToDDS(request.path, *request.pBitmap, request.mode, request.generateMips, quality);
             }
-            else if (getNumChannelBits(image.format, 0) == 32)
+            catch (const std::exception& e)
             {
-                setImage<float>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+                std::lock_guard<std::mutex> lock(errorMutex);
+                errors.push_back(e.what());
             }
         }
+    );
 
-        image.images.push_back(surface);
+    if (!errors.empty())
+    {
+        std::string msg = fmt::format("Failed to save {} of {} DDS images:", errors.size(), requests.size());
+        for (const auto& error : errors)
+            msg += "\n" + error;
+        throw RuntimeError(msg);
+    }
+}
 
-        // NVTT's Surface is designed to only hold uncompressed data, which means saving a compressed image as-is
-        // requires the data be re-compressed. The selected compression mode is updated here to reflect this.
-        if (isCompressedFormat(image.format) && mode == CompressionMode::None)
-        {
-            mode = convertFormatToMode(image.format);
-        }
+std::vector<uint8_t> ImageIO::compressToMemory(const Bitmap& bitmap, CompressionMode mode, CompressionQuality quality, bool splitIntoStrips)
+{
+    checkArgument(mode != CompressionMode::None, "Compression mode must not be 'None'.");
+    checkArgument(!isCompressedFormat(bitmap.getFormat()), "Bitmap must be uncompressed.");
 
-        exportDDS(path, image, mode, generateMips);
-    }
-    catch (const RuntimeError& e)
+    ExportData image = prepareBitmapExport({}, bitmap, mode, false);
+    nvtt::Format format = convertModeToNvttFormat(mode);
+    nvtt::CompressionOptions compressionOptions = getCompressionOptions(image, mode, quality);
+    MemoryOutputHandler outputHandler;
+    nvtt::OutputOptions outputOptions;
+    outputOptions.setOutputHandler(&outputHandler);
+    outputOptions.setOutputHeader(false);
+
+    // Use the CPU encoder so that the result doesn't depend on CUDA availability.
+    nvtt::Context context(false);
+    compressSurface(context, image.images[0], 0, 0, compressionOptions, format, outputOptions, outputHandler, splitIntoStrips);
+    return outputHandler.getData();
+}
+
+ImageIO::CompressionStats ImageIO::evaluateCompression(const Bitmap& bitmap, CompressionMode mode, CompressionQuality quality)
+{
+    checkArgument(mode != CompressionMode::None, "Compression mode must not be 'None'.");
+    checkArgument(!isCompressedFormat(bitmap.getFormat()), "Bitmap must be uncompressed.");
+
+    ExportData image = prepareBitmapExport({}, bitmap, mode, false);
+    const nvtt::Surface& reference = image.images[0];
+
+    nvtt::Format format = convertModeToNvttFormat(mode);
+    nvtt::CompressionOptions compressionOptions = getCompressionOptions(image, mode, quality);
+    MemoryOutputHandler outputHandler;
+    nvtt::OutputOptions outputOptions;
+    outputOptions.setOutputHandler(&outputHandler);
+    outputOptions.setOutputHeader(false);
+    nvtt::Context context;
+
+    CompressionStats stats;
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    compressSurface(context, reference, 0, 0, compressionOptions, format, outputOptions, outputHandler);
+    stats.encodeTimeInSeconds = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+    double megapixels = double(image.width) * image.height * 1e-6;
+    stats.megapixelsPerSecond = stats.encodeTimeInSeconds > 0.0 ? megapixels / stats.encodeTimeInSeconds : 0.0;
+
+    nvtt::Surface decoded;
+    if (!decoded.setImage3D(format, (int)image.width, (int)image.height, 1, outputHandler.getData().data()))
+        throw RuntimeError("Failed to decode compressed image.");
+
+    // Only compare the channels that are stored by the compression mode.
+    uint32_t channelCount = 4;
+    if (mode == CompressionMode::BC4)
+        channelCount = 1;
+    else if (mode == CompressionMode::BC5)
+        channelCount = 2;
+    else if (mode == CompressionMode::BC1 || mode == CompressionMode::BC6)
+        channelCount = 3;
+
+    const size_t pixelCount = size_t(image.width) * image.height;
+    double squaredError = 0.0;
+    for (uint32_t c = 0; c < channelCount; ++c)
     {
-        throw RuntimeError("Failed to save DDS image to '{}': {}", path, e.what());
+        const float* pRef = reference.channel(c);
+        const float* pDec = decoded.channel(c);
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            double d = double(pRef[i]) - double(pDec[i]);
+            squaredError += d * d;
+        }
     }
+    double mse = squaredError / double(pixelCount * channelCount);
+    stats.psnr = mse > 0.0 ? -10.0 * std::log10(mse) : std::numeric_limits<double>::infinity();
+
+    return stats;
 }
 
 void ImageIO::saveToDDS(
@@ -694,7 +1020,8 @@ void ImageIO::saveToDDS(
     const std::filesystem::path& path,
     const ref<Texture>& pTexture,
     CompressionMode mode,
-    bool generateMips
+    bool generateMips,
+    CompressionQuality quality
 )
 {
     if (!hasExtension(path, "dds"))
@@ -793,7 +1120,7 @@ void ImageIO::saveToDDS(
             mode = convertFormatToMode(image.format);
         }
 
-        exportDDS(path, image, mode, generateMips);
+        exportDDS(path, image, mode, generateMips, quality);
     }
     catch (const RuntimeError& e)
     {
@@ -29,7 +29,9 @@
 #include "Bitmap.h"
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
+#include <fstd/span.h>
 #include <filesystem>
+#include <vector>
 
 namespace Falcor
 {
@@ -72,6 +74,32 @@ public:
         None
     };
 
+    /// Block compression quality presets. Higher quality presets search more encodings per block, trading encode speed for PSNR.
+    enum class CompressionQuality
+    {
+        Fastest,    ///< Fastest encoding, lowest quality.
+        Normal,     ///< Good tradeoff between speed and quality (default).
+        Production, ///< Slow, high quality encoding for final assets.
+        Highest,    ///< Exhaustive search. Very slow.
+    };
+
+    /// Request for saving a bitmap to a DDS file. Used for batch conversion.
+    struct DDSSaveRequest
+    {
+        std::filesystem::path path;                   ///< Path to save to.
+        const Bitmap* pBitmap = nullptr;              ///< Bitmap to save.
+        CompressionMode mode = CompressionMode::None; ///< Block compression mode.
+        bool generateMips = false;                    ///< Generate and save full mipmap chain.
+    };
+
+    /// Result of evaluating a block compression mode and quality preset on an image.
+    struct CompressionStats
+    {
+        double encodeTimeInSeconds = 0.0; ///< Wall-clock time to encode the image.
+        double megapixelsPerSecond = 0.0; ///< Encode throughput.
+        double psnr = 0.0;                ///< Peak signal-to-noise ratio in dB over the channels stored by the mode (peak value 1).
+    };
+
     /**
      * Load a DDS file to a Bitmap. If the file contains an image array and/or mips, only the first image will be loaded.
      * Throws an exception if the DDS file is malformed.
@@ -97,14 +125,67 @@ public:
      * @param[in] bitmap Bitmap object to save.
      * @param[in] mode Block compression mode. By default, will save data as-is and will not decompress if already compressed.
      * @param[in] if true, generate and save full mipmap chain; requires the caller to have initialized COM.
+     * @param[in] quality Block compression quality preset.
      */
     static void saveToDDS(
         const std::filesystem::path& path,
         const Bitmap& bitmap,
         CompressionMode mode = CompressionMode::None,
-        bool generateMips = false
+        bool generateMips = false,
+        CompressionQuality quality = CompressionQuality::Normal
     );
 
+    /**
+     * Saves a precomputed mip chain to a DDS file, for example one generated by MipGenerator.
+     * Throws an exception if the path is invalid, the levels don't form a valid mip chain or the image cannot be saved.
+     * @param[in] path File path to save to.
+     * @param[in] mipChain Mip levels starting with the base level. All levels must have the same format.
+     * @param[in] mode Block compression mode. By default, will save data as-is and will not decompress if already compressed.
+     * @param[in] quality Block compression quality preset.
+     */
+    static void saveMipChainToDDS(
+        const std::filesystem::path& path,
+        fstd::span<const Bitmap* const> mipChain,
+        CompressionMode mode = CompressionMode::None,
+        CompressionQuality quality = CompressionQuality::Normal
+    );
+
+    /**
+     * Saves a batch of bitmaps to DDS files. The images are compressed concurrently on the thread pool.
+     * All requests are processed even if some of them fail. Throws an exception listing the failed requests afterwards.
+     * @param[in] requests List of save requests.
+     * @param[in] quality Block compression quality preset.
+     */
+    static void saveToDDS(fstd::span<const DDSSaveRequest> requests, CompressionQuality quality = CompressionQuality::Normal);
+
+    /**
+     * Block compress the base level of a bitmap in memory on the CPU.
+     * Throws an exception if the bitmap can't be compressed with the given mode.
+     * @param[in] bitmap Uncompressed bitmap.
+     * @param[in] mode Block compression mode.
+     * @param[in] quality Block compression quality preset.
+     * @param[in] splitIntoStrips If true, large images are split into strips that are compressed concurrently.
+     * If false, the image is compressed in a single call.
+     * @return Compressed block data without a file header.
+     */
+    static std::vector<uint8_t> compressToMemory(
+        const Bitmap& bitmap,
+        CompressionMode mode,
+        CompressionQuality quality = CompressionQuality::Normal,
+        bool splitIntoStrips = true
+    );
+
+    /**
+     * Evaluate a block compression mode and quality preset on a bitmap.
+     * The base level is compressed in memory, decompressed again and compared to the input.
+     * Throws an exception if the bitmap can't be compressed with the given mode.
+     * @param[in] bitmap Uncompressed bitmap.
+     * @param[in] mode Block compression mode.
+     * @param[in] quality Block compression quality preset.
+     * @return Encode time, throughput and PSNR.
+     */
+    static CompressionStats evaluateCompression(const Bitmap& bitmap, CompressionMode mode, CompressionQuality quality);
+
     /**
      * Saves a Texture to a DDS file. All mips and array images are saved.
      * Throws an exception if the path is invalid or the image cannot be saved.
@@ -116,13 +197,15 @@ public:
      * @param[in] pBitmap Bitmap object to save.
      * @param[in] mode Block compression mode. By default, will save data as-is and will not decompress if already compressed.
      * @param[in] if true, generate and save full mipmap chain; requires the caller to have initialized COM.
+     * @param[in] quality Block compression quality preset.
      */
     static void saveToDDS(
         CopyContext* pContext,
         const std::filesystem::path& path,
         const ref<Texture>& pTexture,
         CompressionMode mode = CompressionMode::None,
-        bool generateMips = false
+        bool generateMips = false,
+        CompressionQuality quality = CompressionQuality::Normal
     );
 };
 } // namespace Falcor
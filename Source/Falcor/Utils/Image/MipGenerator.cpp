@@ -0,0 +1,460 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MipGenerator.h"
+#include "Core/Errors.h"
+#include "Utils/Math/ScalarTypes.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+enum class Storage
+{
+    Unorm8,
+    Float16,
+    Float32,
+};
+
+struct FormatInfo
+{
+    Storage storage;
+    bool isSrgb;
+};
+
+bool getFormatInfo(ResourceFormat format, FormatInfo& info)
+{
+    switch (format)
+    {
+    case ResourceFormat::RGBA8Unorm:
+    case ResourceFormat::BGRA8Unorm:
+        info = {Storage::Unorm8, false};
+        return true;
+    case ResourceFormat::RGBA8UnormSrgb:
+    case ResourceFormat::BGRA8UnormSrgb:
+        info = {Storage::Unorm8, true};
+        return true;
+    case ResourceFormat::RGBA16Float:
+        info = {Storage::Float16, false};
+        return true;
+    case ResourceFormat::RGBA32Float:
+        info = {Storage::Float32, false};
+        return true;
+    default:
+        return false;
+    }
+}
+
+FormatInfo checkFormat(ResourceFormat format)
+{
+    FormatInfo info;
+    if (!getFormatInfo(format, info))
+        throw ArgumentError("Unsupported format '{}' for CPU mip generation.", to_string(format));
+    return info;
+}
+
+/// Four channel float image. The channel order is the same as in the bitmap, alpha is always the last channel.
+struct FloatImage
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> data;
+
+    FloatImage() = default;
+    FloatImage(uint32_t w, uint32_t h) : width(w), height(h), data((size_t)w * h * 4) {}
+
+    float* getRow(uint32_t y) { return data.data() + (size_t)y * width * 4; }
+    const float* getRow(uint32_t y) const { return data.data() + (size_t)y * width * 4; }
+};
+
+template<typename Func>
+void forEachRow(uint32_t height, Func func)
+{
+    NumericRange<uint32_t> range(0, height);
+    std::for_each(std::execution::par, range.begin(), range.end(), func);
+}
+
+float srgbToLinear(float c)
+{
+    return c <= 0.04045f ? c * (1.f / 12.92f) : std::pow((c + 0.055f) * (1.f / 1.055f), 2.4f);
+}
+
+float linearToSrgb(float c)
+{
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.f / 2.4f) - 0.055f;
+}
+
+const std::array<float, 256>& getSrgbToLinearTable()
+{
+    static const std::array<float, 256> table = []()
+    {
+        std::array<float, 256> t;
+        for (uint32_t i = 0; i < 256; ++i)
+            t[i] = srgbToLinear(i / 255.f);
+        return t;
+    }();
+    return table;
+}
+
+uint8_t floatToUnorm8(float v)
+{
+    return (uint8_t)(std::clamp(v, 0.f, 1.f) * 255.f + 0.5f);
+}
+
+FloatImage decode(const Bitmap& bitmap, const FormatInfo& info)
+{
+    FloatImage image(bitmap.getWidth(), bitmap.getHeight());
+    const auto& srgbTable = getSrgbToLinearTable();
+    const uint32_t width = image.width;
+
+    forEachRow(
+        image.height,
+        [&](uint32_t y)
+        {
+            const uint8_t* pSrc = bitmap.getData() + (size_t)y * bitmap.getRowPitch();
+            float* pDst = image.getRow(y);
+            switch (info.storage)
+            {
+            case Storage::Unorm8:
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    for (uint32_t c = 0; c < 3; ++c)
+                        pDst[4 * x + c] = info.isSrgb ? srgbTable[pSrc[4 * x + c]] : pSrc[4 * x + c] * (1.f / 255.f);
+                    pDst[4 * x + 3] = pSrc[4 * x + 3] * (1.f / 255.f);
+                }
+                break;
+            case Storage::Float16:
+            {
+                const float16_t* pSrc16 = reinterpret_cast<const float16_t*>(pSrc);
+                for (uint32_t i = 0; i < 4 * width; ++i)
+                    pDst[i] = float(pSrc16[i]);
+                break;
+            }
+            case Storage::Float32:
+                std::memcpy(pDst, pSrc, (size_t)width * 4 * sizeof(float));
+                break;
+            }
+        }
+    );
+
+    return image;
+}
+
+Bitmap::UniqueConstPtr encode(const FloatImage& image, ResourceFormat format, const FormatInfo& info, float alphaScale)
+{
+    const uint32_t bytesPerPixel = getFormatBytesPerBlock(format);
+    const uint32_t width = image.width;
+    std::vector<uint8_t> data((size_t)width * image.height * bytesPerPixel);
+
+    forEachRow(
+        image.height,
+        [&](uint32_t y)
+        {
+            const float* pSrc = image.getRow(y);
+            uint8_t* pDst = data.data() + (size_t)y * width * bytesPerPixel;
+            switch (info.storage)
+            {
+            case Storage::Unorm8:
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        float v = std::clamp(pSrc[4 * x + c], 0.f, 1.f);
+                        pDst[4 * x + c] = floatToUnorm8(info.isSrgb ? linearToSrgb(v) : v);
+                    }
+                    pDst[4 * x + 3] = floatToUnorm8(pSrc[4 * x + 3] * alphaScale);
+                }
+                break;
+            case Storage::Float16:
+            {
+                float16_t* pDst16 = reinterpret_cast<float16_t*>(pDst);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    for (uint32_t c = 0; c < 3; ++c)
+                        pDst16[4 * x + c] = float16_t(pSrc[4 * x + c]);
+                    pDst16[4 * x + 3] = float16_t(alphaScale != 1.f ? std::clamp(pSrc[4 * x + 3] * alphaScale, 0.f, 1.f) : pSrc[4 * x + 3]);
+                }
+                break;
+            }
+            case Storage::Float32:
+            {
+                float* pDst32 = reinterpret_cast<float*>(pDst);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    for (uint32_t c = 0; c < 3; ++c)
+                        pDst32[4 * x + c] = pSrc[4 * x + c];
+                    pDst32[4 * x + 3] = alphaScale != 1.f ? std::clamp(pSrc[4 * x + 3] * alphaScale, 0.f, 1.f) : pSrc[4 * x + 3];
+                }
+                break;
+            }
+            }
+        }
+    );
+
+    return Bitmap::create(width, image.height, format, data.data());
+}
+
+/// Filter taps for resampling one axis. Destination texel i reads taps [offsets[i], offsets[i + 1]).
+struct AxisFilter
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> indices;
+    std::vector<float> weights;
+};
+
+double besselI0(double x)
+{
+    // Power series, converges quickly for the small arguments used by the Kaiser window.
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = 0.5 * x;
+    for (uint32_t k = 1; k < 32; ++k)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+double kaiser(double x, double width, double alpha)
+{
+    double t = x / width;
+    if (std::abs(t) >= 1.0)
+        return 0.0;
+    double sinc = x == 0.0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+    return sinc * besselI0(alpha * std::sqrt(1.0 - t * t)) / besselI0(alpha);
+}
+
+AxisFilter createAxisFilter(uint32_t srcSize, uint32_t dstSize, const MipGenerator::Options& options)
+{
+    AxisFilter filter;
+    filter.offsets.reserve(dstSize + 1);
+    const double scale = double(srcSize) / double(dstSize);
+
+    std::vector<std::pair<uint32_t, double>> taps;
+    for (uint32_t i = 0; i < dstSize; ++i)
+    {
+        taps.clear();
+        if (options.filter == MipGenerator::Filter::Box)
+        {
+            // Weight each source texel by its overlap with the destination texel footprint.
+            double lo = i * scale;
+            double hi = (i + 1) * scale;
+            for (int64_t j = (int64_t)std::floor(lo); j < (int64_t)std::ceil(hi); ++j)
+            {
+                double w = std::min(hi, double(j + 1)) - std::max(lo, double(j));
+                if (w > 0.0)
+                    taps.emplace_back((uint32_t)std::clamp<int64_t>(j, 0, srcSize - 1), w);
+            }
+        }
+        else
+        {
+            // Kaiser-windowed sinc evaluated in destination texel units, with clamp-to-edge addressing.
+            double center = (i + 0.5) * scale;
+            double radius = options.kaiserWidth * scale;
+            for (int64_t j = (int64_t)std::floor(center - radius); j <= (int64_t)std::ceil(center + radius); ++j)
+            {
+                double w = kaiser((j + 0.5 - center) / scale, options.kaiserWidth, options.kaiserAlpha);
+                if (w != 0.0)
+                    taps.emplace_back((uint32_t)std::clamp<int64_t>(j, 0, srcSize - 1), w);
+            }
+        }
+
+        double weightSum = 0.0;
+        for (const auto& tap : taps)
+            weightSum += tap.second;
+        FALCOR_ASSERT(weightSum != 0.0);
+
+        filter.offsets.push_back((uint32_t)filter.indices.size());
+        for (const auto& tap : taps)
+        {
+            filter.indices.push_back(tap.first);
+            filter.weights.push_back(float(tap.second / weightSum));
+        }
+    }
+    filter.offsets.push_back((uint32_t)filter.indices.size());
+    return filter;
+}
+
+FloatImage downsample(const FloatImage& src, uint32_t dstWidth, uint32_t dstHeight, const MipGenerator::Options& options)
+{
+    const AxisFilter filterX = createAxisFilter(src.width, dstWidth, options);
+    const AxisFilter filterY = createAxisFilter(src.height, dstHeight, options);
+
+    // Horizontal pass.
+    FloatImage tmp(dstWidth, src.height);
+    forEachRow(
+        src.height,
+        [&](uint32_t y)
+        {
+            const float* pSrc = src.getRow(y);
+            float* pDst = tmp.getRow(y);
+            for (uint32_t x = 0; x < dstWidth; ++x)
+            {
+                float acc[4] = {};
+                for (uint32_t t = filterX.offsets[x]; t < filterX.offsets[x + 1]; ++t)
+                {
+                    const float* p = pSrc + 4 * filterX.indices[t];
+                    const float w = filterX.weights[t];
+                    for (uint32_t c = 0; c < 4; ++c)
+                        acc[c] += w * p[c];
+                }
+                for (uint32_t c = 0; c < 4; ++c)
+                    pDst[4 * x + c] = acc[c];
+            }
+        }
+    );
+
+    // Vertical pass. Accumulates whole rows, which keeps the inner loop contiguous for vectorization.
+    FloatImage dst(dstWidth, dstHeight);
+    const uint32_t rowLength = 4 * dstWidth;
+    forEachRow(
+        dstHeight,
+        [&](uint32_t y)
+        {
+            float* pDst = dst.getRow(y);
+            for (uint32_t t = filterY.offsets[y]; t < filterY.offsets[y + 1]; ++t)
+            {
+                const float* pSrc = tmp.getRow(filterY.indices[t]);
+                const float w = filterY.weights[t];
+                for (uint32_t i = 0; i < rowLength; ++i)
+                    pDst[i] += w * pSrc[i];
+            }
+        }
+    );
+
+    return dst;
+}
+
+float computeCoverage(const FloatImage& image, float alphaCutoff, float alphaScale = 1.f)
+{
+    size_t count = 0;
+    const size_t pixelCount = (size_t)image.width * image.height;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        if (image.data[4 * i + 3] * alphaScale >= alphaCutoff)
+            ++count;
+    }
+    return pixelCount > 0 ? float(double(count) / pixelCount) : 0.f;
+}
+
+/// Computes the alpha scale that makes the fraction of texels passing the alpha test match the target coverage.
+float computeAlphaScale(const FloatImage& image, float alphaCutoff, float targetCoverage)
+{
+    const size_t pixelCount = (size_t)image.width * image.height;
+    const size_t passCount = (size_t)std::llround(double(targetCoverage) * pixelCount);
+    if (passCount == 0 || alphaCutoff <= 0.f)
+        return 1.f;
+
+    // Find the alpha value of the passCount-th largest texel, scaling it to the cutoff makes exactly the texels above it pass.
+    std::vector<float> alpha(pixelCount);
+    for (size_t i = 0; i < pixelCount; ++i)
+        alpha[i] = image.data[4 * i + 3];
+    auto nth = alpha.begin() + (pixelCount - passCount);
+    std::nth_element(alpha.begin(), nth, alpha.end());
+    float threshold = *nth;
+
+    // With ties at the threshold more texels than requested pass. Use the next larger alpha value instead if that is closer to the target.
+    size_t aboveCount = 0;
+    float nextThreshold = std::numeric_limits<float>::infinity();
+    for (auto it = nth + 1; it != alpha.end(); ++it)
+    {
+        if (*it > threshold)
+        {
+            ++aboveCount;
+            nextThreshold = std::min(nextThreshold, *it);
+        }
+    }
+    size_t atOrAboveCount = (size_t)std::count(alpha.begin(), alpha.end(), threshold) + aboveCount;
+    if (aboveCount > 0 && passCount - aboveCount < atOrAboveCount - passCount)
+        threshold = nextThreshold;
+
+    if (threshold <= 0.f)
+        return 1.f;
+    return alphaCutoff / threshold;
+}
+} // namespace
+
+bool MipGenerator::isFormatSupported(ResourceFormat format)
+{
+    FormatInfo info;
+    return getFormatInfo(format, info);
+}
+
+std::vector<Bitmap::UniqueConstPtr> MipGenerator::generateMips(const Bitmap& bitmap, const Options& options)
+{
+    const FormatInfo info = checkFormat(bitmap.getFormat());
+    checkArgument(bitmap.getWidth() > 0 && bitmap.getHeight() > 0, "Bitmap must not be empty.");
+    checkArgument(options.kaiserWidth > 0.f, "Kaiser width must be positive.");
+
+    uint32_t width = bitmap.getWidth();
+    uint32_t height = bitmap.getHeight();
+    uint32_t mipCount = 1;
+    while ((width >> mipCount) > 0 || (height >> mipCount) > 0)
+        ++mipCount;
+    if (options.maxMipLevels > 0)
+        mipCount = std::min(mipCount, options.maxMipLevels);
+
+    std::vector<Bitmap::UniqueConstPtr> mips;
+    if (mipCount <= 1)
+        return mips;
+    mips.reserve(mipCount - 1);
+
+    FloatImage level = decode(bitmap, info);
+    const float targetCoverage = options.preserveAlphaCoverage ? computeCoverage(level, options.alphaCutoff) : 0.f;
+
+    for (uint32_t mip = 1; mip < mipCount; ++mip)
+    {
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+        level = downsample(level, width, height, options);
+
+        float alphaScale = 1.f;
+        if (options.preserveAlphaCoverage)
+            alphaScale = computeAlphaScale(level, options.alphaCutoff, targetCoverage);
+
+        mips.push_back(encode(level, bitmap.getFormat(), info, alphaScale));
+    }
+
+    return mips;
+}
+
+float MipGenerator::computeAlphaCoverage(const Bitmap& bitmap, float alphaCutoff)
+{
+    const FormatInfo info = checkFormat(bitmap.getFormat());
+    return computeCoverage(decode(bitmap, info), alphaCutoff);
+}
+} // namespace Falcor
@@ -0,0 +1,97 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "Core/Macros.h"
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU mip chain generation for bitmaps.
+ *
+ * This complements the GPU blit in Texture::generateMips() for offline conversion, CPU-side texture analysis and headless runs.
+ * Each level is computed from the previous level, which is kept at float precision internally to avoid accumulating
+ * quantization errors. sRGB formats are filtered in linear space. The filters are separable and each pass runs row-parallel.
+ *
+ * Supported formats are RGBA8Unorm, RGBA8UnormSrgb, BGRA8Unorm, BGRA8UnormSrgb, RGBA16Float and RGBA32Float.
+ */
+class FALCOR_API MipGenerator
+{
+public:
+    enum class Filter
+    {
+        Box,    ///< Box filter. Exact 2x2 average for even dimensions.
+        Kaiser, ///< Kaiser-windowed sinc. Sharper, with less aliasing than the box filter.
+    };
+
+    struct Options
+    {
+        Filter filter = Filter::Box;
+
+        /// Maximum number of mip levels to generate, including the base level. Zero generates the full chain down to 1x1.
+        uint32_t maxMipLevels = 0;
+
+        /// Scale the alpha channel of each level so the fraction of texels passing the alpha test matches the base level.
+        /// This keeps alpha-tested geometry such as foliage from thinning out in lower mips.
+        bool preserveAlphaCoverage = false;
+
+        /// Alpha test cutoff used for alpha coverage preservation.
+        float alphaCutoff = 0.5f;
+
+        /// Kaiser filter radius in destination texels.
+        float kaiserWidth = 3.f;
+
+        /// Kaiser window shape parameter. Larger values give a smoother window.
+        float kaiserAlpha = 4.f;
+    };
+
+    /**
+     * Check if a format is supported for mip generation.
+     */
+    static bool isFormatSupported(ResourceFormat format);
+
+    /**
+     * Generate a mip chain for a bitmap.
+     * Throws an exception if the bitmap format is not supported.
+     * @param[in] bitmap Base level.
+     * @param[in] options Mip generation options.
+     * @return List of bitmaps for mip levels 1 and higher, in the format of the base level. The base level is not included.
+     */
+    static std::vector<Bitmap::UniqueConstPtr> generateMips(const Bitmap& bitmap, const Options& options);
+
+    /**
+     * Compute the fraction of texels with alpha greater or equal to a cutoff.
+     * Throws an exception if the bitmap format is not supported.
+     * @param[in] bitmap Bitmap.
+     * @param[in] alphaCutoff Alpha test cutoff.
+     * @return Alpha coverage in [0,1].
+     */
+    static float computeAlphaCoverage(const Bitmap& bitmap, float alphaCutoff);
+};
+} // namespace Falcor
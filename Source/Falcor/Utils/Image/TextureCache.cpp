@@ -0,0 +1,244 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TextureCache.h"
+#include "Core/API/Texture.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include <atomic>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const std::string kDirectory = "NVIDIA/Falcor/TextureCache";
+
+// Bump this version whenever the baked texture content changes (e.g. different compression settings).
+const uint32_t kVersion = 1;
+
+const bool kTopDown = true; // Matches the setting used in Texture::createFromFile().
+
+bool isOpaque(const Bitmap& bitmap)
+{
+    // Rows may be padded, so step by the row pitch.
+    for (uint32_t y = 0; y < bitmap.getHeight(); ++y)
+    {
+        const uint8_t* pRow = bitmap.getData() + (size_t)y * bitmap.getRowPitch();
+        for (uint32_t x = 0; x < bitmap.getWidth(); ++x)
+        {
+            if (pRow[x * 4 + 3] != 0xff)
+                return false;
+        }
+    }
+    return true;
+}
+
+/// Returns a suffix for temporary file names that is unique across the threads and processes sharing the cache.
+std::string getUniqueTempSuffix()
+{
+    static const uint64_t processNonce = []()
+    {
+        std::random_device rd;
+        return (uint64_t(rd()) << 32) | rd();
+    }();
+    static std::atomic<uint64_t> counter{0};
+    return fmt::format("{:016x}.{}", processNonce, counter.fetch_add(1));
+}
+
+ref<Texture> createTextureFromBitmap(
+    ref<Device> pDevice,
+    const Bitmap& bitmap,
+    bool generateMipLevels,
+    bool loadAsSrgb,
+    Resource::BindFlags bindFlags
+)
+{
+    ResourceFormat texFormat = bitmap.getFormat();
+    if (loadAsSrgb)
+        texFormat = linearToSrgbFormat(texFormat);
+
+    return Texture::create2D(
+        pDevice, bitmap.getWidth(), bitmap.getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, bitmap.getData(),
+        bindFlags
+    );
+}
+} // namespace
+
+TextureCache::TextureCache(std::filesystem::path directory) : mDirectory(std::move(directory)) {}
+
+std::filesystem::path TextureCache::getDefaultDirectory()
+{
+    return getAppDataDirectory() / kDirectory;
+}
+
+std::optional<TextureCache::Key> TextureCache::computeKey(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb)
+{
+    MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    if (!file.isOpen())
+        return {};
+
+    SHA1 sha1;
+    sha1.update(kVersion);
+    sha1.update(generateMipLevels);
+    sha1.update(loadAsSrgb);
+    sha1.update(file.getData(), file.getSize());
+    return sha1.finalize();
+}
+
+ImageIO::CompressionMode TextureCache::selectCompressionMode(const Bitmap& bitmap, bool loadAsSrgb)
+{
+    // The DX spec requires the dimensions of BC encoded textures to be a multiple of 4 at the base resolution.
+    // ImageIO would crop other sizes, so we don't bake them.
+    if (bitmap.getWidth() % 4 != 0 || bitmap.getHeight() % 4 != 0)
+        return ImageIO::CompressionMode::None;
+
+    switch (bitmap.getFormat())
+    {
+    case ResourceFormat::R8Unorm:
+        return ImageIO::CompressionMode::BC4;
+    case ResourceFormat::RG8Unorm:
+        return ImageIO::CompressionMode::BC5;
+    case ResourceFormat::BGRX8Unorm:
+        return loadAsSrgb ? ImageIO::CompressionMode::BC1 : ImageIO::CompressionMode::BC7;
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::RGBA8Unorm:
+        if (isOpaque(bitmap))
+            return loadAsSrgb ? ImageIO::CompressionMode::BC1 : ImageIO::CompressionMode::BC7;
+        return ImageIO::CompressionMode::BC7;
+    default:
+        // HDR and 16-bit images are not baked.
+        return ImageIO::CompressionMode::None;
+    }
+}
+
+std::filesystem::path TextureCache::getCachePath(const Key& key) const
+{
+    return mDirectory / (SHA1::toString(key) + ".dds");
+}
+
+std::filesystem::path TextureCache::bakeTexture(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb) const
+{
+    auto key = computeKey(path, generateMipLevels, loadAsSrgb);
+    if (!key)
+        return {};
+
+    std::filesystem::path cachePath = getCachePath(*key);
+    if (std::filesystem::exists(cachePath))
+        return cachePath;
+
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown);
+    if (!pBitmap)
+        return {};
+
+    ImageIO::CompressionMode mode = selectCompressionMode(*pBitmap, loadAsSrgb);
+    if (mode == ImageIO::CompressionMode::None || !writeBakedTexture(*pBitmap, mode, generateMipLevels, *key))
+        return {};
+
+    return cachePath;
+}
+
+ref<Texture> TextureCache::loadTexture(
+    ref<Device> pDevice,
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    bool loadAsSrgb,
+    Resource::BindFlags bindFlags
+) const
+{
+    // Block-compressed textures can only be bound as shader resources. DDS files are already in a GPU format.
+    if (bindFlags != Resource::BindFlags::ShaderResource || hasExtension(path, "dds"))
+        return Texture::createFromFile(pDevice, path, generateMipLevels, loadAsSrgb, bindFlags);
+
+    auto key = computeKey(path, generateMipLevels, loadAsSrgb);
+    if (!key)
+        return Texture::createFromFile(pDevice, path, generateMipLevels, loadAsSrgb, bindFlags);
+
+    std::filesystem::path cachePath = getCachePath(*key);
+    if (!std::filesystem::exists(cachePath))
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown);
+        if (!pBitmap)
+        {
+            logWarning("Error when loading image file '{}'.", path);
+            return nullptr;
+        }
+
+        // Use the decoded image directly if it can't be baked.
+        ImageIO::CompressionMode mode = selectCompressionMode(*pBitmap, loadAsSrgb);
+        if (mode == ImageIO::CompressionMode::None || !writeBakedTexture(*pBitmap, mode, generateMipLevels, *key))
+        {
+            ref<Texture> pTexture = createTextureFromBitmap(pDevice, *pBitmap, generateMipLevels, loadAsSrgb, bindFlags);
+            if (pTexture)
+                pTexture->setSourcePath(path);
+            return pTexture;
+        }
+    }
+
+    ref<Texture> pTexture = ImageIO::loadTextureFromDDS(pDevice, cachePath, loadAsSrgb);
+    if (!pTexture)
+    {
+        logWarning("Failed to load baked texture '{}', loading '{}' instead.", cachePath, path);
+        return Texture::createFromFile(pDevice, path, generateMipLevels, loadAsSrgb, bindFlags);
+    }
+
+    // Report the original file as the source so the texture can be re-created without the cache.
+    pTexture->setSourcePath(path);
+    logDebug(
+        "Loaded texture from cache: size={}x{} mips={} format={} path={}", pTexture->getWidth(), pTexture->getHeight(),
+        pTexture->getMipCount(), to_string(pTexture->getFormat()), path
+    );
+
+    return pTexture;
+}
+
+bool TextureCache::writeBakedTexture(const Bitmap& bitmap, ImageIO::CompressionMode mode, bool generateMipLevels, const Key& key) const
+{
+    // Textures are baked from multiple threads and multiple processes may share the cache.
+    // Write to a unique temporary file first and move it into place when complete.
+    const std::filesystem::path cachePath = getCachePath(key);
+    const std::filesystem::path tempPath = mDirectory / fmt::format("{}.{}.tmp.dds", SHA1::toString(key), getUniqueTempSuffix());
+
+    try
+    {
+        std::filesystem::create_directories(mDirectory);
+        ImageIO::saveToDDS(tempPath, bitmap, mode, generateMipLevels);
+        std::filesystem::rename(tempPath, cachePath);
+        logDebug("Baked texture cache file '{}'.", cachePath);
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Failed to write texture cache file '{}': {}", cachePath, e.what());
+        std::error_code ec;
+        std::filesystem::remove(tempPath, ec);
+        return std::filesystem::exists(cachePath, ec);
+    }
+
+    return true;
+}
+} // namespace Falcor
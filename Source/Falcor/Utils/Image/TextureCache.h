@@ -0,0 +1,131 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "ImageIO.h"
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+#include "Core/API/Resource.h"
+#include "Utils/CryptoUtils.h"
+#include <filesystem>
+#include <optional>
+
+namespace Falcor
+{
+/**
+ * Persistent cache of block-compressed textures.
+ *
+ * On first load, a texture is decoded, converted to a block-compressed DDS file with
+ * a prebuilt mip chain and stored in the cache directory. Subsequent loads read the DDS
+ * file directly, skipping image decoding and GPU mip generation. Cache entries are keyed
+ * by the content hash of the source file and the load settings, so edited textures are
+ * baked again automatically.
+ *
+ * Only 8-bit LDR textures with dimensions that are a multiple of 4 are baked. All other
+ * textures are loaded as usual.
+ */
+class FALCOR_API TextureCache
+{
+public:
+    using Key = SHA1::MD;
+
+    /**
+     * Constructor.
+     * @param[in] directory Directory to store baked textures in.
+     */
+    explicit TextureCache(std::filesystem::path directory = getDefaultDirectory());
+
+    /**
+     * Get the default cache directory (next to the scene cache in the app data directory).
+     */
+    static std::filesystem::path getDefaultDirectory();
+
+    /**
+     * Get the cache directory.
+     */
+    const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+    /**
+     * Compute the cache key for a texture.
+     * @param[in] path Full path of the source texture.
+     * @param[in] generateMipLevels Whether the full mip-chain is generated.
+     * @param[in] loadAsSrgb Whether the texture is loaded as sRGB.
+     * @return Returns the cache key, or an empty optional if the file can't be read.
+     */
+    static std::optional<Key> computeKey(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb);
+
+    /**
+     * Select the block compression mode for a bitmap based on its channel usage, alpha and color space.
+     * Single and two channel images use BC4 and BC5. Color images with alpha use BC7. Opaque color images
+     * use BC1 when loaded as sRGB (albedo-like data) and BC7 otherwise (normal maps and other linear data).
+     * @param[in] bitmap Bitmap to compress.
+     * @param[in] loadAsSrgb Whether the texture is loaded as sRGB.
+     * @return Returns the compression mode, or CompressionMode::None if the bitmap can't be baked.
+     */
+    static ImageIO::CompressionMode selectCompressionMode(const Bitmap& bitmap, bool loadAsSrgb);
+
+    /**
+     * Get the path of the baked texture in the cache.
+     * @param[in] key Cache key.
+     * @return Returns the path of the DDS file (which may not exist).
+     */
+    std::filesystem::path getCachePath(const Key& key) const;
+
+    /**
+     * Bake a texture into the cache if it's not cached yet.
+     * @param[in] path Full path of the source texture.
+     * @param[in] generateMipLevels Whether the full mip-chain should be generated.
+     * @param[in] loadAsSrgb Whether the texture is loaded as sRGB.
+     * @return Returns the path of the baked DDS file, or an empty path if the texture can't be baked.
+     */
+    std::filesystem::path bakeTexture(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb) const;
+
+    /**
+     * Load a texture through the cache. This is a drop-in replacement for Texture::createFromFile().
+     * Textures that can't be baked are loaded from the source file.
+     * @param[in] pDevice GPU device.
+     * @param[in] path Full path of the source texture.
+     * @param[in] generateMipLevels Whether the full mip-chain should be generated.
+     * @param[in] loadAsSrgb Load the texture as sRGB format if supported, otherwise linear color.
+     * @param[in] bindFlags The bind flags for the texture resource.
+     * @return Returns the texture, or nullptr if loading failed.
+     */
+    ref<Texture> loadTexture(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        bool loadAsSrgb,
+        Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource
+    ) const;
+
+private:
+    bool writeBakedTexture(const Bitmap& bitmap, ImageIO::CompressionMode mode, bool generateMipLevels, const Key& key) const;
+
+    std::filesystem::path mDirectory;
+};
+} // namespace Falcor
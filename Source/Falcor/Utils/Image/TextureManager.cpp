@@ -26,14 +26,23 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureManager.h"
+#include "TextureCache.h"
 #include "Core/API/Device.h"
+#include "Core/API/RenderContext.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
 #include "Utils/NumericRange.h"
+#include "Utils/Math/Common.h"
 
+#include <algorithm>
+#include <cstring>
 #include <execution>
+#include <set>
 
 // Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
 // Until then `TextureManager` should only called from the main thread.
+// Scene textures are then loaded on the main thread, so the priorities, cancellation and upload budget of
+// AsyncTextureLoader are not used by them. Reloads of evicted textures apply the upload budget in loadPendingReloads().
 #define DISABLE_ASYNC_TEXTURE_LOADER
 
 namespace Falcor
@@ -42,6 +51,140 @@ namespace
 {
 const size_t kMaxTextureHandleCount = std::numeric_limits<uint32_t>::max();
 static_assert(TextureManager::TextureHandle::kInvalidID >= kMaxTextureHandleCount);
+
+/// Loader priority of reloads of evicted textures. These are in use, so they are loaded before regular requests.
+const float kReloadPriority = 1.f;
+
+/// Block size in bytes for hashing files in parallel. Large files are split into blocks hashed by separate tasks.
+const size_t kContentHashBlockSize = 16ull << 20;
+
+/**
+ * Suspends the upload budget of an async texture loader for the lifetime of the object.
+ */
+class UploadBudgetSuspension
+{
+public:
+    UploadBudgetSuspension(AsyncTextureLoader& loader) : mLoader(loader) { mLoader.suspendUploadBudget(); }
+    ~UploadBudgetSuspension() { mLoader.resumeUploadBudget(); }
+
+private:
+    AsyncTextureLoader& mLoader;
+};
+
+/**
+ * 64-bit xxHash (XXH64) of a block of memory.
+ */
+uint64_t xxHash64(const void* data, size_t size, uint64_t seed)
+{
+    constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+    auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+    auto read64 = [](const uint8_t* p)
+    {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    };
+    auto read32 = [](const uint8_t* p)
+    {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    };
+    auto round = [&](uint64_t acc, uint64_t input) { return rotl(acc + input * kPrime2, 31) * kPrime1; };
+    auto mergeRound = [&](uint64_t acc, uint64_t val) { return (acc ^ round(0, val)) * kPrime1 + kPrime4; };
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t h;
+
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        for (; p + 32 <= end; p += 32)
+        {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+        }
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + kPrime5;
+    }
+
+    h += size;
+
+    for (; p + 8 <= end; p += 8)
+        h = rotl(h ^ round(0, read64(p)), 27) * kPrime1 + kPrime4;
+    if (p + 4 <= end)
+    {
+        h = rotl(h ^ (read32(p) * kPrime1), 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; p++)
+        h = rotl(h ^ (*p * kPrime5), 11) * kPrime1;
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * Hash the contents of a list of files.
+ * Each file is split into blocks that are hashed in parallel, and the block hashes are combined in order.
+ * @param[in] paths File paths.
+ * @param[out] hash Combined hash.
+ * @param[out] size Total size of the files in bytes.
+ * @return True if successful, false if a file can't be read.
+ */
+bool hashFileContents(const std::vector<std::filesystem::path>& paths, uint64_t& hash, uint64_t& size)
+{
+    hash = 0;
+    size = 0;
+    for (const auto& path : paths)
+    {
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen())
+            return false;
+
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(file.getData());
+        const size_t fileSize = file.getSize();
+        const size_t blockCount = std::max<size_t>(1, div_round_up(fileSize, kContentHashBlockSize));
+
+        std::vector<uint64_t> blockHashes(blockCount);
+        NumericRange<size_t> blockRange(0, blockCount);
+        std::for_each(
+            std::execution::par, blockRange.begin(), blockRange.end(),
+            [&](size_t i)
+            {
+                size_t offset = i * kContentHashBlockSize;
+                size_t blockSize = std::min(kContentHashBlockSize, fileSize - offset);
+                blockHashes[i] = xxHash64(pData + offset, blockSize, 0);
+            }
+        );
+
+        hash = xxHash64(blockHashes.data(), blockHashes.size() * sizeof(uint64_t), hash);
+        size += fileSize;
+    }
+    return true;
+}
 } // namespace
 
 TextureManager::TextureManager(ref<Device> pDevice, size_t maxTextureCount, size_t threadCount)
@@ -305,7 +448,7 @@ TextureManager::TextureHandle TextureManager::loadTexture(
         }
         else
         {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags);
+            pTexture = createTextureFromFile(paths[0], generateMipLevels, loadAsSRGB, bindFlags);
         }
 
         // Add new texture desc.
@@ -333,11 +476,84 @@ TextureManager::TextureHandle TextureManager::loadTexture(
     return handle;
 }
 
+void TextureManager::setUseTextureCache(bool enabled)
+{
+    if (enabled == getUseTextureCache())
+        return;
+
+    mpTextureCache = enabled ? std::make_shared<TextureCache>() : nullptr;
+    mAsyncTextureLoader.setTextureCache(mpTextureCache);
+}
+
+void TextureManager::setMemoryBudget(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMemoryBudget = bytes;
+}
+
+uint64_t TextureManager::getMemoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMemoryBudget;
+}
+
+void TextureManager::setResidentMipTailSize(uint32_t size)
+{
+    checkArgument(size > 0, "'size' must be greater than zero.");
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mResidentMipTailSize = size;
+}
+
+void TextureManager::markTextureUsed(const TextureHandle& handle)
+{
+    if (!handle)
+        return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (handle.isUdim())
+    {
+        size_t rangeStart = handle.getID();
+        for (size_t i = rangeStart; i < rangeStart + mUdimIndirectionSize[rangeStart]; ++i)
+        {
+            if (mUdimIndirection[i] >= 0)
+                markTextureUsedInternal(TextureHandle(mUdimIndirection[i]));
+        }
+    }
+    else
+    {
+        markTextureUsedInternal(handle);
+    }
+}
+
+void TextureManager::markTextureUsed(const Texture* pTexture)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (auto it = mTextureToHandle.find(pTexture); it != mTextureToHandle.end())
+        markTextureUsedInternal(it->second);
+}
+
+std::vector<TextureManager::TextureSwap> TextureManager::beginFrame()
+{
+    mAsyncTextureLoader.beginFrame();
+
+    std::vector<TextureSwap> swaps;
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFrameIndex++;
+    loadPendingReloads(true);
+    installReloadedTextures(swaps);
+    evictTextures(swaps);
+    return swaps;
+}
+
 void TextureManager::waitForTextureLoading(const TextureHandle& handle)
 {
     if (!handle)
         return;
 
+    // Requests held back by the upload budget would only start at the next beginFrame(), so suspend it while waiting.
+    UploadBudgetSuspension suspension(mAsyncTextureLoader);
+
     // Acquire mutex and wait for texture state to change.
     std::unique_lock<std::mutex> lock(mMutex);
     mCondition.wait(lock, [&]() { return getDesc(handle).state == TextureState::Loaded; });
@@ -347,6 +563,8 @@ void TextureManager::waitForTextureLoading(const TextureHandle& handle)
 
 void TextureManager::waitForAllTexturesLoading()
 {
+    UploadBudgetSuspension suspension(mAsyncTextureLoader);
+
     // Acquire mutex and wait for all in-progress requests to finish.
     std::unique_lock<std::mutex> lock(mMutex);
     mCondition.wait(lock, [&]() { return mLoadRequestsInProgress == 0; });
@@ -354,6 +572,30 @@ void TextureManager::waitForAllTexturesLoading()
     mpDevice->flushAndSync();
 }
 
+void TextureManager::waitForPendingReloads()
+{
+#ifndef DISABLE_ASYNC_TEXTURE_LOADER
+    UploadBudgetSuspension suspension(mAsyncTextureLoader);
+
+    // Acquire mutex and wait for all reload requests to finish.
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(
+        lock,
+        [&]()
+        {
+            return std::none_of(
+                mResidency.begin(),
+                mResidency.end(),
+                [](const ResidencyInfo& residency) { return residency.pReloadToken && !residency.reloadFinished; }
+            );
+        }
+    );
+#else
+    std::lock_guard<std::mutex> lock(mMutex);
+    loadPendingReloads(false);
+#endif
+}
+
 void TextureManager::beginDeferredLoading()
 {
     mUseDeferredLoading = true;
@@ -381,20 +623,60 @@ void TextureManager::endDeferredLoading()
     if (jobs.empty())
         return;
 
+    // Find textures with identical contents by hashing their source files in parallel.
+    // Only the first texture of each group of identical textures is loaded, the others share its texture.
+    std::vector<TextureHandle> sharedHandles(jobs.size());
+    if (mUseContentHashing)
+    {
+        struct ContentHash
+        {
+            uint64_t hash = 0;
+            uint64_t size = 0;
+            bool valid = false;
+        };
+
+        std::vector<ContentHash> hashes(jobs.size());
+        NumericRange<size_t> hashRange(0, jobs.size());
+        std::for_each(
+            std::execution::par, hashRange.begin(), hashRange.end(),
+            [&](size_t i) { hashes[i].valid = hashFileContents(jobs[i].key.fullPaths, hashes[i].hash, hashes[i].size); }
+        );
+
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            if (!hashes[i].valid)
+                continue;
+
+            const auto& key = jobs[i].key;
+            const ContentKey contentKey{hashes[i].hash, hashes[i].size, key.generateMipLevels, key.loadAsSRGB, key.bindFlags};
+            auto [it, inserted] = mContentToHandle.try_emplace(contentKey, jobs[i].handle);
+
+            // Don't share textures that are currently evicted to their mip tail.
+            if (!inserted && !getResidency(it->second).isEvicted)
+                sharedHandles[i] = it->second;
+        }
+    }
+
+    std::vector<size_t> loadJobs;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (!sharedHandles[i])
+            loadJobs.push_back(i);
+    }
+
     // Load textures in parallel.
     std::atomic<size_t> texturesLoaded;
-    NumericRange<size_t> jobRange(0, jobs.size());
+    NumericRange<size_t> jobRange(0, loadJobs.size());
     std::for_each(
         std::execution::par_unseq, jobRange.begin(), jobRange.end(),
         [&](size_t i)
         {
-            const auto& job = jobs[i];
+            const auto& job = jobs[loadJobs[i]];
             auto& desc = getDesc(job.handle);
             if (job.key.fullPaths.size() == 1)
             {
-                desc.pTexture = Texture::createFromFile(
-                    mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags
-                );
+                desc.pTexture =
+                    createTextureFromFile(job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags);
                 logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
             }
             else
@@ -412,12 +694,24 @@ void TextureManager::endDeferredLoading()
     );
     mpDevice->flushAndSync();
 
+    // Assign shared textures to textures with identical contents.
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (!sharedHandles[i])
+            continue;
+        auto& desc = getDesc(jobs[i].handle);
+        desc.pTexture = getDesc(sharedHandles[i]).pTexture;
+        logDebug("Texture '{}' has identical contents as a loaded texture, sharing it", jobs[i].key.fullPaths[0]);
+    }
+
     // Mark loaded textures and add them to lookup table.
+    // Shared textures keep the handle of the texture that was loaded first.
     for (const auto& job : jobs)
     {
         auto& desc = getDesc(job.handle);
         desc.state = desc.pTexture ? TextureState::Loaded : TextureState::Invalid;
-        mTextureToHandle[desc.pTexture.get()] = job.handle;
+        if (desc.pTexture)
+            mTextureToHandle.try_emplace(desc.pTexture.get(), job.handle);
     }
 }
 
@@ -445,12 +739,37 @@ void TextureManager::removeTexture(const TextureHandle& handle)
     if (it != mKeyToHandle.end())
         mKeyToHandle.erase(it);
 
+    auto contentIt =
+        std::find_if(mContentToHandle.begin(), mContentToHandle.end(), [handle](const auto& keyVal) { return keyVal.second == handle; });
+    if (contentIt != mContentToHandle.end())
+        mContentToHandle.erase(contentIt);
+
     if (desc.pTexture)
     {
-        FALCOR_ASSERT(mTextureToHandle.find(desc.pTexture.get()) != mTextureToHandle.end());
-        mTextureToHandle.erase(desc.pTexture.get());
+        // A texture shared by textures with identical contents is mapped to one of its handles.
+        // Remap it to another handle still using the texture.
+        auto texIt = mTextureToHandle.find(desc.pTexture.get());
+        FALCOR_ASSERT(texIt != mTextureToHandle.end());
+        if (texIt->second == handle)
+        {
+            mTextureToHandle.erase(texIt);
+            for (size_t i = 0; i < mTextureDescs.size(); i++)
+            {
+                if (i != handle.getID() && mTextureDescs[i].pTexture == desc.pTexture)
+                {
+                    mTextureToHandle[desc.pTexture.get()] = TextureHandle{static_cast<uint32_t>(i)};
+                    break;
+                }
+            }
+        }
     }
 
+    // Cancel a pending reload and clear residency state.
+    auto& residency = getResidency(handle);
+    if (residency.pReloadToken)
+        residency.pReloadToken->cancel();
+    residency = {};
+
     // Clear texture desc.
     desc = {};
 
@@ -471,6 +790,18 @@ TextureManager::TextureDesc TextureManager::getTextureDesc(const TextureHandle&
     return mTextureDescs[handle.getID()];
 }
 
+ref<Texture> TextureManager::createTextureFromFile(
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    bool loadAsSRGB,
+    Resource::BindFlags bindFlags
+)
+{
+    if (mpTextureCache)
+        return mpTextureCache->loadTexture(mpDevice, path, generateMipLevels, loadAsSRGB, bindFlags);
+    return Texture::createFromFile(mpDevice, path, generateMipLevels, loadAsSRGB, bindFlags);
+}
+
 size_t TextureManager::getTextureDescCount() const
 {
     std::lock_guard<std::mutex> lock(mMutex);
@@ -526,10 +857,17 @@ TextureManager::Stats TextureManager::getStats() const
 {
     std::lock_guard<std::mutex> lock(mMutex);
     TextureManager::Stats s;
+    std::set<const Texture*> textures;
     for (const auto& t : mTextureDescs)
     {
         if (!t.pTexture)
             continue;
+        if (!textures.insert(t.pTexture.get()).second)
+        {
+            s.textureDeduplicatedCount++;
+            s.textureDeduplicatedMemoryInBytes += t.pTexture->getTextureSizeInBytes();
+            continue;
+        }
         uint64_t texelCount = t.pTexture->getTexelCount();
         uint32_t channelCount = getFormatChannelCount(t.pTexture->getFormat());
         s.textureCount++;
@@ -542,6 +880,37 @@ TextureManager::Stats TextureManager::getStats() const
     return s;
 }
 
+TextureManager::ResidencyStats TextureManager::getResidencyStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    TextureManager::ResidencyStats s;
+    s.memoryBudget = mMemoryBudget;
+    s.evictionCount = mEvictionCount;
+    s.reloadCount = mReloadCount;
+    std::set<const Texture*> textures;
+    for (size_t i = 0; i < mTextureDescs.size(); i++)
+    {
+        const auto& t = mTextureDescs[i];
+        if (!t.pTexture || !textures.insert(t.pTexture.get()).second)
+            continue;
+        uint64_t size = t.pTexture->getTextureSizeInBytes();
+        s.residentMemoryInBytes += size;
+        if (i < mResidency.size() && mResidency[i].isEvicted)
+        {
+            s.fullMemoryInBytes += mResidency[i].fullSizeInBytes;
+            s.evictedTextureCount++;
+            if (mResidency[i].pReloadToken)
+                s.pendingReloadCount++;
+        }
+        else
+        {
+            s.fullMemoryInBytes += size;
+            s.residentTextureCount++;
+        }
+    }
+    return s;
+}
+
 TextureManager::TextureHandle TextureManager::addDesc(const TextureDesc& desc)
 {
     TextureHandle handle;
@@ -563,6 +932,11 @@ TextureManager::TextureHandle TextureManager::addDesc(const TextureDesc& desc)
         mTextureDescs.emplace_back(desc);
     }
 
+    // Reset residency state. New textures count as used so that the application has a frame to mark them.
+    auto& residency = getResidency(handle);
+    residency = {};
+    residency.lastUsedFrame = mFrameIndex;
+
     return handle;
 }
 
@@ -575,6 +949,249 @@ TextureManager::TextureDesc& TextureManager::getDesc(const TextureHandle& handle
     return mTextureDescs[handle.getID()];
 }
 
+TextureManager::ResidencyInfo& TextureManager::getResidency(const TextureHandle& handle)
+{
+    FALCOR_ASSERT(handle && !handle.isUdim() && handle.getID() < mTextureDescs.size());
+    if (mResidency.size() < mTextureDescs.size())
+        mResidency.resize(mTextureDescs.size());
+    return mResidency[handle.getID()];
+}
+
+void TextureManager::markTextureUsedInternal(const TextureHandle& handle)
+{
+    auto& residency = getResidency(handle);
+    residency.lastUsedFrame = mFrameIndex;
+    if (residency.isEvicted && !residency.pReloadToken)
+        requestReload(handle);
+}
+
+void TextureManager::requestReload(const TextureHandle& handle)
+{
+    auto& residency = getResidency(handle);
+    FALCOR_ASSERT(residency.isEvicted && residency.pKey && !residency.pReloadToken);
+
+    auto pToken = std::make_shared<AsyncTextureLoader::LoadToken>(kReloadPriority);
+    residency.pReloadToken = pToken;
+    residency.reloadFinished = false;
+
+#ifndef DISABLE_ASYNC_TEXTURE_LOADER
+    // Function called by the async texture loader when loading finishes.
+    // The texture is installed by the next call to beginFrame() on the main thread.
+    auto callback = [this, handle, pToken](ref<Texture> pTexture)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // Ignore the result if the texture was removed in the meantime.
+        if (handle.getID() >= mResidency.size() || mResidency[handle.getID()].pReloadToken != pToken)
+            return;
+
+        auto& residency = mResidency[handle.getID()];
+        residency.pReloadedTexture = pTexture;
+        residency.reloadFinished = true;
+        mCondition.notify_all();
+    };
+
+    const TextureKey& key = *residency.pKey;
+    if (key.fullPaths.size() > 1)
+    {
+        mAsyncTextureLoader.loadMippedFromFiles(key.fullPaths, key.loadAsSRGB, key.bindFlags, callback, pToken);
+    }
+    else
+    {
+        mAsyncTextureLoader.loadFromFile(key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, callback, pToken);
+    }
+#else
+    // Reloads are loaded on the main thread by the next call to beginFrame().
+    mPendingReloads.push_back(handle);
+#endif
+}
+
+void TextureManager::loadPendingReloads(bool useUploadBudget)
+{
+    // Load reloads queued by requestReload() on the main thread, up to the per-frame upload budget if used.
+    // Requests over the budget stay queued for the following frames.
+    const uint64_t uploadBudget = useUploadBudget ? mAsyncTextureLoader.getUploadBudget() : 0;
+    uint64_t uploadedBytes = 0;
+
+    size_t count = 0;
+    for (; count < mPendingReloads.size(); count++)
+    {
+        if (uploadBudget > 0 && uploadedBytes >= uploadBudget)
+            break;
+
+        const TextureHandle handle = mPendingReloads[count];
+
+        // Skip reloads of textures that were removed in the meantime.
+        auto& residency = getResidency(handle);
+        if (!residency.pReloadToken || residency.pReloadToken->isCancelled() || residency.reloadFinished)
+            continue;
+
+        const TextureKey& key = *residency.pKey;
+        ref<Texture> pTexture;
+        if (key.fullPaths.size() > 1)
+            pTexture = Texture::createMippedFromFiles(mpDevice, key.fullPaths, key.loadAsSRGB, key.bindFlags);
+        else
+            pTexture = createTextureFromFile(key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags);
+
+        uploadedBytes += pTexture ? pTexture->getTextureSizeInBytes() : 0;
+        residency.pReloadedTexture = pTexture;
+        residency.reloadFinished = true;
+    }
+
+    mPendingReloads.erase(mPendingReloads.begin(), mPendingReloads.begin() + count);
+}
+
+void TextureManager::installReloadedTextures(std::vector<TextureSwap>& swaps)
+{
+    for (size_t i = 0; i < mResidency.size(); i++)
+    {
+        auto& residency = mResidency[i];
+        if (!residency.reloadFinished)
+            continue;
+
+        ref<Texture> pTexture = std::move(residency.pReloadedTexture);
+        residency.pReloadToken = nullptr;
+        residency.reloadFinished = false;
+
+        // Keep the mip tail if reloading failed. The reload is retried the next time the texture is used.
+        if (!pTexture)
+        {
+            logWarning("TextureManager: Failed to reload evicted texture '{}'.", residency.pKey->fullPaths[0]);
+            continue;
+        }
+
+        replaceTexture(TextureHandle{static_cast<uint32_t>(i)}, pTexture, swaps);
+        residency.isEvicted = false;
+        residency.fullSizeInBytes = 0;
+        residency.pKey = nullptr;
+        residency.lastUsedFrame = mFrameIndex;
+        mReloadCount++;
+    }
+}
+
+void TextureManager::evictTextures(std::vector<TextureSwap>& swaps)
+{
+    if (mMemoryBudget == 0)
+        return;
+
+    // Count the memory of textures shared by textures with identical contents only once.
+    uint64_t residentBytes = 0;
+    std::map<const Texture*, uint32_t> textureUseCounts;
+    for (const auto& desc : mTextureDescs)
+    {
+        if (desc.pTexture && textureUseCounts[desc.pTexture.get()]++ == 0)
+            residentBytes += desc.pTexture->getTextureSizeInBytes();
+    }
+    if (residentBytes <= mMemoryBudget)
+        return;
+
+    // Only textures loaded from files can be reloaded. Look up their keys.
+    std::vector<const TextureKey*> keys(mTextureDescs.size(), nullptr);
+    for (const auto& [key, handle] : mKeyToHandle)
+        keys[handle.getID()] = &key;
+
+    // Collect eviction candidates. Textures used in the previous frame are kept to avoid thrashing.
+    std::vector<uint32_t> candidates;
+    for (uint32_t i = 0; i < (uint32_t)mTextureDescs.size(); i++)
+    {
+        const auto& desc = mTextureDescs[i];
+        const auto& residency = getResidency(TextureHandle{i});
+        if (desc.state != TextureState::Loaded || !desc.pTexture || !keys[i])
+            continue;
+        if (residency.isEvicted || residency.lastUsedFrame + 1 >= mFrameIndex)
+            continue;
+        if (desc.pTexture->getMipCount() <= 1 || desc.pTexture->getArraySize() != 1)
+            continue;
+        // Shared textures are kept resident as evicting them for a single handle wouldn't release memory.
+        if (textureUseCounts[desc.pTexture.get()] > 1)
+            continue;
+        candidates.push_back(i);
+    }
+
+    // Evict in LRU order. Larger textures go first among textures last used in the same frame.
+    std::sort(
+        candidates.begin(), candidates.end(),
+        [&](uint32_t a, uint32_t b)
+        {
+            if (mResidency[a].lastUsedFrame != mResidency[b].lastUsedFrame)
+                return mResidency[a].lastUsedFrame < mResidency[b].lastUsedFrame;
+            uint64_t sizeA = mTextureDescs[a].pTexture->getTextureSizeInBytes();
+            uint64_t sizeB = mTextureDescs[b].pTexture->getTextureSizeInBytes();
+            return sizeA != sizeB ? sizeA > sizeB : a < b;
+        }
+    );
+
+    for (uint32_t i : candidates)
+    {
+        if (residentBytes <= mMemoryBudget)
+            break;
+
+        ref<Texture> pTexture = mTextureDescs[i].pTexture;
+        ref<Texture> pTail = createMipTail(pTexture);
+        if (!pTail)
+            continue;
+
+        uint64_t fullSize = pTexture->getTextureSizeInBytes();
+        residentBytes -= fullSize - pTail->getTextureSizeInBytes();
+
+        auto& residency = mResidency[i];
+        residency.isEvicted = true;
+        residency.fullSizeInBytes = fullSize;
+        residency.pKey = keys[i];
+        replaceTexture(TextureHandle{i}, pTail, swaps);
+        mEvictionCount++;
+    }
+}
+
+ref<Texture> TextureManager::createMipTail(const ref<Texture>& pTexture) const
+{
+    const uint32_t mipCount = pTexture->getMipCount();
+    const ResourceFormat format = pTexture->getFormat();
+
+    // Find the first mip level that fits into the resident tail size.
+    uint32_t tailMip = 0;
+    while (tailMip < mipCount && std::max(pTexture->getWidth(tailMip), pTexture->getHeight(tailMip)) > mResidentMipTailSize)
+        tailMip++;
+
+    // The top level of the tail of a block-compressed texture must consist of whole blocks.
+    const uint32_t blockWidth = getFormatWidthCompressionRatio(format);
+    const uint32_t blockHeight = getFormatHeightCompressionRatio(format);
+    while (tailMip > 0 && (pTexture->getWidth(tailMip) % blockWidth != 0 || pTexture->getHeight(tailMip) % blockHeight != 0))
+        tailMip--;
+
+    // Nothing to evict if the texture is already small enough.
+    if (tailMip == 0 || tailMip >= mipCount)
+        return nullptr;
+
+    ref<Texture> pTail = Texture::create2D(
+        mpDevice, pTexture->getWidth(tailMip), pTexture->getHeight(tailMip), format, 1, mipCount - tailMip, nullptr,
+        pTexture->getBindFlags()
+    );
+    pTail->setSourcePath(pTexture->getSourcePath());
+
+    RenderContext* pRenderContext = mpDevice->getRenderContext();
+    for (uint32_t mip = 0; mip < pTail->getMipCount(); mip++)
+    {
+        pRenderContext->copySubresource(
+            pTail.get(), pTail->getSubresourceIndex(0, mip), pTexture.get(), pTexture->getSubresourceIndex(0, tailMip + mip)
+        );
+    }
+
+    return pTail;
+}
+
+void TextureManager::replaceTexture(const TextureHandle& handle, const ref<Texture>& pTexture, std::vector<TextureSwap>& swaps)
+{
+    auto& desc = getDesc(handle);
+    ref<Texture> pOldTexture = desc.pTexture;
+
+    mTextureToHandle.erase(pOldTexture.get());
+    mTextureToHandle[pTexture.get()] = handle;
+    desc.pTexture = pTexture;
+
+    swaps.push_back(TextureSwap{pOldTexture, pTexture});
+}
+
 size_t TextureManager::getUdimRange(size_t requiredSize)
 {
     // But first look in the freed ranges for the smallest one that we can reuse
@@ -38,10 +38,13 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 namespace Falcor
 {
 class SearchDirectories;
+class TextureCache;
 
 /**
  * Multi-threaded texture manager.
@@ -66,11 +69,33 @@ public:
 
     struct Stats
     {
-        uint64_t textureCount = 0;             ///< Number of unique textures. A texture can be referenced by multiple materials.
-        uint64_t textureCompressedCount = 0;   ///< Number of unique compressed textures.
-        uint64_t textureTexelCount = 0;        ///< Total number of texels in all textures.
-        uint64_t textureTexelChannelCount = 0; ///< Total number of texel channels in all textures.
-        uint64_t textureMemoryInBytes = 0;     ///< Total memory in bytes used by the textures.
+        uint64_t textureCount = 0;                     ///< Number of unique textures. A texture can be referenced by multiple materials.
+        uint64_t textureCompressedCount = 0;           ///< Number of unique compressed textures.
+        uint64_t textureTexelCount = 0;                ///< Total number of texels in all textures.
+        uint64_t textureTexelChannelCount = 0;         ///< Total number of texel channels in all textures.
+        uint64_t textureMemoryInBytes = 0;             ///< Total memory in bytes used by the textures.
+        uint64_t textureDeduplicatedCount = 0;         ///< Number of textures sharing the texture of another file with identical contents.
+        uint64_t textureDeduplicatedMemoryInBytes = 0; ///< Memory in bytes saved by sharing textures with identical contents.
+    };
+
+    /// Residency stats when a texture memory budget is set. See setMemoryBudget().
+    struct ResidencyStats
+    {
+        uint64_t memoryBudget = 0;          ///< Texture memory budget in bytes, or 0 if residency management is disabled.
+        uint64_t residentMemoryInBytes = 0; ///< Memory in bytes used by the currently bound textures.
+        uint64_t fullMemoryInBytes = 0;     ///< Memory in bytes the textures would use if all mips were resident.
+        uint64_t residentTextureCount = 0;  ///< Number of textures with all mips resident.
+        uint64_t evictedTextureCount = 0;   ///< Number of textures with only the mip tail resident.
+        uint64_t pendingReloadCount = 0;    ///< Number of evicted textures currently being reloaded.
+        uint64_t evictionCount = 0;         ///< Total number of evictions since the manager was created.
+        uint64_t reloadCount = 0;           ///< Total number of completed reloads since the manager was created.
+    };
+
+    /// Texture object replaced by the residency manager. Returned by beginFrame().
+    struct TextureSwap
+    {
+        ref<Texture> pOldTexture; ///< Texture that was bound before.
+        ref<Texture> pNewTexture; ///< Texture that is bound now. Uses the same handle as the old texture.
     };
 
     /**
@@ -111,7 +136,7 @@ public:
 
     /**
      * Constructor.
-     * @param[in] pDevice GPU device.
+     * @param[in] pDevice GPU device. If nullptr, no textures can be loaded (see getDevice()).
      * @param[in] maxTextureCount Maximum number of textures that can be simultaneously managed.
      * @param[in] threadCount Number of worker threads.
      */
@@ -119,6 +144,12 @@ public:
 
     ~TextureManager();
 
+    /**
+     * Get the GPU device.
+     * @return The device, or nullptr if the manager was created without a device.
+     */
+    const ref<Device>& getDevice() const { return mpDevice; }
+
     /**
      * Add a texture to the manager.
      * If the texture is already managed, its existing handle is returned.
@@ -165,6 +196,91 @@ public:
         size_t* loadedTextureCount = nullptr
     );
 
+    /**
+     * Enable or disable the persistent texture cache.
+     * When enabled, textures loaded from single image files are converted to block-compressed DDS files with
+     * prebuilt mips on first load and loaded from the cache on subsequent loads. See TextureCache.
+     * Only affects textures loaded after the call.
+     * @param[in] enabled Enable the texture cache.
+     */
+    void setUseTextureCache(bool enabled);
+
+    /**
+     * Check if the persistent texture cache is enabled.
+     */
+    bool getUseTextureCache() const { return mpTextureCache != nullptr; }
+
+    /**
+     * Enable or disable deduplication of textures by content.
+     * When enabled, endDeferredLoading() hashes the source files of the textures in parallel. Textures whose files
+     * have identical contents and that are loaded with identical flags share a single texture resource,
+     * even if they are referenced by different paths. Only affects textures loaded with deferred loading after the call.
+     * @param[in] enabled Enable content hashing.
+     */
+    void setUseContentHashing(bool enabled) { mUseContentHashing = enabled; }
+
+    /**
+     * Check if deduplication of textures by content is enabled.
+     */
+    bool getUseContentHashing() const { return mUseContentHashing; }
+
+    /**
+     * Set the per-frame upload budget for texture loads that happen while rendering, i.e. reloads of evicted textures.
+     * See AsyncTextureLoader::setUploadBudget(). The budget is suspended while waiting for textures to load.
+     * @param[in] bytesPerFrame Upload budget in bytes per frame, or 0 for no limit (default).
+     */
+    void setUploadBudget(uint64_t bytesPerFrame) { mAsyncTextureLoader.setUploadBudget(bytesPerFrame); }
+
+    /**
+     * Get the per-frame upload budget in bytes, 0 means no limit.
+     */
+    uint64_t getUploadBudget() { return mAsyncTextureLoader.getUploadBudget(); }
+
+    /**
+     * Set the texture memory budget.
+     * When a budget is set, beginFrame() evicts the least recently used textures while the bound textures exceed the budget.
+     * Evicted textures are replaced by a copy of their low-resolution mip tail and are reloaded when markTextureUsed() is
+     * called for them. Reloads are loaded by beginFrame() on the main thread within the upload budget (see setUploadBudget()),
+     * or by the async texture loader when it is enabled. Only textures loaded from files and having more than one mip level
+     * can be evicted.
+     * Setting the budget to 0 disables eviction, but already evicted textures stay evicted until they are used again.
+     * @param[in] bytes Texture memory budget in bytes, or 0 to disable residency management (default).
+     */
+    void setMemoryBudget(uint64_t bytes);
+
+    /**
+     * Get the texture memory budget in bytes, or 0 if residency management is disabled.
+     */
+    uint64_t getMemoryBudget() const;
+
+    /**
+     * Set the size of the mip tail kept resident for evicted textures.
+     * The tail starts at the first mip level whose width and height are at most the given size.
+     * @param[in] size Maximum width and height in texels of the largest resident mip level (default 64).
+     */
+    void setResidentMipTailSize(uint32_t size);
+
+    /**
+     * Mark a texture as used in the current frame.
+     * This updates the LRU order for eviction and requests a reload if the texture is currently evicted.
+     * @param[in] handle Texture handle. UDIM handles mark all textures of the UDIM set.
+     */
+    void markTextureUsed(const TextureHandle& handle);
+
+    /**
+     * Mark a texture as used in the current frame. See markTextureUsed(const TextureHandle&).
+     * @param[in] pTexture Currently bound texture. The call is ignored if the texture is not managed.
+     */
+    void markTextureUsed(const Texture* pTexture);
+
+    /**
+     * Start a new frame. Called once per frame by the material system.
+     * This resets the upload budget, installs textures that finished reloading and evicts textures if over the memory budget.
+     * Other owners of a replaced texture should switch to the new texture, otherwise the memory of evicted mips is not released.
+     * @return List of textures that were replaced since the last call.
+     */
+    std::vector<TextureSwap> beginFrame();
+
     /**
      * Wait for a requested texture to load.
      * If the handle is valid, the call blocks until the texture is loaded (or failed to load).
@@ -177,6 +293,12 @@ public:
      */
     void waitForAllTexturesLoading();
 
+    /**
+     * Waits for all requested reloads of evicted textures to finish loading, ignoring the upload budget.
+     * The reloaded textures are installed by the next call to beginFrame().
+     */
+    void waitForPendingReloads();
+
     /**
      * Marks the beginning of a section where texture loading is deferred.
      * All loadTexture() and loadUdimTexture() calls after calling this will be put on a deferred list.
@@ -237,6 +359,11 @@ public:
      */
     Stats getStats() const;
 
+    /**
+     * Returns residency stats for the textures.
+     */
+    ResidencyStats getResidencyStats() const;
+
 private:
     size_t getUdimRange(size_t requiredSize);
     void freeUdimRange(size_t rangeStart);
@@ -271,8 +398,54 @@ private:
         }
     };
 
+    /**
+     * Key to identify textures with identical contents. See setUseContentHashing().
+     */
+    struct ContentKey
+    {
+        uint64_t hash;
+        uint64_t size;
+        bool generateMipLevels;
+        bool loadAsSRGB;
+        Resource::BindFlags bindFlags;
+
+        bool operator<(const ContentKey& rhs) const
+        {
+            return std::tie(hash, size, generateMipLevels, loadAsSRGB, bindFlags) <
+                   std::tie(rhs.hash, rhs.size, rhs.generateMipLevels, rhs.loadAsSRGB, rhs.bindFlags);
+        }
+    };
+
+    /**
+     * Residency state of a managed texture. Indexed by handle ID.
+     */
+    struct ResidencyInfo
+    {
+        uint64_t lastUsedFrame = 0;                                   ///< Frame index of the last use.
+        uint64_t fullSizeInBytes = 0;                                 ///< Size of the texture with all mips, valid when evicted.
+        bool isEvicted = false;                                       ///< True if only the mip tail is resident.
+        const TextureKey* pKey = nullptr;                             ///< Key used to reload the texture, valid when evicted.
+        std::shared_ptr<AsyncTextureLoader::LoadToken> pReloadToken;  ///< Token of the reload request in flight, or nullptr.
+        ref<Texture> pReloadedTexture;                                ///< Reloaded texture waiting to be installed by beginFrame().
+        bool reloadFinished = false;                                  ///< True if the reload request finished (pReloadedTexture may be nullptr on failure).
+    };
+
     TextureHandle addDesc(const TextureDesc& desc);
+    ResidencyInfo& getResidency(const TextureHandle& handle);
+    void markTextureUsedInternal(const TextureHandle& handle);
+    void requestReload(const TextureHandle& handle);
+    void loadPendingReloads(bool useUploadBudget);
+    void installReloadedTextures(std::vector<TextureSwap>& swaps);
+    void evictTextures(std::vector<TextureSwap>& swaps);
+    ref<Texture> createMipTail(const ref<Texture>& pTexture) const;
+    void replaceTexture(const TextureHandle& handle, const ref<Texture>& pTexture, std::vector<TextureSwap>& swaps);
     TextureDesc& getDesc(const TextureHandle& handle);
+    ref<Texture> createTextureFromFile(
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        bool loadAsSRGB,
+        Resource::BindFlags bindFlags
+    );
 
     ref<Device> mpDevice;
 
@@ -284,6 +457,7 @@ private:
     std::vector<TextureHandle> mFreeList;                     ///< List of unused handles.
     std::map<TextureKey, TextureHandle> mKeyToHandle;         ///< Map from texture key to handle.
     std::map<const Texture*, TextureHandle> mTextureToHandle; ///< Map from texture ptr to handle.
+    std::map<ContentKey, TextureHandle> mContentToHandle;     ///< Map from content key to handle, when content hashing is used.
     /// Map from UDIM-1001 to an actual textureID, -1 if the texture does not exist (e.g., there is 1001 and 1003, so 1002 [1] == -1)
     std::vector<int32_t> mUdimIndirection;
     /// For each udim indirection range, writes (at the first element), how long that range is (there is 0 everywhere else)
@@ -295,6 +469,17 @@ private:
     mutable ref<Buffer> mpUdimIndirection;
 
     bool mUseDeferredLoading = false;
+    bool mUseContentHashing = false;
+
+    std::shared_ptr<const TextureCache> mpTextureCache; ///< Persistent texture cache (optional).
+
+    std::vector<ResidencyInfo> mResidency;      ///< Residency state of all textures, indexed by handle ID.
+    std::vector<TextureHandle> mPendingReloads; ///< Reloads waiting to be loaded on the main thread by beginFrame().
+    uint64_t mMemoryBudget = 0;                 ///< Texture memory budget in bytes, or 0 if disabled.
+    uint32_t mResidentMipTailSize = 64;         ///< Maximum size of the largest mip level kept resident for evicted textures.
+    uint64_t mFrameIndex = 0;                   ///< Frame index incremented by beginFrame().
+    uint64_t mEvictionCount = 0;                ///< Total number of evictions.
+    uint64_t mReloadCount = 0;                  ///< Total number of completed reloads.
 
     AsyncTextureLoader mAsyncTextureLoader; ///< Utility for asynchronous texture loading.
     size_t mLoadRequestsInProgress = 0;     ///< Number of load requests currently in progress.
@@ -28,19 +28,46 @@
 #include "Logger.h"
 #include "Core/Assert.h"
 #include "Core/Platform/OS.h"
+#include "Utils/Algorithm/BoundedMPSCQueue.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <mutex>
 #include <set>
+#include <shared_mutex>
+#include <thread>
 
 namespace Falcor
 {
+inline const char* getLogLevelString(Logger::Level level)
+{
+    switch (level)
+    {
+    case Logger::Level::Fatal:
+        return "(Fatal)";
+    case Logger::Level::Error:
+        return "(Error)";
+    case Logger::Level::Warning:
+        return "(Warning)";
+    case Logger::Level::Info:
+        return "(Info)";
+    case Logger::Level::Debug:
+        return "(Debug)";
+    default:
+        FALCOR_UNREACHABLE();
+        return nullptr;
+    }
+}
+
 namespace
 {
 std::mutex sMutex;
-Logger::Level sVerbosity = Logger::Level::Info;
-Logger::OutputFlags sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
+std::atomic<Logger::Level> sVerbosity{Logger::Level::Info};
+std::atomic<Logger::OutputFlags> sOutputs{Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow};
 std::filesystem::path sLogFilePath;
 
 #if FALCOR_ENABLE_LOGGER
@@ -75,7 +102,7 @@ FILE* openLogFile()
     return pFile;
 }
 
-void printToLogFile(const std::string& s)
+void printToLogFile(const std::string& s, bool flush)
 {
     if (!sInitialized)
     {
@@ -86,8 +113,273 @@ void printToLogFile(const std::string& s)
     if (sLogFile)
     {
         std::fprintf(sLogFile, "%s", s.c_str());
+        if (flush)
+            std::fflush(sLogFile);
+    }
+}
+
+/// Write a formatted message to all outputs. Must be called with sMutex held.
+void writeMessage(Logger::Level level, const std::string& s, bool flush)
+{
+    Logger::OutputFlags outputs = sOutputs.load();
+
+    // Write to console.
+    if (is_set(outputs, Logger::OutputFlags::Console))
+    {
+        auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
+        os << s;
+        if (flush)
+            os.flush();
+    }
+
+    // Write to file.
+    if (is_set(outputs, Logger::OutputFlags::File))
+    {
+        printToLogFile(s, flush);
+    }
+
+    // Write to debug window if debugger is attached.
+    if (is_set(outputs, Logger::OutputFlags::DebugWindow) && isDebuggerPresent())
+    {
+        printToDebugWindow(s);
+    }
+}
+
+/// Flush all outputs. Must be called with sMutex held.
+void flushOutputs()
+{
+    std::cout.flush();
+    std::cerr.flush();
+    if (sLogFile)
         std::fflush(sLogFile);
+}
+
+struct LogMessage
+{
+    Logger::Level level = Logger::Level::Info;
+    std::string text;
+};
+
+using MessageQueue = BoundedMPSCQueue<LogMessage>;
+
+/**
+ * Background writer for asynchronous logging.
+ * Producers push formatted messages to a lock-free queue. The writer thread wakes up periodically or when enough messages are pending,
+ * writes all pending messages and flushes the outputs once per batch.
+ */
+class AsyncWriter
+{
+public:
+    static constexpr size_t kQueueCapacity = 16384;                ///< Maximum number of pending messages.
+    static constexpr size_t kBatchSize = 256;                      ///< Number of pending messages that wakes up the writer.
+    static constexpr std::chrono::milliseconds kFlushInterval{50}; ///< Maximum time between writing and flushing messages.
+    static constexpr uint32_t kRateLimit = 1000;                   ///< Maximum number of warning/info/debug messages per second.
+
+    ~AsyncWriter() { stop(); }
+
+    bool isRunning() const { return mThread.joinable(); }
+
+    void start()
+    {
+        if (isRunning())
+            return;
+        if (!mpQueue)
+            mpQueue = std::make_unique<MessageQueue>(kQueueCapacity);
+        mStop = false;
+        mThread = std::thread(&AsyncWriter::run, this);
+    }
+
+    void stop()
+    {
+        if (!isRunning())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mStop = true;
+        }
+        mWakeCondition.notify_one();
+        mThread.join();
+
+        // Write messages pushed while the writer was stopping.
+        std::lock_guard<std::mutex> lock(sMutex);
+        drain();
+        writeSummaries();
+        flushOutputs();
+    }
+
+    /// Push a message. The message is moved from on success. Returns false if the queue is full.
+    bool push(LogMessage& message)
+    {
+        Logger::Level level = message.level;
+
+        // Count the message as pending before it becomes visible to the writer, so that the writer never decrements the count below zero.
+        size_t pendingCount = mPendingCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (!mpQueue->tryPush(message))
+        {
+            mPendingCount.fetch_sub(1, std::memory_order_relaxed);
+            // Errors are written synchronously by the caller instead.
+            if (level > Logger::Level::Error)
+                mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        mPushedCount.fetch_add(1, std::memory_order_release);
+
+        // Wake up the writer early for errors and large batches. Otherwise the writer wakes up after the flush interval.
+        if (pendingCount == kBatchSize || level <= Logger::Level::Error)
+            mWakeCondition.notify_one();
+        return true;
+    }
+
+    /// Wait until all messages pushed before this call are written.
+    void flush()
+    {
+        if (!isRunning())
+            return;
+        std::unique_lock<std::mutex> lock(mWakeMutex);
+        uint64_t target = mPushedCount.load(std::memory_order_acquire);
+        mFlushRequested = true;
+        mWakeCondition.notify_one();
+        mFlushCondition.wait(lock, [&]() { return mWrittenCount >= target || mStop; });
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mWakeMutex);
+        while (true)
+        {
+            mWakeCondition.wait_for(
+                lock,
+                kFlushInterval,
+                [&]() { return mStop || mFlushRequested || mPendingCount.load(std::memory_order_relaxed) >= kBatchSize; }
+            );
+            bool stop = mStop;
+            mFlushRequested = false;
+            lock.unlock();
+
+            uint64_t count = 0;
+            {
+                std::lock_guard<std::mutex> outputLock(sMutex);
+                count = drain();
+                bool hasSummaries = writeSummaries();
+                if (count > 0 || hasSummaries)
+                    flushOutputs();
+            }
+
+            lock.lock();
+            mWrittenCount += count;
+            mFlushCondition.notify_all();
+            if (stop)
+                break;
+        }
+    }
+
+    /// Write all pending messages. Must be called with sMutex held.
+    uint64_t drain()
+    {
+        uint64_t count = 0;
+        LogMessage message;
+        while (mpQueue->tryPop(message))
+        {
+            mPendingCount.fetch_sub(1, std::memory_order_relaxed);
+            ++count;
+
+            // Collapse consecutive repeats of the same message.
+            if (message.level == mLastMessage.level && message.text == mLastMessage.text)
+            {
+                ++mRepeatCount;
+                continue;
+            }
+            writeRepeatSummary();
+
+            if (message.level > Logger::Level::Error && !acquireRateLimit())
+            {
+                ++mSuppressedCount;
+                continue;
+            }
+
+            writeMessage(message.level, message.text, false);
+            mLastMessage = std::move(message);
+        }
+        return count;
     }
+
+    bool acquireRateLimit()
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - mRateLimitStart >= std::chrono::seconds(1))
+        {
+            mRateLimitStart = now;
+            mRateLimitCount = 0;
+        }
+        return mRateLimitCount++ < kRateLimit;
+    }
+
+    void writeRepeatSummary()
+    {
+        if (mRepeatCount == 0)
+            return;
+        std::string s = fmt::format("{} Last message repeated {} times.\n", getLogLevelString(mLastMessage.level), mRepeatCount);
+        writeMessage(mLastMessage.level, s, false);
+        mRepeatCount = 0;
+    }
+
+    /// Write summaries of collapsed, suppressed and dropped messages. Must be called with sMutex held.
+    bool writeSummaries()
+    {
+        bool written = mRepeatCount > 0;
+        writeRepeatSummary();
+
+        uint64_t droppedCount = mDroppedCount.exchange(0, std::memory_order_relaxed);
+        if (mSuppressedCount > 0 || droppedCount > 0)
+        {
+            writeMessage(
+                Logger::Level::Warning,
+                fmt::format(
+                    "{} Logger suppressed {} messages exceeding the rate limit and dropped {} messages because the queue was full.\n",
+                    getLogLevelString(Logger::Level::Warning),
+                    mSuppressedCount,
+                    droppedCount
+                ),
+                false
+            );
+            mSuppressedCount = 0;
+            written = true;
+        }
+        return written;
+    }
+
+    std::unique_ptr<MessageQueue> mpQueue;
+    std::thread mThread;
+
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCondition;
+    std::condition_variable mFlushCondition;
+    bool mStop = false;
+    bool mFlushRequested = false;
+    uint64_t mWrittenCount = 0; ///< Number of popped messages, protected by mWakeMutex.
+
+    std::atomic<uint64_t> mPushedCount{0};
+    std::atomic<size_t> mPendingCount{0};
+    std::atomic<uint64_t> mDroppedCount{0};
+
+    // Writer state, protected by sMutex.
+    LogMessage mLastMessage;
+    uint64_t mRepeatCount = 0;
+    uint64_t mSuppressedCount = 0;
+    uint32_t mRateLimitCount = 0;
+    std::chrono::steady_clock::time_point mRateLimitStart;
+};
+
+/// Held shared by producers while checking sAsync and pushing, and exclusively while switching modes.
+/// This guarantees that no message is pushed after the writer has stopped and drained the queue.
+std::shared_mutex sAsyncMutex;
+std::atomic<bool> sAsync{false};
+
+AsyncWriter& getAsyncWriter()
+{
+    static AsyncWriter writer;
+    return writer;
 }
 #endif
 } // namespace
@@ -95,6 +387,9 @@ void printToLogFile(const std::string& s)
 void Logger::shutdown()
 {
 #if FALCOR_ENABLE_LOGGER
+    setAsync(false);
+
+    std::lock_guard<std::mutex> lock(sMutex);
     if (sLogFile)
     {
         fclose(sLogFile);
@@ -104,26 +399,6 @@ void Logger::shutdown()
 #endif
 }
 
-inline const char* getLogLevelString(Logger::Level level)
-{
-    switch (level)
-    {
-    case Logger::Level::Fatal:
-        return "(Fatal)";
-    case Logger::Level::Error:
-        return "(Error)";
-    case Logger::Level::Warning:
-        return "(Warning)";
-    case Logger::Level::Info:
-        return "(Info)";
-    case Logger::Level::Debug:
-        return "(Debug)";
-    default:
-        FALCOR_UNREACHABLE();
-        return nullptr;
-    }
-}
-
 class MessageDeduplicator
 {
 public:
@@ -152,59 +427,93 @@ private:
 
 void Logger::log(Level level, const std::string_view msg, Frequency frequency)
 {
-    std::lock_guard<std::mutex> lock(sMutex);
 #if FALCOR_ENABLE_LOGGER
-    if (level <= sVerbosity)
+    if (level <= sVerbosity.load())
     {
-        std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+        LogMessage message{level, fmt::format("{} {}\n", getLogLevelString(level), msg)};
 
-        if (frequency == Frequency::Once && MessageDeduplicator::instance().isDuplicate(s))
+        if (frequency == Frequency::Once && MessageDeduplicator::instance().isDuplicate(message.text))
             return;
 
-        // Write to console.
-        if (is_set(sOutputs, OutputFlags::Console))
+        if (sAsync.load(std::memory_order_relaxed))
         {
-            auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
-            os << s;
-            os.flush();
+            std::shared_lock<std::shared_mutex> asyncLock(sAsyncMutex);
+            if (sAsync.load(std::memory_order_relaxed))
+            {
+                // Fatal messages are written synchronously after all pending messages, as the application is about to terminate.
+                if (level == Level::Fatal)
+                    getAsyncWriter().flush();
+                else if (getAsyncWriter().push(message) || level > Level::Error)
+                    return;
+            }
         }
 
-        // Write to file.
-        if (is_set(sOutputs, OutputFlags::File))
-        {
-            printToLogFile(s);
-        }
+        std::lock_guard<std::mutex> lock(sMutex);
+        writeMessage(level, message.text, true);
+    }
+#endif
+}
 
-        // Write to debug window if debugger is attached.
-        if (is_set(sOutputs, OutputFlags::DebugWindow) && isDebuggerPresent())
-        {
-            printToDebugWindow(s);
-        }
+void Logger::setAsync(bool enabled)
+{
+#if FALCOR_ENABLE_LOGGER
+    std::unique_lock<std::shared_mutex> lock(sAsyncMutex);
+    if (enabled == sAsync.load())
+        return;
+
+    if (enabled)
+    {
+        getAsyncWriter().start();
+        sAsync.store(true, std::memory_order_relaxed);
+    }
+    else
+    {
+        sAsync.store(false, std::memory_order_relaxed);
+        getAsyncWriter().stop();
     }
 #endif
 }
 
-void Logger::setVerbosity(Level level)
+bool Logger::isAsync()
 {
+#if FALCOR_ENABLE_LOGGER
+    return sAsync.load();
+#else
+    return false;
+#endif
+}
+
+void Logger::flush()
+{
+#if FALCOR_ENABLE_LOGGER
+    {
+        std::shared_lock<std::shared_mutex> asyncLock(sAsyncMutex);
+        if (sAsync.load(std::memory_order_relaxed))
+            getAsyncWriter().flush();
+    }
+
     std::lock_guard<std::mutex> lock(sMutex);
+    flushOutputs();
+#endif
+}
+
+void Logger::setVerbosity(Level level)
+{
     sVerbosity = level;
 }
 
 Logger::Level Logger::getVerbosity()
 {
-    std::lock_guard<std::mutex> lock(sMutex);
     return sVerbosity;
 }
 
 void Logger::setOutputs(OutputFlags outputs)
 {
-    std::lock_guard<std::mutex> lock(sMutex);
     sOutputs = outputs;
 }
 
 Logger::OutputFlags Logger::getOutputs()
 {
-    std::lock_guard<std::mutex> lock(sMutex);
     return sOutputs;
 }
 
@@ -263,10 +572,15 @@ FALCOR_SCRIPT_BINDING(Logger)
         [](pybind11::object, std::filesystem::path path) { Logger::setLogFilePath(path); }
     );
 
+    logger.def_property_static(
+        "async_mode", [](pybind11::object) { return Logger::isAsync(); }, [](pybind11::object, bool enabled) { Logger::setAsync(enabled); }
+    );
+
     logger.def_static(
         "log", [](Logger::Level level, const std::string_view msg) { Logger::log(level, msg, Logger::Frequency::Always); }, "level"_a,
         "msg"_a
     );
+    logger.def_static("flush", &Logger::flush);
 }
 
 } // namespace Falcor
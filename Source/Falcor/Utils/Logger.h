@@ -111,6 +111,26 @@ public:
      */
     static std::filesystem::path getLogFilePath();
 
+    /**
+     * Enable/disable asynchronous logging.
+     * In asynchronous mode, log() formats the message and pushes it to a lock-free queue instead of writing it. A background thread
+     * writes the queued messages in batches and flushes the outputs when a time or size threshold is reached. Consecutive repeats of
+     * the same message are collapsed into a single line, and warning, info and debug messages are rate limited. Messages are dropped
+     * if the queue is full. Fatal messages are always written synchronously, after all pending messages.
+     * @param enabled True to enable asynchronous logging.
+     */
+    static void setAsync(bool enabled);
+
+    /**
+     * Check if asynchronous logging is enabled.
+     */
+    static bool isAsync();
+
+    /**
+     * Wait until all pending messages are written and flush the outputs.
+     */
+    static void flush();
+
     /**
      * Check if the logger is enabled.
      */
@@ -27,123 +27,334 @@
  **************************************************************************/
 #include "AliasTable.h"
 #include "Core/Errors.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <execution>
+#include <limits>
+#include <mutex>
 
 namespace Falcor
 {
-// This builds an alias table via the O(N) algorithm from Vose 1991, "A linear algorithm for generating random
-// numbers with a given distribution," IEEE Transactions on Software Engineering 17(9), 972-975.
+namespace
+{
+// Number of weights handled per task. The chunk size also determines how the table construction is split
+// into independent parts. It is fixed, so the resulting table doesn't depend on the number of threads.
+const size_t kChunkSize = 1 << 14;
+
+size_t getChunkCount(size_t count)
+{
+    return (count + kChunkSize - 1) / kChunkSize;
+}
+
+/**
+ * Run func(chunk, begin, end) for all chunks of [0, count) in parallel.
+ * Exceptions thrown by func are rethrown on the calling thread.
+ */
+template<typename Func>
+void forEachChunk(size_t count, Func func)
+{
+    const size_t chunkCount = getChunkCount(count);
+    if (chunkCount <= 1)
+    {
+        func(size_t(0), size_t(0), count);
+        return;
+    }
+
+    std::exception_ptr pException;
+    std::mutex exceptionMutex;
+    auto range = NumericRange<size_t>(0, chunkCount);
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](size_t chunk)
+        {
+            try
+            {
+                func(chunk, chunk * kChunkSize, std::min(count, (chunk + 1) * kChunkSize));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!pException)
+                    pException = std::current_exception();
+            }
+        }
+    );
+    if (pException)
+        std::rethrow_exception(pException);
+}
+} // namespace
+
+AliasTable::AliasTable(ref<Device> pDevice, fstd::span<const float> weights)
+{
+    build(weights);
+
+    mpWeights = Buffer::createStructured(
+        pDevice, sizeof(float), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, mWeights.data()
+    );
+    mpItems = Buffer::createStructured(
+        pDevice, sizeof(AliasTable::Item), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, mItems.data()
+    );
+}
+
+AliasTable::AliasTable(fstd::span<const float> weights)
+{
+    build(weights);
+}
+
+// This builds an alias table with the parallel sweeping construction from Hübschle-Schneider and Sanders 2022,
+// "Parallel Weighted Random Sampling," ACM Transactions on Mathematical Software 48(3).
 //
-// Basic idea:  creating each alias table entry combines one overweighted sample and one underweighted sample
-// into one alias table entry plus a residual sample (the overweighted sample minus some of its weight).
+// Basic idea:  all weights are normalized so the average weight is 1 and split into a list of light items
+// (weight < 1) and a list of heavy items (weight >= 1), both in index order.  The sequential sweep then fills
+// table entries (buckets) one at a time.  It keeps a current heavy item and fills the bucket of the next light
+// item with the light item plus the missing weight taken from the current heavy item.  Once the residual weight
+// of the heavy item drops to 1 or below, the heavy item's own bucket is filled with its residual plus weight taken
+// from the next heavy item.  Every item owns exactly one bucket, so indexB of entry i is always i.
 //
-// By first separating all inputs into 2 temporary buffer (one overweighted set, with weights above the
-// average; one underweighted set, with weights below average), we can simply walk through the lists once,
-// merging the first elements in each temporary buffer.  The residual sample is interted into either the
-// overweighted or underweighted set, depending on its residual weight.
+// The state of the sweep after c filled buckets is fully determined by the number of light items a and heavy
+// items b = c - a whose buckets are filled:  it is the smallest a for which the prefix sums of the light and
+// heavy weights satisfy sumLight(a) + sumHeavy(b) <= c.  The remaining weight c - sumLight(a) - sumHeavy(b) was
+// spilled from heavy item b into earlier buckets.  This lets us find the state at the start of every chunk of
+// buckets with a binary search and sweep all chunks independently.
 //
-// The main complexity is dealing with corner cases, thanks to numerical precision issues, where you don't
-// have 2 valid entries to combine.  By definition, in these corner cases, all remaining unhandled samples
-// actually have the average weight (within numerical precision limits)
-AliasTable::AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt19937& rng) : mCount((uint32_t)weights.size())
+// Numerical precision issues are dealt with by clamping thresholds to [0,1] and by giving the last heavy
+// item (and any light items left without a heavy partner) a threshold of 1.  In these corner cases all
+// remaining items have the average weight within numerical precision limits.
+void AliasTable::build(fstd::span<const float> weights)
 {
-    // Use >= since we reserve 0xFFFFFFFFu as an invalid flag marker during construction.
+    // Use >= since we reserve 0xFFFFFFFFu as an invalid index.
     if (weights.size() >= std::numeric_limits<uint32_t>::max())
         throw RuntimeError("Too many entries for alias table.");
+    checkArgument(!weights.empty(), "Alias table needs at least one weight.");
 
-    std::uniform_int_distribution<uint32_t> rngDist;
+    mCount = (uint32_t)weights.size();
+    mWeights.assign(weights.begin(), weights.end());
+    mItems.resize(mCount);
 
-    mpWeights = Buffer::createStructured(
-        pDevice, sizeof(float), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, weights.data()
+    const size_t chunkCount = getChunkCount(mCount);
+
+    // Sum element weights per chunk, use double to minimize precision issues.
+    // Chunk sums are accumulated in order to keep the result deterministic.
+    std::vector<double> chunkWeightSums(chunkCount, 0.0);
+    forEachChunk(
+        mCount,
+        [&](size_t chunk, size_t begin, size_t end)
+        {
+            double sum = 0.0;
+            for (size_t i = begin; i < end; ++i)
+                sum += weights[i];
+            chunkWeightSums[chunk] = sum;
+        }
     );
+    mWeightSum = 0.0;
+    for (double sum : chunkWeightSums)
+        mWeightSum += sum;
 
-    // Our working set / intermediate buffers (underweight & overweight); initialize to "invalid"
-    std::vector<uint32_t> lowIdx(mCount, 0xFFFFFFFFu);
-    std::vector<uint32_t> highIdx(mCount, 0xFFFFFFFFu);
+    // Find the average weight. If there is no weight to distribute, all entries are sampled uniformly.
+    const double avgWeight = mWeightSum / double(mCount);
+    if (!(avgWeight > 0.0) || !std::isfinite(avgWeight))
+    {
+        forEachChunk(
+            mCount,
+            [&](size_t chunk, size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                    mItems[i] = {1.0f, (uint32_t)i, (uint32_t)i, 0};
+            }
+        );
+        return;
+    }
 
-    // Sum element weights, use double to minimize precision issues
-    mWeightSum = 0.0;
-    for (float f : weights)
-        mWeightSum += f;
+    auto getNormalizedWeight = [&](uint32_t index) { return double(weights[index]) / avgWeight; };
+    auto isLight = [&](size_t index) { return double(weights[index]) < avgWeight; };
+
+    // Count the light items in each chunk to find where each chunk writes into the light and heavy lists.
+    std::vector<size_t> chunkLightOffsets(chunkCount + 1, 0);
+    forEachChunk(
+        mCount,
+        [&](size_t chunk, size_t begin, size_t end)
+        {
+            size_t lightCount = 0;
+            for (size_t i = begin; i < end; ++i)
+                lightCount += isLight(i) ? 1 : 0;
+            chunkLightOffsets[chunk + 1] = lightCount;
+        }
+    );
+    std::vector<double> chunkLightBases(chunkCount, 0.0);
+    std::vector<double> chunkHeavyBases(chunkCount, 0.0);
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        chunkLightOffsets[chunk + 1] += chunkLightOffsets[chunk];
 
-    // Find the average weight
-    float avgWeight = float(mWeightSum / double(mCount));
+    const size_t lightCount = chunkLightOffsets[chunkCount];
+    const size_t heavyCount = mCount - lightCount;
 
-    // Initialize working set. Inset inputs into our lists of above-average or below-average weight elements.
-    int lowCount = 0;
-    int highCount = 0;
-    for (uint32_t i = 0; i < mCount; ++i)
+    // Build the light and heavy lists in index order along with the prefix sums of their normalized weights.
+    std::vector<uint32_t> lightIdx(lightCount);
+    std::vector<uint32_t> heavyIdx(heavyCount);
+    std::vector<double> lightPrefix(lightCount + 1, 0.0);
+    std::vector<double> heavyPrefix(heavyCount + 1, 0.0);
+    forEachChunk(
+        mCount,
+        [&](size_t chunk, size_t begin, size_t end)
+        {
+            size_t lightPos = chunkLightOffsets[chunk];
+            size_t heavyPos = begin - lightPos;
+            double lightSum = 0.0;
+            double heavySum = 0.0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (isLight(i))
+                {
+                    lightIdx[lightPos] = (uint32_t)i;
+                    lightSum += getNormalizedWeight((uint32_t)i);
+                    lightPrefix[++lightPos] = lightSum;
+                }
+                else
+                {
+                    heavyIdx[heavyPos] = (uint32_t)i;
+                    heavySum += getNormalizedWeight((uint32_t)i);
+                    heavyPrefix[++heavyPos] = heavySum;
+                }
+            }
+            chunkLightBases[chunk] = lightSum;
+            chunkHeavyBases[chunk] = heavySum;
+        }
+    );
+
+    // Turn the per-chunk prefix sums into global prefix sums.
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk)
     {
-        if (weights[i] < avgWeight)
-            lowIdx[lowCount++] = i;
-        else
-            highIdx[highCount++] = i;
+        chunkLightBases[chunk] += chunkLightBases[chunk - 1];
+        chunkHeavyBases[chunk] += chunkHeavyBases[chunk - 1];
     }
+    forEachChunk(
+        mCount,
+        [&](size_t chunk, size_t begin, size_t end)
+        {
+            if (chunk == 0)
+                return;
+            const size_t lightBegin = chunkLightOffsets[chunk];
+            const size_t lightEnd = chunkLightOffsets[chunk + 1];
+            for (size_t i = lightBegin; i < lightEnd; ++i)
+                lightPrefix[i + 1] += chunkLightBases[chunk - 1];
+            const size_t heavyBegin = begin - lightBegin;
+            const size_t heavyEnd = end - lightEnd;
+            for (size_t i = heavyBegin; i < heavyEnd; ++i)
+                heavyPrefix[i + 1] += chunkHeavyBases[chunk - 1];
+        }
+    );
 
-    // Create alias table entries by merging above- and below-average samples
-    std::vector<AliasTable::Item> items(mCount);
-    for (uint32_t i = 0; i < mCount; ++i)
+    // Find the sweep state at the start of each chunk of buckets.
+    struct SplitPoint
     {
-        // Usual case:  We have an above-average and below-average sample we can combine into one alias table entry
-        if ((lowIdx[i] != 0xFFFFFFFFu) && (highIdx[i] != 0xFFFFFFFFu))
+        size_t light; ///< Number of light items whose buckets are filled.
+        size_t heavy; ///< Number of heavy items whose buckets are filled.
+        double spill; ///< Weight of the current heavy item used by earlier buckets.
+    };
+
+    auto findSplit = [&](size_t bucketCount)
+    {
+        // f(a) = lightPrefix[a] + heavyPrefix[c - a] is non-increasing in a, find the smallest a with f(a) <= c.
+        const double c = double(bucketCount);
+        size_t lo = bucketCount > heavyCount ? bucketCount - heavyCount : 0;
+        size_t hi = std::min(bucketCount, lightCount);
+        while (lo < hi)
         {
-            // Create an alias table tuple:
-            items[i] = {weights[lowIdx[i]] / avgWeight, highIdx[i], lowIdx[i], 0};
-
-            // We've removed some weight from element highIdx[i]; update it's weight, then re-enter it
-            // on the end of either the above-average or below-average lists.
-            float updatedWeight = (weights[lowIdx[i]] + weights[highIdx[i]]) - avgWeight;
-            weights[highIdx[i]] = updatedWeight;
-            if (updatedWeight < avgWeight)
-                lowIdx[lowCount++] = highIdx[i];
+            size_t mid = lo + (hi - lo) / 2;
+            if (lightPrefix[mid] + heavyPrefix[bucketCount - mid] <= c)
+                hi = mid;
             else
-                highIdx[highCount++] = highIdx[i];
+                lo = mid + 1;
         }
+        const size_t heavy = bucketCount - lo;
+        return SplitPoint{lo, heavy, std::max(0.0, c - lightPrefix[lo] - heavyPrefix[heavy])};
+    };
 
-        // The next two cases can only occur towards the end of table creation, because either:
-        //    (a) all the remaining possible alias table entries have weight *exactly* equal to avgWeight,
-        //        which means these alias table entries only have one input item that is selected
-        //        with 100% probability
-        //    (b) all the remaining alias table entires have *almost* avgWeight, but due to (compounding)
-        //        precision issues throughout the process, they don't have *quite* that value.  In this case
-        //        treating these entries as having exactly avgWeight (as in case (a)) is the only right
-        //        thing to do mathematically (other than re-generating the alias table using higher precision
-        //        or trying to reduce catasrophic numerical cancellation in the "updatedWeight" computation above).
-        else if (highIdx[i] != 0xFFFFFFFFu)
-        {
-            items[i] = {1.0f, highIdx[i], highIdx[i], 0};
-        }
-        else if (lowIdx[i] != 0xFFFFFFFFu)
+    std::vector<SplitPoint> splits(chunkCount + 1);
+    splits[0] = {0, 0, 0.0};
+    splits[chunkCount] = {lightCount, heavyCount, 0.0};
+    forEachChunk(
+        chunkCount,
+        [&](size_t, size_t begin, size_t end)
         {
-            items[i] = {1.0f, lowIdx[i], lowIdx[i], 0};
+            for (size_t chunk = std::max(begin, size_t(1)); chunk < end; ++chunk)
+                splits[chunk] = findSplit(chunk * kChunkSize);
         }
+    );
 
-        // If there is neither a highIdx[i] or lowIdx[i] for some array element(s).  By construction,
-        // this cannot occur (without some logic bug above).
-        else
+    // Sweep all chunks of buckets independently.
+    forEachChunk(
+        mCount,
+        [&](size_t chunk, size_t, size_t)
         {
-            FALCOR_ASSERT(false); // Should not occur
-        }
-    }
+            const SplitPoint& first = splits[chunk];
+            const SplitPoint& last = splits[chunk + 1];
 
-    // TODO: We can simplify the alias table to implicitly store indexB (aka lowIdx[i]), so the AliasTable::Item
-    // structure would be 1 float + 1 uint32_t, rather than 128 bits.  This, of course, would change usage in shaders
-    // and elsewhere.  To do this, here you'd need to sort elements by indexB so that when looking up mpItems[j],
-    // indexB==j.  This works since, by construction, only one element in the table has indexB==j (for any j
-    // in [0...mCount-1]).  Alternatively, during the loop above, you could directly enter elements into the
-    // correct location in the alias table.
+            size_t i = first.light;
+            size_t j = first.heavy;
+            double w = j < heavyCount ? getNormalizedWeight(heavyIdx[j]) - first.spill : 0.0;
 
-    // Stash the alias table in our GPU buffer
-    mpItems = Buffer::createStructured(
-        pDevice, sizeof(AliasTable::Item), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, items.data()
+            while (i < last.light || j < last.heavy)
+            {
+                if (i < last.light && (j == last.heavy || w > 1.0))
+                {
+                    // Fill the bucket of the next light item using weight of the current heavy item.
+                    const uint32_t light = lightIdx[i++];
+                    if (j < heavyCount)
+                    {
+                        const double lightWeight = getNormalizedWeight(light);
+                        mItems[light] = {(float)lightWeight, heavyIdx[j], light, 0};
+                        w -= 1.0 - lightWeight;
+                    }
+                    else
+                    {
+                        mItems[light] = {1.0f, light, light, 0};
+                    }
+                }
+                else
+                {
+                    // The current heavy item has become light, fill its bucket using weight of the next heavy item.
+                    const uint32_t heavy = heavyIdx[j++];
+                    if (j < heavyCount)
+                    {
+                        mItems[heavy] = {(float)std::clamp(w, 0.0, 1.0), heavyIdx[j], heavy, 0};
+                        w = getNormalizedWeight(heavyIdx[j]) - (1.0 - w);
+                    }
+                    else
+                    {
+                        mItems[heavy] = {1.0f, heavy, heavy, 0};
+                    }
+                }
+            }
+        }
     );
 }
 
 void AliasTable::setShaderData(const ShaderVar& var) const
 {
+    checkInvariant(mpItems != nullptr, "Alias table was created without a device.");
+
     var["items"] = mpItems;
     var["weights"] = mpWeights;
     var["count"] = mCount;
     var["weightSum"] = (float)mWeightSum;
 }
 
+std::vector<double> AliasTable::computeProbabilities() const
+{
+    std::vector<double> probabilities(mCount, 0.0);
+    const double invCount = 1.0 / double(mCount);
+    for (const Item& item : mItems)
+    {
+        const double threshold = std::clamp((double)item.threshold, 0.0, 1.0);
+        probabilities[item.indexB] += threshold * invCount;
+        probabilities[item.indexA] += (1.0 - threshold) * invCount;
+    }
+    return probabilities;
+}
+
 } // namespace Falcor
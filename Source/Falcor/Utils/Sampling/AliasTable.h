@@ -29,32 +29,73 @@
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
 #include "Core/Program/ShaderVar.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <algorithm>
 #include <memory>
-#include <random>
+#include <vector>
 
 namespace Falcor
 {
 /**
  * Implements the alias method for sampling from a discrete probability distribution.
+ * The table is built on the CPU (in parallel for large inputs) and kept in host memory,
+ * so it can be sampled on the host as well as on the GPU.
  */
 class FALCOR_API AliasTable
 {
 public:
     /**
-     * Create an alias table.
+     * Create an alias table and upload it to the GPU.
      * The weights don't need to be normalized to sum up to 1.
      * @param[in] pDevice GPU device.
      * @param[in] weights The weights we'd like to sample each entry proportional to.
-     * @param[in] rng The random number generator to use when creating the table.
      */
-    AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt19937& rng);
+    AliasTable(ref<Device> pDevice, fstd::span<const float> weights);
+
+    /**
+     * Create a host-only alias table. No GPU resources are created, so the table
+     * can only be sampled with the host-side sample() functions.
+     * The weights don't need to be normalized to sum up to 1.
+     * @param[in] weights The weights we'd like to sample each entry proportional to.
+     */
+    explicit AliasTable(fstd::span<const float> weights);
 
     /**
      * Bind the alias table data to a given shader var.
+     * Throws if the table was created without a device.
      * @param[in] var The shader variable to set the data into.
      */
     void setShaderData(const ShaderVar& var) const;
 
+    /**
+     * Sample from the table proportional to the weights (host-side version of AliasTable.sample()).
+     * @param[in] index Uniform random index in [0..count).
+     * @param[in] rnd Uniform random number in [0..1).
+     * @return Returns the sampled item index.
+     */
+    uint32_t sample(uint32_t index, float rnd) const
+    {
+        const Item& item = mItems[index];
+        return rnd >= item.threshold ? item.indexA : item.indexB;
+    }
+
+    /**
+     * Sample from the table proportional to the weights (host-side version of AliasTable.sample()).
+     * @param[in] rnd Two uniform random numbers in [0..1).
+     * @return Returns the sampled item index.
+     */
+    uint32_t sample(float2 rnd) const
+    {
+        uint32_t index = std::min(mCount - 1, (uint32_t)(rnd.x * mCount));
+        return sample(index, rnd.y);
+    }
+
+    /**
+     * Get the original weight at a given index.
+     */
+    float getWeight(uint32_t index) const { return mWeights[index]; }
+
     /**
      * Get the number of weights in the table.
      */
@@ -65,7 +106,17 @@ public:
      */
     double getWeightSum() const { return mWeightSum; }
 
+    /**
+     * Compute the probability of sampling a given index from the table entries.
+     * This is the exact distribution realized by the table and can be compared against
+     * the normalized weights to validate the construction.
+     * @return Returns the per-index probabilities.
+     */
+    std::vector<double> computeProbabilities() const;
+
 private:
+    void build(fstd::span<const float> weights);
+
     // Item structure for the mpItems buffer.
     struct Item
     {
@@ -75,9 +126,11 @@ private:
         uint32_t _pad;
     };
 
-    uint32_t mCount;       ///< Number of items in the alias table.
-    double mWeightSum;     ///< Total weight of all elements used to create the alias table.
-    ref<Buffer> mpItems;   ///< Buffer containing table items.
-    ref<Buffer> mpWeights; ///< Buffer containing item weights.
+    uint32_t mCount = 0;         ///< Number of items in the alias table.
+    double mWeightSum = 0.0;     ///< Total weight of all elements used to create the alias table.
+    std::vector<Item> mItems;    ///< Table items (host copy).
+    std::vector<float> mWeights; ///< Item weights (host copy).
+    ref<Buffer> mpItems;         ///< Buffer containing table items.
+    ref<Buffer> mpWeights;       ///< Buffer containing item weights.
 };
 } // namespace Falcor
@@ -0,0 +1,185 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "HdrHistogram.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+uint32_t bitScanReverse64(uint64_t a)
+{
+    uint32_t hi = uint32_t(a >> 32);
+    return hi != 0 ? 32 + bitScanReverse(hi) : bitScanReverse(uint32_t(a));
+}
+} // namespace
+
+HdrHistogram::HdrHistogram(uint64_t highestTrackableValue, uint32_t significantDigits)
+    : mHighestTrackableValue(highestTrackableValue), mSignificantDigits(significantDigits)
+{
+    checkArgument(significantDigits >= 1 && significantDigits <= 5, "'significantDigits' must be in the range [1, 5].");
+    checkArgument(highestTrackableValue >= 2, "'highestTrackableValue' must be at least 2.");
+
+    // Values up to this limit are recorded with single unit resolution.
+    uint64_t largestValueWithSingleUnitResolution = 2;
+    for (uint32_t i = 0; i < significantDigits; ++i)
+        largestValueWithSingleUnitResolution *= 10;
+
+    uint32_t subBucketCountMagnitude = (uint32_t)std::ceil(std::log2((double)largestValueWithSingleUnitResolution));
+    mSubBucketHalfCountMagnitude = std::max(subBucketCountMagnitude, 1u) - 1;
+    uint64_t subBucketCount = uint64_t(1) << (mSubBucketHalfCountMagnitude + 1);
+    mSubBucketHalfCount = uint32_t(subBucketCount / 2);
+    mSubBucketMask = subBucketCount - 1;
+
+    // Each bucket doubles the covered value range.
+    uint64_t smallestUntrackableValue = subBucketCount;
+    mBucketCount = 1;
+    while (smallestUntrackableValue <= highestTrackableValue)
+    {
+        if (smallestUntrackableValue > std::numeric_limits<uint64_t>::max() / 2)
+        {
+            ++mBucketCount;
+            break;
+        }
+        smallestUntrackableValue <<= 1;
+        ++mBucketCount;
+    }
+
+    mCounts.resize(size_t(mBucketCount + 1) * mSubBucketHalfCount, 0);
+}
+
+void HdrHistogram::record(uint64_t value, uint64_t count)
+{
+    value = std::min(value, mHighestTrackableValue);
+    mCounts[getCountsIndex(value)] += count;
+    mTotalCount += count;
+    mMinValue = std::min(mMinValue, value);
+    mMaxValue = std::max(mMaxValue, value);
+    mSum += (double)value * (double)count;
+}
+
+void HdrHistogram::add(const HdrHistogram& other)
+{
+    checkArgument(
+        other.mHighestTrackableValue == mHighestTrackableValue && other.mSignificantDigits == mSignificantDigits,
+        "Histograms must have the same configuration."
+    );
+
+    for (size_t i = 0; i < mCounts.size(); ++i)
+        mCounts[i] += other.mCounts[i];
+    mTotalCount += other.mTotalCount;
+    mMinValue = std::min(mMinValue, other.mMinValue);
+    mMaxValue = std::max(mMaxValue, other.mMaxValue);
+    mSum += other.mSum;
+}
+
+void HdrHistogram::reset()
+{
+    std::fill(mCounts.begin(), mCounts.end(), 0);
+    mTotalCount = 0;
+    mMinValue = std::numeric_limits<uint64_t>::max();
+    mMaxValue = 0;
+    mSum = 0.0;
+}
+
+uint64_t HdrHistogram::getMin() const
+{
+    if (mTotalCount == 0)
+        return 0;
+    return getValueFromIndex(getCountsIndex(mMinValue));
+}
+
+uint64_t HdrHistogram::getMax() const
+{
+    if (mTotalCount == 0)
+        return 0;
+    return getHighestEquivalentValue(mMaxValue);
+}
+
+double HdrHistogram::getMean() const
+{
+    return mTotalCount == 0 ? 0.0 : mSum / (double)mTotalCount;
+}
+
+uint64_t HdrHistogram::getValueAtPercentile(double percentile) const
+{
+    if (mTotalCount == 0)
+        return 0;
+
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    uint64_t countAtPercentile = (uint64_t)std::ceil(percentile / 100.0 * (double)mTotalCount);
+    countAtPercentile = std::max(countAtPercentile, uint64_t(1));
+
+    uint64_t totalToCurrentIndex = 0;
+    for (size_t i = 0; i < mCounts.size(); ++i)
+    {
+        totalToCurrentIndex += mCounts[i];
+        if (totalToCurrentIndex >= countAtPercentile)
+            return std::min(getHighestEquivalentValue(getValueFromIndex(i)), getHighestEquivalentValue(mMaxValue));
+    }
+    return getMax();
+}
+
+uint32_t HdrHistogram::getBucketIndex(uint64_t value) const
+{
+    // Values in the first bucket map to bucket 0, then each bucket covers twice the range of the previous one.
+    uint32_t pow2Ceiling = bitScanReverse64(value | mSubBucketMask) + 1;
+    return pow2Ceiling - (mSubBucketHalfCountMagnitude + 1);
+}
+
+size_t HdrHistogram::getCountsIndex(uint64_t value) const
+{
+    uint32_t bucketIndex = getBucketIndex(value);
+    uint64_t subBucketIndex = value >> bucketIndex;
+    // Buckets above the first only use their upper half of sub-buckets, as the lower half is covered by the previous bucket.
+    return (size_t(bucketIndex + 1) << mSubBucketHalfCountMagnitude) + size_t(subBucketIndex - mSubBucketHalfCount);
+}
+
+uint64_t HdrHistogram::getValueFromIndex(size_t index) const
+{
+    int64_t bucketIndex = int64_t(index >> mSubBucketHalfCountMagnitude) - 1;
+    uint64_t subBucketIndex = (index & (mSubBucketHalfCount - 1)) + mSubBucketHalfCount;
+    if (bucketIndex < 0)
+    {
+        subBucketIndex -= mSubBucketHalfCount;
+        bucketIndex = 0;
+    }
+    return subBucketIndex << bucketIndex;
+}
+
+uint64_t HdrHistogram::getHighestEquivalentValue(uint64_t value) const
+{
+    uint32_t bucketIndex = getBucketIndex(value);
+    uint64_t lowestEquivalentValue = (value >> bucketIndex) << bucketIndex;
+    return lowestEquivalentValue + (uint64_t(1) << bucketIndex) - 1;
+}
+} // namespace Falcor
@@ -0,0 +1,118 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * High dynamic range histogram.
+ * Records integer values with a fixed number of significant decimal digits over a large range, using log-linear buckets. The memory
+ * footprint only depends on the value range and precision, not on the number of recorded values, which makes it suitable for tracking
+ * tail percentiles of long-running timing measurements.
+ * Values are recorded in integer units chosen by the user (e.g. nanoseconds for frame times).
+ */
+class FALCOR_API HdrHistogram
+{
+public:
+    /**
+     * Constructor.
+     * @param[in] highestTrackableValue Highest value that can be recorded. Larger values are clamped.
+     * @param[in] significantDigits Number of significant decimal digits to maintain (1-5).
+     */
+    HdrHistogram(uint64_t highestTrackableValue, uint32_t significantDigits = 3);
+
+    /**
+     * Record a value.
+     * @param[in] value Value to record. Values larger than the highest trackable value are clamped.
+     * @param[in] count Number of times to record the value.
+     */
+    void record(uint64_t value, uint64_t count = 1);
+
+    /**
+     * Add all values recorded in another histogram with the same configuration.
+     * @param[in] other Histogram to add.
+     */
+    void add(const HdrHistogram& other);
+
+    /**
+     * Remove all recorded values.
+     */
+    void reset();
+
+    uint64_t getTotalCount() const { return mTotalCount; }
+    uint64_t getHighestTrackableValue() const { return mHighestTrackableValue; }
+    uint32_t getSignificantDigits() const { return mSignificantDigits; }
+
+    /**
+     * Get the smallest recorded value (within the histogram precision), or 0 if no values were recorded.
+     */
+    uint64_t getMin() const;
+
+    /**
+     * Get the largest recorded value (within the histogram precision), or 0 if no values were recorded.
+     */
+    uint64_t getMax() const;
+
+    /**
+     * Get the mean of the recorded values, or 0 if no values were recorded.
+     */
+    double getMean() const;
+
+    /**
+     * Get the value at a given percentile.
+     * The returned value is the highest value that is equivalent (within the histogram precision) to the value such that the given
+     * percentage of all recorded values are less than or equal to it.
+     * @param[in] percentile Percentile in [0, 100].
+     * @return Returns the value at the percentile, or 0 if no values were recorded.
+     */
+    uint64_t getValueAtPercentile(double percentile) const;
+
+private:
+    uint32_t getBucketIndex(uint64_t value) const;
+    size_t getCountsIndex(uint64_t value) const;
+    uint64_t getValueFromIndex(size_t index) const;
+    uint64_t getHighestEquivalentValue(uint64_t value) const;
+
+    uint64_t mHighestTrackableValue;
+    uint32_t mSignificantDigits;
+    uint32_t mSubBucketHalfCountMagnitude; ///< Log2 of the number of linear sub-buckets in the upper half of each bucket.
+    uint32_t mSubBucketHalfCount;          ///< Number of linear sub-buckets in the upper half of each bucket.
+    uint64_t mSubBucketMask;               ///< Mask covering all sub-buckets of the first bucket.
+    uint32_t mBucketCount;                 ///< Number of exponential buckets.
+    std::vector<uint64_t> mCounts;         ///< Counts by sub-bucket index.
+    uint64_t mTotalCount = 0;
+    uint64_t mMinValue = std::numeric_limits<uint64_t>::max();
+    uint64_t mMaxValue = 0;
+    double mSum = 0.0;
+};
+} // namespace Falcor
@@ -31,7 +31,12 @@
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
 
+#include <fmt/format.h>
+
+#include <deque>
 #include <fstream>
+#include <iterator>
+#include <mutex>
 
 namespace Falcor
 {
@@ -46,6 +51,49 @@ const float kSigma = 0.98f;
 // for computing statistics (min, max, mean, stddev) over the recent history.
 const size_t kMaxHistorySize = 512;
 
+/// Process-wide registry of interned event names.
+struct NameRegistry
+{
+    std::mutex mutex;
+    std::unordered_map<std::string, Profiler::NameID> nameToID;
+    std::deque<std::string> names; ///< Names by ID. Using a deque so references stay valid.
+};
+
+NameRegistry& getNameRegistry()
+{
+    static NameRegistry registry;
+    return registry;
+}
+
+/// Returns a small process-wide index for the calling thread, used to assign trace events to threads.
+uint32_t getCurrentThreadIndex()
+{
+    static std::atomic<uint32_t> sNextThreadIndex{0};
+    thread_local uint32_t threadIndex = sNextThreadIndex.fetch_add(1);
+    return threadIndex;
+}
+
+void appendEscapedJson(fmt::memory_buffer& buffer, std::string_view str)
+{
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"':
+            fmt::format_to(std::back_inserter(buffer), "\\\"");
+            break;
+        case '\\':
+            fmt::format_to(std::back_inserter(buffer), "\\\\");
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+                fmt::format_to(std::back_inserter(buffer), "\\u{:04x}", (unsigned)c);
+            else
+                buffer.push_back(c);
+        }
+    }
+}
+
 pybind11::dict toPython(const Profiler::Stats& stats)
 {
     pybind11::dict d;
@@ -63,6 +111,8 @@ pybind11::dict toPython(const Profiler::Capture& capture)
 
     pyCapture["frame_count"] = capture.getFrameCount();
     pyCapture["events"] = pyEvents;
+    if (capture.hasTrace())
+        pyCapture["trace_event_count"] = capture.getTraceEvents().size();
 
     for (const auto& lane : capture.getLanes())
     {
@@ -175,7 +225,7 @@ void Profiler::Event::start(Profiler& profiler, uint32_t frameIndex)
     frameData.valid = false;
 }
 
-void Profiler::Event::end(uint32_t frameIndex)
+void Profiler::Event::end(uint32_t frameIndex, bool recordTrace)
 {
     if (--mTriggered != 0)
         return;
@@ -183,7 +233,10 @@ void Profiler::Event::end(uint32_t frameIndex)
     auto& frameData = mFrameData[frameIndex % 2];
 
     // Update CPU time.
-    frameData.cpuTotalTime += (float)CpuTimer::calcDuration(frameData.cpuStartTime, CpuTimer::getCurrentTimePoint());
+    CpuTimer::TimePoint cpuEndTime = CpuTimer::getCurrentTimePoint();
+    frameData.cpuTotalTime += (float)CpuTimer::calcDuration(frameData.cpuStartTime, cpuEndTime);
+    if (recordTrace)
+        frameData.cpuIntervals.push_back({frameData.cpuStartTime, cpuEndTime, getCurrentThreadIndex()});
 
     // Update GPU time.
     FALCOR_ASSERT(frameData.pActiveTimer != nullptr);
@@ -192,7 +245,7 @@ void Profiler::Event::end(uint32_t frameIndex)
     frameData.valid = true;
 }
 
-void Profiler::Event::endFrame(uint32_t frameIndex)
+void Profiler::Event::endFrame(uint32_t frameIndex, Capture* pCapture)
 {
     // Resolve GPU timers for the current frame measurements.
     // This is necessary before we readback of results next frame.
@@ -209,13 +262,31 @@ void Profiler::Event::endFrame(uint32_t frameIndex)
 
     // Skip update if there are no measurements last frame.
     if (!frameData.valid)
+    {
+        frameData.cpuIntervals.clear();
         return;
+    }
 
     mCpuTime = frameData.cpuTotalTime;
     mGpuTime = 0.f;
     for (size_t i = 0; i < frameData.currentTimer; ++i)
         mGpuTime += (float)frameData.pTimers[i]->getElapsedTime();
+
+    // Record the intervals of last frame in the trace.
+    if (pCapture && pCapture->hasTrace() && frameIndex > 0)
+    {
+        for (const auto& interval : frameData.cpuIntervals)
+            pCapture->recordCpuInterval(this, frameIndex - 1, interval);
+        for (size_t i = 0; i < frameData.currentTimer; ++i)
+        {
+            uint64_t start, end;
+            frameData.pTimers[i]->getTimestamps(start, end);
+            pCapture->recordGpuInterval(this, frameIndex - 1, start, end);
+        }
+    }
+
     frameData.cpuTotalTime = 0.f;
+    frameData.cpuIntervals.clear();
     frameData.currentTimer = 0;
 
     // Update EMA.
@@ -250,12 +321,79 @@ void Profiler::Capture::writeToFile(const std::filesystem::path& path) const
     ofs.write(json.data(), json.size());
 }
 
-Profiler::Capture::Capture(size_t reservedEvents, size_t reservedFrames) : mReservedFrames(reservedFrames)
+std::string Profiler::Capture::toChromeTraceString() const
+{
+    fmt::memory_buffer buffer;
+    auto out = std::back_inserter(buffer);
+
+    // Times in the Chrome trace event format are in microseconds.
+    fmt::format_to(out, "{{\"traceEvents\":[\n");
+    fmt::format_to(out, R"({{"name":"process_name","ph":"M","pid":1,"tid":0,"args":{{"name":"CPU"}}}},)""\n");
+    fmt::format_to(out, R"({{"name":"process_name","ph":"M","pid":2,"tid":0,"args":{{"name":"GPU"}}}},)""\n");
+    fmt::format_to(out, R"({{"name":"thread_name","ph":"M","pid":2,"tid":0,"args":{{"name":"Render queue"}}}})");
+
+    uint32_t threadCount = 0;
+    for (const auto& event : mTraceEvents)
+    {
+        if (event.threadIndex != kGpuThreadIndex)
+            threadCount = std::max(threadCount, event.threadIndex + 1);
+    }
+    for (uint32_t i = 0; i < threadCount; ++i)
+        fmt::format_to(out, ",\n" R"({{"name":"thread_name","ph":"M","pid":1,"tid":{0},"args":{{"name":"Thread {0}"}}}})", i);
+
+    for (size_t i = 0; i < mTraceFrameEndTimes.size(); ++i)
+    {
+        fmt::format_to(
+            out, ",\n" R"({{"name":"Frame {}","ph":"i","s":"p","pid":1,"tid":0,"ts":{:.3f}}})", i, mTraceFrameEndTimes[i] * 1000.0
+        );
+    }
+
+    for (const auto& event : mTraceEvents)
+    {
+        const std::string& path = mTraceEventNames[event.nameIndex];
+        std::string_view name = std::string_view(path).substr(path.find_last_of('/') + 1);
+        bool isGpu = event.threadIndex == kGpuThreadIndex;
+
+        fmt::format_to(out, ",\n" R"({{"name":")");
+        appendEscapedJson(buffer, name);
+        fmt::format_to(
+            out,
+            R"(","cat":"{}","ph":"X","pid":{},"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"path":")",
+            isGpu ? "gpu" : "cpu",
+            isGpu ? 2 : 1,
+            isGpu ? 0 : event.threadIndex,
+            event.start * 1000.0,
+            event.duration * 1000.0
+        );
+        appendEscapedJson(buffer, path);
+        fmt::format_to(out, R"(","frame":{}}}}})", event.frameIndex);
+    }
+
+    fmt::format_to(out, "\n],\"displayTimeUnit\":\"ms\"}}\n");
+    return fmt::to_string(buffer);
+}
+
+void Profiler::Capture::writeChromeTraceToFile(const std::filesystem::path& path) const
+{
+    auto json = toChromeTraceString();
+    std::ofstream ofs(path);
+    ofs.write(json.data(), json.size());
+}
+
+Profiler::Capture::Capture(size_t reservedEvents, size_t reservedFrames, bool recordTrace)
+    : mReservedFrames(reservedFrames), mRecordTrace(recordTrace)
 {
     // Speculativly allocate event record storage.
     mLanes.resize(reservedEvents * 2);
     for (auto& lane : mLanes)
         lane.records.reserve(reservedFrames);
+
+    if (mRecordTrace)
+    {
+        // Each event is recorded on both the CPU and GPU timeline.
+        mTraceEvents.reserve(reservedEvents * reservedFrames * 2);
+        mTraceFrameEndTimes.reserve(reservedFrames);
+    }
 }
 
 void Profiler::Capture::captureEvents(const std::vector<Event*>& events)
@@ -290,6 +428,50 @@ void Profiler::Capture::captureEvents(const std::vector<Event*>& events)
     ++mFrameCount;
 }
 
+double Profiler::Capture::toTraceTime(CpuTimer::TimePoint time) const
+{
+    return CpuTimer::calcDuration(mStartTime, time);
+}
+
+double Profiler::Capture::toTraceTime(uint64_t gpuTimestamp) const
+{
+    // Timestamps are unsigned, compute the signed difference to handle timestamps before the calibration point.
+    return (double)(int64_t)(gpuTimestamp - mStartGpuTimestamp) * mGpuTimestampPeriod;
+}
+
+uint32_t Profiler::Capture::getTraceEventNameIndex(const Event* pEvent)
+{
+    auto [it, inserted] = mTraceEventNameIndices.try_emplace(pEvent, (uint32_t)mTraceEventNames.size());
+    if (inserted)
+        mTraceEventNames.push_back(pEvent->getName());
+    return it->second;
+}
+
+void Profiler::Capture::recordCpuInterval(const Event* pEvent, uint32_t frameIndex, const Event::CpuInterval& interval)
+{
+    if (frameIndex < mStartFrameIndex)
+        return;
+
+    double start = toTraceTime(interval.start);
+    double end = toTraceTime(interval.end);
+    mTraceEvents.push_back({getTraceEventNameIndex(pEvent), interval.threadIndex, frameIndex - mStartFrameIndex, start, end - start});
+}
+
+void Profiler::Capture::recordGpuInterval(const Event* pEvent, uint32_t frameIndex, uint64_t startTimestamp, uint64_t endTimestamp)
+{
+    if (frameIndex < mStartFrameIndex)
+        return;
+
+    double start = toTraceTime(startTimestamp);
+    double end = toTraceTime(endTimestamp);
+    mTraceEvents.push_back({getTraceEventNameIndex(pEvent), kGpuThreadIndex, frameIndex - mStartFrameIndex, start, end - start});
+}
+
+void Profiler::Capture::recordFrameEnd(CpuTimer::TimePoint time)
+{
+    mTraceFrameEndTimes.push_back(toTraceTime(time));
+}
+
 void Profiler::Capture::finalize()
 {
     FALCOR_ASSERT(!mFinalized);
@@ -308,52 +490,90 @@ Profiler::Profiler(ref<Device> pDevice) : mpDevice(pDevice)
 {
     mpFence = GpuFence::create(mpDevice);
     mpFence->breakStrongReferenceToDevice();
+
+    mEventNodes.emplace_back(); // Root node.
+}
+
+Profiler::NameID Profiler::internName(std::string_view name)
+{
+    // '/' is used as a "path delimiter", so it cannot be used in the event name.
+    if (name.find('/') != std::string_view::npos)
+        return kInvalidNameID;
+
+    auto& registry = getNameRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto [it, inserted] = registry.nameToID.try_emplace(std::string(name), NameID(registry.names.size()));
+    if (inserted)
+        registry.names.push_back(it->first);
+    return it->second;
+}
+
+const std::string& Profiler::getInternedName(NameID nameID)
+{
+    auto& registry = getNameRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    FALCOR_ASSERT(nameID < registry.names.size());
+    return registry.names[nameID];
 }
 
 void Profiler::startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
 {
-    if (mEnabled && is_set(flags, Flags::Internal))
+    startEvent(pRenderContext, internName(name), flags);
+}
+
+void Profiler::startEvent(RenderContext* pRenderContext, NameID nameID, Flags flags)
+{
+    if (nameID == kInvalidNameID)
     {
-        // '/' is used as a "path delimiter", so it cannot be used in the event name.
-        if (name.find('/') != std::string::npos)
-        {
+        if (mEnabled && is_set(flags, Flags::Internal))
             logWarning("Profiler event names must not contain '/'. Ignoring this profiler event.");
-            return;
-        }
+        return;
+    }
 
-        mCurrentEventName = mCurrentEventName + "/" + name;
+    // The node caches the interned name, which avoids locking the name registry for debug events.
+    const std::string* pName = nullptr;
+    if (mEnabled && is_set(flags, Flags::Internal))
+    {
+        mCurrentNode = getChildNode(mCurrentNode, nameID);
 
-        Event* pEvent = getEvent(mCurrentEventName);
+        Event* pEvent = mEventNodes[mCurrentNode].pEvent;
+        pName = mEventNodes[mCurrentNode].pName;
         FALCOR_ASSERT(pEvent != nullptr);
         if (!mPaused)
             pEvent->start(*this, mFrameIndex);
 
-        if (std::find(mCurrentFrameEvents.begin(), mCurrentFrameEvents.end(), pEvent) == mCurrentFrameEvents.end())
+        if (pEvent->mRegisteredFrame != mFrameIndex)
         {
+            pEvent->mRegisteredFrame = mFrameIndex;
             mCurrentFrameEvents.push_back(pEvent);
         }
     }
     if (is_set(flags, Flags::Pix))
     {
         FALCOR_ASSERT(pRenderContext);
-        pRenderContext->getLowLevelData()->beginDebugEvent(name.c_str());
+        pRenderContext->getLowLevelData()->beginDebugEvent((pName ? *pName : getInternedName(nameID)).c_str());
     }
 }
 
 void Profiler::endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
 {
-    if (mEnabled && is_set(flags, Flags::Internal))
-    {
-        // '/' is used as a "path delimiter", so it cannot be used in the event name.
-        if (name.find('/') != std::string::npos)
-            return;
+    endEvent(pRenderContext, internName(name), flags);
+}
 
-        Event* pEvent = getEvent(mCurrentEventName);
-        FALCOR_ASSERT(pEvent != nullptr);
+void Profiler::endEvent(RenderContext* pRenderContext, NameID nameID, Flags flags)
+{
+    if (nameID == kInvalidNameID)
+        return;
+
+    // Ignore unbalanced calls, which happen when the profiler is enabled while an event is running.
+    if (mEnabled && is_set(flags, Flags::Internal) && mCurrentNode != kRootNode)
+    {
+        const EventNode& node = mEventNodes[mCurrentNode];
+        FALCOR_ASSERT(node.nameID == nameID);
         if (!mPaused)
-            pEvent->end(mFrameIndex);
+            node.pEvent->end(mFrameIndex, mpCapture && mpCapture->hasTrace());
 
-        mCurrentEventName.erase(mCurrentEventName.find_last_of("/"));
+        mCurrentNode = node.parent;
     }
 
     if (is_set(flags, Flags::Pix))
@@ -363,6 +583,32 @@ void Profiler::endEvent(RenderContext* pRenderContext, const std::string& name,
     }
 }
 
+uint32_t Profiler::getChildNode(uint32_t parent, NameID nameID)
+{
+    for (uint32_t child = mEventNodes[parent].firstChild; child != kInvalidNode; child = mEventNodes[child].nextSibling)
+    {
+        if (mEventNodes[child].nameID == nameID)
+            return child;
+    }
+
+    // Create the node on first use. The event name is the path of names from the root.
+    const std::string& internedName = getInternedName(nameID);
+    std::string name = parent == kRootNode ? std::string() : mEventNodes[parent].pEvent->getName();
+    name += "/" + internedName;
+
+    EventNode node;
+    node.nameID = nameID;
+    node.pName = &internedName;
+    node.parent = parent;
+    node.nextSibling = mEventNodes[parent].firstChild;
+    node.pEvent = getEvent(name);
+
+    uint32_t index = (uint32_t)mEventNodes.size();
+    mEventNodes.push_back(node);
+    mEventNodes[parent].firstChild = index;
+    return index;
+}
+
 Profiler::Event* Profiler::getEvent(const std::string& name)
 {
     auto event = findEvent(name);
@@ -382,7 +628,7 @@ void Profiler::endFrame(RenderContext* pRenderContext)
 
     for (Event* pEvent : mCurrentFrameEvents)
     {
-        pEvent->endFrame(mFrameIndex);
+        pEvent->endFrame(mFrameIndex, mpCapture.get());
     }
 
     // Flush and insert signal for synchronization of GPU timings.
@@ -390,16 +636,29 @@ void Profiler::endFrame(RenderContext* pRenderContext)
     mFenceValue = mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
 
     if (mpCapture)
+    {
         mpCapture->captureEvents(mCurrentFrameEvents);
+        if (mpCapture->hasTrace())
+            mpCapture->recordFrameEnd(CpuTimer::getCurrentTimePoint());
+    }
 
-    mLastFrameEvents = std::move(mCurrentFrameEvents);
+    // Swap the event lists to keep their storage allocated.
+    std::swap(mLastFrameEvents, mCurrentFrameEvents);
+    mCurrentFrameEvents.clear();
     ++mFrameIndex;
 }
 
-void Profiler::startCapture(size_t reservedFrames)
+void Profiler::startCapture(size_t reservedFrames, bool recordTrace)
 {
     setEnabled(true);
-    mpCapture = std::make_shared<Capture>(mLastFrameEvents.size(), reservedFrames);
+    mpCapture = std::make_shared<Capture>(mLastFrameEvents.size(), reservedFrames, recordTrace);
+
+    if (recordTrace)
+    {
+        mpCapture->mStartFrameIndex = mFrameIndex;
+        mpCapture->mGpuTimestampPeriod = mpDevice->getGpuTimestampFrequency();
+        calibrateGpuClock(mpCapture->mStartTime, mpCapture->mStartGpuTimestamp);
+    }
 }
 
 std::shared_ptr<Profiler::Capture> Profiler::endCapture()
@@ -416,6 +675,28 @@ bool Profiler::isCapturing() const
     return mpCapture != nullptr;
 }
 
+void Profiler::calibrateGpuClock(CpuTimer::TimePoint& cpuTime, uint64_t& gpuTimestamp)
+{
+    // There is no portable way of sampling the CPU and GPU clocks at the same time. Instead, we wait for the GPU to become idle,
+    // write a timestamp and wait for it to complete. The timestamp is assumed to be taken halfway between submit and completion.
+    RenderContext* pRenderContext = mpDevice->getRenderContext();
+    pRenderContext->flush(true);
+
+    ref<GpuTimer> pTimer = GpuTimer::create(mpDevice);
+    pTimer->breakStrongReferenceToDevice();
+    pTimer->begin();
+    pTimer->end();
+    pTimer->resolve();
+
+    CpuTimer::TimePoint submitTime = CpuTimer::getCurrentTimePoint();
+    pRenderContext->flush(true);
+    CpuTimer::TimePoint completeTime = CpuTimer::getCurrentTimePoint();
+
+    uint64_t start;
+    pTimer->getTimestamps(start, gpuTimestamp);
+    cpuTime = submitTime + (completeTime - submitTime) / 2;
+}
+
 Profiler::Event* Profiler::createEvent(const std::string& name)
 {
     auto pEvent = std::shared_ptr<Event>(new Event(name));
@@ -435,27 +716,40 @@ void Profiler::breakStrongReferenceToDevice()
 }
 
 ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags)
-    : mpRenderContext(pRenderContext), mName(name), mFlags(flags)
+    : ScopedProfilerEvent(pRenderContext, Profiler::internName(name), flags)
+{}
+
+ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, Profiler::NameID nameID, Profiler::Flags flags)
+    : mpRenderContext(pRenderContext), mNameID(nameID), mFlags(flags)
 {
     FALCOR_ASSERT(mpRenderContext);
-    mpRenderContext->getProfiler()->startEvent(mpRenderContext, mName, mFlags);
+    mpRenderContext->getProfiler()->startEvent(mpRenderContext, mNameID, mFlags);
 }
 
 ScopedProfilerEvent::~ScopedProfilerEvent()
 {
-    mpRenderContext->getProfiler()->endEvent(mpRenderContext, mName, mFlags);
+    mpRenderContext->getProfiler()->endEvent(mpRenderContext, mNameID, mFlags);
 }
 
 FALCOR_SCRIPT_BINDING(Profiler)
 {
     using namespace pybind11::literals;
 
-    auto endCapture = [](Profiler* pProfiler)
+    auto endCapture = [](Profiler* pProfiler, const std::filesystem::path& tracePath)
     {
         std::optional<pybind11::dict> result;
         auto pCapture = pProfiler->endCapture();
         if (pCapture)
+        {
             result = toPython(*pCapture);
+            if (!tracePath.empty())
+            {
+                if (!pCapture->hasTrace())
+                    logWarning("Profiler capture was not started with trace recording enabled. Not writing trace to '{}'.", tracePath);
+                else
+                    pCapture->writeChromeTraceToFile(tracePath);
+            }
+        }
         return result;
     };
 
@@ -464,7 +758,7 @@ FALCOR_SCRIPT_BINDING(Profiler)
     profiler.def_property("paused", &Profiler::isPaused, &Profiler::setPaused);
     profiler.def_property_readonly("is_capturing", &Profiler::isCapturing);
     profiler.def_property_readonly("events", [](const Profiler& profiler) { return toPython(profiler.getEvents()); });
-    profiler.def("start_capture", &Profiler::startCapture, "reserved_frames"_a = 1000);
-    profiler.def("end_capture", endCapture);
+    profiler.def("start_capture", &Profiler::startCapture, "reserved_frames"_a = 1000, "trace"_a = false);
+    profiler.def("end_capture", endCapture, "trace_path"_a = std::filesystem::path());
 }
 } // namespace Falcor
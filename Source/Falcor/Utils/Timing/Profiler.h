@@ -29,9 +29,11 @@
 #include "CpuTimer.h"
 #include "Core/Macros.h"
 #include "Core/API/GpuTimer.h"
+#include <atomic>
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -43,6 +45,8 @@ class RenderContext;
  * Container class for CPU/GPU profiling.
  * This class uses the most accurately available CPU and GPU timers to profile given events.
  * It automatically creates event hierarchies based on the order and nesting of the calls made.
+ * Event names are interned to integer IDs and the hierarchy is stored as a tree of name IDs, so starting and ending
+ * events with a known name ID does not build strings or allocate memory.
  * This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
  * ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
  */
@@ -58,6 +62,37 @@ public:
         Default = Internal | Pix
     };
 
+    /// ID of an interned event name.
+    using NameID = uint32_t;
+    static constexpr NameID kInvalidNameID = NameID(-1);
+
+    /**
+     * Per call site cache of an interned event name, used by the FALCOR_PROFILE macros.
+     * Names given as string literals (or other character arrays) are interned on first use only.
+     * Other names are interned on every call.
+     */
+    class NameCache
+    {
+    public:
+        template<size_t N>
+        NameID get(const char (&name)[N])
+        {
+            NameID nameID = mNameID.load(std::memory_order_relaxed);
+            if (nameID == kInvalidNameID)
+            {
+                nameID = internName(name);
+                mNameID.store(nameID, std::memory_order_relaxed);
+            }
+            return nameID;
+        }
+
+        NameID get(std::string_view name) const { return internName(name); }
+        NameID get(NameID nameID) const { return nameID; }
+
+    private:
+        std::atomic<NameID> mNameID{kInvalidNameID};
+    };
+
     struct Stats
     {
         float min;
@@ -68,6 +103,8 @@ public:
         static Stats compute(const float* data, size_t len);
     };
 
+    class Capture;
+
     class Event
     {
     public:
@@ -86,8 +123,8 @@ public:
         Event(const std::string& name);
 
         void start(Profiler& profiler, uint32_t frameIndex);
-        void end(uint32_t frameIndex);
-        void endFrame(uint32_t frameIndex);
+        void end(uint32_t frameIndex, bool recordTrace);
+        void endFrame(uint32_t frameIndex, Capture* pCapture);
 
         std::string mName; ///< Nested event name.
 
@@ -102,12 +139,21 @@ public:
         size_t mHistoryWriteIndex = 0;      ///< History write index.
         size_t mHistorySize = 0;            ///< History size.
 
-        uint32_t mTriggered = 0; ///< Keeping track of nested calls to start().
+        uint32_t mTriggered = 0;                  ///< Keeping track of nested calls to start().
+        uint32_t mRegisteredFrame = uint32_t(-1); ///< Frame index for which the event was last registered.
+
+        struct CpuInterval
+        {
+            CpuTimer::TimePoint start;
+            CpuTimer::TimePoint end;
+            uint32_t threadIndex;
+        };
 
         struct FrameData
         {
-            CpuTimer::TimePoint cpuStartTime; ///< Last event CPU start time.
-            float cpuTotalTime = 0.0;         ///< Total accumulated CPU time.
+            CpuTimer::TimePoint cpuStartTime;      ///< Last event CPU start time.
+            float cpuTotalTime = 0.0;              ///< Total accumulated CPU time.
+            std::vector<CpuInterval> cpuIntervals; ///< CPU intervals (only recorded when capturing a trace).
 
             std::vector<ref<GpuTimer>> pTimers; ///< Pool of GPU timers.
             size_t currentTimer = 0;            ///< Next GPU timer to use from the pool.
@@ -118,6 +164,7 @@ public:
         FrameData mFrameData[2]; ///< Double-buffered frame data to avoid GPU flushes.
 
         friend class Profiler;
+        friend class Capture;
     };
 
     class Capture
@@ -130,25 +177,73 @@ public:
             std::vector<float> records;
         };
 
-        Capture(size_t reservedEvents, size_t reservedFrames);
+        /// Interval of an event on the CPU or GPU timeline.
+        struct TraceEvent
+        {
+            uint32_t nameIndex;   ///< Index into the trace event names.
+            uint32_t threadIndex; ///< Index of the CPU thread, or kGpuThreadIndex for GPU intervals.
+            uint32_t frameIndex;  ///< Index of the frame since the start of the capture.
+            double start;         ///< Start time in milliseconds since the start of the capture.
+            double duration;      ///< Duration in milliseconds.
+        };
+
+        static constexpr uint32_t kGpuThreadIndex = uint32_t(-1);
+
+        Capture(size_t reservedEvents, size_t reservedFrames, bool recordTrace = false);
 
         size_t getFrameCount() const { return mFrameCount; }
         const std::vector<Lane>& getLanes() const { return mLanes; }
 
+        bool hasTrace() const { return mRecordTrace; }
+        const std::vector<TraceEvent>& getTraceEvents() const { return mTraceEvents; }
+        const std::vector<std::string>& getTraceEventNames() const { return mTraceEventNames; }
+        const std::vector<double>& getTraceFrameEndTimes() const { return mTraceFrameEndTimes; }
+
         std::string toJsonString() const;
         void writeToFile(const std::filesystem::path& path) const;
 
+        /**
+         * Convert the trace to the Chrome trace event format.
+         * The trace can be viewed in chrome://tracing or Perfetto. CPU threads and the GPU are shown as separate tracks.
+         * @return Returns the trace as a JSON string.
+         */
+        std::string toChromeTraceString() const;
+
+        /**
+         * Write the trace to a file in the Chrome trace event format.
+         * @param[in] path File path.
+         */
+        void writeChromeTraceToFile(const std::filesystem::path& path) const;
+
     private:
         void captureEvents(const std::vector<Event*>& events);
         void finalize();
 
+        double toTraceTime(CpuTimer::TimePoint time) const;
+        double toTraceTime(uint64_t gpuTimestamp) const;
+        uint32_t getTraceEventNameIndex(const Event* pEvent);
+        void recordCpuInterval(const Event* pEvent, uint32_t frameIndex, const Event::CpuInterval& interval);
+        void recordGpuInterval(const Event* pEvent, uint32_t frameIndex, uint64_t startTimestamp, uint64_t endTimestamp);
+        void recordFrameEnd(CpuTimer::TimePoint time);
+
         size_t mReservedFrames = 0;
         size_t mFrameCount = 0;
         std::vector<Event*> mEvents;
         std::vector<Lane> mLanes;
         bool mFinalized = false;
 
+        bool mRecordTrace = false;
+        uint32_t mStartFrameIndex = 0;                                     ///< Profiler frame index at the start of the capture.
+        CpuTimer::TimePoint mStartTime;                                    ///< CPU time at the start of the capture.
+        uint64_t mStartGpuTimestamp = 0;                                   ///< GPU timestamp corresponding to mStartTime.
+        double mGpuTimestampPeriod = 0.0;                                  ///< Milliseconds per GPU tick.
+        std::vector<TraceEvent> mTraceEvents;                              ///< Recorded CPU and GPU intervals.
+        std::vector<std::string> mTraceEventNames;                         ///< Event names referenced by the trace events.
+        std::unordered_map<const Event*, uint32_t> mTraceEventNameIndices; ///< Trace event name index by event.
+        std::vector<double> mTraceFrameEndTimes;                           ///< CPU time at the end of each frame.
+
         friend class Profiler;
+        friend class Event;
     };
 
     /**
@@ -156,6 +251,21 @@ public:
      */
     Profiler(ref<Device> pDevice);
 
+    /**
+     * Intern an event name.
+     * Names are interned process-wide, so name IDs can be cached and are valid for all profilers.
+     * @param[in] name The event name.
+     * @return Returns the name ID, or kInvalidNameID if the name contains '/'.
+     */
+    static NameID internName(std::string_view name);
+
+    /**
+     * Get an interned event name.
+     * @param[in] nameID The name ID.
+     * @return Returns the event name.
+     */
+    static const std::string& getInternedName(NameID nameID);
+
     /**
      * Check if the profiler is enabled.
      * @return Returns true if the profiler is enabled.
@@ -182,9 +292,13 @@ public:
 
     /**
      * Start profile capture.
+     * When recording a trace, the begin and end times of all CPU and GPU intervals are recorded in addition to the
+     * per-frame event times. The GPU clock is calibrated against the CPU clock when the capture starts, which waits for
+     * the GPU to become idle.
      * @param[in] reservedFrames Number of frames to reserve memory for.
+     * @param[in] recordTrace Record a trace of the CPU and GPU timelines.
      */
-    void startCapture(size_t reservedFrames = 1024);
+    void startCapture(size_t reservedFrames = 1024, bool recordTrace = false);
 
     /**
      * End profile capture.
@@ -212,6 +326,15 @@ public:
      */
     void startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
 
+    /**
+     * Start profiling a new event and update the events hierarchies.
+     * This does not allocate memory once the event has been created.
+     * @param[in] pRenderContext Render context for measuring GPU time.
+     * @param[in] nameID The interned event name.
+     * @param[in] flags The event flags.
+     */
+    void startEvent(RenderContext* pRenderContext, NameID nameID, Flags flags = Flags::Default);
+
     /**
      * Finish profiling a new event and update the events hierarchies.
      * @param[in] pRenderContext Render context for measuring GPU time.
@@ -220,6 +343,14 @@ public:
      */
     void endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
 
+    /**
+     * Finish profiling a new event and update the events hierarchies.
+     * @param[in] pRenderContext Render context for measuring GPU time.
+     * @param[in] nameID The interned event name.
+     * @param[in] flags The event flags.
+     */
+    void endEvent(RenderContext* pRenderContext, NameID nameID, Flags flags = Flags::Default);
+
     /**
      * Get the event, or create a new one if the event does not yet exist.
      * This is a public interface to facilitate more complicated construction of event names and finegrained control over the profiled
@@ -251,6 +382,35 @@ private:
      */
     Event* findEvent(const std::string& name);
 
+    /**
+     * Get a child node in the event tree, or create it if it does not yet exist.
+     * @param[in] parent Index of the parent node.
+     * @param[in] nameID The interned event name.
+     * @return Returns the index of the child node.
+     */
+    uint32_t getChildNode(uint32_t parent, NameID nameID);
+
+    /**
+     * Calibrate the GPU clock against the CPU clock.
+     * @param[out] cpuTime CPU time.
+     * @param[out] gpuTimestamp GPU timestamp corresponding to the CPU time.
+     */
+    void calibrateGpuClock(CpuTimer::TimePoint& cpuTime, uint64_t& gpuTimestamp);
+
+    /// Node in the event tree. The path of name IDs from the root identifies the event.
+    struct EventNode
+    {
+        NameID nameID = kInvalidNameID;
+        const std::string* pName = nullptr; ///< Interned name. Stays valid since interned names are never removed.
+        uint32_t parent = kInvalidNode;
+        uint32_t firstChild = kInvalidNode;
+        uint32_t nextSibling = kInvalidNode;
+        Event* pEvent = nullptr;
+    };
+
+    static constexpr uint32_t kRootNode = 0;
+    static constexpr uint32_t kInvalidNode = uint32_t(-1);
+
     BreakableReference<Device> mpDevice;
 
     bool mEnabled = false;
@@ -259,7 +419,8 @@ private:
     std::unordered_map<std::string, std::shared_ptr<Event>> mEvents; ///< Events by name.
     std::vector<Event*> mCurrentFrameEvents;                         ///< Events registered for current frame.
     std::vector<Event*> mLastFrameEvents;                            ///< Events from last frame.
-    std::string mCurrentEventName;                                   ///< Current nested event name.
+    std::vector<EventNode> mEventNodes;                              ///< Event tree. The first node is the root.
+    uint32_t mCurrentNode = kRootNode;                               ///< Current nested event node.
     uint32_t mCurrentLevel = 0;                                      ///< Current nesting level.
     uint32_t mFrameIndex = 0;                                        ///< Current frame index.
 
@@ -281,20 +442,27 @@ class FALCOR_API ScopedProfilerEvent
 {
 public:
     ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags = Profiler::Flags::Default);
+    ScopedProfilerEvent(RenderContext* pRenderContext, Profiler::NameID nameID, Profiler::Flags flags = Profiler::Flags::Default);
     ~ScopedProfilerEvent();
 
 private:
     RenderContext* mpRenderContext;
-    const std::string mName;
+    const Profiler::NameID mNameID;
     Profiler::Flags mFlags;
 };
 } // namespace Falcor
 
 #if FALCOR_ENABLE_PROFILER
-#define FALCOR_PROFILE(_pRenderContext, _name) \
-    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, _name)
-#define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags) \
-    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, _name, _flags)
+#define FALCOR_PROFILE(_pRenderContext, _name)                                        \
+    static Falcor::Profiler::NameCache FALCOR_CONCAT_STRINGS(_profileName, __LINE__); \
+    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(       \
+        _pRenderContext, FALCOR_CONCAT_STRINGS(_profileName, __LINE__).get(_name)     \
+    )
+#define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags)                             \
+    static Falcor::Profiler::NameCache FALCOR_CONCAT_STRINGS(_profileName, __LINE__);     \
+    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(           \
+        _pRenderContext, FALCOR_CONCAT_STRINGS(_profileName, __LINE__).get(_name), _flags \
+    )
 #else
 #define FALCOR_PROFILE(_pRenderContext, _name)
 #define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags)
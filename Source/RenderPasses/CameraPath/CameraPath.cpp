@@ -26,24 +26,107 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "CameraPath.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Math/Common.h"
 #include "Utils/Math/VectorMath.h"
+#include "Utils/NumericRange.h"
 
+#include <cstring>
+#include <execution>
 #include <fstream>
 
 extern "C" FALCOR_API_EXPORT void registerPlugin(Falcor::PluginRegistry& registry)
 {
     registry.registerClass<RenderPass, CameraPath>();
+    ScriptBindings::registerBinding(CameraPath::registerBindings);
+}
+
+namespace
+{
+    // Binary camera path format. A header is followed by the nodes, stored as float3 position, float3 target and double deltaT.
+    const char kBinaryExtension[] = ".fcpb";
+    const uint32_t kBinaryMagic = 0x42504346; // "FCPB"
+    const uint32_t kBinaryVersion = 1;
+
+    struct BinaryHeader
+    {
+        uint32_t magic = kBinaryMagic;
+        uint32_t version = kBinaryVersion;
+        uint64_t nodeCount = 0;
+    };
+    static_assert(sizeof(BinaryHeader) == 16);
+
+    // Serialized parameters
+    const char kReplay[] = "replay";
+    const char kFramesPerSegment[] = "framesPerSegment";
+    const char kInterpolation[] = "interpolation";
+    const char kLockAnimationTime[] = "lockAnimationTime";
+
+    /** Evaluate a Catmull-Rom spline through p1 and p2 using the Barry-Goldman formulation.
+        The knot spacing is the distance between the control points raised to the power alpha (0 = uniform, 0.5 = centripetal).
+    */
+    float3 evalCatmullRom(const float3& p0, const float3& p1, const float3& p2, const float3& p3, float t, float alpha)
+    {
+        // Coincident control points would result in zero knot intervals.
+        const float kMinKnotInterval = 1e-4f;
+        auto knotInterval = [&](const float3& a, const float3& b)
+        { return std::max(std::pow(math::length(b - a), alpha), kMinKnotInterval); };
+
+        float t0 = 0.f;
+        float t1 = t0 + knotInterval(p0, p1);
+        float t2 = t1 + knotInterval(p1, p2);
+        float t3 = t2 + knotInterval(p2, p3);
+        float u = math::lerp(t1, t2, t);
+
+        float3 a1 = (t1 - u) / (t1 - t0) * p0 + (u - t0) / (t1 - t0) * p1;
+        float3 a2 = (t2 - u) / (t2 - t1) * p1 + (u - t1) / (t2 - t1) * p2;
+        float3 a3 = (t3 - u) / (t3 - t2) * p2 + (u - t2) / (t3 - t2) * p3;
+        float3 b1 = (t2 - u) / (t2 - t0) * a1 + (u - t0) / (t2 - t0) * a2;
+        float3 b2 = (t3 - u) / (t3 - t1) * a2 + (u - t1) / (t3 - t1) * a3;
+        return (t2 - u) / (t2 - t1) * b1 + (u - t1) / (t2 - t1) * b2;
+    }
 }
 
 CameraPath::CameraPath(ref<Device> pDevice, const Properties& props)
     : RenderPass(pDevice)
 {
     mClock = Clock();
+
+    for (const auto& [key, value] : props)
+    {
+        if (key == kReplay) mReplay = value;
+        else if (key == kFramesPerSegment) mFramesPerSegment = std::max(1u, (uint32_t)value);
+        else if (key == kInterpolation) mInterpolation = value;
+        else if (key == kLockAnimationTime) mLockAnimationTime = value;
+        else logWarning("Unknown property '{}' in CameraPath properties.", key);
+    }
+}
+
+CameraPath::~CameraPath()
+{
+    releaseAnimationTime();
 }
 
 Properties CameraPath::getProperties() const
 {
-    return {};
+    Properties props;
+    props[kReplay] = mReplay;
+    props[kFramesPerSegment] = mFramesPerSegment;
+    props[kInterpolation] = mInterpolation;
+    props[kLockAnimationTime] = mLockAnimationTime;
+    return props;
+}
+
+void CameraPath::registerBindings(pybind11::module& m)
+{
+    using namespace pybind11::literals;
+
+    pybind11::class_<CameraPath, RenderPass, ref<CameraPath>> pass(m, "CameraPath");
+    pass.def("start", &CameraPath::startPath);
+    pass.def("stop", &CameraPath::stopPath);
+    pass.def("loadPath", [](CameraPath& cp, const std::filesystem::path& path) { return cp.loadCameraPathFromFile(path); }, "path"_a);
+    pass.def_property_readonly("replayFrame", [](const CameraPath& cp) { return cp.mReplayFrame; });
+    pass.def_property_readonly("replayFrameCount", &CameraPath::getReplayFrameCount);
 }
 
 RenderPassReflection CameraPath::reflect(const CompileData& compileData)
@@ -55,6 +138,8 @@ RenderPassReflection CameraPath::reflect(const CompileData& compileData)
 
 void CameraPath::setScene(RenderContext* pRenderContext, const ref<Scene>& pScene)
 {
+    releaseAnimationTime();
+    mUseCameraPath = false;
     mpScene = pScene;
     mpCamera = mpScene->getCamera();
 
@@ -62,7 +147,7 @@ void CameraPath::setScene(RenderContext* pRenderContext, const ref<Scene>& pScen
     std::string modelPath = mpScene->getPath().parent_path().string();     //Directory path
     for (const auto& entry : std::filesystem::directory_iterator(modelPath))
     {
-        if (entry.path().extension() == ".fcp")
+        if (entry.path().extension() == ".fcp" || entry.path().extension() == kBinaryExtension)
         {
             if (loadCameraPathFromFile(entry.path()))
                 break;
@@ -85,7 +170,10 @@ void CameraPath::execute(RenderContext* pRenderContext, const RenderData& render
     if (mCameraPath.empty() || !mUseCameraPath)
         return;
 
-    pathFrame();
+    if (mReplay)
+        replayFrame();
+    else
+        pathFrame();
 }
 
 void CameraPath::renderUI(Gui::Widgets& widget)
@@ -121,6 +209,18 @@ void CameraPath::renderUI(Gui::Widgets& widget)
     if (widget.button("Record Path", true))
         startRecording();
 
+    if (auto group = widget.group("Replay"))
+    {
+        if (group.checkbox("Deterministic Replay", mReplay) && !mReplay)
+            releaseAnimationTime();
+        group.tooltip("Steps a fixed number of frames per path segment instead of following the clock, so runs render the same frames.");
+        group.var("Frames per Segment", mFramesPerSegment, 1u, 1024u, 1u);
+        group.dropdown("Interpolation", mInterpolation);
+        if (group.checkbox("Lock Animation Time", mLockAnimationTime) && !mLockAnimationTime)
+            releaseAnimationTime();
+        group.tooltip("Sets the scene animation time to the recorded time of the current replay frame.");
+    }
+
     if (widget.button("Store Camera Path"))
     {
         std::filesystem::path storePath;
@@ -165,6 +265,8 @@ void CameraPath::renderUI(Gui::Widgets& widget)
 void CameraPath::pathUI(Gui::Widgets& widget)
 {
     widget.text("Current Node: " + std::to_string(mCurrentPathFrame));
+    if (mReplay)
+        widget.text("Replay Frame: " + std::to_string(mReplayFrame));
 
     if (auto group = widget.group("Clock", true))
     {
@@ -184,7 +286,8 @@ void CameraPath::pathUI(Gui::Widgets& widget)
             }
                 
 
-            group.var("Set Node", mCurrentPathFrame, size_t(0), mCameraPath.size()-1, 1u);
+            if (group.var("Set Node", mCurrentPathFrame, size_t(0), mCameraPath.size()-1, 1u) && mReplay)
+                mReplayFrame = uint64_t(mCurrentPathFrame) * mFramesPerSegment;
         }
         else
         {
@@ -201,7 +304,7 @@ void CameraPath::pathUI(Gui::Widgets& widget)
     widget.dummy("", float2(1, 10));
 
     if (widget.button("Stop"))
-        mUseCameraPath = false;
+        stopPath();
 }
 
 void CameraPath::startRecording() {
@@ -248,6 +351,115 @@ void CameraPath::startPath() {
     mNextFrameTime = mCameraPath[0].deltaT;
     mUseCameraPath = true;
     mClock.setTime(0); // Restart Clock
+
+    //Node times for the replay mode. The deltaT of a node is the time since the previous node.
+    mReplayFrame = 0;
+    mNodeTimes.resize(mCameraPath.size());
+    mNodeTimes[0] = 0.0;
+    for (size_t i = 1; i < mCameraPath.size(); i++)
+        mNodeTimes[i] = mNodeTimes[i - 1] + mCameraPath[i].deltaT;
+
+    //The scene is updated before the pass executes, so the animation time of the first replay frame is set here
+    if (mReplay)
+        lockAnimationTime();
+}
+
+void CameraPath::stopPath()
+{
+    mUseCameraPath = false;
+    releaseAnimationTime();
+}
+
+void CameraPath::releaseAnimationTime()
+{
+    //Only clear the override if it was set by this pass
+    if (mpScene && mAnimationTimeLocked)
+        mpScene->setAnimationTimeOverride(std::nullopt);
+    mAnimationTimeLocked = false;
+}
+
+CameraPath::CamPathData CameraPath::evalPath(size_t segment, float t) const
+{
+    FALCOR_ASSERT(segment + 1 < mCameraPath.size());
+    const CamPathData& n1 = mCameraPath[segment];
+    const CamPathData& n2 = mCameraPath[segment + 1];
+
+    CamPathData result;
+    result.deltaT = n2.deltaT;
+    if (mInterpolation == Interpolation::Linear)
+    {
+        result.position = math::lerp(n1.position, n2.position, t);
+        result.target = math::lerp(n1.target, n2.target, t);
+        return result;
+    }
+
+    //Mirror the neighboring nodes at the path ends
+    const float alpha = mInterpolation == Interpolation::Centripetal ? 0.5f : 0.f;
+    bool hasPrev = segment > 0;
+    bool hasNext = segment + 2 < mCameraPath.size();
+    const CamPathData& n0 = mCameraPath[hasPrev ? segment - 1 : segment];
+    const CamPathData& n3 = mCameraPath[hasNext ? segment + 2 : segment + 1];
+    float3 p0 = hasPrev ? n0.position : 2.f * n1.position - n2.position;
+    float3 p3 = hasNext ? n3.position : 2.f * n2.position - n1.position;
+    float3 t0 = hasPrev ? n0.target : 2.f * n1.target - n2.target;
+    float3 t3 = hasNext ? n3.target : 2.f * n2.target - n1.target;
+
+    result.position = evalCatmullRom(p0, n1.position, n2.position, p3, t, alpha);
+    result.target = evalCatmullRom(t0, n1.target, n2.target, t3, t, alpha);
+    return result;
+}
+
+uint64_t CameraPath::getReplayFrameCount() const
+{
+    return mCameraPath.size() <= 1 ? 0 : uint64_t(mCameraPath.size() - 1) * mFramesPerSegment + 1;
+}
+
+void CameraPath::getReplayPosition(uint64_t frame, size_t& segment, float& t) const
+{
+    //Frame i is at parameter (i % framesPerSegment) / framesPerSegment of segment i / framesPerSegment. The last frame is the last node.
+    //Frames past the end wrap around to the start of the path.
+    if (frame >= getReplayFrameCount())
+        frame = 0;
+
+    segment = std::min(size_t(frame / mFramesPerSegment), mCameraPath.size() - 2);
+    t = float(frame - uint64_t(segment) * mFramesPerSegment) / float(mFramesPerSegment);
+}
+
+void CameraPath::lockAnimationTime()
+{
+    if (!mLockAnimationTime || !mpScene || mCameraPath.size() <= 1)
+        return;
+
+    size_t segment;
+    float t;
+    getReplayPosition(mReplayFrame, segment, t);
+    mpScene->setAnimationTimeOverride(math::lerp(mNodeTimes[segment], mNodeTimes[segment + 1], double(t)));
+    mAnimationTimeLocked = true;
+}
+
+void CameraPath::replayFrame()
+{
+    if (mCameraPath.size() <= 1)
+        return;
+    if (mReplayFrame >= getReplayFrameCount())
+        mReplayFrame = 0;
+
+    size_t segment;
+    float t;
+    getReplayPosition(mReplayFrame, segment, t);
+    mCurrentPathFrame = segment;
+
+    CamPathData n = evalPath(segment, t);
+    mpCamera->setPosition(n.position);
+    mpCamera->setTarget(n.target);
+
+    //Hold the current frame while the clock is paused
+    if (!mClock.isPaused())
+        mReplayFrame++;
+
+    //The scene was already updated for this frame, so lock the animation time of the next frame.
+    //Scene::update() runs before the pass executes, so the geometry then matches the camera of the same frame.
+    lockAnimationTime();
 }
 
 void CameraPath::pathFrame() {
@@ -320,7 +532,10 @@ bool CameraPath::storeCameraPath(std::filesystem::path& path) {
         reportError(mStatus);
         return false;
     }
-           
+
+    if (path.extension() == kBinaryExtension)
+        return storeBinaryCameraPath(path);
+
     std::ofstream file(path.string(), std::ios::trunc);
 
     if (!file)
@@ -346,48 +561,117 @@ bool CameraPath::storeCameraPath(std::filesystem::path& path) {
     return true;
 }
 
-bool CameraPath::loadCameraPathFromFile(const std::filesystem::path& path) {
+bool CameraPath::storeBinaryCameraPath(const std::filesystem::path& path)
+{
+    static_assert(sizeof(CamPathData) == 32, "Binary camera path nodes are written directly from memory");
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        mStatus = "Could not store file at " + path.string();
+        reportError(mStatus);
+        return false;
+    }
+
+    BinaryHeader header;
+    header.nodeCount = mCameraPath.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(mCameraPath.data()), mCameraPath.size() * sizeof(CamPathData));
+    file.close();
+
+    if (!file)
+    {
+        mStatus = "Could not write file at " + path.string();
+        reportError(mStatus);
+        return false;
+    }
 
-    std::ifstream file(path.string());
+    mStatus = "File successfully stored at: " + path.string();
+    return true;
+}
 
-    if (!file.is_open())
+bool CameraPath::loadBinaryCameraPath(const std::filesystem::path& path, std::vector<CamPathData>& nodes)
+{
+    MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    if (!file.isOpen())
     {
         mStatus = "Could not open file";
         reportError(mStatus);
         return false;
     }
 
-    std::vector<CamPathData> readData;
+    BinaryHeader header;
+    if (file.getSize() >= sizeof(header))
+        std::memcpy(&header, file.getData(), sizeof(header));
+    if (file.getSize() < sizeof(header) || header.magic != kBinaryMagic || header.version != kBinaryVersion)
+    {
+        mStatus = "CameraPath file format error!";
+        reportError(mStatus);
+        return false;
+    }
 
-    std::string line;
-    while (std::getline(file, line))
+    if (header.nodeCount > (file.getSize() - sizeof(header)) / sizeof(CamPathData))
     {
-        std::vector<std::string> valuesStr;
-        std::stringstream ss(line);
-        std::string lineValue;
-        while (std::getline(ss, lineValue, ','))
-        {
-            valuesStr.push_back(lineValue);
-        }
+        mStatus = "CameraPath file is truncated!";
+        reportError(mStatus);
+        return false;
+    }
+
+    //The nodes are stored in the same layout as in memory
+    nodes.resize(header.nodeCount);
+    std::memcpy(nodes.data(), static_cast<const uint8_t*>(file.getData()) + sizeof(header), nodes.size() * sizeof(CamPathData));
+    return true;
+}
+
+bool CameraPath::loadCameraPathFromFile(const std::filesystem::path& path) {
+
+    std::vector<CamPathData> readData;
+    if (path.extension() == kBinaryExtension)
+    {
+        if (!loadBinaryCameraPath(path, readData))
+            return false;
+    }
+    else
+    {
+        std::ifstream file(path.string());
 
-        if (valuesStr.size() != 7)
+        if (!file.is_open())
         {
-            mStatus = "CameraPath file format error!";
+            mStatus = "Could not open file";
             reportError(mStatus);
             return false;
         }
 
-        //Create and fill node
-        CamPathData n;
-        n.position.x = std::stof(valuesStr[0]);
-        n.position.y = std::stof(valuesStr[1]);
-        n.position.z = std::stof(valuesStr[2]);
-        n.target.x = std::stof(valuesStr[3]);
-        n.target.y = std::stof(valuesStr[4]);
-        n.target.z = std::stof(valuesStr[5]);
-        n.deltaT = std::stod(valuesStr[6]);
-
-        readData.push_back(n);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::vector<std::string> valuesStr;
+            std::stringstream ss(line);
+            std::string lineValue;
+            while (std::getline(ss, lineValue, ','))
+            {
+                valuesStr.push_back(lineValue);
+            }
+
+            if (valuesStr.size() != 7)
+            {
+                mStatus = "CameraPath file format error!";
+                reportError(mStatus);
+                return false;
+            }
+
+            //Create and fill node
+            CamPathData n;
+            n.position.x = std::stof(valuesStr[0]);
+            n.position.y = std::stof(valuesStr[1]);
+            n.position.z = std::stof(valuesStr[2]);
+            n.target.x = std::stof(valuesStr[3]);
+            n.target.y = std::stof(valuesStr[4]);
+            n.target.z = std::stof(valuesStr[5]);
+            n.deltaT = std::stod(valuesStr[6]);
+
+            readData.push_back(n);
+        }
     }
 
     if (readData.size() <= 1)
@@ -397,7 +681,7 @@ bool CameraPath::loadCameraPathFromFile(const std::filesystem::path& path) {
         return false;
     }
 
-    mCameraPath = readData;
+    mCameraPath = std::move(readData);
     mRecordedFrames = mCameraPath.size() - 1;
 
     mStatus = "File with " + std::to_string(mRecordedFrames) + " nodes successfully loaded";
@@ -446,31 +730,39 @@ void CameraPath::smoothCameraPath() {
     for (uint32_t i = 0; i <= center; i++)
         weights[i] = weights[i] / sum;
 
-    //Loop over the camera path
-    const int offset = -int(center);
-    std::vector<CamPathData> smoothedData;
-    smoothedData.reserve(mCameraPath.size());
+    //Filter the path in parallel chunks. Each chunk reads a halo of center nodes on both sides from the unmodified backup,
+    //clamped at the ends of the path, so the result is identical to filtering the whole path at once.
+    const std::vector<CamPathData>& source = mCameraPathBackup;
+    const int64_t lastIndex = int64_t(source.size()) - 1;
+    std::vector<CamPathData> smoothedData(source.size());
 
-    for (int i = 0; i < mCameraPath.size(); i++)
+    auto filterChunk = [&](size_t chunk)
     {
-        CamPathData filtered;
-        filtered.position = mSmoothPosition ? float3(0) : mCameraPath[i].position;
-        filtered.target = mSmoothTarget ? float3(0) : mCameraPath[i].target;
-        filtered.deltaT = mCameraPath[i].deltaT;
-        for (int j = 0; j < int(mSmoothFilterSize); j++)
+        const int64_t begin = int64_t(chunk * kSmoothChunkSize);
+        const int64_t end = std::min(begin + int64_t(kSmoothChunkSize), lastIndex + 1);
+        for (int64_t i = begin; i < end; i++)
         {
-            int idx = std::clamp(i + offset + j, 0, int(mCameraPath.size() - 1));
-            int weightIdx = std::abs(offset + j);
-            if (mSmoothPosition)
-                filtered.position += mCameraPath[idx].position * weights[weightIdx];
-            if (mSmoothTarget)
-                filtered.target += mCameraPath[idx].target * weights[weightIdx];
+            CamPathData filtered;
+            filtered.position = mSmoothPosition ? float3(0) : source[i].position;
+            filtered.target = mSmoothTarget ? float3(0) : source[i].target;
+            filtered.deltaT = source[i].deltaT;
+            for (int64_t j = -int64_t(center); j <= int64_t(center); j++)
+            {
+                int64_t idx = std::clamp(i + j, int64_t(0), lastIndex);
+                float weight = weights[std::abs(j)];
+                if (mSmoothPosition)
+                    filtered.position += source[idx].position * weight;
+                if (mSmoothTarget)
+                    filtered.target += source[idx].target * weight;
+            }
+            smoothedData[i] = filtered;
         }
-        smoothedData.push_back(filtered);
-    }
+    };
+
+    NumericRange<size_t> chunks(0, div_round_up(source.size(), kSmoothChunkSize));
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(), filterChunk);
 
-    //Copy Vector
-    mCameraPath = smoothedData;
+    mCameraPath = std::move(smoothedData);
 
     mStatus = "Gaussian Smoothing successfully applied";
 }
@@ -40,6 +40,7 @@ public:
     static ref<CameraPath> create(ref<Device> pDevice, const Properties& props) { return make_ref<CameraPath>(pDevice, props); }
 
     CameraPath(ref<Device> pDevice, const Properties& props);
+    ~CameraPath();
 
     virtual Properties getProperties() const override;
     virtual RenderPassReflection reflect(const CompileData& compileData) override;
@@ -50,6 +51,23 @@ public:
     virtual bool onMouseEvent(const MouseEvent& mouseEvent) override { return false; }
     virtual bool onKeyEvent(const KeyboardEvent& keyEvent) override { return false; }
 
+    static void registerBindings(pybind11::module& m);
+
+    /** Interpolation between path nodes in replay mode.
+    */
+    enum class Interpolation : uint32_t
+    {
+        Linear,         ///< Linear interpolation between neighboring nodes.
+        CatmullRom,     ///< Uniform Catmull-Rom spline through the nodes.
+        Centripetal,    ///< Centripetal Catmull-Rom spline through the nodes. Avoids cusps and overshoot for unevenly spaced nodes.
+    };
+
+    FALCOR_ENUM_INFO(Interpolation, {
+        { Interpolation::Linear, "Linear" },
+        { Interpolation::CatmullRom, "CatmullRom" },
+        { Interpolation::Centripetal, "Centripetal" },
+    });
+
 private:
     struct CamPathData
     {
@@ -61,16 +79,29 @@ private:
     void startRecording();
     void recordFrame();
     void startPath();
+    void stopPath();
+    void releaseAnimationTime();
     void pathFrame();
+    void replayFrame();
+    uint64_t getReplayFrameCount() const;
+    void getReplayPosition(uint64_t frame, size_t& segment, float& t) const;
+    void lockAnimationTime();
+    CamPathData evalPath(size_t segment, float t) const;
     bool storeCameraPath(std::filesystem::path& path);
+    bool storeBinaryCameraPath(const std::filesystem::path& path);
     bool loadCameraPathFromFile(const std::filesystem::path& path);
+    bool loadBinaryCameraPath(const std::filesystem::path& path, std::vector<CamPathData>& nodes);
     void smoothCameraPath();
 
     void pathUI(Gui::Widgets & widget);
 
     const size_t kMaxSearchedFrames = 512;
     const size_t kMinSmoothSize = 30;
-    FileDialogFilterVec kCamPathFileFilters = {FileDialogFilter("fcp", "Faclor Camera Path File")};
+    const size_t kSmoothChunkSize = 4096;
+    FileDialogFilterVec kCamPathFileFilters = {
+        FileDialogFilter("fcpb", "Falcor Binary Camera Path File"),
+        FileDialogFilter("fcp", "Faclor Camera Path File"),
+    };
 
     ref<Scene> mpScene;     ///< Scene Reference Pointer
     ref<Camera> mpCamera;   ///< Camera Pointer
@@ -91,9 +122,20 @@ private:
 
     double mClockTimeScale = 1.0;       ///< Time scale for the clock
 
+    //Deterministic replay
+    bool mReplay = false;                                      ///< Step a fixed number of frames per segment instead of following the clock
+    uint32_t mFramesPerSegment = 1;                            ///< Number of replay frames per path segment
+    Interpolation mInterpolation = Interpolation::Centripetal; ///< Interpolation between path nodes in replay mode
+    bool mLockAnimationTime = true;                            ///< Lock the scene animation time to the replay frame
+    bool mAnimationTimeLocked = false;                         ///< True while the scene animation time override is set by this pass
+    uint64_t mReplayFrame = 0;                                 ///< Current replay frame
+    std::vector<double> mNodeTimes;                            ///< Recorded time of each path node, used as animation time in replay mode
+
     //Smoothing
     bool mSmoothTarget = true;
     bool mSmoothPosition = false;
     uint mSmoothFilterSize = 5;
     float mGaussSigma = 1.0f;
 };
+
+FALCOR_ENUM_REGISTER(CameraPath::Interpolation);
@@ -29,21 +29,103 @@
 
 #include <fstream>
 
+#include <nlohmann/json.hpp>
+
 #include "RenderGraph/RenderPassStandardFlags.h"
 
 extern "C" FALCOR_API_EXPORT void registerPlugin(Falcor::PluginRegistry& registry)
 {
     registry.registerClass<RenderPass, PathBenchmark>();
+    ScriptBindings::registerBinding(PathBenchmark::registerBindings);
+}
+
+namespace
+{
+// Serialized parameters
+const char kRelTolerance[] = "relTolerance";
+const char kAbsTolerance[] = "absTolerance";
+
+// Statistics columns. The percentiles are compared against the baseline.
+const char kCount[] = "count";
+const char kMean[] = "mean";
+const char kMin[] = "min";
+const char kMax[] = "max";
+const std::pair<const char*, double> kPercentiles[] = {{"p50", 50.0}, {"p90", 90.0}, {"p99", 99.0}, {"p99.9", 99.9}};
+
+uint64_t toNanoseconds(float ms)
+{
+    return (uint64_t)(std::max(ms, 0.f) * 1e6);
+}
+
+double toMilliseconds(double ns)
+{
+    return ns * 1e-6;
+}
+
+std::map<std::string, double> computeHistogramStats(const HdrHistogram& histogram)
+{
+    std::map<std::string, double> stats;
+    stats[kCount] = (double)histogram.getTotalCount();
+    stats[kMean] = toMilliseconds(histogram.getMean());
+    stats[kMin] = toMilliseconds((double)histogram.getMin());
+    for (const auto& [name, percentile] : kPercentiles)
+        stats[name] = toMilliseconds((double)histogram.getValueAtPercentile(percentile));
+    stats[kMax] = toMilliseconds((double)histogram.getMax());
+    return stats;
 }
 
+std::vector<const char*> getStatsColumns()
+{
+    std::vector<const char*> columns = {kCount, kMean, kMin};
+    for (const auto& [name, percentile] : kPercentiles)
+        columns.push_back(name);
+    columns.push_back(kMax);
+    return columns;
+}
+} // namespace
+
 PathBenchmark::PathBenchmark(ref<Device> pDevice, const Properties& props) : RenderPass(pDevice)
 {
     mpProfiler = mpDevice->getProfiler();
+
+    for (const auto& [key, value] : props)
+    {
+        if (key == kRelTolerance)
+            mRelTolerance = value;
+        else if (key == kAbsTolerance)
+            mAbsTolerance = value;
+        else
+            logWarning("Unknown property '{}' in PathBenchmark properties.", key);
+    }
 }
 
 Properties PathBenchmark::getProperties() const
 {
-    return {};
+    Properties props;
+    props[kRelTolerance] = mRelTolerance;
+    props[kAbsTolerance] = mAbsTolerance;
+    return props;
+}
+
+void PathBenchmark::registerBindings(pybind11::module& m)
+{
+    using namespace pybind11::literals;
+
+    pybind11::class_<PathBenchmark, RenderPass, ref<PathBenchmark>> pass(m, "PathBenchmark");
+    pass.def_property(
+        kRelTolerance,
+        [](const PathBenchmark& pb) { return pb.mRelTolerance; },
+        [](PathBenchmark& pb, float value) { pb.mRelTolerance = value; }
+    );
+    pass.def_property(
+        kAbsTolerance,
+        [](const PathBenchmark& pb) { return pb.mAbsTolerance; },
+        [](PathBenchmark& pb, float value) { pb.mAbsTolerance = value; }
+    );
+    pass.def("reset", &PathBenchmark::reset);
+    pass.def("computeStats", &PathBenchmark::computeStats);
+    pass.def("writeStats", &PathBenchmark::writeStats, "path"_a);
+    pass.def("compareToBaseline", &PathBenchmark::compareToBaseline, "path"_a);
 }
 
 RenderPassReflection PathBenchmark::reflect(const CompileData& compileData)
@@ -81,6 +163,12 @@ void PathBenchmark::execute(RenderContext* pRenderContext, const RenderData& ren
     const auto& events = mpProfiler->getEvents();
     for (const auto& e : events)
     {
+        // Record the per-frame times (not the running averages) to capture the tails of the distribution.
+        // Every frame is recorded, including frames that overwrite the last timestamp while the animation is paused.
+        auto& stats = mStats[e->getName()];
+        stats.cpuTime.record(toNanoseconds(e->getCpuTime()));
+        stats.gpuTime.record(toNanoseconds(e->getGpuTime()));
+
         if (!mEnabled[e->getName()])
             continue;
         auto& vec = mTimes[e->getName()];
@@ -192,6 +280,62 @@ void PathBenchmark::renderUI(Gui::Widgets& widget)
         if (saveFileDialog(filters, path))
             writeCsv(path.string());
     }
+
+    if (auto statsGroup = widget.group("Statistics"))
+    {
+        for (const auto& [name, stats] : mStats)
+        {
+            auto it = mEnabled.find(name);
+            if (it == mEnabled.end() || !it->second)
+                continue;
+
+            std::string text = getFilename(name);
+            for (const auto& [label, pHistogram] : {std::make_pair("CPU", &stats.cpuTime), std::make_pair("GPU", &stats.gpuTime)})
+            {
+                text += fmt::format("\n  {}:", label);
+                for (const auto& [percentileName, percentile] : kPercentiles)
+                    text += fmt::format(" {} {:.3f}", percentileName, toMilliseconds((double)pHistogram->getValueAtPercentile(percentile)));
+            }
+            statsGroup.text(text);
+        }
+
+        statsGroup.var("Relative tolerance", mRelTolerance, 0.f, 10.f, 0.01f);
+        statsGroup.tooltip("Relative tolerance of the baseline comparison.");
+        statsGroup.var("Absolute tolerance (ms)", mAbsTolerance, 0.f, 1000.f, 0.01f);
+        statsGroup.tooltip("Absolute tolerance of the baseline comparison in milliseconds.");
+
+        FileDialogFilterVec filters = {{"json"}, {"csv"}};
+        std::filesystem::path path;
+        if (statsGroup.button("Export stats") && saveFileDialog(filters, path))
+            writeStats(path);
+        if (statsGroup.button("Compare to baseline", true) && openFileDialog(filters, path))
+        {
+            try
+            {
+                compareToBaseline(path);
+            }
+            catch (const std::exception& e)
+            {
+                logError("PathBenchmark: {}", e.what());
+            }
+        }
+    }
+
+    // Record a trace of the CPU and GPU timelines for inspection in chrome://tracing or Perfetto.
+    if (!mpProfiler->isCapturing())
+    {
+        if (widget.button("Start trace", true))
+            mpProfiler->startCapture(1024, true);
+    }
+    else if (widget.button("Stop trace", true))
+    {
+        auto pCapture = mpProfiler->endCapture();
+        FileDialogFilterVec filters = {{"json", "Chrome trace"}};
+        std::filesystem::path path;
+        if (pCapture->hasTrace() && saveFileDialog(filters, path))
+            pCapture->writeChromeTraceToFile(path);
+    }
+    widget.tooltip("Records the CPU and GPU intervals of all profiler events and exports them in the Chrome trace event format.");
 }
 
 void PathBenchmark::setScene(RenderContext* pRenderContext, const ref<Scene>& pScene)
@@ -213,6 +357,143 @@ void PathBenchmark::reset()
 {
     mTimestamps.resize(0);
     mTimes.clear();
+    mStats.clear();
+}
+
+PathBenchmark::StatsTable PathBenchmark::computeStats() const
+{
+    StatsTable table;
+    for (const auto& [name, stats] : mStats)
+    {
+        table[name + "/cpu_time"] = computeHistogramStats(stats.cpuTime);
+        table[name + "/gpu_time"] = computeHistogramStats(stats.gpuTime);
+    }
+    return table;
+}
+
+void PathBenchmark::writeStats(const std::filesystem::path& path) const
+{
+    StatsTable table = computeStats();
+    auto columns = getStatsColumns();
+
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        logError("PathBenchmark: Could not open '{}' for writing.", path);
+        return;
+    }
+
+    if (hasExtension(path, "json"))
+    {
+        nlohmann::json json;
+        for (const auto& [lane, stats] : table)
+        {
+            for (const char* column : columns)
+                json[lane][column] = stats.at(column);
+        }
+        file << json.dump(2) << "\n";
+    }
+    else
+    {
+        file << "lane";
+        for (const char* column : columns)
+            file << "," << column;
+        file << "\n";
+
+        for (const auto& [lane, stats] : table)
+        {
+            file << lane;
+            for (const char* column : columns)
+                file << "," << fmt::format("{}", stats.at(column));
+            file << "\n";
+        }
+    }
+}
+
+PathBenchmark::StatsTable PathBenchmark::readStats(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+        throw RuntimeError("Could not open baseline '{}'.", path);
+
+    StatsTable table;
+    if (hasExtension(path, "json"))
+    {
+        nlohmann::json json = nlohmann::json::parse(file, nullptr, false);
+        if (json.is_discarded() || !json.is_object())
+            throw RuntimeError("Baseline '{}' is not a valid JSON object.", path);
+        for (const auto& [lane, stats] : json.items())
+        {
+            for (const auto& [column, value] : stats.items())
+            {
+                if (value.is_number())
+                    table[lane][column] = value.get<double>();
+            }
+        }
+    }
+    else
+    {
+        std::string line;
+        if (!std::getline(file, line))
+            throw RuntimeError("Baseline '{}' is empty.", path);
+        std::vector<std::string> columns = splitString(line, ',');
+
+        while (std::getline(file, line))
+        {
+            if (line.empty())
+                continue;
+            std::vector<std::string> values = splitString(line, ',');
+            if (values.size() != columns.size())
+                throw RuntimeError("Baseline '{}' has a malformed line '{}'.", path, line);
+            auto& stats = table[values[0]];
+            for (size_t i = 1; i < columns.size(); ++i)
+                stats[columns[i]] = std::stod(values[i]);
+        }
+    }
+    return table;
+}
+
+uint32_t PathBenchmark::compareToBaseline(const std::filesystem::path& path) const
+{
+    StatsTable baseline = readStats(path);
+    StatsTable current = computeStats();
+
+    uint32_t regressionCount = 0;
+    for (const auto& [lane, baselineStats] : baseline)
+    {
+        auto it = current.find(lane);
+        if (it == current.end())
+        {
+            logWarning("PathBenchmark: '{}' is in the baseline but was not recorded.", lane);
+            continue;
+        }
+
+        for (const auto& [name, percentile] : kPercentiles)
+        {
+            auto baselineValue = baselineStats.find(name);
+            if (baselineValue == baselineStats.end())
+                continue;
+
+            double value = it->second.at(name);
+            double threshold = baselineValue->second * (1.0 + mRelTolerance) + mAbsTolerance;
+            if (value > threshold)
+            {
+                logError(
+                    "PathBenchmark: Regression in '{}' {}: {:.3f} ms exceeds {:.3f} ms (baseline {:.3f} ms).",
+                    lane,
+                    name,
+                    value,
+                    threshold,
+                    baselineValue->second
+                );
+                ++regressionCount;
+            }
+        }
+    }
+
+    if (regressionCount == 0)
+        logInfo("PathBenchmark: No regressions compared to baseline '{}'.", path);
+    return regressionCount;
 }
 
 void PathBenchmark::writeCsv(const std::string& filename) const
@@ -28,6 +28,9 @@
 #pragma once
 #include "Falcor.h"
 #include "RenderGraph/RenderPass.h"
+#include "Utils/Timing/HdrHistogram.h"
+#include <filesystem>
+#include <map>
 
 using namespace Falcor;
 
@@ -49,13 +52,53 @@ public:
     virtual bool onMouseEvent(const MouseEvent& mouseEvent) override { return false; }
     virtual bool onKeyEvent(const KeyboardEvent& keyEvent) override { return false; }
 
-private:
+    static void registerBindings(pybind11::module& m);
+
+    /// Statistics (count, mean, min, percentiles, max) in milliseconds by profiler lane name ("<event>/cpu_time", "<event>/gpu_time").
+    using StatsTable = std::map<std::string, std::map<std::string, double>>;
+
     void reset();
+
+    /**
+     * Compute the CPU and GPU time statistics of all profiler events recorded since the last reset.
+     */
+    StatsTable computeStats() const;
+
+    /**
+     * Write the time statistics to a file. The format (CSV or JSON) is chosen based on the file extension.
+     * @param[in] path File path.
+     */
+    void writeStats(const std::filesystem::path& path) const;
+
+    /**
+     * Compare the time statistics to a baseline written by writeStats().
+     * A percentile regresses if it exceeds the baseline value by more than the relative and absolute tolerances.
+     * Regressions are logged as errors, so that scripts can fail a benchmark run with exit(1) if any are found.
+     * @param[in] path Baseline file path (CSV or JSON).
+     * @return Returns the number of regressed percentiles.
+     */
+    uint32_t compareToBaseline(const std::filesystem::path& path) const;
+
+private:
+    /// Per-frame CPU and GPU times of a profiler event in nanoseconds.
+    struct EventStats
+    {
+        static constexpr uint64_t kMaxTrackableTime = 60'000'000'000ull; ///< One minute.
+
+        HdrHistogram cpuTime{kMaxTrackableTime, 3};
+        HdrHistogram gpuTime{kMaxTrackableTime, 3};
+    };
+
     void writeCsv(const std::string& filename) const;
+    static StatsTable readStats(const std::filesystem::path& path);
 
     Profiler* mpProfiler = nullptr;
     std::unordered_map<std::string, bool> mEnabled;
     std::vector<float> mTimestamps; // timestamps corresponding to the values in mTimes
     std::unordered_map<std::string, std::vector<float>> mTimes;
+    std::map<std::string, EventStats> mStats; ///< Per-frame time statistics by event name.
     float mLastTime = 0.0;
+
+    float mRelTolerance = 0.05f; ///< Relative tolerance of the baseline comparison.
+    float mAbsTolerance = 0.05f; ///< Absolute tolerance of the baseline comparison in milliseconds.
 };
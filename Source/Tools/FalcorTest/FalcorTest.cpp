@@ -57,6 +57,16 @@ int main(int argc, char** argv)
     args::ValueFlag<uint32_t> repeatFlag(parser, "N", "Number of times to repeat the test.", {'r', "repeat"});
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::Flag enableAftermathFlag(parser, "", "Enable Aftermath GPU crash dump.", {"enable-aftermath"});
+    args::Flag benchmarkFlag(parser, "", "Run benchmarks with full measurements (otherwise they run a single iteration).", {"benchmark"});
+    args::ValueFlag<std::string> benchmarkReportFlag(parser, "path", "Benchmark JSON report output file.", {"benchmark-report"});
+    args::ValueFlag<std::string> benchmarkBaselineFlag(
+        parser, "path", "Benchmark JSON report to compare against. Regressions are reported as failures.", {"benchmark-baseline"}
+    );
+    args::ValueFlag<double> benchmarkToleranceFlag(
+        parser, "fraction", "Relative slowdown over the baseline reported as regression (default: 0.1).", {"benchmark-tolerance"}
+    );
+    args::ValueFlag<double> benchmarkMinTimeFlag(parser, "seconds", "Minimum measured time per benchmark.", {"benchmark-min-time"});
+    args::Flag benchmarkCountersFlag(parser, "", "Sample hardware counters in benchmarks (Linux only).", {"benchmark-counters"});
 
     args::CompletionFlag completionFlag(parser, {"complete"});
 
@@ -129,6 +139,25 @@ int main(int argc, char** argv)
     if (repeatFlag)
         options.repeat = args::get(repeatFlag);
 
+    if (benchmarkFlag)
+        options.benchmark.enabled = true;
+    if (benchmarkReportFlag)
+    {
+        options.benchmark.enabled = true;
+        options.benchmark.reportPath = args::get(benchmarkReportFlag);
+    }
+    if (benchmarkBaselineFlag)
+    {
+        options.benchmark.enabled = true;
+        options.benchmark.baselinePath = args::get(benchmarkBaselineFlag);
+    }
+    if (benchmarkToleranceFlag)
+        options.benchmark.tolerance = args::get(benchmarkToleranceFlag);
+    if (benchmarkMinTimeFlag)
+        options.benchmark.minTime = args::get(benchmarkMinTimeFlag);
+    if (benchmarkCountersFlag)
+        options.benchmark.hardwareCounters = true;
+
     if (listTestSuites || listTestCases || listTags)
     {
         std::vector<unittest::Test> tests = unittest::enumerateTests();
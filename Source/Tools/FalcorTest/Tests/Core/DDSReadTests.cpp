@@ -28,6 +28,7 @@
 #include "Testing/UnitTest.h"
 #include "Utils/Image/ImageIO.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include <fstream>
 
 namespace Falcor
 {
@@ -176,6 +177,27 @@ DDS_TEST(BC7UnormOdd, ResourceFormat::BC7Unorm);
 DDS_TEST(BC7UnormSrgb, ResourceFormat::BC7UnormSrgb);
 DDS_TEST(BC7UnormTiny, ResourceFormat::BC7Unorm);
 
+CPU_TEST(DDSReadBitmapMemoryMapped)
+{
+    // BC1Unorm.dds uses the legacy header (magic + DDS_HEADER) without the DX10 extension.
+    const std::filesystem::path ddsPath = getRuntimeDirectory() / "data/tests/BC1Unorm.dds";
+    const size_t headerSize = 4 + 124;
+
+    std::ifstream file(ddsPath, std::ios::binary);
+    std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ASSERT_GT(fileData.size(), headerSize);
+
+    // The bitmap references the image data in the mapped file instead of copying it.
+    Bitmap::UniqueConstPtr pBitmap = ImageIO::loadBitmapFromDDS(ddsPath);
+    ASSERT(pBitmap != nullptr);
+    EXPECT(pBitmap->isMemoryMapped());
+    EXPECT_EQ(pBitmap->getFormat(), ResourceFormat::BC1Unorm);
+    EXPECT_EQ(pBitmap->getWidth(), 256);
+    EXPECT_EQ(pBitmap->getHeight(), 256);
+    ASSERT_LE(headerSize + pBitmap->getSize(), fileData.size());
+    EXPECT(std::memcmp(pBitmap->getData(), fileData.data() + headerSize, pBitmap->getSize()) == 0);
+}
+
 GPU_TEST(BC7UnormBroken)
 {
     testDDS(ctx, std::string("BC7UnormBroken"), ResourceFormat::BC7Unorm, true);
@@ -0,0 +1,241 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+using MeshLightTriangle = LightCollection::MeshLightTriangle;
+
+/// Creates a synthetic many-emitter mesh: a bumpy grid of gridSize x gridSize quads with random flux.
+/// Every 16th triangle has zero flux to exercise culling with pre-integration.
+std::vector<MeshLightTriangle> createEmitterGrid(uint32_t gridSize)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+    auto getVertex = [&](uint32_t x, uint32_t y)
+    {
+        float fx = (float)x / gridSize, fy = (float)y / gridSize;
+        return float3(fx, 0.1f * std::sin(20.f * fx) * std::cos(15.f * fy), fy);
+    };
+
+    std::vector<MeshLightTriangle> triangles;
+    triangles.reserve(2 * gridSize * gridSize);
+    for (uint32_t y = 0; y < gridSize; ++y)
+    {
+        for (uint32_t x = 0; x < gridSize; ++x)
+        {
+            const float3 corners[4] = { getVertex(x, y), getVertex(x + 1, y), getVertex(x + 1, y + 1), getVertex(x, y + 1) };
+            for (uint32_t t = 0; t < 2; ++t)
+            {
+                MeshLightTriangle tri;
+                tri.vtx[0].pos = corners[0];
+                tri.vtx[1].pos = corners[t + 1];
+                tri.vtx[2].pos = corners[t + 2];
+                const float3 n = cross(tri.vtx[1].pos - tri.vtx[0].pos, tri.vtx[2].pos - tri.vtx[0].pos);
+                tri.area = 0.5f * length(n);
+                tri.normal = normalize(n);
+                tri.flux = triangles.size() % 16 == 0 ? 0.f : dist(rng);
+                triangles.push_back(tri);
+            }
+        }
+    }
+    return triangles;
+}
+
+struct BuildOutput
+{
+    std::vector<PackedNode> nodes;
+    std::vector<uint32_t> triangleIndices;
+    std::vector<uint64_t> triangleBitmasks;
+};
+
+BuildOutput build(const LightBVHBuilder::Options& options, const std::vector<MeshLightTriangle>& triangles)
+{
+    LightBVHBuilder builder(options);
+    BuildOutput output;
+    builder.buildNodes(triangles, output.nodes, output.triangleIndices, output.triangleBitmasks);
+    return output;
+}
+
+bool isEqual(const BuildOutput& a, const BuildOutput& b)
+{
+    return a.nodes.size() == b.nodes.size() && std::memcmp(a.nodes.data(), b.nodes.data(), a.nodes.size() * sizeof(PackedNode)) == 0 &&
+           a.triangleIndices == b.triangleIndices && a.triangleBitmasks == b.triangleBitmasks;
+}
+
+/// Checks that the tree references each emitting triangle exactly once and that the bitmasks retrace the path to each leaf.
+void validateTree(CPUUnitTestContext& ctx, const BuildOutput& output, const std::vector<MeshLightTriangle>& triangles)
+{
+    std::vector<uint32_t> referenceCount(triangles.size(), 0);
+    uint32_t visitedNodes = 0;
+
+    auto visit = [&](auto&& self, uint32_t nodeIndex, uint32_t depth, uint64_t bitmask) -> void
+    {
+        ASSERT(nodeIndex < output.nodes.size());
+        visitedNodes++;
+        const PackedNode& node = output.nodes[nodeIndex];
+        if (node.isLeaf())
+        {
+            const LeafNode leaf = node.getLeafNode();
+            ASSERT(leaf.triangleOffset + leaf.triangleCount <= output.triangleIndices.size());
+            for (uint32_t i = 0; i < leaf.triangleCount; ++i)
+            {
+                uint32_t triangleIndex = output.triangleIndices[leaf.triangleOffset + i];
+                referenceCount[triangleIndex]++;
+                EXPECT_EQ(output.triangleBitmasks[triangleIndex], bitmask);
+            }
+        }
+        else
+        {
+            const InternalNode internal = node.getInternalNode();
+            self(self, nodeIndex + 1, depth + 1, bitmask);
+            self(self, internal.rightChildIdx, depth + 1, bitmask | (1ull << depth));
+        }
+    };
+    visit(visit, 0, 0, 0);
+
+    EXPECT_EQ(visitedNodes, output.nodes.size());
+    for (size_t i = 0; i < triangles.size(); ++i)
+    {
+        EXPECT_EQ(referenceCount[i], triangles[i].flux > 0.f ? 1u : 0u) << "triangle " << i;
+    }
+}
+} // namespace
+
+CPU_TEST(LightBVHBuilder_ParallelMatchesSequential)
+{
+    const auto triangles = createEmitterGrid(192);
+
+    for (auto heuristic : {LightBVHBuilder::SplitHeuristic::Equal, LightBVHBuilder::SplitHeuristic::BinnedSAH, LightBVHBuilder::SplitHeuristic::BinnedSAOH})
+    {
+        LightBVHBuilder::Options options;
+        options.splitHeuristicSelection = heuristic;
+
+        options.useParallelBuild = false;
+        const BuildOutput sequential = build(options, triangles);
+        options.useParallelBuild = true;
+        const BuildOutput parallel = build(options, triangles);
+        const BuildOutput parallelAgain = build(options, triangles);
+
+        ASSERT(!parallel.nodes.empty());
+        EXPECT(isEqual(sequential, parallel)) << "heuristic " << (uint32_t)heuristic;
+        EXPECT(isEqual(parallel, parallelAgain)) << "heuristic " << (uint32_t)heuristic;
+        validateTree(ctx, parallel, triangles);
+    }
+}
+
+CPU_TEST(LightBVHBuilder_RefitUnchanged)
+{
+    const auto triangles = createEmitterGrid(64);
+
+    LightBVHBuilder::Options options;
+    LightBVHBuilder builder(options);
+    BuildOutput output = build(options, triangles);
+
+    // The first refit records the node costs.
+    std::vector<float> nodeCosts;
+    const auto initStats = builder.refitNodes(triangles, output.nodes, output.triangleIndices, output.triangleBitmasks, nodeCosts);
+    EXPECT_EQ(nodeCosts.size(), output.nodes.size());
+    EXPECT_EQ(initStats.getCostDelta(), 0.f);
+    EXPECT_GT(initStats.referenceCost, 0.f);
+
+    const BuildOutput refitted = output;
+    const auto stats = builder.refitNodes(triangles, output.nodes, output.triangleIndices, output.triangleBitmasks, nodeCosts);
+    EXPECT_EQ(stats.getCostDelta(), 0.f);
+    EXPECT_EQ(stats.finalCost, stats.refitCost);
+    EXPECT_EQ(stats.rebuiltSubtreeCount, 0u);
+    EXPECT(isEqual(output, refitted));
+}
+
+CPU_TEST(LightBVHBuilder_RefitRebuildsDegradedSubtrees)
+{
+    auto triangles = createEmitterGrid(64);
+
+    LightBVHBuilder::Options options;
+    LightBVHBuilder builder(options);
+    BuildOutput output = build(options, triangles);
+    std::vector<float> nodeCosts;
+    builder.refitNodes(triangles, output.nodes, output.triangleIndices, output.triangleBitmasks, nodeCosts);
+
+    // Scatter the triangles of the first rows of the grid over the whole grid.
+    std::mt19937 rng(567);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    const size_t movedCount = triangles.size() / 8;
+    for (size_t i = 0; i < movedCount; ++i)
+    {
+        const float3 offset = float3(dist(rng), 0.f, dist(rng));
+        for (auto& vtx : triangles[i].vtx) vtx.pos += offset;
+    }
+
+    // With rebuilding disabled, only the refit happens.
+    {
+        LightBVHBuilder::Options refitOnlyOptions = options;
+        refitOnlyOptions.rebuildCostThreshold = 0.f;
+        BuildOutput refitOnly = output;
+        std::vector<float> refitOnlyNodeCosts = nodeCosts;
+        const auto stats = LightBVHBuilder(refitOnlyOptions).refitNodes(triangles, refitOnly.nodes, refitOnly.triangleIndices, refitOnly.triangleBitmasks, refitOnlyNodeCosts);
+        EXPECT_GT(stats.getCostDelta(), 0.f);
+        EXPECT_EQ(stats.rebuiltSubtreeCount, 0u);
+        EXPECT_EQ(refitOnly.nodes.size(), output.nodes.size());
+    }
+
+    const auto stats = builder.refitNodes(triangles, output.nodes, output.triangleIndices, output.triangleBitmasks, nodeCosts);
+    EXPECT_GT(stats.getCostDelta(), 0.f);
+    EXPECT_GT(stats.rebuiltSubtreeCount, 0u);
+    EXPECT_LT(stats.rebuiltTriangleCount, (uint32_t)triangles.size()) << "expected a partial rebuild";
+    EXPECT_LT(stats.finalCost, stats.refitCost);
+    EXPECT_EQ(nodeCosts.size(), output.nodes.size());
+    validateTree(ctx, output, triangles);
+
+    // The rebuilt subtrees are the new reference, so refitting again doesn't rebuild anything.
+    const auto nextStats = builder.refitNodes(triangles, output.nodes, output.triangleIndices, output.triangleBitmasks, nodeCosts);
+    EXPECT_EQ(nextStats.rebuiltSubtreeCount, 0u);
+    EXPECT_LE(nextStats.refitCost, options.rebuildCostThreshold * nextStats.referenceCost);
+}
+
+CPU_BENCHMARK(LightBVHBuilder_Build)
+{
+    const auto triangles = createEmitterGrid(512);
+
+    LightBVHBuilder::Options options;
+    for (bool useParallelBuild : {false, true})
+    {
+        options.useParallelBuild = useParallelBuild;
+        ctx.measure(
+            fmt::format("{} build ({} triangles)", useParallelBuild ? "parallel" : "sequential", triangles.size()),
+            [&]() { ctx.doNotOptimize(build(options, triangles)); }
+        );
+    }
+}
+} // namespace Falcor
@@ -31,22 +31,18 @@
 #include <hypothesis/hypothesis.h>
 
 #include <iostream>
+#include <random>
 
 namespace Falcor
 {
 namespace
 {
-void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> specificWeights = {})
+std::vector<float> generateWeights(uint32_t N, std::mt19937& rng)
 {
-    ref<Device> pDevice = ctx.getDevice();
-
-    std::mt19937 rng;
     std::uniform_real_distribution<float> uniform;
-
-    // Use specificed weights or generate pseudo-random weights.
     std::vector<float> weights(N);
     for (uint32_t i = 0; i < N; ++i)
-        weights[i] = i < specificWeights.size() ? specificWeights[i] : uniform(rng);
+        weights[i] = uniform(rng);
 
     // Add a few zero weights.
     if (N >= 100)
@@ -54,9 +50,81 @@ void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> spec
         for (uint32_t i = 0; i < N / 100; ++i)
             weights[(size_t)(uniform(rng) * N)] = 0.f;
     }
+    return weights;
+}
+
+void testHostAliasTable(CPUUnitTestContext& ctx, const std::vector<float>& weights, uint32_t samplesPerWeight)
+{
+    const uint32_t N = (uint32_t)weights.size();
+    AliasTable aliasTable(weights);
+
+    double weightSum = 0.0;
+    for (const auto& weight : weights)
+        weightSum += weight;
+
+    EXPECT_EQ(aliasTable.getCount(), N);
+    EXPECT_LE(std::abs(aliasTable.getWeightSum() - weightSum), 1e-9 * weightSum);
+
+    // Verify that the distribution realized by the table entries matches the weights.
+    // Tables without any weight sample all entries uniformly.
+    std::vector<double> probabilities = aliasTable.computeProbabilities();
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        const double expected = weightSum > 0.0 ? weights[i] / weightSum : 1.0 / N;
+        EXPECT_LE(std::abs(probabilities[i] - expected), 1e-6 * expected + 1e-9) << "index " << i;
+        EXPECT_EQ(aliasTable.getWeight(i), weights[i]);
+    }
+
+    if (samplesPerWeight == 0)
+        return;
+
+    // Sample the table on the host and verify the histogram using a chi-square test.
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    std::vector<uint32_t> histogram(N, 0);
+    const uint64_t sampleCount = (uint64_t)N * samplesPerWeight;
+    for (uint64_t i = 0; i < sampleCount; ++i)
+    {
+        float2 u;
+        u.x = uniform(rng);
+        u.y = uniform(rng);
+        uint32_t item = aliasTable.sample(u);
+        ASSERT_LT(item, N);
+        histogram[item]++;
+    }
+
+    if (N == 1)
+    {
+        EXPECT_EQ(histogram[0], samplesPerWeight);
+        return;
+    }
+
+    std::vector<double> expFrequencies(N);
+    std::vector<double> obsFrequencies(N);
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        expFrequencies[i] = probabilities[i] * sampleCount;
+        obsFrequencies[i] = (double)histogram[i];
+    }
+    const auto& [success, report] =
+        hypothesis::chi2_test(N, obsFrequencies.data(), expFrequencies.data(), sampleCount, 5, 0.1);
+    if (!success)
+        std::cout << report << std::endl;
+    EXPECT(success);
+}
+
+void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> specificWeights = {})
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+
+    // Use specificed weights or generate pseudo-random weights.
+    std::vector<float> weights = specificWeights.empty() ? generateWeights(N, rng) : specificWeights;
 
     // Create alias table.
-    AliasTable aliasTable(pDevice, weights, rng);
+    AliasTable aliasTable(pDevice, weights);
 
     // Compute weight sum.
     double weightSum = 0.0;
@@ -146,4 +214,38 @@ GPU_TEST(AliasTable)
     testAliasTable(ctx, 100);
     testAliasTable(ctx, 1000);
 }
+
+CPU_TEST(AliasTable_HostSample)
+{
+    std::mt19937 rng;
+    testHostAliasTable(ctx, {1.f}, 10000);
+    testHostAliasTable(ctx, {1.f, 2.f}, 10000);
+    testHostAliasTable(ctx, {0.f, 0.f, 0.f}, 0);
+    testHostAliasTable(ctx, generateWeights(100, rng), 10000);
+    testHostAliasTable(ctx, generateWeights(1000, rng), 10000);
+}
+
+CPU_TEST(AliasTable_ParallelBuild)
+{
+    // Use enough weights to split the construction into many chunks.
+    std::mt19937 rng;
+    testHostAliasTable(ctx, generateWeights(200000, rng), 0);
+
+    // Skewed distribution with a few very heavy items, so heavy items span many chunks.
+    std::vector<float> weights = generateWeights(200000, rng);
+    for (uint32_t i = 0; i < 10; ++i)
+        weights[i * 19997] = 1e4f;
+    testHostAliasTable(ctx, weights, 0);
+
+    // Constant weights.
+    testHostAliasTable(ctx, std::vector<float>(100000, 0.5f), 0);
+}
+
+CPU_BENCHMARK(AliasTable_Build)
+{
+    std::mt19937 rng;
+    std::vector<float> weights = generateWeights(1 << 22, rng);
+
+    ctx.measure("4M weights", [&]() { ctx.doNotOptimize(AliasTable(weights).getCount()); });
+}
 } // namespace Falcor
@@ -0,0 +1,87 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+
+namespace Falcor
+{
+namespace
+{
+ref<Animation> createAnimation(uint32_t keyframeCount)
+{
+    ref<Animation> pAnimation = Animation::create("test", NodeID{0}, double(keyframeCount - 1));
+    for (uint32_t i = 0; i < keyframeCount; ++i)
+    {
+        Animation::Keyframe keyframe;
+        keyframe.time = double(i);
+        keyframe.translation = float3(float(i) * 10.f, 0.f, float(i % 2));
+        pAnimation->addKeyframe(keyframe);
+    }
+    return pAnimation;
+}
+} // namespace
+
+CPU_TEST(Animation_Linear)
+{
+    ref<Animation> pAnimation = createAnimation(4);
+
+    float4x4 transform = pAnimation->animate(0.0);
+    EXPECT_EQ(transform[0][3], 0.f);
+
+    transform = pAnimation->animate(1.5);
+    EXPECT_EQ(transform[0][3], 15.f);
+    EXPECT_EQ(transform[2][3], 0.5f);
+
+    // Constant behavior after the last keyframe.
+    transform = pAnimation->animate(10.0);
+    EXPECT_EQ(transform[0][3], 30.f);
+}
+
+CPU_BENCHMARK(Animation_Animate)
+{
+    for (auto mode : {Animation::InterpolationMode::Linear, Animation::InterpolationMode::Hermite})
+    {
+        ref<Animation> pAnimation = createAnimation(256);
+        pAnimation->setInterpolationMode(mode);
+
+        // Advance time in small steps as during playback, wrapping around at the end.
+        double time = 0.0;
+        const double duration = pAnimation->getDuration();
+        ctx.measure(
+            mode == Animation::InterpolationMode::Linear ? "Linear" : "Hermite",
+            [&]()
+            {
+                time += 1.0 / 60.0;
+                if (time > duration)
+                    time = 0.0;
+                ctx.doNotOptimize(pAnimation->animate(time));
+            }
+        );
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,288 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/CpuVertexAnimation.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+// Positions are exact fp32 math, normals and tangents go through fp16 and 2x16 octahedral packing.
+const float kPositionEpsilon = 1e-4f;
+const float kDirectionEpsilon = 2e-3f;
+
+struct SkinningTestData
+{
+    std::vector<PackedStaticVertexData> staticData;
+    std::vector<SkinningVertexData> skinningData;
+    std::vector<float4x4> boneMatrices;
+    std::vector<float4x4> invTransposeBoneMatrices;
+    std::vector<float4x4> worldMatrices;
+    std::vector<float4x4> invTransposeWorldMatrices;
+    std::vector<float4x4> meshBindMatrices;
+    std::vector<float4x4> meshInvBindMatrices;
+
+    CpuVertexAnimation::SkinningTransforms getTransforms() const
+    {
+        CpuVertexAnimation::SkinningTransforms transforms;
+        transforms.boneMatrices = boneMatrices;
+        transforms.inverseTransposeBoneMatrices = invTransposeBoneMatrices;
+        transforms.worldMatrices = worldMatrices;
+        transforms.inverseTransposeWorldMatrices = invTransposeWorldMatrices;
+        transforms.meshBindMatrices = meshBindMatrices;
+        transforms.meshInvBindMatrices = meshInvBindMatrices;
+        return transforms;
+    }
+};
+
+float4x4 randomTransform(std::mt19937& r)
+{
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    float4x4 m = math::matrixFromTranslation(float3(u(r), u(r), u(r)) * 10.f);
+    m = mul(m, math::matrixFromRotationXYZ(u(r) * 3.f, u(r) * 3.f, u(r) * 3.f));
+    m = mul(m, math::matrixFromScaling(float3(1.5f + u(r))));
+    return m;
+}
+
+StaticVertexData randomVertex(std::mt19937& r)
+{
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    StaticVertexData v = {};
+    v.position = float3(u(r), u(r), u(r)) * 5.f;
+    v.normal = normalize(float3(u(r), u(r), u(r)) + float3(0.f, 0.f, 2.f));
+    v.tangent = float4(normalize(float3(u(r), u(r), u(r)) + float3(2.f, 0.f, 0.f)), 1.f);
+    v.texCrd = float2(u(r), u(r));
+    return v;
+}
+
+SkinningTestData createSkinningTestData(uint32_t vertexCount, uint32_t boneCount, uint32_t seed)
+{
+    std::mt19937 r(seed);
+    SkinningTestData data;
+
+    for (uint32_t i = 0; i < boneCount; i++)
+    {
+        data.boneMatrices.push_back(randomTransform(r));
+        data.invTransposeBoneMatrices.push_back(transpose(inverse(data.boneMatrices.back())));
+        data.worldMatrices.push_back(randomTransform(r));
+        data.invTransposeWorldMatrices.push_back(transpose(inverse(data.worldMatrices.back())));
+        data.meshBindMatrices.push_back(randomTransform(r));
+        data.meshInvBindMatrices.push_back(inverse(data.meshBindMatrices.back()));
+    }
+
+    // Every other vertex is skinned. The rest must be left untouched.
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        data.staticData.push_back(PackedStaticVertexData(randomVertex(r)));
+        if (i % 2 == 1) continue;
+
+        SkinningVertexData s;
+        s.boneID = uint4(r() % boneCount, r() % boneCount, r() % boneCount, r() % boneCount);
+        s.boneWeight = float4(u(r), u(r), u(r), u(r));
+        s.boneWeight /= s.boneWeight.x + s.boneWeight.y + s.boneWeight.z + s.boneWeight.w;
+        s.staticIndex = i;
+        s.bindMatrixID = r() % boneCount;
+        s.skeletonMatrixID = r() % boneCount;
+        data.skinningData.push_back(s);
+    }
+
+    return data;
+}
+
+void compareVertices(CPUUnitTestContext& ctx, const PackedStaticVertexData& result, const PackedStaticVertexData& expected, size_t i)
+{
+    StaticVertexData a = result.unpack();
+    StaticVertexData b = expected.unpack();
+    float scale = std::max(1.f, length(b.position));
+    EXPECT_LE(length(a.position - b.position), kPositionEpsilon * scale) << "i = " << i;
+    EXPECT_LE(length(a.normal - b.normal), kDirectionEpsilon) << "i = " << i;
+    EXPECT_LE(length(a.tangent - b.tangent), kDirectionEpsilon) << "i = " << i;
+    EXPECT_EQ(a.texCrd, b.texCrd) << "i = " << i;
+}
+} // namespace
+
+CPU_TEST(CpuSkinning_RigidTransform)
+{
+    // With identity bind and skeleton matrices and all weights on bones with the same transform,
+    // skinning reduces to transforming the vertices by that transform.
+    const uint32_t vertexCount = 10000;
+    SkinningTestData data = createSkinningTestData(vertexCount, 4, 1);
+    std::mt19937 r(2);
+    float4x4 transform = randomTransform(r);
+    for (size_t i = 0; i < data.boneMatrices.size(); i++)
+    {
+        data.boneMatrices[i] = transform;
+        data.invTransposeBoneMatrices[i] = transpose(inverse(transform));
+        data.worldMatrices[i] = data.invTransposeWorldMatrices[i] = float4x4::identity();
+        data.meshBindMatrices[i] = data.meshInvBindMatrices[i] = float4x4::identity();
+    }
+
+    std::vector<PackedStaticVertexData> skinned = data.staticData;
+    std::vector<PrevVertexData> prev(data.skinningData.size());
+    CpuVertexAnimation::skinVertices(data.getTransforms(), data.skinningData, data.staticData, skinned, prev, false);
+
+    std::vector<PackedStaticVertexData> expected = data.staticData;
+    for (const auto& s : data.skinningData)
+    {
+        StaticVertexData v = data.staticData[s.staticIndex].unpack();
+        v.position = transformPoint(transform, v.position);
+        v.normal = normalize(transformVector(transpose(inverse(transform)), v.normal));
+        v.tangent = float4(normalize(transformVector(transform, v.tangent.xyz())), v.tangent.w);
+        expected[s.staticIndex].pack(v);
+    }
+
+    for (size_t i = 0; i < vertexCount; i++)
+        compareVertices(ctx, skinned[i], expected[i], i);
+
+    // Previous positions are the positions in the output buffer before skinning.
+    for (size_t i = 0; i < data.skinningData.size(); i++)
+        EXPECT_EQ(prev[i].position, data.staticData[data.skinningData[i].staticIndex].position) << "i = " << i;
+}
+
+CPU_TEST(CpuSkinning_InPlace)
+{
+    SkinningTestData data = createSkinningTestData(5000, 8, 3);
+
+    std::vector<PackedStaticVertexData> skinned = data.staticData;
+    CpuVertexAnimation::skinVertices(data.getTransforms(), data.skinningData, data.staticData, skinned);
+
+    std::vector<PackedStaticVertexData> inPlace = data.staticData;
+    CpuVertexAnimation::skinVertices(data.getTransforms(), data.skinningData, inPlace, inPlace);
+
+    for (size_t i = 0; i < skinned.size(); i++)
+        EXPECT(std::memcmp(&skinned[i], &inPlace[i], sizeof(PackedStaticVertexData)) == 0) << "i = " << i;
+}
+
+GPU_TEST(CpuSkinning_MatchesGpu)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const uint32_t vertexCount = 20000;
+    SkinningTestData data = createSkinningTestData(vertexCount, 16, 4);
+    const uint32_t skinnedCount = (uint32_t)data.skinningData.size();
+
+    ctx.createProgram("Scene/Animation/Skinning.slang", "main");
+    auto var = ctx["gData"];
+
+    auto createMatrixBuffer = [&](const std::vector<float4x4>& matrices)
+    {
+        return Buffer::createStructured(
+            pDevice, sizeof(float4x4), (uint32_t)matrices.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, matrices.data(), false
+        );
+    };
+
+    ref<Buffer> pSkinnedVertices = Buffer::createStructured(
+        pDevice, var["skinnedVertices"], vertexCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None,
+        data.staticData.data(), false
+    );
+    ref<Buffer> pPrevVertices = Buffer::createStructured(
+        pDevice, var["prevSkinnedVertices"], skinnedCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess,
+        Buffer::CpuAccess::None, nullptr, false
+    );
+
+    var["initPrev"] = true;
+    var["staticData"] = Buffer::createStructured(
+        pDevice, var["staticData"], vertexCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.staticData.data(), false
+    );
+    var["skinningData"] = Buffer::createStructured(
+        pDevice, var["skinningData"], skinnedCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.skinningData.data(), false
+    );
+    var["skinnedVertices"] = pSkinnedVertices;
+    var["prevSkinnedVertices"] = pPrevVertices;
+    var["boneMatrices"] = createMatrixBuffer(data.boneMatrices);
+    var["inverseTransposeBoneMatrices"] = createMatrixBuffer(data.invTransposeBoneMatrices);
+    var["worldMatrices"] = createMatrixBuffer(data.worldMatrices);
+    var["inverseTransposeWorldMatrices"] = createMatrixBuffer(data.invTransposeWorldMatrices);
+    var["meshBindMatrices"] = createMatrixBuffer(data.meshBindMatrices);
+    var["meshInvBindMatrices"] = createMatrixBuffer(data.meshInvBindMatrices);
+    ctx.runProgram(skinnedCount);
+
+    std::vector<PackedStaticVertexData> skinned = data.staticData;
+    std::vector<PrevVertexData> prev(skinnedCount);
+    CpuVertexAnimation::skinVertices(data.getTransforms(), data.skinningData, data.staticData, skinned, prev, true);
+
+    const PackedStaticVertexData* gpuSkinned = reinterpret_cast<const PackedStaticVertexData*>(pSkinnedVertices->map(Buffer::MapType::Read));
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        StaticVertexData a = gpuSkinned[i].unpack();
+        StaticVertexData b = skinned[i].unpack();
+        float scale = std::max(1.f, length(b.position));
+        EXPECT_LE(length(a.position - b.position), kPositionEpsilon * scale) << "i = " << i;
+        EXPECT_LE(length(a.normal - b.normal), kDirectionEpsilon) << "i = " << i;
+        EXPECT_LE(length(a.tangent - b.tangent), kDirectionEpsilon) << "i = " << i;
+    }
+    pSkinnedVertices->unmap();
+
+    const PrevVertexData* gpuPrev = reinterpret_cast<const PrevVertexData*>(pPrevVertices->map(Buffer::MapType::Read));
+    for (size_t i = 0; i < skinnedCount; i++)
+    {
+        float scale = std::max(1.f, length(prev[i].position));
+        EXPECT_LE(length(gpuPrev[i].position - prev[i].position), kPositionEpsilon * scale) << "i = " << i;
+    }
+    pPrevVertices->unmap();
+}
+
+CPU_TEST(CpuVertexAnimation_Interpolate)
+{
+    const uint32_t vertexCount = 10000;
+    std::mt19937 r(5);
+    std::vector<PackedStaticVertexData> keyframeA, keyframeB, vertices;
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        keyframeA.push_back(PackedStaticVertexData(randomVertex(r)));
+        keyframeB.push_back(PackedStaticVertexData(randomVertex(r)));
+        vertices.push_back(PackedStaticVertexData(randomVertex(r)));
+    }
+
+    for (float t : {0.f, 0.25f, 1.f})
+    {
+        std::vector<PackedStaticVertexData> result = vertices;
+        std::vector<PrevVertexData> prev(vertexCount);
+        CpuVertexAnimation::interpolateVertices(keyframeA, keyframeB, t, result, prev);
+
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            StaticVertexData a = keyframeA[i].unpack();
+            StaticVertexData b = keyframeB[i].unpack();
+            StaticVertexData v = result[i].unpack();
+
+            float scale = std::max(1.f, length(a.position) + length(b.position));
+            EXPECT_LE(length(v.position - lerp(a.position, b.position, t)), kPositionEpsilon * scale) << "t = " << t << ", i = " << i;
+            EXPECT_EQ(v.texCrd, vertices[i].texCrd) << "t = " << t << ", i = " << i;
+            EXPECT_EQ(prev[i].position, vertices[i].position) << "t = " << t << ", i = " << i;
+            if (t == 0.f)
+                EXPECT_LE(length(v.normal - a.normal), kDirectionEpsilon) << "i = " << i;
+            if (t == 1.f)
+                EXPECT_LE(length(v.normal - b.normal), kDirectionEpsilon) << "i = " << i;
+        }
+    }
+}
+
+} // namespace Falcor
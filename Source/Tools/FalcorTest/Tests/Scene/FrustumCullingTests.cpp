@@ -0,0 +1,83 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/FrustumCulling.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+FrustumCulling createFrustum()
+{
+    // Camera at the origin looking down the negative z-axis.
+    return FrustumCulling(float3(0.f), float3(0.f, 0.f, -1.f), float3(0.f, 1.f, 0.f), 1.f, math::radians(90.f), 0.1f, 100.f);
+}
+} // namespace
+
+CPU_TEST(FrustumCulling_IsInFrustum)
+{
+    FrustumCulling frustum = createFrustum();
+
+    EXPECT(frustum.isInFrustum(AABB(float3(-1.f, -1.f, -11.f), float3(1.f, 1.f, -9.f))));
+    // Partially inside.
+    EXPECT(frustum.isInFrustum(AABB(float3(-1.f, -1.f, -1.f), float3(1.f, 1.f, 1.f))));
+    // Behind the camera.
+    EXPECT(!frustum.isInFrustum(AABB(float3(-1.f, -1.f, 9.f), float3(1.f, 1.f, 11.f))));
+    // Beyond the far plane.
+    EXPECT(!frustum.isInFrustum(AABB(float3(-1.f, -1.f, -202.f), float3(1.f, 1.f, -200.f))));
+    // Outside of the side planes.
+    EXPECT(!frustum.isInFrustum(AABB(float3(20.f, -1.f, -11.f), float3(22.f, 1.f, -9.f))));
+    EXPECT(!frustum.isInFrustum(AABB(float3(-1.f, -22.f, -11.f), float3(1.f, -20.f, -9.f))));
+}
+
+CPU_BENCHMARK(FrustumCulling_IsInFrustumThroughput)
+{
+    FrustumCulling frustum = createFrustum();
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+    std::vector<AABB> boxes(4096);
+    for (auto& box : boxes)
+    {
+        float3 center(dist(rng), dist(rng), dist(rng));
+        box = AABB(center - float3(1.f), center + float3(1.f));
+    }
+
+    uint32_t visibleCount = 0;
+    ctx.measure(
+        "4096 boxes",
+        [&]()
+        {
+            for (const auto& box : boxes)
+                visibleCount += frustum.isInFrustum(box) ? 1 : 0;
+            ctx.doNotOptimize(visibleCount);
+        }
+    );
+}
+} // namespace Falcor
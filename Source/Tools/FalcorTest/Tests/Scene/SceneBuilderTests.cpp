@@ -0,0 +1,181 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Plugin.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Image/Bitmap.h"
+#include <cstring>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<ref<TriangleMesh>> createTestMeshes()
+{
+    std::vector<ref<TriangleMesh>> meshes = {
+        TriangleMesh::createQuad(),
+        TriangleMesh::createCube(),
+        TriangleMesh::createSphere(),
+        TriangleMesh::createDisk(1.f),
+        TriangleMesh::createSphere(1.f, 8, 4),
+    };
+    for (size_t i = 0; i < meshes.size(); ++i)
+        meshes[i]->setName("mesh" + std::to_string(i));
+    return meshes;
+}
+
+void addMeshInstances(SceneBuilder& builder, const std::vector<MeshID>& meshIDs)
+{
+    for (MeshID meshID : meshIDs)
+    {
+        NodeID nodeID = builder.addNode({"node", float4x4::identity(), float4x4::identity()});
+        builder.addMeshInstance(nodeID, meshID);
+    }
+}
+
+/// Writes a Python scene with a single quad using a textured material.
+void writeTexturedQuadScene(const std::filesystem::path& scenePath, const std::filesystem::path& texturePath)
+{
+    std::vector<uint8_t> texels(4 * 4 * 4, 0xff);
+    Bitmap::saveImage(
+        texturePath, 4, 4, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, texels.data()
+    );
+
+    std::ofstream file(scenePath);
+    file << "material = StandardMaterial('Textured')\n";
+    file << fmt::format("material.loadTexture(MaterialTextureSlot.BaseColor, r'{}')\n", texturePath.string());
+    file << "meshID = sceneBuilder.addTriangleMesh(TriangleMesh.createQuad(), material)\n";
+    file << "sceneBuilder.addMeshInstance(sceneBuilder.addNode('Quad'), meshID)\n";
+}
+
+template<typename T>
+bool equalBytes(const std::vector<T>& a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+} // namespace
+
+GPU_TEST(SceneBuilder_AddTriangleMeshes)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Add the same meshes one by one and as a batch.
+    SceneBuilder sequentialBuilder(pDevice, Settings());
+    auto pSequentialMaterial = StandardMaterial::create(pDevice, "Material");
+    std::vector<MeshID> sequentialIDs;
+    for (const auto& pMesh : createTestMeshes())
+        sequentialIDs.push_back(sequentialBuilder.addTriangleMesh(pMesh, pSequentialMaterial));
+
+    SceneBuilder batchBuilder(pDevice, Settings());
+    auto pBatchMaterial = StandardMaterial::create(pDevice, "Material");
+    std::vector<std::pair<ref<TriangleMesh>, ref<Material>>> batch;
+    for (const auto& pMesh : createTestMeshes())
+        batch.emplace_back(pMesh, pBatchMaterial);
+    std::vector<MeshID> batchIDs = batchBuilder.addTriangleMeshes(batch);
+
+    // Mesh IDs are assigned in input order.
+    ASSERT_EQ(batchIDs.size(), sequentialIDs.size());
+    for (size_t i = 0; i < batchIDs.size(); ++i)
+    {
+        EXPECT_EQ(sequentialIDs[i].get(), i);
+        EXPECT_EQ(batchIDs[i].get(), sequentialIDs[i].get());
+    }
+
+    // Both builders produce the same mesh data.
+    addMeshInstances(sequentialBuilder, sequentialIDs);
+    addMeshInstances(batchBuilder, batchIDs);
+    Scene::SceneData sequentialData = sequentialBuilder.getSceneData();
+    Scene::SceneData batchData = batchBuilder.getSceneData();
+
+    EXPECT(sequentialData.meshNames == batchData.meshNames);
+    EXPECT(equalBytes(sequentialData.meshDesc, batchData.meshDesc));
+    EXPECT(equalBytes(sequentialData.meshIndexData, batchData.meshIndexData));
+    EXPECT(equalBytes(sequentialData.meshStaticData, batchData.meshStaticData));
+}
+
+CPU_TEST(SceneBuilder_Headless)
+{
+    PluginManager::instance().loadPluginByName("PythonImporter");
+
+    const std::filesystem::path scenePath = getRuntimeDirectory() / "headless_scene.pyscene";
+    const std::filesystem::path texturePath = getRuntimeDirectory() / "headless_texture.png";
+    writeTexturedQuadScene(scenePath, texturePath);
+
+    // Headless builders use their own scene cache entries.
+    const SceneBuilder::Flags flags = SceneBuilder::Flags::Default | SceneBuilder::Flags::UseCache;
+    const std::filesystem::path fullPath = std::filesystem::canonical(scenePath);
+    const SceneCache::Key headlessKey = SceneBuilder::computeSceneCacheKey(fullPath, flags, true);
+    const SceneCache::Key deviceKey = SceneBuilder::computeSceneCacheKey(fullPath, flags, false);
+    EXPECT(headlessKey != deviceKey);
+    std::filesystem::remove(SceneCache::getCachePath(headlessKey));
+    std::filesystem::remove(SceneCache::getCachePath(deviceKey));
+
+    auto checkSceneData = [&](const Scene::SceneData& sceneData, const std::string& firstStage)
+    {
+        // Every build stage is recorded with its name.
+        ASSERT(!sceneData.buildStats.stages.empty());
+        EXPECT_EQ(sceneData.buildStats.stages[0].name, firstStage);
+        for (const auto& stage : sceneData.buildStats.stages)
+        {
+            EXPECT(!stage.name.empty());
+            EXPECT_GE(stage.timeInSeconds, 0.0);
+        }
+
+        EXPECT_EQ(sceneData.meshDesc.size(), 1);
+        ASSERT(sceneData.pMaterials != nullptr);
+        ASSERT_EQ(sceneData.pMaterials->getMaterialCount(), 1);
+
+        // Textures are referenced by path instead of being loaded.
+        const auto& pMaterial = sceneData.pMaterials->getMaterial(MaterialID(0));
+        EXPECT_EQ(pMaterial->getName(), "Textured");
+        EXPECT(pMaterial->getTexture(Material::TextureSlot::BaseColor) == nullptr);
+        EXPECT(pMaterial->getDeferredTexturePath(Material::TextureSlot::BaseColor) == std::filesystem::canonical(texturePath));
+    };
+
+    // Import the scene without a device. This writes the headless scene cache.
+    {
+        SceneBuilder builder(nullptr, scenePath, Settings(), flags);
+        EXPECT(builder.isHeadless());
+        checkSceneData(builder.getSceneData(), "import");
+    }
+    EXPECT(SceneCache::hasValidCache(headlessKey));
+    EXPECT(!SceneCache::hasValidCache(deviceKey));
+
+    // Import the scene again, which reads the headless scene cache.
+    {
+        SceneBuilder builder(nullptr, scenePath, Settings(), flags);
+        checkSceneData(builder.getSceneData(), "readCache");
+    }
+
+    std::filesystem::remove(SceneCache::getCachePath(headlessKey));
+    std::filesystem::remove(scenePath);
+    std::filesystem::remove(texturePath);
+}
+} // namespace Falcor
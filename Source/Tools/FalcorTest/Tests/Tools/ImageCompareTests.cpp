@@ -0,0 +1,120 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "ImageCompare/ImageMetrics.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 64;
+const uint32_t kHeight = 48;
+
+std::shared_ptr<ImageCompare::Image> createImage(float r, float g, float b)
+{
+    auto image = ImageCompare::Image::create(kWidth, kHeight);
+    float* data = image->getData();
+    for (size_t i = 0; i < size_t(kWidth) * kHeight; ++i)
+    {
+        data[i * 4 + 0] = r;
+        data[i * 4 + 1] = g;
+        data[i * 4 + 2] = b;
+        data[i * 4 + 3] = 1.f;
+    }
+    return image;
+}
+
+std::shared_ptr<ImageCompare::Image> createRandomImage(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist;
+    auto image = ImageCompare::Image::create(kWidth, kHeight);
+    float* data = image->getData();
+    for (size_t i = 0; i < size_t(kWidth) * kHeight * 4; ++i)
+        data[i] = dist(rng);
+    return image;
+}
+} // namespace
+
+CPU_TEST(ImageCompare_SSIMIdentical)
+{
+    auto image = createRandomImage(1);
+    std::vector<float> errorMap(size_t(kWidth) * kHeight);
+    EXPECT_LE(ImageCompare::evalSSIM(*image, *image, false, errorMap.data()), 1e-6);
+    EXPECT_LE(ImageCompare::evalSSIM(*image, *image, true, errorMap.data()), 1e-6);
+}
+
+CPU_TEST(ImageCompare_SSIMConstant)
+{
+    // For constant images the variances and the covariance vanish, so 1 - SSIM = 1 - (2ab + C1) / (a^2 + b^2 + C1).
+    // With a = 0.5, b = 0.25 and C1 = 0.01^2 this is 1 - 0.2501 / 0.3126 = 0.199936.
+    auto a = createImage(0.5f, 0.5f, 0.5f);
+    auto b = createImage(0.25f, 0.25f, 0.25f);
+    std::vector<float> errorMap(size_t(kWidth) * kHeight);
+    EXPECT_LE(std::abs(ImageCompare::evalSSIM(*a, *b, false, errorMap.data()) - 0.199936), 1e-4);
+    for (float error : errorMap)
+        EXPECT_LE(std::abs(error - 0.199936f), 1e-4f);
+}
+
+CPU_TEST(ImageCompare_FLIPIdentical)
+{
+    auto image = createRandomImage(2);
+    std::vector<float> errorMap(size_t(kWidth) * kHeight);
+    EXPECT_LE(ImageCompare::evalFLIP(*image, *image, false, errorMap.data()), 1e-6);
+    EXPECT_LE(ImageCompare::evalFLIP(*image, *image, true, errorMap.data()), 1e-6);
+}
+
+CPU_TEST(ImageCompare_FLIPBlackWhite)
+{
+    // Constant images have no features, so the error is given by the color pipeline alone. Black and white are at
+    // L* = 0 and L* = 100 with no chroma, so the HyAB distance is 100. With the maximum distance between green and
+    // blue of 41.2761 (after the 0.7 power), the redistributed error is
+    // 0.95 + (100^0.7 - 0.4 * 41.2761) / (0.6 * 41.2761) * 0.05 = 0.967380.
+    auto black = createImage(0.f, 0.f, 0.f);
+    auto white = createImage(1.f, 1.f, 1.f);
+    std::vector<float> errorMap(size_t(kWidth) * kHeight);
+    EXPECT_LE(std::abs(ImageCompare::evalFLIP(*black, *white, false, errorMap.data()) - 0.967380), 1e-3);
+    for (float error : errorMap)
+        EXPECT_LE(std::abs(error - 0.967380f), 1e-3f);
+}
+
+CPU_TEST(ImageCompare_HDRFLIPBlackReference)
+{
+    // A black reference has no luminance to derive the exposure range from, which must not hide the error.
+    auto black = createImage(0.f, 0.f, 0.f);
+    auto white = createImage(1.f, 1.f, 1.f);
+    std::vector<float> errorMap(size_t(kWidth) * kHeight);
+    double error = ImageCompare::evalFLIP(*black, *white, true, errorMap.data());
+    EXPECT(std::isfinite(error));
+    EXPECT_GE(error, 0.5);
+}
+} // namespace Falcor
@@ -0,0 +1,101 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/AABBReductionTree.h"
+
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+AABB randomBox(std::mt19937& r)
+{
+    std::uniform_real_distribution<float> u(-100.f, 100.f);
+    float3 p(u(r), u(r), u(r));
+    float3 q(u(r), u(r), u(r));
+    return AABB(min(p, q), max(p, q));
+}
+
+AABB computeReference(const std::vector<AABB>& leaves)
+{
+    AABB bounds;
+    for (const auto& leaf : leaves)
+        bounds |= leaf;
+    return bounds;
+}
+} // namespace
+
+CPU_TEST(AABBReductionTree_Empty)
+{
+    AABBReductionTree tree;
+    EXPECT_FALSE(tree.getBounds().valid());
+
+    tree.reset(0);
+    EXPECT_FALSE(tree.update());
+    tree.rebuild();
+    EXPECT_FALSE(tree.getBounds().valid());
+}
+
+CPU_TEST(AABBReductionTree_Randomized)
+{
+    for (size_t leafCount : {1, 2, 3, 17, 64, 1000})
+    {
+        std::mt19937 r(1234 + (uint32_t)leafCount);
+        std::vector<AABB> leaves(leafCount);
+        AABBReductionTree tree(leafCount);
+        for (size_t i = 0; i < leafCount; ++i)
+        {
+            leaves[i] = randomBox(r);
+            tree.setLeaf(i, leaves[i]);
+        }
+        tree.rebuild();
+        EXPECT(tree.getBounds() == computeReference(leaves)) << "leafCount = " << leafCount;
+
+        // Update a few leaves at a time, including shrinking boxes, and check against brute force.
+        for (int iter = 0; iter < 50; ++iter)
+        {
+            size_t changeCount = 1 + r() % 4;
+            for (size_t j = 0; j < changeCount; ++j)
+            {
+                size_t i = r() % leafCount;
+                leaves[i] = (r() % 2) ? randomBox(r) : AABB(leaves[i].center());
+                tree.setLeaf(i, leaves[i]);
+            }
+            tree.update();
+            EXPECT(tree.getBounds() == computeReference(leaves)) << "leafCount = " << leafCount << ", iter = " << iter;
+        }
+
+        // Setting an unchanged leaf should not require an update.
+        tree.setLeaf(0, leaves[0]);
+        EXPECT_FALSE(tree.update());
+    }
+}
+
+} // namespace Falcor
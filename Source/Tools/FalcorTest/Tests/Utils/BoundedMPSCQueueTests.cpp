@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/BoundedMPSCQueue.h"
+
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+CPU_TEST(BoundedMPSCQueue_Basic)
+{
+    BoundedMPSCQueue<int> queue(4);
+    EXPECT_EQ(queue.getCapacity(), 4);
+
+    int value = 0;
+    EXPECT_FALSE(queue.tryPop(value));
+
+    // Fill the queue, wrapping around twice.
+    for (int round = 0; round < 2; ++round)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            value = round * 4 + i;
+            EXPECT_TRUE(queue.tryPush(value));
+        }
+        value = -1;
+        EXPECT_FALSE(queue.tryPush(value));
+        EXPECT_EQ(value, -1);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            EXPECT_TRUE(queue.tryPop(value));
+            EXPECT_EQ(value, round * 4 + i);
+        }
+        EXPECT_FALSE(queue.tryPop(value));
+    }
+}
+
+CPU_TEST(BoundedMPSCQueue_MultipleProducers)
+{
+    const uint32_t kProducerCount = 4;
+    const uint32_t kValueCount = 100000;
+
+    // Elements are pushed by several producers and popped concurrently. Each producer's elements must arrive exactly once and in order.
+    BoundedMPSCQueue<uint64_t> queue(256);
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < kProducerCount; ++p)
+    {
+        producers.emplace_back(
+            [&queue, p]()
+            {
+                for (uint32_t i = 0; i < kValueCount; ++i)
+                {
+                    uint64_t value = (uint64_t(p) << 32) | i;
+                    while (!queue.tryPush(value))
+                        std::this_thread::yield();
+                }
+            }
+        );
+    }
+
+    std::vector<uint32_t> nextValue(kProducerCount, 0);
+    uint64_t popCount = 0;
+    bool inOrder = true;
+    while (popCount < uint64_t(kProducerCount) * kValueCount)
+    {
+        uint64_t value;
+        if (!queue.tryPop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t p = uint32_t(value >> 32);
+        uint32_t i = uint32_t(value);
+        if (p >= kProducerCount || i != nextValue[p])
+            inOrder = false;
+        else
+            ++nextValue[p];
+        ++popCount;
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+
+    EXPECT_TRUE(inOrder);
+    for (uint32_t p = 0; p < kProducerCount; ++p)
+        EXPECT_EQ(nextValue[p], kValueCount);
+    uint64_t value;
+    EXPECT_FALSE(queue.tryPop(value));
+}
+} // namespace Falcor
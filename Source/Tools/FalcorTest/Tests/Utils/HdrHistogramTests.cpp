@@ -0,0 +1,100 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/HdrHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace Falcor
+{
+CPU_TEST(HdrHistogram_Empty)
+{
+    HdrHistogram histogram(1000000);
+    EXPECT_EQ(histogram.getTotalCount(), 0);
+    EXPECT_EQ(histogram.getMin(), 0);
+    EXPECT_EQ(histogram.getMax(), 0);
+    EXPECT_EQ(histogram.getMean(), 0.0);
+    EXPECT_EQ(histogram.getValueAtPercentile(50.0), 0);
+}
+
+CPU_TEST(HdrHistogram_Linear)
+{
+    // Values below 2 * 10^digits are recorded exactly.
+    HdrHistogram histogram(1000, 3);
+    for (uint64_t i = 1; i <= 1000; ++i)
+        histogram.record(i);
+
+    EXPECT_EQ(histogram.getTotalCount(), 1000);
+    EXPECT_EQ(histogram.getMin(), 1);
+    EXPECT_EQ(histogram.getMax(), 1000);
+    EXPECT_EQ(histogram.getMean(), 500.5);
+    EXPECT_EQ(histogram.getValueAtPercentile(0.0), 1);
+    EXPECT_EQ(histogram.getValueAtPercentile(50.0), 500);
+    EXPECT_EQ(histogram.getValueAtPercentile(99.0), 990);
+    EXPECT_EQ(histogram.getValueAtPercentile(99.9), 999);
+    EXPECT_EQ(histogram.getValueAtPercentile(100.0), 1000);
+
+    // Values above the highest trackable value are clamped.
+    histogram.record(5000);
+    EXPECT_EQ(histogram.getMax(), 1000);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.getTotalCount(), 0);
+}
+
+CPU_TEST(HdrHistogram_Percentiles)
+{
+    // Frame times in nanoseconds, up to one hour.
+    HdrHistogram histogram(3600ull * 1000000000ull, 3);
+    HdrHistogram second(3600ull * 1000000000ull, 3);
+
+    std::mt19937_64 rng(1);
+    std::lognormal_distribution<double> dist(13.0, 1.0);
+    std::vector<uint64_t> values;
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        uint64_t value = (uint64_t)dist(rng);
+        values.push_back(value);
+        (i % 2 == 0 ? histogram : second).record(value);
+    }
+    histogram.add(second);
+    std::sort(values.begin(), values.end());
+
+    EXPECT_EQ(histogram.getTotalCount(), values.size());
+    for (double percentile : {0.0, 50.0, 90.0, 99.0, 99.9, 100.0})
+    {
+        size_t index = std::max<size_t>(1, (size_t)std::ceil(percentile / 100.0 * values.size())) - 1;
+        double exact = (double)values[index];
+        double value = (double)histogram.getValueAtPercentile(percentile);
+        // Three significant digits.
+        EXPECT_GE(value, exact) << "percentile = " << percentile;
+        EXPECT_LE(value, exact * 1.001) << "percentile = " << percentile;
+    }
+}
+} // namespace Falcor
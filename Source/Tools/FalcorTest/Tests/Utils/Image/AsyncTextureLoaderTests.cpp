@@ -0,0 +1,229 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncTextureLoader.h"
+#include "Utils/Image/Bitmap.h"
+
+namespace Falcor
+{
+namespace
+{
+std::vector<std::filesystem::path> writeTestImages(const std::string& prefix, uint32_t count)
+{
+    std::vector<std::filesystem::path> paths;
+    std::vector<uint8_t> data(16 * 16 * 4);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        std::fill(data.begin(), data.end(), (uint8_t)i);
+        auto path = getRuntimeDirectory() / fmt::format("{}{}.png", prefix, i);
+        Bitmap::saveImage(
+            path, 16, 16, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, data.data()
+        );
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+void removeFiles(const std::vector<std::filesystem::path>& paths)
+{
+    for (const auto& path : paths)
+        std::filesystem::remove(path);
+}
+
+/// Helper for blocking the single worker thread in a load callback until released.
+struct WorkerBlocker
+{
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseFuture = release.get_future().share();
+
+    AsyncTextureLoader::LoadCallback getCallback()
+    {
+        return [this](ref<Texture>)
+        {
+            started.set_value();
+            releaseFuture.wait();
+        };
+    }
+};
+} // namespace
+
+GPU_TEST(AsyncTextureLoader_Priority)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    auto paths = writeTestImages("async_priority_", 5);
+
+    std::vector<uint32_t> order;
+    std::mutex orderMutex;
+    {
+        AsyncTextureLoader loader(pDevice, 1);
+
+        // Block the worker so that all following requests are pending at the same time.
+        WorkerBlocker blocker;
+        loader.loadFromFile(paths[0], false, false, Resource::BindFlags::ShaderResource, blocker.getCallback());
+        blocker.started.get_future().wait();
+
+        std::vector<std::shared_ptr<AsyncTextureLoader::LoadToken>> tokens;
+        for (uint32_t i = 1; i < 5; ++i)
+        {
+            auto pToken = std::make_shared<AsyncTextureLoader::LoadToken>(float(i));
+            tokens.push_back(pToken);
+            loader.loadFromFile(
+                paths[i], false, false, Resource::BindFlags::ShaderResource,
+                [&, i](ref<Texture> pTexture)
+                {
+                    std::lock_guard<std::mutex> lock(orderMutex);
+                    order.push_back(i);
+                },
+                pToken
+            );
+        }
+        EXPECT_EQ(loader.getPendingRequestCount(), 4);
+
+        // Raise the priority of the first request after it was issued.
+        tokens[0]->setPriority(10.f);
+
+        blocker.release.set_value();
+    }
+
+    // Request 1 was raised to the highest priority, the others load in order of decreasing priority.
+    const std::vector<uint32_t> expected = {1, 4, 3, 2};
+    EXPECT(order == expected);
+
+    removeFiles(paths);
+}
+
+GPU_TEST(AsyncTextureLoader_Cancel)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    auto paths = writeTestImages("async_cancel_", 3);
+
+    AsyncTextureLoader loader(pDevice, 1);
+
+    WorkerBlocker blocker;
+    loader.loadFromFile(paths[0], false, false, Resource::BindFlags::ShaderResource, blocker.getCallback());
+    blocker.started.get_future().wait();
+
+    // Two requests share a token and are cancelled together, the third one loads.
+    auto pToken = std::make_shared<AsyncTextureLoader::LoadToken>();
+    std::atomic<uint32_t> cancelledCallbacks = 0;
+    auto cancelledCallback = [&](ref<Texture> pTexture)
+    {
+        if (pTexture == nullptr)
+            cancelledCallbacks++;
+    };
+    auto future1 = loader.loadFromFile(paths[1], false, false, Resource::BindFlags::ShaderResource, cancelledCallback, pToken);
+    auto future2 = loader.loadFromFile(paths[2], false, false, Resource::BindFlags::ShaderResource, cancelledCallback, pToken);
+    auto future3 = loader.loadFromFile(paths[2], false, false);
+    pToken->cancel();
+
+    blocker.release.set_value();
+
+    EXPECT(future1.get() == nullptr);
+    EXPECT(future2.get() == nullptr);
+    EXPECT(future3.get() != nullptr);
+    EXPECT_EQ(cancelledCallbacks.load(), 2);
+
+    removeFiles(paths);
+}
+
+GPU_TEST(AsyncTextureLoader_CancelWithoutBudget)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    auto paths = writeTestImages("async_cancel_budget_", 2);
+
+    AsyncTextureLoader loader(pDevice, 1);
+    loader.setUploadBudget(1);
+
+    // The first request uses up the budget of the frame, so the second one stays pending.
+    auto future0 = loader.loadFromFile(paths[0], false, false);
+    EXPECT(future0.get() != nullptr);
+
+    auto pToken = std::make_shared<AsyncTextureLoader::LoadToken>();
+    auto future1 = loader.loadFromFile(paths[1], false, false, Resource::BindFlags::ShaderResource, {}, pToken);
+    EXPECT_EQ(loader.getPendingRequestCount(), 1);
+
+    // Cancelling wakes up the worker, which completes the request without waiting for the next frame.
+    pToken->cancel();
+    EXPECT(future1.get() == nullptr);
+    EXPECT_EQ(loader.getPendingRequestCount(), 0);
+
+    removeFiles(paths);
+}
+
+GPU_TEST(AsyncTextureLoader_UploadBudget)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    auto paths = writeTestImages("async_budget_", 3);
+
+    AsyncTextureLoader loader(pDevice, 1);
+
+    // A budget of a single byte allows one texture per frame.
+    loader.setUploadBudget(1);
+    EXPECT_EQ(loader.getUploadBudget(), 1);
+
+    std::vector<std::future<ref<Texture>>> futures;
+    for (const auto& path : paths)
+        futures.push_back(loader.loadFromFile(path, false, false));
+
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        EXPECT(futures[i].get() != nullptr);
+
+        // The budget is used up before the future is ready, so the next texture is not started until the next frame.
+        EXPECT_EQ(loader.getPendingRequestCount(), futures.size() - i - 1);
+        loader.beginFrame();
+    }
+
+    removeFiles(paths);
+}
+
+GPU_TEST(AsyncTextureLoader_SuspendUploadBudget)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    auto paths = writeTestImages("async_suspend_", 3);
+
+    AsyncTextureLoader loader(pDevice, 1);
+    loader.setUploadBudget(1);
+
+    std::vector<std::future<ref<Texture>>> futures;
+    for (const auto& path : paths)
+        futures.push_back(loader.loadFromFile(path, false, false));
+
+    EXPECT(futures[0].get() != nullptr);
+    EXPECT_EQ(loader.getPendingRequestCount(), 2);
+
+    // All remaining requests complete without a new frame while the budget is suspended.
+    loader.suspendUploadBudget();
+    EXPECT(futures[1].get() != nullptr);
+    EXPECT(futures[2].get() != nullptr);
+    loader.resumeUploadBudget();
+
+    removeFiles(paths);
+}
+} // namespace Falcor
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Testing/UnitTest.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Image/Bitmap.h"
 
 namespace Falcor
@@ -74,4 +75,64 @@ GPU_TEST(Bitmap_LinearRamp_PNG)
     // Delete the test file.
     std::filesystem::remove(path);
 }
+
+CPU_TEST(Bitmap_EXR_RoundTrip)
+{
+    const auto path = getRuntimeDirectory() / "test_roundtrip.exr";
+
+    // Odd size that is not a multiple of the scanline blocks decoded per task.
+    const uint32_t width = 301, height = 203;
+    std::vector<float> data(width * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float* p = &data[(y * width + x) * 4];
+            p[0] = float(x) / width;
+            p[1] = float(y) / height;
+            p[2] = 10.f * float(x + y); // HDR values must not be clamped.
+            p[3] = (x + y) % 2 ? 1.f : 0.25f;
+        }
+    }
+
+    // Store as uncompressed 32-bit float to compare exactly.
+    Bitmap::saveImage(
+        path, width, height, Bitmap::FileFormat::ExrFile, Bitmap::ExportFlags::ExportAlpha | Bitmap::ExportFlags::Uncompressed,
+        ResourceFormat::RGBA32Float, true /* top-down */, data.data()
+    );
+
+    auto checkBitmap = [&](const Bitmap* bmp, bool isTopDown)
+    {
+        ASSERT(bmp != nullptr);
+        EXPECT_EQ(bmp->getWidth(), width);
+        EXPECT_EQ(bmp->getHeight(), height);
+        EXPECT_EQ(bmp->getFormat(), ResourceFormat::RGBA32Float);
+
+        const float* pLoaded = reinterpret_cast<const float*>(bmp->getData());
+        size_t mismatches = 0;
+        for (uint32_t y = 0; y < height; y++)
+        {
+            uint32_t srcY = isTopDown ? y : height - 1 - y;
+            if (std::memcmp(&pLoaded[y * width * 4], &data[srcY * width * 4], width * 4 * sizeof(float)) != 0)
+                mismatches++;
+        }
+        EXPECT_EQ(mismatches, 0) << "isTopDown=" << isTopDown;
+    };
+
+    for (bool isTopDown : {true, false})
+    {
+        // Decode with the parallel EXR path directly. It throws instead of falling back to FreeImage if the file can't be decoded.
+        {
+            MemoryMappedFile file(path);
+            ASSERT(file.isOpen());
+            auto bmp = Bitmap::createFromEXR(file, path, isTopDown);
+            checkBitmap(bmp.get(), isTopDown);
+        }
+
+        checkBitmap(Bitmap::createFromFile(path, isTopDown).get(), isTopDown);
+    }
+
+    // Delete the test file.
+    std::filesystem::remove(path);
+}
 } // namespace Falcor
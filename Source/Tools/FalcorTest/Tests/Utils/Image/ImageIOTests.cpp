@@ -0,0 +1,211 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/ImageIO.h"
+#include "Utils/Image/MipGenerator.h"
+#include <cmath>
+
+namespace Falcor
+{
+namespace
+{
+// Creates a smooth RGBA8 test image with some high frequency detail, which is representative of typical texture content.
+Bitmap::UniqueConstPtr createTestImage(uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::vector<uint8_t> data((size_t)width * height * 4);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float u = float(x) / width;
+            float v = float(y) / height;
+            uint8_t* p = &data[((size_t)y * width + x) * 4];
+            p[0] = (uint8_t)(255.f * u);
+            p[1] = (uint8_t)(255.f * v);
+            p[2] = (uint8_t)(127.5f + 127.5f * std::sin(20.f * (u + v) + float(seed)));
+            p[3] = (uint8_t)(((x / 8 + y / 8 + seed) & 1) ? 0xff : 0x80);
+        }
+    }
+    return Bitmap::create(width, height, ResourceFormat::RGBA8Unorm, data.data());
+}
+} // namespace
+
+CPU_TEST(ImageIO_CompressionQualityPresets)
+{
+    auto pBitmap = createTestImage(64, 64, 0);
+
+    const ImageIO::CompressionQuality qualities[] = {
+        ImageIO::CompressionQuality::Fastest,
+        ImageIO::CompressionQuality::Normal,
+        ImageIO::CompressionQuality::Production,
+    };
+    const std::pair<ImageIO::CompressionMode, const char*> modes[] = {
+        {ImageIO::CompressionMode::BC1, "BC1"},
+        {ImageIO::CompressionMode::BC7, "BC7"},
+    };
+
+    for (const auto& [mode, name] : modes)
+    {
+        double fastestPsnr = 0.0;
+        for (auto quality : qualities)
+        {
+            ImageIO::CompressionStats stats = ImageIO::evaluateCompression(*pBitmap, mode, quality);
+            EXPECT_GT(stats.psnr, 30.0) << name << " quality " << (uint32_t)quality;
+            if (quality == ImageIO::CompressionQuality::Fastest)
+                fastestPsnr = stats.psnr;
+            else
+                EXPECT_GE(stats.psnr, fastestPsnr - 0.1);
+        }
+    }
+}
+
+CPU_TEST(ImageIO_CompressionStripsMatchSingleCall)
+{
+    // Tall enough to be split into several strips, with a partial last strip and a height that isn't a multiple of the block size.
+    auto pBitmap = createTestImage(256, 522, 0);
+
+    const ImageIO::CompressionMode modes[] = {ImageIO::CompressionMode::BC1, ImageIO::CompressionMode::BC7};
+    for (auto mode : modes)
+    {
+        auto strips = ImageIO::compressToMemory(*pBitmap, mode, ImageIO::CompressionQuality::Fastest, true);
+        auto single = ImageIO::compressToMemory(*pBitmap, mode, ImageIO::CompressionQuality::Fastest, false);
+        ASSERT_EQ(strips.size(), single.size());
+        EXPECT(strips == single) << "mode " << (uint32_t)mode;
+    }
+}
+
+CPU_BENCHMARK(ImageIO_Compression)
+{
+    auto pBitmap = createTestImage(512, 512, 0);
+
+    const std::pair<ImageIO::CompressionQuality, const char*> qualities[] = {
+        {ImageIO::CompressionQuality::Fastest, "Fastest"},
+        {ImageIO::CompressionQuality::Normal, "Normal"},
+        {ImageIO::CompressionQuality::Production, "Production"},
+    };
+    const std::pair<ImageIO::CompressionMode, const char*> modes[] = {
+        {ImageIO::CompressionMode::BC1, "BC1"},
+        {ImageIO::CompressionMode::BC7, "BC7"},
+    };
+
+    for (const auto& [mode, modeName] : modes)
+    {
+        for (const auto& [quality, qualityName] : qualities)
+        {
+            ctx.measure(
+                fmt::format("512x512 {} {}", modeName, qualityName),
+                [&, mode = mode, quality = quality]() { ctx.doNotOptimize(ImageIO::evaluateCompression(*pBitmap, mode, quality).psnr); }
+            );
+        }
+    }
+}
+
+CPU_TEST(ImageIO_BatchSaveToDDS)
+{
+    const std::filesystem::path directory = getRuntimeDirectory() / "test_dds_batch";
+    std::filesystem::create_directories(directory);
+
+    std::vector<Bitmap::UniqueConstPtr> bitmaps;
+    std::vector<ImageIO::DDSSaveRequest> requests;
+    const ImageIO::CompressionMode modes[] = {ImageIO::CompressionMode::BC1, ImageIO::CompressionMode::BC3, ImageIO::CompressionMode::BC7};
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        bitmaps.push_back(createTestImage(256, 200 + 4 * i, i));
+        ImageIO::DDSSaveRequest request;
+        request.path = directory / fmt::format("image{}.dds", i);
+        request.pBitmap = bitmaps.back().get();
+        request.mode = modes[i % 3];
+        request.generateMips = (i % 2) == 0;
+        requests.push_back(request);
+    }
+
+    ImageIO::saveToDDS(requests, ImageIO::CompressionQuality::Fastest);
+
+    for (const auto& request : requests)
+    {
+        auto pLoaded = ImageIO::loadBitmapFromDDS(request.path);
+        ASSERT(pLoaded != nullptr);
+        EXPECT_EQ(pLoaded->getWidth(), request.pBitmap->getWidth());
+        EXPECT_EQ(pLoaded->getHeight(), request.pBitmap->getHeight());
+        EXPECT(isCompressedFormat(pLoaded->getFormat()));
+    }
+
+    // A failing request is reported without preventing the others from being saved.
+    requests[0].pBitmap = nullptr;
+    std::filesystem::remove(requests[1].path);
+    bool threw = false;
+    try
+    {
+        ImageIO::saveToDDS(requests, ImageIO::CompressionQuality::Fastest);
+    }
+    catch (const RuntimeError&)
+    {
+        threw = true;
+    }
+    EXPECT(threw);
+    EXPECT(std::filesystem::exists(requests[1].path));
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(ImageIO_SaveMipChainToDDS)
+{
+    const std::filesystem::path path = getRuntimeDirectory() / "test_dds_mipchain.dds";
+    auto pBitmap = createTestImage(64, 32, 0);
+
+    MipGenerator::Options options;
+    options.preserveAlphaCoverage = true;
+    auto mips = MipGenerator::generateMips(*pBitmap, options);
+
+    std::vector<const Bitmap*> chain = {pBitmap.get()};
+    for (const auto& pMip : mips)
+        chain.push_back(pMip.get());
+    ImageIO::saveMipChainToDDS(path, chain, ImageIO::CompressionMode::BC7, ImageIO::CompressionQuality::Fastest);
+
+    auto pLoaded = ImageIO::loadBitmapFromDDS(path);
+    ASSERT(pLoaded != nullptr);
+    EXPECT_EQ(pLoaded->getWidth(), 64);
+    EXPECT_EQ(pLoaded->getHeight(), 32);
+    EXPECT_EQ(pLoaded->getFormat(), ResourceFormat::BC7Unorm);
+
+    // Levels that don't form a mip chain are rejected.
+    std::swap(chain[1], chain[2]);
+    bool threw = false;
+    try
+    {
+        ImageIO::saveMipChainToDDS(path, chain, ImageIO::CompressionMode::BC7);
+    }
+    catch (const RuntimeError&)
+    {
+        threw = true;
+    }
+    EXPECT(threw);
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -0,0 +1,186 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/MipGenerator.h"
+#include <functional>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+Bitmap::UniqueConstPtr createRGBA8(uint32_t width, uint32_t height, ResourceFormat format, std::function<uint32_t(uint32_t, uint32_t)> func)
+{
+    std::vector<uint32_t> data((size_t)width * height);
+    for (uint32_t y = 0; y < height; ++y)
+        for (uint32_t x = 0; x < width; ++x)
+            data[(size_t)y * width + x] = func(x, y);
+    return Bitmap::create(width, height, format, reinterpret_cast<const uint8_t*>(data.data()));
+}
+
+const uint8_t* getTexel(const Bitmap& bitmap, uint32_t x, uint32_t y)
+{
+    return bitmap.getData() + (size_t)y * bitmap.getRowPitch() + (size_t)x * getFormatBytesPerBlock(bitmap.getFormat());
+}
+} // namespace
+
+CPU_TEST(MipGenerator_ChainDimensions)
+{
+    auto pBitmap = createRGBA8(13, 7, ResourceFormat::RGBA8Unorm, [](uint32_t x, uint32_t y) { return 0xff204060u; });
+
+    for (auto filter : {MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser})
+    {
+        MipGenerator::Options options;
+        options.filter = filter;
+        auto mips = MipGenerator::generateMips(*pBitmap, options);
+
+        const uint32_t expected[][2] = {{6, 3}, {3, 1}, {1, 1}};
+        ASSERT_EQ(mips.size(), 3);
+        for (size_t i = 0; i < mips.size(); ++i)
+        {
+            EXPECT_EQ(mips[i]->getWidth(), expected[i][0]);
+            EXPECT_EQ(mips[i]->getHeight(), expected[i][1]);
+            EXPECT_EQ(mips[i]->getFormat(), ResourceFormat::RGBA8Unorm);
+
+            // A constant image stays constant with normalized filter weights.
+            for (uint32_t y = 0; y < mips[i]->getHeight(); ++y)
+                for (uint32_t x = 0; x < mips[i]->getWidth(); ++x)
+                    EXPECT_EQ(*reinterpret_cast<const uint32_t*>(getTexel(*mips[i], x, y)), 0xff204060u);
+        }
+    }
+
+    MipGenerator::Options options;
+    options.maxMipLevels = 2;
+    EXPECT_EQ(MipGenerator::generateMips(*pBitmap, options).size(), 1);
+}
+
+CPU_TEST(MipGenerator_SrgbAveraging)
+{
+    // Black and white checkerboard. Averaging in linear space gives 0.5 linear, which is 188 in sRGB.
+    auto checker = [](uint32_t x, uint32_t y) { return ((x + y) & 1) ? 0xffffffffu : 0xff000000u; };
+
+    auto pSrgb = createRGBA8(8, 8, ResourceFormat::RGBA8UnormSrgb, checker);
+    auto srgbMips = MipGenerator::generateMips(*pSrgb, {});
+    const uint8_t* pTexel = getTexel(*srgbMips[0], 0, 0);
+    EXPECT_EQ(pTexel[0], 188);
+    EXPECT_EQ(pTexel[3], 255);
+
+    auto pLinear = createRGBA8(8, 8, ResourceFormat::RGBA8Unorm, checker);
+    auto linearMips = MipGenerator::generateMips(*pLinear, {});
+    EXPECT_EQ(getTexel(*linearMips[0], 0, 0)[0], 128);
+}
+
+CPU_TEST(MipGenerator_FloatFormats)
+{
+    const uint32_t width = 4, height = 2;
+    std::vector<float> data(width * height * 4);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = float(i);
+
+    auto pBitmap32 = Bitmap::create(width, height, ResourceFormat::RGBA32Float, reinterpret_cast<const uint8_t*>(data.data()));
+    auto mips32 = MipGenerator::generateMips(*pBitmap32, {});
+    ASSERT_EQ(mips32.size(), 2);
+    const float* pMip = reinterpret_cast<const float*>(mips32[0]->getData());
+    // Texel (0,0) of mip 1 averages texels (0,0), (1,0), (0,1) and (1,1) of the base level.
+    for (uint32_t c = 0; c < 4; ++c)
+        EXPECT_EQ(pMip[c], (data[c] + data[4 + c] + data[16 + c] + data[20 + c]) / 4.f);
+
+    std::vector<float16_t> data16(data.size());
+    for (size_t i = 0; i < data.size(); ++i)
+        data16[i] = float16_t(data[i]);
+    auto pBitmap16 = Bitmap::create(width, height, ResourceFormat::RGBA16Float, reinterpret_cast<const uint8_t*>(data16.data()));
+    auto mips16 = MipGenerator::generateMips(*pBitmap16, {});
+    ASSERT_EQ(mips16.size(), 2);
+    const float16_t* pMip16 = reinterpret_cast<const float16_t*>(mips16[0]->getData());
+    for (uint32_t c = 0; c < 4; ++c)
+        EXPECT_EQ(float(pMip16[c]), pMip[c]);
+}
+
+CPU_TEST(MipGenerator_AlphaCoverage)
+{
+    // Noisy foliage-like alpha with about 30% of the texels passing the alpha test.
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    auto pBitmap = createRGBA8(256, 256, ResourceFormat::RGBA8UnormSrgb, [&](uint32_t x, uint32_t y) { return (dist(rng) << 24) | 0x00ff00u; });
+
+    const float cutoff = 0.7f;
+    const float baseCoverage = MipGenerator::computeAlphaCoverage(*pBitmap, cutoff);
+    EXPECT_LT(std::abs(baseCoverage - 0.3f), 0.02f);
+
+    MipGenerator::Options options;
+    options.alphaCutoff = cutoff;
+    auto plainMips = MipGenerator::generateMips(*pBitmap, options);
+    options.preserveAlphaCoverage = true;
+    auto preservedMips = MipGenerator::generateMips(*pBitmap, options);
+
+    // Without preservation the averaged alpha quickly falls below the cutoff everywhere.
+    EXPECT_LT(MipGenerator::computeAlphaCoverage(*plainMips[2], cutoff), 0.1f);
+
+    for (size_t i = 0; i < preservedMips.size(); ++i)
+    {
+        const auto& pMip = preservedMips[i];
+        if (pMip->getWidth() * pMip->getHeight() < 64)
+            break;
+        float coverage = MipGenerator::computeAlphaCoverage(*pMip, cutoff);
+        EXPECT_LT(std::abs(coverage - baseCoverage), 0.02f) << "mip " << i + 1;
+    }
+}
+
+CPU_TEST(MipGenerator_UnsupportedFormat)
+{
+    std::vector<uint8_t> data(16);
+    auto pBitmap = Bitmap::create(4, 4, ResourceFormat::R8Unorm, data.data());
+    EXPECT(!MipGenerator::isFormatSupported(ResourceFormat::R8Unorm));
+    bool threw = false;
+    try
+    {
+        MipGenerator::generateMips(*pBitmap, {});
+    }
+    catch (const ArgumentError&)
+    {
+        threw = true;
+    }
+    EXPECT(threw);
+}
+
+CPU_BENCHMARK(MipGenerator_GenerateMips)
+{
+    auto pBitmap = createRGBA8(2048, 2048, ResourceFormat::RGBA8UnormSrgb, [](uint32_t x, uint32_t y) { return (x * 2654435761u) ^ y; });
+
+    for (auto filter : {MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser})
+    {
+        MipGenerator::Options options;
+        options.filter = filter;
+        options.preserveAlphaCoverage = true;
+        ctx.measure(
+            filter == MipGenerator::Filter::Box ? "2048x2048 sRGB box" : "2048x2048 sRGB Kaiser",
+            [&]() { ctx.doNotOptimize(MipGenerator::generateMips(*pBitmap, options).size()); }
+        );
+    }
+}
+} // namespace Falcor
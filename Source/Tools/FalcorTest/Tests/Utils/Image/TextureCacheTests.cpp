@@ -0,0 +1,153 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureCache.h"
+
+namespace Falcor
+{
+namespace
+{
+Bitmap::UniqueConstPtr createBitmap(uint32_t width, uint32_t height, ResourceFormat format, uint8_t alpha = 0xff)
+{
+    const uint32_t bytesPerPixel = getFormatBytesPerBlock(format);
+    std::vector<uint8_t> data((size_t)width * height * bytesPerPixel);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i * 7);
+    if (getFormatChannelCount(format) == 4 && bytesPerPixel == 4)
+    {
+        for (size_t i = 0; i < data.size(); i += 4)
+            data[i + 3] = alpha;
+    }
+    return Bitmap::create(width, height, format, data.data());
+}
+
+void writePng(const std::filesystem::path& path, uint32_t width, uint32_t height, uint8_t seed)
+{
+    std::vector<uint8_t> data((size_t)width * height * 4);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i * seed);
+    for (size_t i = 0; i < data.size(); i += 4)
+        data[i + 3] = 0xff;
+
+    Bitmap::saveImage(
+        path, width, height, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::BGRA8Unorm, true /* top-down */,
+        data.data()
+    );
+}
+} // namespace
+
+CPU_TEST(TextureCache_SelectCompressionMode)
+{
+    using Mode = ImageIO::CompressionMode;
+
+    EXPECT(TextureCache::selectCompressionMode(*createBitmap(8, 8, ResourceFormat::R8Unorm), false) == Mode::BC4);
+    EXPECT(TextureCache::selectCompressionMode(*createBitmap(8, 8, ResourceFormat::RG8Unorm), false) == Mode::BC5);
+
+    // Opaque color images use BC1 for sRGB data and BC7 for linear data.
+    EXPECT(TextureCache::selectCompressionMode(*createBitmap(8, 8, ResourceFormat::BGRX8Unorm), true) == Mode::BC1);
+    EXPECT(TextureCache::selectCompressionMode(*createBitmap(8, 8, ResourceFormat::BGRX8Unorm), false) == Mode::BC7);
+    EXPECT(TextureCache::selectCompressionMode(*createBitmap(8, 8, ResourceFormat::BGRA8Unorm), true) == Mode::BC1);
+
+    // Images with alpha use BC7.
+    EXPECT(TextureCache::selectCompressionMode(*createBitmap(8, 8, ResourceFormat::BGRA8Unorm, 0x80), true) == Mode::BC7);
+    EXPECT(TextureCache::selectCompressionMode(*createBitmap(8, 8, ResourceFormat::BGRA8Unorm, 0x80), false) == Mode::BC7);
+
+    // Unsupported sizes and formats are not baked.
+    EXPECT(TextureCache::selectCompressionMode(*createBitmap(6, 8, ResourceFormat::BGRA8Unorm), true) == Mode::None);
+    EXPECT(TextureCache::selectCompressionMode(*createBitmap(8, 8, ResourceFormat::RGBA16Float), false) == Mode::None);
+}
+
+CPU_TEST(TextureCache_Key)
+{
+    const auto directory = getRuntimeDirectory() / "test_texture_cache";
+    std::filesystem::create_directories(directory);
+    const auto path = directory / "texture.png";
+
+    writePng(path, 16, 16, 3);
+    auto key = TextureCache::computeKey(path, true, true);
+    EXPECT(key.has_value());
+
+    // Keys depend on the load settings.
+    EXPECT(TextureCache::computeKey(path, true, true) == key);
+    EXPECT(TextureCache::computeKey(path, false, true) != key);
+    EXPECT(TextureCache::computeKey(path, true, false) != key);
+
+    // Keys depend on the file content, not the file name.
+    const auto copyPath = directory / "copy.png";
+    std::filesystem::copy_file(path, copyPath, std::filesystem::copy_options::overwrite_existing);
+    EXPECT(TextureCache::computeKey(copyPath, true, true) == key);
+    writePng(path, 16, 16, 5);
+    EXPECT(TextureCache::computeKey(path, true, true) != key);
+
+    EXPECT(!TextureCache::computeKey(directory / "missing.png", true, true).has_value());
+
+    std::filesystem::remove_all(directory);
+}
+
+GPU_TEST(TextureCache_BakeAndLoad)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const auto directory = getRuntimeDirectory() / "test_texture_cache";
+    const auto path = directory / "texture.png";
+    std::filesystem::create_directories(directory);
+    writePng(path, 64, 32, 3);
+
+    TextureCache textureCache(directory / "cache");
+
+    // First load bakes the texture.
+    ref<Texture> pTexture = textureCache.loadTexture(pDevice, path, true, true);
+    ASSERT(pTexture != nullptr);
+    EXPECT_EQ(pTexture->getWidth(), 64);
+    EXPECT_EQ(pTexture->getHeight(), 32);
+    EXPECT_EQ(pTexture->getMipCount(), 7);
+    EXPECT(pTexture->getFormat() == ResourceFormat::BC1UnormSrgb);
+    EXPECT(pTexture->getSourcePath() == path);
+
+    auto key = TextureCache::computeKey(path, true, true);
+    ASSERT(key.has_value());
+    EXPECT(std::filesystem::exists(textureCache.getCachePath(*key)));
+    EXPECT(textureCache.bakeTexture(path, true, true) == textureCache.getCachePath(*key));
+
+    // Second load reads the baked texture. Loading as linear uses a separate cache entry.
+    pTexture = textureCache.loadTexture(pDevice, path, true, true);
+    ASSERT(pTexture != nullptr);
+    EXPECT(pTexture->getFormat() == ResourceFormat::BC1UnormSrgb);
+    pTexture = textureCache.loadTexture(pDevice, path, false, false);
+    ASSERT(pTexture != nullptr);
+    EXPECT_EQ(pTexture->getMipCount(), 1);
+    EXPECT(pTexture->getFormat() == ResourceFormat::BC7Unorm);
+
+    // Textures that need other bind flags bypass the cache.
+    pTexture = textureCache.loadTexture(pDevice, path, false, false, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+    ASSERT(pTexture != nullptr);
+    EXPECT(pTexture->getFormat() == ResourceFormat::BGRX8Unorm);
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
@@ -51,4 +51,125 @@ GPU_TEST(TextureManager_LoadMips)
     EXPECT_EQ(tex->getMipCount(), 3);
     EXPECT_EQ(tex->getArraySize(), 1);
 }
+
+GPU_TEST(TextureManager_ResidencyBudget)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10);
+    textureManager.setResidentMipTailSize(1);
+
+    std::filesystem::path path = getRuntimeDirectory() / "data/tests/tiny_<MIP>.png";
+    auto handle = textureManager.loadTexture(path, false, false, ResourceBindFlags::ShaderResource, false);
+    ASSERT(handle.isValid());
+
+    ref<Texture> pFull = textureManager.getTexture(handle);
+    ASSERT(pFull != nullptr);
+    const uint64_t fullSize = pFull->getTextureSizeInBytes();
+
+    // Without a budget nothing is evicted.
+    for (int i = 0; i < 3; i++)
+        EXPECT(textureManager.beginFrame().empty());
+    EXPECT_EQ(textureManager.getResidencyStats().evictedTextureCount, 0);
+
+    // A texture used in the previous frame is kept resident.
+    textureManager.setMemoryBudget(1);
+    textureManager.markTextureUsed(handle);
+    EXPECT(textureManager.beginFrame().empty());
+
+    // An unused texture is evicted to its 1x1 mip tail.
+    auto swaps = textureManager.beginFrame();
+    ASSERT_EQ(swaps.size(), 1);
+    EXPECT(swaps[0].pOldTexture == pFull);
+
+    ref<Texture> pTail = textureManager.getTexture(handle);
+    ASSERT(pTail != nullptr);
+    EXPECT(pTail == swaps[0].pNewTexture);
+    EXPECT_EQ(pTail->getWidth(), 1);
+    EXPECT_EQ(pTail->getHeight(), 1);
+    EXPECT_EQ(pTail->getMipCount(), 1);
+
+    auto stats = textureManager.getResidencyStats();
+    EXPECT_EQ(stats.evictedTextureCount, 1);
+    EXPECT_EQ(stats.residentTextureCount, 0);
+    EXPECT_EQ(stats.fullMemoryInBytes, fullSize);
+    EXPECT_EQ(stats.residentMemoryInBytes, pTail->getTextureSizeInBytes());
+    EXPECT_EQ(stats.evictionCount, 1);
+
+    // Using the evicted texture reloads all mips.
+    textureManager.markTextureUsed(pTail.get());
+    EXPECT_EQ(textureManager.getResidencyStats().pendingReloadCount, 1);
+
+    textureManager.waitForPendingReloads();
+    swaps = textureManager.beginFrame();
+    ASSERT_EQ(swaps.size(), 1);
+    EXPECT(swaps[0].pOldTexture == pTail);
+
+    ref<Texture> pReloaded = textureManager.getTexture(handle);
+    ASSERT(pReloaded != nullptr);
+    EXPECT_EQ(pReloaded->getWidth(), 4);
+    EXPECT_EQ(pReloaded->getMipCount(), 3);
+
+    stats = textureManager.getResidencyStats();
+    EXPECT_EQ(stats.evictedTextureCount, 0);
+    EXPECT_EQ(stats.pendingReloadCount, 0);
+    EXPECT_EQ(stats.reloadCount, 1);
+}
+
+GPU_TEST(TextureManager_ContentHashing)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Create two copies of the same image under different paths.
+    const auto directory = getRuntimeDirectory() / "test_texture_dedup";
+    std::filesystem::create_directories(directory);
+    const auto source = getRuntimeDirectory() / "data/tests/tiny_mip0.png";
+    const auto pathA = directory / "a.png";
+    const auto pathB = directory / "b.png";
+    std::filesystem::copy_file(source, pathA, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::copy_file(source, pathB, std::filesystem::copy_options::overwrite_existing);
+
+    for (bool useContentHashing : {false, true})
+    {
+        TextureManager textureManager(pDevice, 10);
+        textureManager.setUseContentHashing(useContentHashing);
+
+        textureManager.beginDeferredLoading();
+        auto handleA = textureManager.loadTexture(pathA, false, false);
+        auto handleB = textureManager.loadTexture(pathB, false, false);
+        auto handleSrgb = textureManager.loadTexture(pathB, false, true);
+        textureManager.endDeferredLoading();
+
+        ref<Texture> pTextureA = textureManager.getTexture(handleA);
+        ref<Texture> pTextureB = textureManager.getTexture(handleB);
+        ref<Texture> pTextureSrgb = textureManager.getTexture(handleSrgb);
+        ASSERT(pTextureA && pTextureB && pTextureSrgb);
+        EXPECT(!(handleA == handleB));
+
+        // Textures loaded with different flags are never shared.
+        EXPECT(pTextureSrgb != pTextureA);
+
+        auto stats = textureManager.getStats();
+        if (useContentHashing)
+        {
+            EXPECT(pTextureA == pTextureB);
+            EXPECT_EQ(stats.textureCount, 2);
+            EXPECT_EQ(stats.textureDeduplicatedCount, 1);
+            EXPECT_EQ(stats.textureDeduplicatedMemoryInBytes, pTextureA->getTextureSizeInBytes());
+        }
+        else
+        {
+            EXPECT(pTextureA != pTextureB);
+            EXPECT_EQ(stats.textureCount, 3);
+            EXPECT_EQ(stats.textureDeduplicatedCount, 0);
+        }
+
+        // Removing one of the handles keeps the shared texture valid for the other.
+        textureManager.removeTexture(handleA);
+        EXPECT(textureManager.getTexture(handleB) == pTextureB);
+        EXPECT(textureManager.addTexture(pTextureB) == handleB);
+    }
+
+    std::filesystem::remove_all(directory);
+}
 } // namespace Falcor
@@ -0,0 +1,152 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Logger.h"
+
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Redirects the console outputs of the logger to string streams and restores the logger state on destruction.
+class ConsoleCapture
+{
+public:
+    ConsoleCapture()
+        : mVerbosity(Logger::getVerbosity())
+        , mOutputs(Logger::getOutputs())
+        , mAsync(Logger::isAsync())
+        , mpCout(std::cout.rdbuf(mOut.rdbuf()))
+        , mpCerr(std::cerr.rdbuf(mErr.rdbuf()))
+    {
+        Logger::setVerbosity(Logger::Level::Info);
+        Logger::setOutputs(Logger::OutputFlags::Console);
+    }
+
+    ~ConsoleCapture()
+    {
+        Logger::setAsync(mAsync);
+        Logger::flush();
+        Logger::setOutputs(mOutputs);
+        Logger::setVerbosity(mVerbosity);
+        std::cout.rdbuf(mpCout);
+        std::cerr.rdbuf(mpCerr);
+    }
+
+    /// Count the lines written to stdout (or stderr) that contain a string.
+    size_t countLines(const std::string& str, bool error = false) const
+    {
+        std::istringstream stream(error ? mErr.str() : mOut.str());
+        size_t count = 0;
+        for (std::string line; std::getline(stream, line);)
+        {
+            if (line.find(str) != std::string::npos)
+                ++count;
+        }
+        return count;
+    }
+
+private:
+    std::ostringstream mOut;
+    std::ostringstream mErr;
+    Logger::Level mVerbosity;
+    Logger::OutputFlags mOutputs;
+    bool mAsync;
+    std::streambuf* mpCout;
+    std::streambuf* mpCerr;
+};
+} // namespace
+
+CPU_TEST(Logger_AsyncFlush)
+{
+    ConsoleCapture capture;
+    Logger::setAsync(true);
+
+    // flush() returns after all messages logged before the call are written.
+    for (uint32_t i = 0; i < 100; ++i)
+        logInfo("Logger_AsyncFlush {}", i);
+    Logger::flush();
+    EXPECT_EQ(capture.countLines("Logger_AsyncFlush"), 100);
+
+    // Disabling asynchronous logging writes the pending messages.
+    for (uint32_t i = 0; i < 100; ++i)
+        logInfo("Logger_AsyncDisable {}", i);
+    Logger::setAsync(false);
+    EXPECT_EQ(capture.countLines("Logger_AsyncDisable"), 100);
+}
+
+CPU_TEST(Logger_AsyncRateLimit)
+{
+    ConsoleCapture capture;
+    Logger::setAsync(true);
+
+    // Distinct info messages are not collapsed, so messages beyond the rate limit are suppressed and summarized.
+    const uint32_t kMessageCount = 3000;
+    for (uint32_t i = 0; i < kMessageCount; ++i)
+        logInfo("Logger_AsyncRateLimit {}", i);
+    Logger::flush();
+    EXPECT_GT(capture.countLines("Logger_AsyncRateLimit"), 0);
+    EXPECT_LT(capture.countLines("Logger_AsyncRateLimit"), kMessageCount);
+    EXPECT_GE(capture.countLines("exceeding the rate limit"), 1);
+}
+
+CPU_TEST(Logger_AsyncToggle)
+{
+    ConsoleCapture capture;
+
+    // Errors are neither rate limited nor dropped, so every message must be written while the mode is switched concurrently.
+    const uint32_t kThreadCount = 4;
+    const uint32_t kMessageCount = 2000;
+    std::atomic<uint32_t> runningCount = kThreadCount;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < kThreadCount; ++t)
+    {
+        threads.emplace_back(
+            [t, &runningCount]()
+            {
+                for (uint32_t i = 0; i < kMessageCount; ++i)
+                    logError("Logger_AsyncToggle {} {}", t, i);
+                --runningCount;
+            }
+        );
+    }
+    for (uint32_t i = 0; runningCount > 0; ++i)
+        Logger::setAsync(i % 2 == 0);
+    for (auto& thread : threads)
+        thread.join();
+    Logger::setAsync(false);
+
+    EXPECT_EQ(capture.countLines("Logger_AsyncToggle", true), kThreadCount * kMessageCount);
+}
+} // namespace Falcor
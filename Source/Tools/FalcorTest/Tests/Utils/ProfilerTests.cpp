@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/Profiler.h"
+
+namespace Falcor
+{
+CPU_TEST(Profiler_InternName)
+{
+    Profiler::NameID a = Profiler::internName("ProfilerTestA");
+    Profiler::NameID b = Profiler::internName("ProfilerTestB");
+    EXPECT(a != Profiler::kInvalidNameID);
+    EXPECT(b != Profiler::kInvalidNameID);
+    EXPECT(a != b);
+    EXPECT_EQ(Profiler::internName(std::string("ProfilerTestA")), a);
+    EXPECT_EQ(Profiler::getInternedName(a), "ProfilerTestA");
+    EXPECT_EQ(Profiler::getInternedName(b), "ProfilerTestB");
+
+    // '/' is reserved as the path delimiter.
+    EXPECT_EQ(Profiler::internName("Profiler/Test"), Profiler::kInvalidNameID);
+
+    // String literals are interned once per call site.
+    Profiler::NameCache cache;
+    EXPECT_EQ(cache.get("ProfilerTestA"), a);
+    EXPECT_EQ(cache.get("ProfilerTestA"), a);
+    EXPECT_EQ(cache.get(std::string("ProfilerTestB")), b);
+    EXPECT_EQ(cache.get(b), b);
+}
+
+GPU_TEST(Profiler_EventTree)
+{
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    Profiler profiler(ctx.getDevice());
+    profiler.setEnabled(true);
+
+    const Profiler::NameID a = Profiler::internName("A");
+    const Profiler::NameID b = Profiler::internName("B");
+    const auto flags = Profiler::Flags::Internal;
+
+    for (uint32_t frame = 0; frame < 3; ++frame)
+    {
+        profiler.startEvent(pRenderContext, a, flags);
+        profiler.startEvent(pRenderContext, b, flags);
+        profiler.endEvent(pRenderContext, b, flags);
+        profiler.endEvent(pRenderContext, a, flags);
+
+        // Events started several times per frame are registered once.
+        profiler.startEvent(pRenderContext, "B", flags);
+        profiler.endEvent(pRenderContext, "B", flags);
+        profiler.startEvent(pRenderContext, b, flags);
+        profiler.endEvent(pRenderContext, b, flags);
+
+        profiler.endFrame(pRenderContext);
+
+        const auto& events = profiler.getEvents();
+        ASSERT_EQ(events.size(), 3);
+        EXPECT_EQ(events[0]->getName(), "/A");
+        EXPECT_EQ(events[1]->getName(), "/A/B");
+        EXPECT_EQ(events[2]->getName(), "/B");
+        EXPECT(events[0] == profiler.getEvent("/A"));
+        EXPECT(events[1] == profiler.getEvent("/A/B"));
+        EXPECT(events[2] == profiler.getEvent("/B"));
+    }
+}
+
+GPU_TEST(Profiler_Trace)
+{
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    Profiler profiler(ctx.getDevice());
+
+    const Profiler::NameID a = Profiler::internName("A");
+    const Profiler::NameID b = Profiler::internName("B");
+    const auto flags = Profiler::Flags::Internal;
+
+    profiler.startCapture(16, true);
+    for (uint32_t frame = 0; frame < 4; ++frame)
+    {
+        profiler.startEvent(pRenderContext, a, flags);
+        profiler.startEvent(pRenderContext, b, flags);
+        profiler.endEvent(pRenderContext, b, flags);
+        profiler.endEvent(pRenderContext, a, flags);
+        profiler.endFrame(pRenderContext);
+    }
+    auto pCapture = profiler.endCapture();
+    ASSERT(pCapture != nullptr);
+    ASSERT(pCapture->hasTrace());
+
+    // Intervals are recorded when the GPU timings are read back one frame later.
+    const auto& traceEvents = pCapture->getTraceEvents();
+    const auto& names = pCapture->getTraceEventNames();
+    EXPECT_EQ(pCapture->getTraceFrameEndTimes().size(), 4);
+    ASSERT_EQ(traceEvents.size(), 3 * 4);
+    ASSERT_EQ(names.size(), 2);
+    EXPECT_EQ(names[0], "/A");
+    EXPECT_EQ(names[1], "/A/B");
+
+    for (uint32_t frame = 0; frame < 3; ++frame)
+    {
+        // Find the intervals of this frame and check that B is nested in A on both timelines.
+        const Profiler::Capture::TraceEvent* intervals[2][2] = {}; // [event][cpu/gpu]
+        for (const auto& event : traceEvents)
+        {
+            if (event.frameIndex == frame)
+                intervals[event.nameIndex][event.threadIndex == Profiler::Capture::kGpuThreadIndex ? 1 : 0] = &event;
+        }
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            const auto* pA = intervals[0][i];
+            const auto* pB = intervals[1][i];
+            ASSERT(pA != nullptr && pB != nullptr);
+            EXPECT_GE(pB->start, pA->start);
+            EXPECT_LE(pB->start + pB->duration, pA->start + pA->duration + 1e-6);
+        }
+    }
+
+    std::string json = pCapture->toChromeTraceString();
+    EXPECT(json.find("\"traceEvents\"") != std::string::npos);
+    EXPECT(json.find("\"path\":\"/A/B\"") != std::string::npos);
+}
+} // namespace Falcor
@@ -25,10 +25,21 @@
  # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
+#include "ImageMetrics.h"
+
 #include <FreeImage.h>
 #include <args.hxx>
 
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfInputFile.h>
+#include <ImfThreading.h>
+
 #include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,230 +47,412 @@
 #include <map>
 #include <functional>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <execution>
+#include <future>
+#include <numeric>
+#include <thread>
 
 #include <cmath>
+#include <cstdio>
 #include <cstring>
 
-template<typename T>
-T sqr(T x)
-{
-    return x * x;
-}
+using namespace ImageCompare;
 
-template<typename T>
-T lerp(T a, T b, T t)
+/// Load an image from a file and convert it to RGBA float format.
+static std::shared_ptr<Image> loadImageFromFile(const std::filesystem::path& path)
 {
-    return a + t * (b - a);
+    FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
+
+    auto pathStr = path.string();
+
+    // Determine file format.
+    fifFormat = FreeImage_GetFileType(pathStr.c_str(), 0);
+    if (fifFormat == FIF_UNKNOWN)
+        fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
+    if (fifFormat == FIF_UNKNOWN)
+        throw std::runtime_error("Unknown image format");
+    if (!FreeImage_FIFSupportsReading(fifFormat))
+        throw std::runtime_error("Unsupported image format");
+
+    // Read image.
+    FIBITMAP* srcBitmap = FreeImage_Load(fifFormat, pathStr.c_str());
+    if (!srcBitmap)
+        throw std::runtime_error("Cannot read image");
+
+    // Convert to RGBA32F.
+    FIBITMAP* floatBitmap = FreeImage_ConvertToRGBAF(srcBitmap);
+    FreeImage_Unload(srcBitmap);
+    if (!floatBitmap)
+        throw std::runtime_error("Cannot convert to RGBA float format");
+
+    // Create image.
+    auto image = Image::create(FreeImage_GetWidth(floatBitmap), FreeImage_GetHeight(floatBitmap));
+    int bytesPerPixel = 4 * sizeof(float);
+    FreeImage_ConvertToRawBits(
+        reinterpret_cast<BYTE*>(image->getData()), floatBitmap, bytesPerPixel * image->getWidth(), bytesPerPixel * 8, FI_RGBA_RED_MASK,
+        FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, true
+    );
+    FreeImage_Unload(floatBitmap);
+
+    return image;
 }
 
-template<typename T>
-T clamp(T x, T lo, T hi)
+/// Save an image to a file. Alpha is only written to EXR and PNG files.
+static void saveImageToFile(const Image& image, const std::filesystem::path& path, bool writeAlpha = true)
 {
-    return std::max(lo, std::min(hi, x));
+    FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
+
+    auto pathStr = path.string();
+
+    // Determine file format.
+    fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
+    if (fifFormat == FIF_UNKNOWN)
+        throw std::runtime_error("Unknown image format");
+    if (!FreeImage_FIFSupportsWriting(fifFormat))
+        throw std::runtime_error("Unsupported image format");
+
+    bool writeFloat = fifFormat == FIF_EXR || fifFormat == FIF_PFM || fifFormat == FIF_HDR;
+    if (fifFormat != FIF_EXR && fifFormat != FIF_PNG)
+        writeAlpha = false;
+
+    // Create bitmap.
+    FIBITMAP* bitmap;
+    const uint32_t width = image.getWidth();
+    const uint32_t height = image.getHeight();
+    const float* src = image.getData();
+    if (writeFloat)
+    {
+        bitmap = FreeImage_AllocateT(writeAlpha ? FIT_RGBAF : FIT_RGBF, width, height);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            float* dst = reinterpret_cast<float*>(FreeImage_GetScanLine(bitmap, height - y - 1));
+            if (writeAlpha)
+            {
+                std::memcpy(dst, src, width * 4 * sizeof(float));
+                src += width * 4;
+            }
+            else
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                    dst += 3;
+                    src += 4;
+                }
+            }
+        }
+    }
+    else
+    {
+        bitmap = FreeImage_Allocate(width, height, writeAlpha ? 32 : 24);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            uint8_t* dst = reinterpret_cast<uint8_t*>(FreeImage_GetScanLine(bitmap, height - y - 1));
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                dst[2] = clamp(int(src[0] * 255.f), 0, 255);
+                dst[1] = clamp(int(src[1] * 255.f), 0, 255);
+                dst[0] = clamp(int(src[2] * 255.f), 0, 255);
+                if (writeAlpha)
+                    dst[3] = clamp(int(src[3] * 255.f), 0, 255);
+                dst += writeAlpha ? 4 : 3;
+                src += 4;
+            }
+        }
+    }
+
+    // Write image.
+    FreeImage_Save(fifFormat, bitmap, pathStr.c_str());
+    FreeImage_Unload(bitmap);
 }
 
-class Image
+/// Number of scanlines read per block in streaming mode.
+static constexpr uint32_t kStreamBlockRows = 64;
+
+/// Default number of images compared at the same time in batch mode. Bounds the number of images held in memory.
+static constexpr uint32_t kDefaultBatchJobs = 4;
+
+/// Number of pixels evaluated per chunk by the metric kernels.
+static constexpr uint32_t kKernelChunkSize = 256;
+
+/**
+ * Source of image scanlines in RGBA float format.
+ * Images are either fully loaded into memory or streamed in blocks of scanlines from disk.
+ */
+class ImageReader
 {
 public:
-    Image(uint32_t width, uint32_t height) : mWidth(width), mHeight(height), mData(std::make_unique<float[]>(width * height * 4)) {}
+    virtual ~ImageReader() = default;
 
     uint32_t getWidth() const { return mWidth; }
     uint32_t getHeight() const { return mHeight; }
-    const float* getData() const { return mData.get(); }
-    float* getData() { return mData.get(); }
-
-    static std::shared_ptr<Image> create(uint32_t width, uint32_t height) { return std::make_shared<Image>(width, height); }
-
-    static std::shared_ptr<Image> loadFromFile(const std::filesystem::path& path)
-    {
-        FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
-
-        auto pathStr = path.string();
-
-        // Determine file format.
-        fifFormat = FreeImage_GetFileType(pathStr.c_str(), 0);
-        if (fifFormat == FIF_UNKNOWN)
-            fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
-        if (fifFormat == FIF_UNKNOWN)
-            throw std::runtime_error("Unknown image format");
-        if (!FreeImage_FIFSupportsReading(fifFormat))
-            throw std::runtime_error("Unsupported image format");
-
-        // Read image.
-        FIBITMAP* srcBitmap = FreeImage_Load(fifFormat, pathStr.c_str());
-        if (!srcBitmap)
-            throw std::runtime_error("Cannot read image");
-
-        // Convert to RGBA32F.
-        FIBITMAP* floatBitmap = FreeImage_ConvertToRGBAF(srcBitmap);
-        FreeImage_Unload(srcBitmap);
-        if (!floatBitmap)
-            throw std::runtime_error("Cannot convert to RGBA float format");
-
-        // Create image.
-        auto image = create(FreeImage_GetWidth(floatBitmap), FreeImage_GetHeight(floatBitmap));
-        int bytesPerPixel = 4 * sizeof(float);
-        FreeImage_ConvertToRawBits(
-            reinterpret_cast<BYTE*>(image->getData()), floatBitmap, bytesPerPixel * image->getWidth(), bytesPerPixel * 8, FI_RGBA_RED_MASK,
-            FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, true
-        );
-        FreeImage_Unload(floatBitmap);
 
-        return image;
+    /// Returns true if readRows() needs a scratch buffer to hold the scanlines.
+    virtual bool needsScratch() const = 0;
+
+    /**
+     * Get a block of scanlines.
+     * @param[in] y First scanline.
+     * @param[in] rowCount Number of scanlines.
+     * @param[in] scratch Buffer of at least rowCount * width * 4 floats that can be used to hold the scanlines.
+     *                    May be nullptr if needsScratch() returns false.
+     * @return Pointer to the tightly packed RGBA float scanlines. Valid until the next call.
+     */
+    virtual const float* readRows(uint32_t y, uint32_t rowCount, float* scratch) = 0;
+
+protected:
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+};
+
+/// Image reader for images held in memory.
+class MemoryImageReader : public ImageReader
+{
+public:
+    MemoryImageReader(std::shared_ptr<Image> image) : mImage(std::move(image))
+    {
+        mWidth = mImage->getWidth();
+        mHeight = mImage->getHeight();
+    }
+
+    bool needsScratch() const override { return false; }
+
+    const float* readRows(uint32_t y, uint32_t rowCount, float* scratch) override { return mImage->getData() + size_t(y) * mWidth * 4; }
+
+    const std::shared_ptr<Image>& getImage() const { return mImage; }
+
+private:
+    std::shared_ptr<Image> mImage;
+};
+
+/// Image reader streaming scanlines from an OpenEXR file.
+class EXRImageReader : public ImageReader
+{
+public:
+    EXRImageReader(const std::filesystem::path& path) : mFile(path.string().c_str(), Imf::globalThreadCount())
+    {
+        const Imath::Box2i& dataWindow = mFile.header().dataWindow();
+        mMinX = dataWindow.min.x;
+        mMinY = dataWindow.min.y;
+        mWidth = dataWindow.max.x - dataWindow.min.x + 1;
+        mHeight = dataWindow.max.y - dataWindow.min.y + 1;
+
+        // Single-channel images are stored in the Y channel. Replicate it to RGB.
+        const Imf::ChannelList& channels = mFile.header().channels();
+        bool isLuminance =
+            !channels.findChannel("R") && !channels.findChannel("G") && !channels.findChannel("B") && channels.findChannel("Y");
+        mChannelNames = {isLuminance ? "Y" : "R", isLuminance ? "Y" : "G", isLuminance ? "Y" : "B", "A"};
     }
 
-    void saveToFile(const std::filesystem::path& path, bool writeAlpha = true) const
+    bool needsScratch() const override { return true; }
+
+    const float* readRows(uint32_t y, uint32_t rowCount, float* scratch) override
     {
-        FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
+        const size_t pixelStride = 4 * sizeof(float);
+        const size_t rowPitch = pixelStride * mWidth;
 
-        auto pathStr = path.string();
+        // OpenEXR addresses pixels by their absolute coordinates in the data window.
+        char* base =
+            reinterpret_cast<char*>(scratch) - (ptrdiff_t(mMinY) + y) * ptrdiff_t(rowPitch) - ptrdiff_t(mMinX) * ptrdiff_t(pixelStride);
 
-        // Determine file format.
-        fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
-        if (fifFormat == FIF_UNKNOWN)
-            throw std::runtime_error("Unknown image format");
-        if (!FreeImage_FIFSupportsWriting(fifFormat))
-            throw std::runtime_error("Unsupported image format");
-
-        bool writeFloat = fifFormat == FIF_EXR || fifFormat == FIF_PFM || fifFormat == FIF_HDR;
-        if (fifFormat != FIF_EXR && fifFormat != FIF_PNG)
-            writeAlpha = false;
-
-        // Create bitmap.
-        FIBITMAP* bitmap;
-        const float* src = getData();
-        if (writeFloat)
-        {
-            bitmap = FreeImage_AllocateT(writeAlpha ? FIT_RGBAF : FIT_RGBF, mWidth, mHeight);
-            for (uint32_t y = 0; y < mHeight; y++)
-            {
-                float* dst = reinterpret_cast<float*>(FreeImage_GetScanLine(bitmap, mHeight - y - 1));
-                if (writeAlpha)
-                {
-                    std::memcpy(dst, src, mWidth * 4 * sizeof(float));
-                    src += mWidth * 4;
-                }
-                else
-                {
-                    for (uint32_t x = 0; x < mWidth; ++x)
-                    {
-                        dst[0] = src[0];
-                        dst[1] = src[1];
-                        dst[2] = src[2];
-                        dst += 3;
-                        src += 4;
-                    }
-                }
-            }
-        }
-        else
+        Imf::FrameBuffer frameBuffer;
+        for (size_t c = 0; c < 4; ++c)
         {
-            bitmap = FreeImage_Allocate(mWidth, mHeight, writeAlpha ? 32 : 24);
-            for (uint32_t y = 0; y < mHeight; y++)
-            {
-                uint8_t* dst = reinterpret_cast<uint8_t*>(FreeImage_GetScanLine(bitmap, mHeight - y - 1));
-                for (uint32_t x = 0; x < mWidth; ++x)
-                {
-                    dst[2] = clamp(int(src[0] * 255.f), 0, 255);
-                    dst[1] = clamp(int(src[1] * 255.f), 0, 255);
-                    dst[0] = clamp(int(src[2] * 255.f), 0, 255);
-                    if (writeAlpha)
-                        dst[3] = clamp(int(src[3] * 255.f), 0, 255);
-                    dst += writeAlpha ? 4 : 3;
-                    src += 4;
-                }
-            }
+            frameBuffer.insert(
+                mChannelNames[c], Imf::Slice(Imf::FLOAT, base + c * sizeof(float), pixelStride, rowPitch, 1, 1, c == 3 ? 1.0 : 0.0)
+            );
         }
+        mFile.setFrameBuffer(frameBuffer);
+        mFile.readPixels(mMinY + int(y), mMinY + int(y + rowCount) - 1);
 
-        // Write image.
-        FreeImage_Save(fifFormat, bitmap, pathStr.c_str());
-        FreeImage_Unload(bitmap);
+        return scratch;
     }
 
 private:
-    uint32_t mWidth;
-    uint32_t mHeight;
-    std::unique_ptr<float[]> mData;
+    Imf::InputFile mFile;
+    int mMinX = 0;
+    int mMinY = 0;
+    std::vector<const char*> mChannelNames;
 };
 
-struct MSE
+static std::unique_ptr<ImageReader> openImage(const std::filesystem::path& path, bool streaming)
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    // Stream EXR files. Other formats are not supported for streaming and are loaded completely.
+    if (streaming)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]);
-        return error / count;
+        auto ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return char(std::tolower(c)); });
+        if (ext == ".exr")
+        {
+            try
+            {
+                return std::make_unique<EXRImageReader>(path);
+            }
+            catch (const std::exception& e)
+            {
+                throw std::runtime_error(std::string("Cannot open EXR file: ") + e.what());
+            }
+        }
     }
+    return std::make_unique<MemoryImageReader>(loadImageFromFile(path));
+}
+
+// The metrics define the error of a single channel. The error of a pixel is the average over its channels, scaled by kScale.
+
+struct MSE
+{
+    static constexpr float kScale = 1.f;
+    static float eval(float a, float b) { return sqr(a - b); }
 };
 
 struct RMSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
-        return error / count;
-    }
+    static constexpr float kScale = 1.f;
+    static float eval(float a, float b) { return sqr(a - b) / (sqr(a) + 1e-3f); }
 };
 
 struct MAE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs(sqr(a[i] - b[i]));
-        return error / count;
-    }
+    static constexpr float kScale = 1.f;
+    static float eval(float a, float b) { return std::fabs(sqr(a - b)); }
 };
 
 struct MAPE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
-        return 100.0 * error / count;
-    }
+    static constexpr float kScale = 100.f;
+    static float eval(float a, float b) { return std::fabs((a - b) / (a + 1e-3f)); }
 };
 
-template<typename Metric>
-double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+/**
+ * Evaluate a metric over one scanline.
+ * The pixels are processed in fixed-size chunks with a compile-time channel count so that the loops vectorize.
+ * @param[in] a Scanline of the first image in RGBA float format.
+ * @param[in] b Scanline of the second image in RGBA float format.
+ * @param[in] width Number of pixels.
+ * @param[out] errorMap Optional per-pixel errors, or nullptr.
+ * @return Sum of the per-pixel errors.
+ */
+template<typename Metric, uint32_t Channels>
+double evalRow(const float* a, const float* b, uint32_t width, float* errorMap)
 {
-    Metric metric;
-    double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
-    for (size_t i = 0; i < count; ++i)
+    constexpr float kPixelScale = Metric::kScale / Channels;
+
+    double lanes[kAccumulatorLanes] = {};
+    float errors[kKernelChunkSize];
+    for (uint32_t x0 = 0; x0 < width; x0 += kKernelChunkSize)
     {
-        double error = metric(a, b, alpha ? 4 : 3);
+        const uint32_t count = std::min(kKernelChunkSize, width - x0);
+        const float* pa = a + size_t(x0) * 4;
+        const float* pb = b + size_t(x0) * 4;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float e = 0.f;
+            for (uint32_t c = 0; c < Channels; ++c)
+                e += Metric::eval(pa[i * 4 + c], pb[i * 4 + c]);
+            errors[i] = e * kPixelScale;
+        }
+
         if (errorMap)
-            *errorMap++ = float(error);
-        sum += error;
-        a += 4;
-        b += 4;
+            std::memcpy(errorMap + x0, errors, count * sizeof(float));
+
+        for (uint32_t i = 0; i < count; ++i)
+            lanes[i % kAccumulatorLanes] += errors[i];
     }
-    return sum / count;
+
+    double sum = 0.0;
+    for (uint32_t i = 0; i < kAccumulatorLanes; ++i)
+        sum += lanes[i];
+    return sum;
+}
+
+using RowKernel = double (*)(const float* a, const float* b, uint32_t width, float* errorMap);
+
+static double evalLDRFLIPMetric(const Image& a, const Image& b, bool alpha, float* errorMap)
+{
+    return evalFLIP(a, b, false, errorMap);
+}
+
+static double evalHDRFLIPMetric(const Image& a, const Image& b, bool alpha, float* errorMap)
+{
+    return evalFLIP(a, b, true, errorMap);
 }
 
+using ImageKernel = double (*)(const Image& a, const Image& b, bool alpha, float* errorMap);
+
 struct ErrorMetric
 {
     std::string name;
     std::string desc;
-    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    RowKernel evalRowRGB = nullptr;
+    RowKernel evalRowRGBA = nullptr;
+    ImageKernel evalImage = nullptr; ///< Metrics with spatial support operate on complete images and always produce an error map.
 };
 
 static const std::vector<ErrorMetric> errorMetrics = {
-    {"mse", "Mean Squared Error", compare<MSE>},
-    {"rmse", "Relative Mean Squared Error", compare<RMSE>},
-    {"mae", "Mean Absolute Error", compare<MAE>},
-    {"mape", "Mean Absolute Percentage Error", compare<MAPE>},
+    {"mse", "Mean Squared Error", evalRow<MSE, 3>, evalRow<MSE, 4>},
+    {"rmse", "Relative Mean Squared Error", evalRow<RMSE, 3>, evalRow<RMSE, 4>},
+    {"mae", "Mean Absolute Error", evalRow<MAE, 3>, evalRow<MAE, 4>},
+    {"mape", "Mean Absolute Percentage Error", evalRow<MAPE, 3>, evalRow<MAPE, 4>},
+    {"ssim", "Structural Dissimilarity (1 - SSIM)", nullptr, nullptr, evalSSIM},
+    {"flip", "FLIP (first image is the reference)", nullptr, nullptr, evalLDRFLIPMetric},
+    {"hdrflip", "HDR-FLIP with ACES tone mapping (first image is the reference)", nullptr, nullptr, evalHDRFLIPMetric},
 };
 
+/**
+ * Compare two images block by block.
+ * Scanlines within a block are evaluated in parallel. Each scanline is accumulated separately and the scanline
+ * sums are added in order, so the result is deterministic.
+ */
+static double compare(
+    ImageReader& readerA,
+    ImageReader& readerB,
+    const ErrorMetric& metric,
+    bool alpha,
+    uint32_t blockRows,
+    float* errorMap
+)
+{
+    const uint32_t width = readerA.getWidth();
+    const uint32_t height = readerA.getHeight();
+    const RowKernel evalRowKernel = alpha ? metric.evalRowRGBA : metric.evalRowRGB;
+
+    std::vector<double> rowSums(height);
+    // Only streaming readers need scratch memory, in-memory images are read in place.
+    const size_t scratchSize = size_t(std::min(blockRows, height)) * width * 4;
+    std::vector<float> scratchA(readerA.needsScratch() ? scratchSize : 0);
+    std::vector<float> scratchB(readerB.needsScratch() ? scratchSize : 0);
+
+    for (uint32_t y0 = 0; y0 < height; y0 += blockRows)
+    {
+        const uint32_t rowCount = std::min(blockRows, height - y0);
+
+        // Read both blocks concurrently.
+        auto futureA = std::async(std::launch::async, [&]() { return readerA.readRows(y0, rowCount, scratchA.data()); });
+        const float* b = readerB.readRows(y0, rowCount, scratchB.data());
+        const float* a = futureA.get();
+
+        forEachRow(
+            rowCount,
+            [&](uint32_t row)
+            {
+                const size_t offset = size_t(row) * width;
+                float* rowErrorMap = errorMap ? errorMap + size_t(y0) * width + offset : nullptr;
+                rowSums[y0 + row] = evalRowKernel(a + offset * 4, b + offset * 4, width, rowErrorMap);
+            }
+        );
+    }
+
+    double sum = 0.0;
+    for (double rowSum : rowSums)
+        sum += rowSum;
+    return sum / (double(width) * height);
+}
+
 static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
 {
     auto writeColor = [](float t, float* dst)
@@ -278,39 +471,68 @@ static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, c
         *dst++ = 1.f;
     };
 
-    const auto [minValue, maxValue] = std::minmax_element(errorMap, errorMap + width * height);
+    const auto [minValue, maxValue] = std::minmax_element(std::execution::par, errorMap, errorMap + size_t(width) * height);
     const float range = std::max(1e-5f, *maxValue - *minValue);
     auto image = Image::create(width, height);
-    float* dst = image->getData();
-    for (size_t i = 0; i < width * height; ++i)
-    {
-        float t = clamp((errorMap[i] - *minValue) / range, 0.f, 1.f);
-        writeColor(t, dst);
-        dst += 4;
-    }
+    forEachRow(
+        height,
+        [&](uint32_t y)
+        {
+            const float* src = errorMap + size_t(y) * width;
+            float* dst = image->getData() + size_t(y) * width * 4;
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                float t = clamp((src[x] - *minValue) / range, 0.f, 1.f);
+                writeColor(t, dst);
+                dst += 4;
+            }
+        }
+    );
 
     return image;
 }
 
-static bool compareImages(
+static bool isWithinThreshold(double error, float threshold)
+{
+    // Treat nans and infs as errors.
+    if (std::isnan(error) || std::isinf(error))
+        return false;
+
+    return error <= threshold;
+}
+
+/**
+ * Compare two image files.
+ * @param[in] pathA Path of the first image.
+ * @param[in] pathB Path of the second image.
+ * @param[in] metric Error metric.
+ * @param[in] alpha Include the alpha channel.
+ * @param[in] heatMapPath Path of the error heat map, or an empty path.
+ * @param[in] streaming Stream EXR images in blocks of scanlines. Ignored by metrics that operate on complete images.
+ * @return The error.
+ * @throws std::runtime_error if the images cannot be loaded or compared.
+ */
+static double compareFiles(
     const std::filesystem::path& pathA,
     const std::filesystem::path& pathB,
-    ErrorMetric metric,
-    float threshold,
+    const ErrorMetric& metric,
     bool alpha,
-    const std::filesystem::path& heatMapPath
+    const std::filesystem::path& heatMapPath,
+    bool streaming
 )
 {
-    auto loadImage = [](const std::filesystem::path& path)
+    if (metric.evalImage)
+        streaming = false;
+
+    auto openReader = [streaming](const std::filesystem::path& path)
     {
         try
         {
-            return Image::loadFromFile(path);
+            return openImage(path, streaming);
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot load image from '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
-            return std::shared_ptr<Image>{};
+            throw std::runtime_error("Cannot load image from '" + path.string() + "' (Error: " + e.what() + ").");
         }
     };
 
@@ -318,7 +540,7 @@ static bool compareImages(
     {
         try
         {
-            image.saveToFile(path);
+            saveImageToFile(image, path);
         }
         catch (const std::runtime_error& e)
         {
@@ -326,42 +548,339 @@ static bool compareImages(
         }
     };
 
-    // Load images.
-    auto imageA = loadImage(pathA);
-    if (!imageA)
-        return false;
-    auto imageB = loadImage(pathB);
-    if (!imageB)
-        return false;
+    // Open images. Images that are not streamed are loaded concurrently.
+    auto futureA = std::async(std::launch::async, openReader, pathA);
+    auto readerB = openReader(pathB);
+    auto readerA = futureA.get();
 
     // Check resolution.
-    if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
-    {
-        std::cerr << "Cannot compare images with different resolutions." << std::endl;
-        return false;
-    }
+    if (readerA->getWidth() != readerB->getWidth() || readerA->getHeight() != readerB->getHeight())
+        throw std::runtime_error("Cannot compare images with different resolutions.");
 
-    uint32_t width = imageA->getWidth();
-    uint32_t height = imageB->getHeight();
+    uint32_t width = readerA->getWidth();
+    uint32_t height = readerA->getHeight();
 
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    std::unique_ptr<float[]> errorMap =
+        heatMapPath.empty() && !metric.evalImage ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    double error;
+    try
+    {
+        if (metric.evalImage)
+        {
+            auto imageA = static_cast<MemoryImageReader&>(*readerA).getImage();
+            auto imageB = static_cast<MemoryImageReader&>(*readerB).getImage();
+            error = metric.evalImage(*imageA, *imageB, alpha, errorMap.get());
+        }
+        else
+        {
+            error = compare(*readerA, *readerB, metric, alpha, streaming ? kStreamBlockRows : height, errorMap.get());
+        }
+    }
+    catch (const std::exception& e)
+    {
+        throw std::runtime_error(std::string("Cannot compare images (Error: ") + e.what() + ").");
+    }
 
     // Generate heat map.
-    if (errorMap)
+    if (!heatMapPath.empty())
     {
         auto heatMap = generateHeatMap(width, height, errorMap.get());
         saveImage(*heatMap, heatMapPath);
     }
 
+    return error;
+}
+
+static bool compareImages(
+    const std::filesystem::path& pathA,
+    const std::filesystem::path& pathB,
+    const ErrorMetric& metric,
+    float threshold,
+    bool alpha,
+    const std::filesystem::path& heatMapPath,
+    bool streaming
+)
+{
+    double error;
+    try
+    {
+        error = compareFiles(pathA, pathB, metric, alpha, heatMapPath, streaming);
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
     std::cout << error << std::endl;
 
-    // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error))
+    return isWithinThreshold(error, threshold);
+}
+
+/// Result of comparing one image in batch mode.
+struct BatchResult
+{
+    std::filesystem::path relativePath;
+    double error = 0.0;
+    bool success = false;
+    std::string message;
+};
+
+static bool isImageFile(const std::filesystem::path& path)
+{
+    static const std::vector<std::string> extensions = {".bmp", ".exr", ".hdr", ".jpg", ".jpeg", ".pfm", ".png", ".tga", ".tif", ".tiff"};
+    auto ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return char(std::tolower(c)); });
+    return std::find(extensions.begin(), extensions.end(), ext) != extensions.end();
+}
+
+/// Collect the relative paths of all images in a directory tree, sorted by path.
+static std::vector<std::filesystem::path> collectImages(const std::filesystem::path& dir)
+{
+    std::vector<std::filesystem::path> images;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+    {
+        if (entry.is_regular_file() && isImageFile(entry.path()))
+            images.push_back(std::filesystem::relative(entry.path(), dir));
+    }
+    std::sort(images.begin(), images.end());
+    return images;
+}
+
+static std::string escapeJSON(const std::string& str)
+{
+    std::string result;
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                result += buf;
+            }
+            else
+            {
+                result += c;
+            }
+        }
+    }
+    return result;
+}
+
+static std::string escapeCSV(const std::string& str)
+{
+    if (str.find_first_of(",\"\n") == std::string::npos)
+        return str;
+
+    std::string result = "\"";
+    for (char c : str)
+    {
+        if (c == '"')
+            result += '"';
+        result += c;
+    }
+    return result + "\"";
+}
+
+/**
+ * Write the batch results to a report file.
+ * The format is determined by the file extension and is either CSV (.csv) or JSON (.json).
+ */
+static void writeReport(
+    const std::filesystem::path& path,
+    const std::vector<BatchResult>& results,
+    const ErrorMetric& metric,
+    float threshold
+)
+{
+    std::ofstream stream(path);
+    if (!stream)
+        throw std::runtime_error("Cannot open file");
+    stream << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+    if (path.extension() == ".json")
+    {
+        stream << "{\n";
+        stream << "  \"metric\": \"" << escapeJSON(metric.name) << "\",\n";
+        stream << "  \"threshold\": " << threshold << ",\n";
+        stream << "  \"images\": [";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = results[i];
+            stream << (i == 0 ? "\n" : ",\n");
+            stream << "    {\"name\": \"" << escapeJSON(result.relativePath.generic_string()) << "\", ";
+            stream << "\"success\": " << (result.success ? "true" : "false") << ", ";
+            stream << "\"error\": ";
+            if (result.message.empty() && !std::isnan(result.error) && !std::isinf(result.error))
+                stream << result.error;
+            else
+                stream << "null";
+            stream << ", \"message\": \"" << escapeJSON(result.message) << "\"}";
+        }
+        stream << "\n  ]\n}\n";
+    }
+    else
+    {
+        stream << "name,success,error,message\n";
+        for (const auto& result : results)
+        {
+            stream << escapeCSV(result.relativePath.generic_string()) << "," << (result.success ? "true" : "false") << ",";
+            if (result.message.empty())
+                stream << result.error;
+            stream << "," << escapeCSV(result.message) << "\n";
+        }
+    }
+
+    if (!stream)
+        throw std::runtime_error("Cannot write file");
+}
+
+/**
+ * Compare all images in two directory trees.
+ * Images are matched by their relative paths and compared in parallel. Images that only exist in one of the
+ * directories are reported as failures.
+ * @param[in] jobCount Maximum number of images compared at the same time.
+ * @return True if all images were compared successfully and their errors are within the threshold.
+ */
+static bool compareDirectories(
+    const std::filesystem::path& dirA,
+    const std::filesystem::path& dirB,
+    const ErrorMetric& metric,
+    float threshold,
+    bool alpha,
+    const std::filesystem::path& heatMapDir,
+    bool streaming,
+    const std::filesystem::path& reportPath,
+    uint32_t jobCount
+)
+{
+    if (!reportPath.empty() && reportPath.extension() != ".csv" && reportPath.extension() != ".json")
+    {
+        std::cerr << "Unknown report format '" << reportPath.extension().string() << "' (expected .csv or .json)." << std::endl;
         return false;
+    }
 
-    return error <= threshold;
+    for (const auto& dir : {dirA, dirB})
+    {
+        if (!std::filesystem::is_directory(dir))
+        {
+            std::cerr << "Directory '" << dir.string() << "' does not exist." << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<std::filesystem::path> imagesA;
+    std::vector<std::filesystem::path> imagesB;
+    try
+    {
+        imagesA = collectImages(dirA);
+        imagesB = collectImages(dirB);
+    }
+    catch (const std::filesystem::filesystem_error& e)
+    {
+        std::cerr << "Cannot list images (Error: " << e.what() << ")." << std::endl;
+        return false;
+    }
+
+    std::vector<std::filesystem::path> images;
+    std::set_union(imagesA.begin(), imagesA.end(), imagesB.begin(), imagesB.end(), std::back_inserter(images));
+    if (images.empty())
+    {
+        std::cerr << "No images found in '" << dirA.string() << "' and '" << dirB.string() << "'." << std::endl;
+        return false;
+    }
+
+    std::vector<BatchResult> results(images.size());
+    for (size_t i = 0; i < images.size(); ++i)
+        results[i].relativePath = images[i];
+
+    auto compareImage = [&](BatchResult& result)
+    {
+        const auto& path = result.relativePath;
+        for (const auto& [dir, dirImages] : {std::make_pair(dirA, &imagesA), std::make_pair(dirB, &imagesB)})
+        {
+            if (!std::binary_search(dirImages->begin(), dirImages->end(), path))
+            {
+                result.message = "Image does not exist in '" + dir.string() + "'.";
+                return;
+            }
+        }
+
+        try
+        {
+            std::filesystem::path heatMapPath;
+            if (!heatMapDir.empty())
+            {
+                heatMapPath = heatMapDir / path;
+                std::filesystem::create_directories(heatMapPath.parent_path());
+            }
+            result.error = compareFiles(dirA / path, dirB / path, metric, alpha, heatMapPath, streaming);
+            result.success = isWithinThreshold(result.error, threshold);
+        }
+        catch (const std::exception& e)
+        {
+            result.message = e.what();
+        }
+    };
+
+    // Each comparison holds both images and is parallelized internally, so only a few images are compared at a time.
+    std::atomic<size_t> nextResult = 0;
+    std::vector<std::thread> workers(std::min(size_t(std::max(jobCount, 1u)), results.size()));
+    for (auto& worker : workers)
+    {
+        worker = std::thread(
+            [&]()
+            {
+                for (size_t i = nextResult++; i < results.size(); i = nextResult++)
+                    compareImage(results[i]);
+            }
+        );
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    size_t failedCount = 0;
+    for (const auto& result : results)
+    {
+        if (result.message.empty())
+            std::cout << result.relativePath.generic_string() << ": " << result.error << (result.success ? "" : " (failed)") << std::endl;
+        else
+            std::cerr << result.relativePath.generic_string() << ": " << result.message << std::endl;
+        if (!result.success)
+            ++failedCount;
+    }
+    std::cout << "Compared " << results.size() << " images, " << failedCount << " failed." << std::endl;
+
+    if (!reportPath.empty())
+    {
+        try
+        {
+            writeReport(reportPath, results, metric, threshold);
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cerr << "Cannot write report to '" << reportPath.string() << "' (Error: " << e.what() << ")." << std::endl;
+            return false;
+        }
+    }
+
+    return failedCount == 0;
 }
 
 static void printMetrics(std::ostream& stream = std::cout)
@@ -382,9 +901,27 @@ int main(int argc, char** argv)
     args::ValueFlag<std::string> metricFlag(parser, "metric", "The error metric.", {'m'});
     args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
-    args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
-    args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
-    args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
+    args::ValueFlag<std::string> heatMapFlag(
+        parser, "filename", "Generate error heat map. In batch mode, the directory for the heat maps.", {'e'}
+    );
+    args::Flag streamFlag(
+        parser, "", "Stream EXR images in blocks of scanlines instead of loading them completely. Reduces memory use for large images.",
+        {'s', "stream"}
+    );
+    args::Flag batchFlag(
+        parser, "", "Compare all images in two directory trees. Images are matched by their relative paths.", {'b', "batch"}
+    );
+    args::ValueFlag<std::string> reportFlag(
+        parser, "filename", "Write the batch mode results to a CSV (.csv) or JSON (.json) report.", {'r', "report"}
+    );
+    args::ValueFlag<uint32_t> jobsFlag(
+        parser, "count",
+        "Maximum number of images compared at the same time in batch mode (default " + std::to_string(kDefaultBatchJobs) + ").", {'j', "jobs"}
+    );
+    args::Positional<std::string> image1(
+        parser, "image1", "The first image (the reference), or directory in batch mode.", args::Options::Required
+    );
+    args::Positional<std::string> image2(parser, "image2", "The second image, or directory in batch mode.", args::Options::Required);
     args::CompletionFlag completionFlag(parser, {"complete"});
 
     try
@@ -414,6 +951,9 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    // Let OpenEXR decode blocks of scanlines in parallel.
+    Imf::setGlobalThreadCount(std::thread::hardware_concurrency());
+
     if (listMetricsFlag)
     {
         printMetrics();
@@ -435,9 +975,23 @@ int main(int argc, char** argv)
         metric = *it;
     }
 
-    bool success = compareImages(
-        args::get(image1), args::get(image2), metric, thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false, heatMapFlag ? args::get(heatMapFlag) : ""
-    );
+    float threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    bool alpha = alphaFlag ? args::get(alphaFlag) : false;
+    std::string heatMap = heatMapFlag ? args::get(heatMapFlag) : "";
+    bool streaming = streamFlag ? args::get(streamFlag) : false;
+    uint32_t jobCount = jobsFlag ? args::get(jobsFlag) : kDefaultBatchJobs;
+
+    bool success;
+    if (batchFlag)
+    {
+        success = compareDirectories(
+            args::get(image1), args::get(image2), metric, threshold, alpha, heatMap, streaming, reportFlag ? args::get(reportFlag) : "",
+            jobCount
+        );
+    }
+    else
+    {
+        success = compareImages(args::get(image1), args::get(image2), metric, threshold, alpha, heatMap, streaming);
+    }
     return success ? 0 : 1;
 }
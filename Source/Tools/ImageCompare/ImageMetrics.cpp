@@ -0,0 +1,663 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ImageMetrics.h"
+
+#include <cmath>
+
+namespace ImageCompare
+{
+/**
+ * Compute the mean of an error map.
+ * Scanlines are accumulated in parallel and the scanline sums are added in order, so the result is deterministic.
+ */
+static double meanError(const float* errorMap, uint32_t width, uint32_t height)
+{
+    std::vector<double> rowSums(height);
+    forEachRow(
+        height,
+        [&](uint32_t y)
+        {
+            const float* row = errorMap + size_t(y) * width;
+            double lanes[kAccumulatorLanes] = {};
+            for (uint32_t x = 0; x < width; ++x)
+                lanes[x % kAccumulatorLanes] += row[x];
+            rowSums[y] = std::accumulate(lanes, lanes + kAccumulatorLanes, 0.0);
+        }
+    );
+
+    double sum = 0.0;
+    for (double rowSum : rowSums)
+        sum += rowSum;
+    return sum / (double(width) * height);
+}
+
+/// One-dimensional filter kernel. Image borders are handled by clamping to the edge.
+struct FilterKernel
+{
+    int radius = 0;
+    std::vector<float> weights; ///< 2 * radius + 1 weights.
+
+    float sum() const { return std::accumulate(weights.begin(), weights.end(), 0.f); }
+};
+
+template<typename Func>
+static FilterKernel createKernel(int radius, Func func)
+{
+    FilterKernel kernel;
+    kernel.radius = radius;
+    kernel.weights.resize(2 * radius + 1);
+    for (int x = -radius; x <= radius; ++x)
+        kernel.weights[x + radius] = func(float(x));
+    return kernel;
+}
+
+/**
+ * Filter a scanline horizontally.
+ * @param[in] src Source scanline of width values.
+ * @param[out] dst Destination scanline of width values.
+ * @param[in] width Number of pixels.
+ * @param[in] kernel Filter kernel.
+ * @param[in,out] padded Scratch buffer for the scanline padded by the kernel radius.
+ */
+static void filterRow(const float* src, float* dst, uint32_t width, const FilterKernel& kernel, std::vector<float>& padded)
+{
+    const int radius = kernel.radius;
+    padded.resize(width + 2 * radius);
+    for (int x = 0; x < int(padded.size()); ++x)
+        padded[x] = src[clamp(x - radius, 0, int(width) - 1)];
+
+    std::fill(dst, dst + width, 0.f);
+    for (int i = 0; i <= 2 * radius; ++i)
+    {
+        const float weight = kernel.weights[i];
+        const float* shifted = padded.data() + i;
+        for (uint32_t x = 0; x < width; ++x)
+            dst[x] += weight * shifted[x];
+    }
+}
+
+/**
+ * Filter one scanline of a plane vertically and add the result to the destination scanline.
+ * @param[in] src Source plane of width * height values.
+ * @param[in,out] dst Destination scanline of width values.
+ * @param[in] width Width of the plane.
+ * @param[in] height Height of the plane.
+ * @param[in] y Scanline to filter.
+ * @param[in] kernel Filter kernel.
+ */
+static void addColumnFilter(const float* src, float* dst, uint32_t width, uint32_t height, uint32_t y, const FilterKernel& kernel)
+{
+    for (int i = -kernel.radius; i <= kernel.radius; ++i)
+    {
+        const float weight = kernel.weights[i + kernel.radius];
+        const float* srcRow = src + size_t(clamp(int(y) + i, 0, int(height) - 1)) * width;
+        for (uint32_t x = 0; x < width; ++x)
+            dst[x] += weight * srcRow[x];
+    }
+}
+
+// SSIM [Wang et al. 2004] with an 11x11 Gaussian window and constants for a dynamic range of 1.
+// The error of a pixel is the structural dissimilarity (1 - SSIM) averaged over its channels.
+
+static constexpr int kSSIMRadius = 5;
+static constexpr float kSSIMSigma = 1.5f;
+static constexpr float kSSIMC1 = 0.01f * 0.01f;
+static constexpr float kSSIMC2 = 0.03f * 0.03f;
+
+double evalSSIM(const Image& a, const Image& b, bool alpha, float* errorMap)
+{
+    const uint32_t width = a.getWidth();
+    const uint32_t height = a.getHeight();
+    const uint32_t channels = alpha ? 4 : 3;
+
+    FilterKernel kernel = createKernel(kSSIMRadius, [](float x) { return std::exp(-sqr(x) / (2.f * sqr(kSSIMSigma))); });
+    const float kernelSum = kernel.sum();
+    for (float& weight : kernel.weights)
+        weight /= kernelSum;
+
+    // Local moments E[a], E[b], E[a^2], E[b^2] and E[ab], filtered horizontally.
+    constexpr size_t kMomentCount = 5;
+    std::vector<float> moments[kMomentCount];
+    for (auto& moment : moments)
+        moment.resize(size_t(width) * height);
+
+    std::fill(errorMap, errorMap + size_t(width) * height, 0.f);
+    for (uint32_t c = 0; c < channels; ++c)
+    {
+        forEachRow(
+            height,
+            [&](uint32_t y)
+            {
+                const float* pa = a.getData() + size_t(y) * width * 4;
+                const float* pb = b.getData() + size_t(y) * width * 4;
+                std::vector<float> values[kMomentCount];
+                for (auto& value : values)
+                    value.resize(width);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    const float va = pa[x * 4 + c];
+                    const float vb = pb[x * 4 + c];
+                    values[0][x] = va;
+                    values[1][x] = vb;
+                    values[2][x] = va * va;
+                    values[3][x] = vb * vb;
+                    values[4][x] = va * vb;
+                }
+
+                std::vector<float> padded;
+                for (size_t i = 0; i < kMomentCount; ++i)
+                    filterRow(values[i].data(), moments[i].data() + size_t(y) * width, width, kernel, padded);
+            }
+        );
+
+        forEachRow(
+            height,
+            [&](uint32_t y)
+            {
+                std::vector<float> filtered[kMomentCount];
+                for (size_t i = 0; i < kMomentCount; ++i)
+                {
+                    filtered[i].assign(width, 0.f);
+                    addColumnFilter(moments[i].data(), filtered[i].data(), width, height, y, kernel);
+                }
+
+                float* dst = errorMap + size_t(y) * width;
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    const float meanA = filtered[0][x];
+                    const float meanB = filtered[1][x];
+                    const float varA = filtered[2][x] - meanA * meanA;
+                    const float varB = filtered[3][x] - meanB * meanB;
+                    const float covAB = filtered[4][x] - meanA * meanB;
+                    const float ssim = ((2.f * meanA * meanB + kSSIMC1) * (2.f * covAB + kSSIMC2)) /
+                                       ((meanA * meanA + meanB * meanB + kSSIMC1) * (varA + varB + kSSIMC2));
+                    dst[x] += (1.f - ssim) / channels;
+                }
+            }
+        );
+    }
+
+    return meanError(errorMap, width, height);
+}
+
+// CPU port of FLIP [Andersson et al. 2020] matching FLIPPass, using its default settings.
+// FLIPPass evaluates the contrast sensitivity and feature detection filters over a square window. These filters are
+// sums of products of one-dimensional functions, so they are evaluated here as horizontal and vertical passes.
+// The first image is the reference.
+
+static constexpr float kPi = 3.14159265358979323846f;
+
+static constexpr float kFLIPgqc = 0.7f;
+static constexpr float kFLIPgpc = 0.4f;
+static constexpr float kFLIPgpt = 0.95f;
+static constexpr float kFLIPgw = 0.082f;
+static constexpr float kFLIPgqf = 0.5f;
+
+// Viewing conditions for the pixels per degree calculation.
+static constexpr uint32_t kFLIPMonitorWidthPixels = 3840;
+static constexpr float kFLIPMonitorWidthMeters = 0.7f;
+static constexpr float kFLIPMonitorDistanceMeters = 0.7f;
+
+/// Maximum number of exposure stops covered by HDR-FLIP. Guards against images with a median luminance of zero.
+static constexpr int kFLIPMaxExposureStops = 19;
+
+struct Float3
+{
+    float x, y, z;
+};
+
+static Float3 linearRGBToXYZ(Float3 c)
+{
+    // Assumes D65 standard illuminant.
+    return {
+        (10135552.f * c.x + 8788810.f * c.y + 4435075.f * c.z) / 24577794.f,
+        (2613072.f * c.x + 8788810.f * c.y + 887015.f * c.z) / 12288897.f,
+        (1425312.f * c.x + 8788810.f * c.y + 70074185.f * c.z) / 73733382.f,
+    };
+}
+
+static Float3 XYZToLinearRGB(Float3 c)
+{
+    // Assumes D65 standard illuminant.
+    return {
+        3.241003275f * c.x - 1.537398934f * c.y - 0.498615861f * c.z,
+        -0.969224334f * c.x + 1.875930071f * c.y + 0.041554224f * c.z,
+        0.055639423f * c.x - 0.204011202f * c.y + 1.057148933f * c.z,
+    };
+}
+
+static const Float3 kD65ReferenceIlluminant = {0.950428545f, 1.000000000f, 1.088900371f};
+static const Float3 kInvD65ReferenceIlluminant = {1.052156925f, 1.000000000f, 0.918357670f};
+
+static Float3 XYZToCIELab(Float3 c)
+{
+    const float delta = 6.f / 29.f;
+    const float deltaCube = delta * delta * delta;
+    const float factor = 1.f / (3.f * delta * delta);
+    const float term = 4.f / 29.f;
+    auto f = [&](float t) { return t > deltaCube ? std::cbrt(t) : factor * t + term; };
+
+    const float x = f(c.x * kInvD65ReferenceIlluminant.x);
+    const float y = f(c.y * kInvD65ReferenceIlluminant.y);
+    const float z = f(c.z * kInvD65ReferenceIlluminant.z);
+    return {116.f * y - 16.f, 500.f * (x - y), 200.f * (y - z)};
+}
+
+static Float3 linearRGBToYCxCz(Float3 rgb)
+{
+    const Float3 c = linearRGBToXYZ(rgb);
+    const float x = c.x * kInvD65ReferenceIlluminant.x;
+    const float y = c.y * kInvD65ReferenceIlluminant.y;
+    const float z = c.z * kInvD65ReferenceIlluminant.z;
+    return {116.f * y - 16.f, 500.f * (x - y), 200.f * (y - z)};
+}
+
+static Float3 YCxCzToLinearRGB(Float3 c)
+{
+    const float y = (c.x + 16.f) / 116.f;
+    const float x = c.y / 500.f + y;
+    const float z = y - c.z / 200.f;
+    return XYZToLinearRGB({x * kD65ReferenceIlluminant.x, y * kD65ReferenceIlluminant.y, z * kD65ReferenceIlluminant.z});
+}
+
+static Float3 hunt(Float3 c)
+{
+    const float huntValue = 0.01f * c.x;
+    return {c.x, huntValue * c.y, huntValue * c.z};
+}
+
+static float hyAB(Float3 a, Float3 b)
+{
+    return std::fabs(a.x - b.x) + std::sqrt(sqr(a.y - b.y) + sqr(a.z - b.z));
+}
+
+static float toneMapACES(float x)
+{
+    // ACES approximation with pre-exposure cancellation, see ToneMappers.slang.
+    const float k0 = 0.6f * 0.6f * 2.51f;
+    const float k1 = 0.6f * 0.03f;
+    const float k3 = 0.6f * 0.6f * 2.43f;
+    const float k4 = 0.6f * 0.59f;
+    const float k5 = 0.14f;
+
+    const float nom = k0 * x * x + k1 * x;
+    float denom = k3 * x * x + k4 * x + k5;
+    if (std::isinf(denom))
+        denom = 1.f;
+    return clamp(nom / denom, 0.f, 1.f);
+}
+
+static float flipMaxDistance()
+{
+    static const float maxDistance = std::pow(
+        hyAB(hunt(XYZToCIELab(linearRGBToXYZ({0.f, 1.f, 0.f}))), hunt(XYZToCIELab(linearRGBToXYZ({0.f, 0.f, 1.f})))), kFLIPgqc
+    );
+    return maxDistance;
+}
+
+static float redistributeErrors(float colorDifference, float featureDifference)
+{
+    const float maxDistance = flipMaxDistance();
+    const float perceptualCutoff = kFLIPgpc * maxDistance;
+
+    float error = std::pow(colorDifference, kFLIPgqc);
+    if (error < perceptualCutoff)
+        error *= kFLIPgpt / perceptualCutoff;
+    else
+        error = kFLIPgpt + ((error - perceptualCutoff) / (maxDistance - perceptualCutoff)) * (1.f - kFLIPgpt);
+
+    return std::pow(error, 1.f - featureDifference);
+}
+
+/// Separable filters of FLIP.
+struct FLIPFilters
+{
+    /// Term of a contrast sensitivity function. Each term is a Gaussian applied to one YCxCz channel.
+    struct CSFTerm
+    {
+        uint32_t channel;
+        FilterKernel horizontal;
+        FilterKernel vertical; ///< Includes the term weight and the normalization of the two-dimensional filter.
+    };
+
+    std::vector<CSFTerm> csfTerms;
+    FilterKernel gaussian; ///< Gaussian of the feature detection filters.
+    FilterKernel point;    ///< Second derivative of the Gaussian, normalized by the sum of the positive or negative weights.
+    FilterKernel edge;     ///< First derivative of the Gaussian, normalized by the sum of the positive weights.
+
+    size_t getPlaneCount() const { return csfTerms.size() + 3; }
+};
+
+static FLIPFilters createFLIPFilters()
+{
+    const float pixelsPerDegree = kFLIPMonitorDistanceMeters * (kFLIPMonitorWidthPixels / kFLIPMonitorWidthMeters) * (kPi / 180.f);
+    const float dx = 1.f / pixelsPerDegree;
+
+    // Radius of the spatial filter kernel, which is always greater than or equal to the radius of the feature detection kernel.
+    const int radius = int(std::ceil(3.f * std::sqrt(0.04f / (2.f * kPi * kPi)) * pixelsPerDegree));
+
+    FLIPFilters filters;
+
+    // Color pipeline. The contrast sensitivity functions are a1 * sqrt(pi / b1) * exp(-pi^2 * r^2 / b1) + a2 * (...).
+    struct
+    {
+        uint32_t channel;
+        float a1, a2, b1, b2;
+    } csfs[] = {
+        {0, 1.f, 0.f, 0.0047f, 1.0e-5f}, // A
+        {1, 1.f, 0.f, 0.0053f, 1.0e-5f}, // RG
+        {2, 34.1f, 13.5f, 0.04f, 0.025f}, // BY
+    };
+    for (const auto& csf : csfs)
+    {
+        const size_t firstTerm = filters.csfTerms.size();
+        std::vector<float> termWeights;
+        float kernelSum = 0.f;
+        for (auto [a, b] : {std::make_pair(csf.a1, csf.b1), std::make_pair(csf.a2, csf.b2)})
+        {
+            if (a == 0.f)
+                continue;
+            FilterKernel kernel = createKernel(radius, [&](float x) { return std::exp(-sqr(x * dx * kPi) / b); });
+            const float weight = a * std::sqrt(kPi / b);
+            kernelSum += weight * sqr(kernel.sum());
+            termWeights.push_back(weight);
+            filters.csfTerms.push_back({csf.channel, kernel, kernel});
+        }
+        for (size_t i = firstTerm; i < filters.csfTerms.size(); ++i)
+        {
+            for (float& weight : filters.csfTerms[i].vertical.weights)
+                weight *= termWeights[i - firstTerm] / kernelSum;
+        }
+    }
+
+    // Feature pipeline.
+    const float sigmaSquared = sqr(0.5f * kFLIPgw * pixelsPerDegree);
+    filters.gaussian = createKernel(radius, [&](float x) { return std::exp(-sqr(x) / (2.f * sigmaSquared)); });
+    filters.point = createKernel(radius, [&](float x) { return (sqr(x) / sigmaSquared - 1.f) * std::exp(-sqr(x) / (2.f * sigmaSquared)); });
+    filters.edge = createKernel(radius, [&](float x) { return -x * std::exp(-sqr(x) / (2.f * sigmaSquared)); });
+
+    const float gaussianSum = filters.gaussian.sum();
+    float positiveSum = 0.f;
+    float negativeSum = 0.f;
+    float edgeSum = 0.f;
+    for (int i = 0; i <= 2 * radius; ++i)
+    {
+        positiveSum += std::max(filters.point.weights[i], 0.f) * gaussianSum;
+        negativeSum += std::max(-filters.point.weights[i], 0.f) * gaussianSum;
+        edgeSum += std::max(filters.edge.weights[i], 0.f) * gaussianSum;
+    }
+    for (float& weight : filters.point.weights)
+        weight /= weight >= 0.f ? positiveSum : negativeSum;
+    for (float& weight : filters.edge.weights)
+        weight /= edgeSum;
+
+    return filters;
+}
+
+/**
+ * Convert an image to YCxCz and apply the horizontal passes of the FLIP filters.
+ * @param[in] image Image in RGBA float format.
+ * @param[in] filters FLIP filters.
+ * @param[in] isHDR Apply exposure compensation and tone mapping.
+ * @param[in] exposure Exposure in stops.
+ * @param[out] planes Horizontally filtered planes: one per contrast sensitivity term, followed by the feature planes
+ *                    filtered by the Gaussian, point and edge kernels.
+ */
+static void filterFLIPRows(
+    const Image& image,
+    const FLIPFilters& filters,
+    bool isHDR,
+    float exposure,
+    std::vector<std::vector<float>>& planes
+)
+{
+    const uint32_t width = image.getWidth();
+    const uint32_t height = image.getHeight();
+    const float exposureScale = std::exp2(exposure);
+    const size_t featurePlane = filters.csfTerms.size();
+
+    planes.resize(filters.getPlaneCount());
+    for (auto& plane : planes)
+        plane.resize(size_t(width) * height);
+
+    forEachRow(
+        height,
+        [&](uint32_t y)
+        {
+            std::vector<float> channels[3];
+            std::vector<float> luminance(width);
+            for (auto& channel : channels)
+                channel.resize(width);
+
+            const float* src = image.getData() + size_t(y) * width * 4;
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                Float3 rgb = {src[x * 4], src[x * 4 + 1], src[x * 4 + 2]};
+                if (isHDR)
+                    rgb = {toneMapACES(exposureScale * rgb.x), toneMapACES(exposureScale * rgb.y), toneMapACES(exposureScale * rgb.z)};
+                const Float3 ycxcz = linearRGBToYCxCz(rgb);
+                channels[0][x] = ycxcz.x;
+                channels[1][x] = ycxcz.y;
+                channels[2][x] = ycxcz.z;
+                luminance[x] = (ycxcz.x + 16.f) / 116.f; // Normalized Y from YCxCz.
+            }
+
+            std::vector<float> padded;
+            const size_t offset = size_t(y) * width;
+            for (size_t i = 0; i < filters.csfTerms.size(); ++i)
+            {
+                const auto& term = filters.csfTerms[i];
+                filterRow(channels[term.channel].data(), planes[i].data() + offset, width, term.horizontal, padded);
+            }
+            filterRow(luminance.data(), planes[featurePlane].data() + offset, width, filters.gaussian, padded);
+            filterRow(luminance.data(), planes[featurePlane + 1].data() + offset, width, filters.point, padded);
+            filterRow(luminance.data(), planes[featurePlane + 2].data() + offset, width, filters.edge, padded);
+        }
+    );
+}
+
+/// Filtered scanline of one image: YCxCz channels and point and edge gradients.
+struct FLIPRow
+{
+    std::vector<float> color[3];
+    std::vector<float> point[2];
+    std::vector<float> edge[2];
+};
+
+static void filterFLIPColumns(
+    const std::vector<std::vector<float>>& planes,
+    const FLIPFilters& filters,
+    uint32_t width,
+    uint32_t height,
+    uint32_t y,
+    FLIPRow& row
+)
+{
+    for (auto* rows : {row.color, row.point, row.edge})
+    {
+        for (size_t i = 0; i < (rows == row.color ? 3 : 2); ++i)
+            rows[i].assign(width, 0.f);
+    }
+
+    for (size_t i = 0; i < filters.csfTerms.size(); ++i)
+    {
+        const auto& term = filters.csfTerms[i];
+        addColumnFilter(planes[i].data(), row.color[term.channel].data(), width, height, y, term.vertical);
+    }
+
+    const size_t featurePlane = filters.csfTerms.size();
+    const float* gaussianPlane = planes[featurePlane].data();
+    addColumnFilter(planes[featurePlane + 1].data(), row.point[0].data(), width, height, y, filters.gaussian);
+    addColumnFilter(gaussianPlane, row.point[1].data(), width, height, y, filters.point);
+    addColumnFilter(planes[featurePlane + 2].data(), row.edge[0].data(), width, height, y, filters.gaussian);
+    addColumnFilter(gaussianPlane, row.edge[1].data(), width, height, y, filters.edge);
+}
+
+/**
+ * Evaluate LDR-FLIP for one exposure.
+ * @param[in] reference Reference image.
+ * @param[in] test Test image.
+ * @param[in] filters FLIP filters.
+ * @param[in] isHDR Apply exposure compensation and tone mapping.
+ * @param[in] exposure Exposure in stops.
+ * @param[in,out] errorMap Per-pixel errors. When evaluating HDR-FLIP, each error is replaced if the new error is larger.
+ */
+static void evalLDRFLIP(const Image& reference, const Image& test, const FLIPFilters& filters, bool isHDR, float exposure, float* errorMap)
+{
+    const uint32_t width = reference.getWidth();
+    const uint32_t height = reference.getHeight();
+
+    std::vector<std::vector<float>> referencePlanes;
+    std::vector<std::vector<float>> testPlanes;
+    filterFLIPRows(reference, filters, isHDR, exposure, referencePlanes);
+    filterFLIPRows(test, filters, isHDR, exposure, testPlanes);
+
+    forEachRow(
+        height,
+        [&](uint32_t y)
+        {
+            FLIPRow referenceRow;
+            FLIPRow testRow;
+            filterFLIPColumns(referencePlanes, filters, width, height, y, referenceRow);
+            filterFLIPColumns(testPlanes, filters, width, height, y, testRow);
+
+            float* dst = errorMap + size_t(y) * width;
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                // Color pipeline.
+                auto toLab = [x](const FLIPRow& row)
+                {
+                    Float3 rgb = YCxCzToLinearRGB({row.color[0][x], row.color[1][x], row.color[2][x]});
+                    rgb = {clamp(rgb.x, 0.f, 1.f), clamp(rgb.y, 0.f, 1.f), clamp(rgb.z, 0.f, 1.f)};
+                    return hunt(XYZToCIELab(linearRGBToXYZ(rgb)));
+                };
+                const float colorDifference = hyAB(toLab(referenceRow), toLab(testRow));
+
+                // Feature pipeline.
+                auto length = [x](const std::vector<float>* gradient) { return std::sqrt(sqr(gradient[0][x]) + sqr(gradient[1][x])); };
+                const float edgeDifference = std::fabs(length(referenceRow.edge) - length(testRow.edge));
+                const float pointDifference = std::fabs(length(referenceRow.point) - length(testRow.point));
+                const float featureDifference = std::pow(std::max(pointDifference, edgeDifference) * std::sqrt(0.5f), kFLIPgqf);
+
+                const float error = redistributeErrors(colorDifference, featureDifference);
+                if (!isHDR)
+                    dst[x] = error;
+                else if (error > dst[x])
+                    dst[x] = error;
+            }
+        }
+    );
+}
+
+/// Compute the exposure range of HDR-FLIP from the luminance of the reference image, see FLIPPass::computeExposureParameters().
+static void computeFLIPExposures(const Image& reference, float& startExposure, float& exposureDelta, uint32_t& exposureCount)
+{
+    const uint32_t width = reference.getWidth();
+    const size_t pixelCount = size_t(width) * reference.getHeight();
+    std::vector<float> luminance(pixelCount);
+    forEachRow(
+        reference.getHeight(),
+        [&](uint32_t y)
+        {
+            const float* src = reference.getData() + size_t(y) * width * 4;
+            float* dst = luminance.data() + size_t(y) * width;
+            for (uint32_t x = 0; x < width; ++x)
+                dst[x] = 0.2126f * src[x * 4] + 0.7152f * src[x * 4 + 1] + 0.0722f * src[x * 4 + 2];
+        }
+    );
+
+    const float maxLuminance = *std::max_element(luminance.begin(), luminance.end());
+    if (!(maxLuminance > 0.f))
+    {
+        // A black reference has no exposure range, so compare at a single exposure of 0.
+        startExposure = 0.f;
+        exposureDelta = 0.f;
+        exposureCount = 1;
+        return;
+    }
+
+    auto median = luminance.begin() + pixelCount / 2;
+    std::nth_element(luminance.begin(), median, luminance.end());
+    float medianLuminance = *median;
+    if (pixelCount % 2 == 0)
+        medianLuminance = 0.5f * (medianLuminance + *std::max_element(luminance.begin(), median));
+    medianLuminance = std::max(medianLuminance, std::ldexp(maxLuminance, -kFLIPMaxExposureStops));
+
+    // Solve for the input value that the ACES tone mapper maps to t.
+    const float tmCoefficients[6] = {0.6f * 0.6f * 2.51f, 0.6f * 0.03f, 0.f, 0.6f * 0.6f * 2.43f, 0.6f * 0.59f, 0.14f};
+    const float t = 0.85f;
+    const float a = tmCoefficients[0] - t * tmCoefficients[3];
+    const float b = tmCoefficients[1] - t * tmCoefficients[4];
+    const float c = tmCoefficients[2] - t * tmCoefficients[5];
+    const float xMax = a == 0.f ? -c / b : -0.5f * (b / a) + std::sqrt(sqr(0.5f * (b / a)) - c / a);
+
+    startExposure = std::log2(xMax / maxLuminance);
+    const float stopExposure = std::log2(xMax / medianLuminance);
+    exposureCount = uint32_t(std::max(2.f, std::ceil(stopExposure - startExposure)));
+    exposureDelta = (stopExposure - startExposure) / (exposureCount - 1.f);
+}
+
+double evalFLIP(const Image& reference, const Image& test, bool isHDR, float* errorMap)
+{
+    const uint32_t width = reference.getWidth();
+    const uint32_t height = reference.getHeight();
+    const size_t pixelCount = size_t(width) * height;
+    const FLIPFilters filters = createFLIPFilters();
+
+    if (isHDR)
+    {
+        // HDR-FLIP is the maximum LDR-FLIP over a range of exposures.
+        std::fill(errorMap, errorMap + pixelCount, 0.f);
+        float startExposure = 0.f;
+        float exposureDelta = 0.f;
+        uint32_t exposureCount = 1;
+        computeFLIPExposures(reference, startExposure, exposureDelta, exposureCount);
+        for (uint32_t i = 0; i < exposureCount; ++i)
+            evalLDRFLIP(reference, test, filters, true, startExposure + i * exposureDelta, errorMap);
+    }
+    else
+    {
+        evalLDRFLIP(reference, test, filters, false, 0.f, errorMap);
+    }
+
+    // Treat invalid errors as maximum errors.
+    std::for_each(
+        std::execution::par,
+        errorMap,
+        errorMap + pixelCount,
+        [](float& error)
+        {
+            if (std::isnan(error) || std::isinf(error) || error < 0.f || error > 1.f)
+                error = 1.f;
+        }
+    );
+
+    return meanError(errorMap, width, height);
+}
+
+} // namespace ImageCompare
@@ -0,0 +1,107 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <algorithm>
+#include <execution>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include <cstdint>
+
+namespace ImageCompare
+{
+template<typename T>
+T sqr(T x)
+{
+    return x * x;
+}
+
+template<typename T>
+T lerp(T a, T b, T t)
+{
+    return a + t * (b - a);
+}
+
+template<typename T>
+T clamp(T x, T lo, T hi)
+{
+    return std::max(lo, std::min(hi, x));
+}
+
+/// Image in RGBA float format.
+class Image
+{
+public:
+    Image(uint32_t width, uint32_t height) : mWidth(width), mHeight(height), mData(std::make_unique<float[]>(width * height * 4)) {}
+
+    uint32_t getWidth() const { return mWidth; }
+    uint32_t getHeight() const { return mHeight; }
+    const float* getData() const { return mData.get(); }
+    float* getData() { return mData.get(); }
+
+    static std::shared_ptr<Image> create(uint32_t width, uint32_t height) { return std::make_shared<Image>(width, height); }
+
+private:
+    uint32_t mWidth;
+    uint32_t mHeight;
+    std::unique_ptr<float[]> mData;
+};
+
+/// Number of partial sums used when accumulating errors. Fixed so that results don't depend on the thread count.
+static constexpr uint32_t kAccumulatorLanes = 8;
+
+template<typename Func>
+void forEachRow(uint32_t rowCount, Func func)
+{
+    std::vector<uint32_t> rows(rowCount);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::for_each(std::execution::par, rows.begin(), rows.end(), func);
+}
+
+/**
+ * Evaluate the structural dissimilarity (1 - SSIM).
+ * @param[in] a First image.
+ * @param[in] b Second image of the same resolution.
+ * @param[in] alpha Include the alpha channel.
+ * @param[out] errorMap Per-pixel errors, width * height values.
+ * @return The mean error.
+ */
+double evalSSIM(const Image& a, const Image& b, bool alpha, float* errorMap);
+
+/**
+ * Evaluate FLIP with the default settings of FLIPPass.
+ * @param[in] reference Reference image.
+ * @param[in] test Test image of the same resolution.
+ * @param[in] isHDR Evaluate HDR-FLIP with ACES tone mapping instead of LDR-FLIP.
+ * @param[out] errorMap Per-pixel errors, width * height values.
+ * @return The mean error.
+ */
+double evalFLIP(const Image& reference, const Image& test, bool isHDR, float* errorMap);
+
+} // namespace ImageCompare
@@ -0,0 +1,161 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Core/Plugin.h"
+#include "Core/Platform/OS.h"
+#include "Scene/SceneBuilder.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Scripting/Scripting.h"
+#include "Utils/Timing/TimeReport.h"
+
+#include <args.hxx>
+
+#include <iostream>
+#include <set>
+#include <string>
+
+using namespace Falcor;
+
+namespace
+{
+void printSceneDataSummary(const Scene::SceneData& sceneData)
+{
+    uint64_t triangleCount = 0;
+    for (const auto& meshDesc : sceneData.meshDesc)
+        triangleCount += meshDesc.getTriangleCount();
+
+    // Count the unique texture files referenced by the materials.
+    std::set<std::filesystem::path> texturePaths;
+    for (const auto& pMaterial : sceneData.pMaterials->getMaterials())
+    {
+        for (uint32_t i = 0; i < (uint32_t)Material::TextureSlot::Count; ++i)
+        {
+            const auto& path = pMaterial->getDeferredTexturePath((Material::TextureSlot)i);
+            if (!path.empty())
+                texturePaths.insert(path);
+        }
+    }
+
+    logInfo("Meshes:                   {}", sceneData.meshDesc.size());
+    logInfo("Mesh instances:           {}", sceneData.meshInstanceData.size());
+    logInfo("Unique triangles:         {}", triangleCount);
+    logInfo("Unique vertices:          {}", sceneData.meshStaticData.size());
+    logInfo("Curves:                   {}", sceneData.curveDesc.size());
+    logInfo("Materials:                {}", sceneData.pMaterials->getMaterialCount());
+    logInfo("Texture files:            {}", texturePaths.size());
+    logInfo("Lights:                   {}", sceneData.lights.size());
+    logInfo("Cameras:                  {}", sceneData.cameras.size());
+    logInfo("Peak RSS:                 {:.1f} MB", sceneData.buildStats.peakRSSInBytes / (1024.0 * 1024.0));
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    args::ArgumentParser parser("Import a scene without a GPU and report the time spent in each stage.");
+    parser.helpParams.programName = "SceneImportProfiler";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::Flag useCacheFlag(parser, "", "Read the scene cache if available, otherwise write it after importing.", {'c', "use-cache"});
+    args::Flag rebuildCacheFlag(parser, "", "Import the scene and rewrite the scene cache.", {"rebuild-cache"});
+    args::Flag useTextureCacheFlag(parser, "", "Use the texture cache (see TextureCache).", {"use-texture-cache"});
+    args::Flag silentFlag(parser, "", "Only write log messages to the log file.", {'s', "silent"});
+    args::Positional<std::string> sceneArg(parser, "scene", "Scene file to import.", args::Options::Required);
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    // The scene builder logs a table with the time and memory use of each build stage.
+    Logger::setOutputs(silentFlag ? Logger::OutputFlags::File : Logger::OutputFlags::Console | Logger::OutputFlags::File);
+
+    SceneBuilder::Flags buildFlags = SceneBuilder::Flags::Default;
+    if (useCacheFlag)
+        buildFlags |= SceneBuilder::Flags::UseCache;
+    if (rebuildCacheFlag)
+        buildFlags |= SceneBuilder::Flags::RebuildCache;
+    if (useTextureCacheFlag)
+        buildFlags |= SceneBuilder::Flags::UseTextureCache;
+
+    OSServices::start();
+    Threading::start();
+    Scripting::start();
+
+    int result = 0;
+    try
+    {
+        TimeReport timeReport;
+
+        PluginManager::instance().loadAllPlugins();
+        timeReport.measure("Loading plugins");
+
+        // Without a device the scene builder only creates CPU-side scene data.
+        SceneBuilder sceneBuilder(nullptr, args::get(sceneArg), Settings(), buildFlags);
+        timeReport.measure("Importing scene");
+
+        Scene::SceneData sceneData = sceneBuilder.getSceneData();
+        timeReport.measure("Building scene data");
+
+        timeReport.addTotal();
+        printSceneDataSummary(sceneData);
+        timeReport.printToLog();
+    }
+    catch (const std::exception& e)
+    {
+        logError("Failed to import scene '{}': {}", args::get(sceneArg), e.what());
+        result = 1;
+    }
+
+    Scripting::shutdown();
+    Threading::shutdown();
+    OSServices::stop();
+
+    return result;
+}
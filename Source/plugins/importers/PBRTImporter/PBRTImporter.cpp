@@ -107,6 +107,9 @@ const float4x4 kInvertZ = {
     0.f, 0.f, 0.f,  1.f, //
 };
 
+/// Number of shapes whose meshes are loaded and pre-processed together.
+const size_t kShapeBatchSize = 1024;
+
 /**
  * Holds the results from creating a camera.
  */
@@ -132,7 +135,7 @@ struct Light
  */
 struct FloatTexture
 {
-    std::variant<std::monostate, float, Falcor::ref<Texture>> texture;
+    std::variant<std::monostate, float, Falcor::ref<Texture>, std::filesystem::path> texture; ///< Image textures are referenced by path in headless builds.
     float4x4 transform = float4x4::identity();
 
     bool isConstant() const { return std::holds_alternative<float>(texture); }
@@ -151,7 +154,7 @@ struct FloatTexture
 struct SpectrumTexture
 {
     SpectrumType spectrumType = SpectrumType::Albedo;
-    std::variant<std::monostate, Spectrum, Falcor::ref<Texture>> texture;
+    std::variant<std::monostate, Spectrum, Falcor::ref<Texture>, std::filesystem::path> texture; ///< Image textures are referenced by path in headless builds.
     float4x4 transform = float4x4::identity();
 
     bool isConstant() const { return std::holds_alternative<Spectrum>(texture); }
@@ -173,6 +176,10 @@ struct Shape
     Falcor::ref<Falcor::TriangleMesh> pTriangleMesh;
     float4x4 transform = float4x4::identity();
     Falcor::ref<Falcor::Material> pMaterial;
+
+    std::filesystem::path meshPath; ///< Mesh file to load for plymesh shapes. Loaded in addShapeMeshes().
+    std::string meshName;           ///< Name of the mesh loaded from meshPath.
+    bool reverseOrientation = false;
 };
 
 /**
@@ -362,13 +369,16 @@ SpectrumTexture getSpectrumTexture(
 void assignSpectrumTexture(
     const SpectrumTexture& spectrumTexture,
     std::function<void(float3)> constantSetter,
-    std::function<void(Falcor::ref<Texture>)> textureSetter
+    Material& material,
+    Material::TextureSlot slot
 )
 {
     if (const auto* pSpectrum = std::get_if<Spectrum>(&spectrumTexture.texture))
         constantSetter(spectrumToRGB(*pSpectrum, spectrumTexture.spectrumType));
     else if (const auto* pTexture = std::get_if<Falcor::ref<Texture>>(&spectrumTexture.texture))
-        textureSetter(*pTexture);
+        material.setTexture(slot, *pTexture);
+    else if (const auto* pPath = std::get_if<std::filesystem::path>(&spectrumTexture.texture))
+        material.setDeferredTexture(slot, *pPath);
 }
 
 std::optional<FloatTexture> getFloatTextureOrNull(BuilderContext& ctx, const ParameterDictionary& params, const std::string& name)
@@ -706,7 +716,12 @@ Light createLight(BuilderContext& ctx, const LightSceneEntity& entity)
         if (!L.empty() && !filename.empty())
             throwError(entity.loc, "Can't specify both emission 'L' and 'filename' for infinite light.");
 
-        if (!L.empty())
+        if (ctx.builder.isHeadless())
+        {
+            // Environment maps are GPU resources.
+            logWarning(entity.loc, "Infinite lights are not supported without a device. Ignoring light.");
+        }
+        else if (!L.empty())
         {
             // Falcor doesn't have constant infinite emitter.
             // We create a one pixel env map for now.
@@ -817,7 +832,10 @@ FloatTexture createFloatTexture(BuilderContext& ctx, const TextureSceneEntity& e
         }
         bool sRGB = encoding == "sRGB";
 
-        floatTexture.texture = Falcor::Texture::createFromFile(ctx.builder.getDevice(), path, generateMips, sRGB);
+        if (ctx.builder.isHeadless())
+            floatTexture.texture = path;
+        else
+            floatTexture.texture = Falcor::Texture::createFromFile(ctx.builder.getDevice(), path, generateMips, sRGB);
     }
     else if (type == "checkerboard")
     {
@@ -934,7 +952,10 @@ SpectrumTexture createSpectrumTexture(BuilderContext& ctx, const TextureSceneEnt
         }
         bool sRGB = encoding == "sRGB";
 
-        spectrumTexture.texture = Falcor::Texture::createFromFile(ctx.builder.getDevice(), path, generateMips, sRGB);
+        if (ctx.builder.isHeadless())
+            spectrumTexture.texture = path;
+        else
+            spectrumTexture.texture = Falcor::Texture::createFromFile(ctx.builder.getDevice(), path, generateMips, sRGB);
     }
     else if (type == "checkerboard")
     {
@@ -999,7 +1020,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             auto pPBRTMaterial = PBRTDiffuseMaterial::create(ctx.builder.getDevice(), entity.name);
             assignSpectrumTexture(
                 reflectance, [&](float3 rgb) { pPBRTMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pPBRTMaterial->setBaseColorTexture(pTexture); }
+                *pPBRTMaterial, Material::TextureSlot::BaseColor
             );
             pPBRTMaterial->setDoubleSided(true);
             pPBRTMaterial->setCastShadow(true);
@@ -1012,7 +1033,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             pStandardMaterial->setRoughness(1.f);
             assignSpectrumTexture(
                 reflectance, [&](float3 rgb) { pStandardMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pStandardMaterial->setBaseColorTexture(pTexture); }
+                *pStandardMaterial, Material::TextureSlot::BaseColor
             );
             pStandardMaterial->setDoubleSided(true);
             pStandardMaterial->setCastShadow(true);
@@ -1038,7 +1059,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             pPBRTMaterial->setRoughness(roughness);
             assignSpectrumTexture(
                 reflectance, [&](float3 rgb) { pPBRTMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pPBRTMaterial->setBaseColorTexture(pTexture); }
+                *pPBRTMaterial, Material::TextureSlot::BaseColor
             );
             pPBRTMaterial->setDoubleSided(true);
             pPBRTMaterial->setCastShadow(true);
@@ -1053,7 +1074,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             pStandardMaterial->setRoughness(std::sqrt(roughness));
             assignSpectrumTexture(
                 reflectance, [&](float3 rgb) { pStandardMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pStandardMaterial->setBaseColorTexture(pTexture); }
+                *pStandardMaterial, Material::TextureSlot::BaseColor
             );
             pStandardMaterial->setDoubleSided(true);
             pStandardMaterial->setCastShadow(true);
@@ -1209,11 +1230,11 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             auto pPBRTMaterial = PBRTDiffuseTransmissionMaterial::create(ctx.builder.getDevice(), entity.name);
             assignSpectrumTexture(
                 reflectance, [&](float3 rgb) { pPBRTMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pPBRTMaterial->setBaseColorTexture(pTexture); }
+                *pPBRTMaterial, Material::TextureSlot::BaseColor
             );
             assignSpectrumTexture(
                 transmittance, [&](float3 rgb) { pPBRTMaterial->setTransmissionColor(rgb); },
-                [&](Falcor::ref<Texture> pTexture) { pPBRTMaterial->setTransmissionTexture(pTexture); }
+                *pPBRTMaterial, Material::TextureSlot::Transmission
             );
             pPBRTMaterial->setCastShadow(true);
             pMaterial = pPBRTMaterial;
@@ -1226,11 +1247,11 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             pStandardMaterial->setDiffuseTransmission(0.5f);
             assignSpectrumTexture(
                 reflectance, [&](float3 rgb) { pStandardMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pStandardMaterial->setBaseColorTexture(pTexture); }
+                *pStandardMaterial, Material::TextureSlot::BaseColor
             );
             assignSpectrumTexture(
                 transmittance, [&](float3 rgb) { pStandardMaterial->setTransmissionColor(rgb); },
-                [&](Falcor::ref<Texture> pTexture) { pStandardMaterial->setTransmissionTexture(pTexture); }
+                *pStandardMaterial, Material::TextureSlot::Transmission
             );
             pStandardMaterial->setDoubleSided(true);
             pStandardMaterial->setCastShadow(true);
@@ -1274,12 +1295,15 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             if (pheomelanin)
                 logWarning(entity.loc, "Ignoring 'pheomelanin' parameter since 'sigma_a' was provided.");
 
-            assignSpectrumTexture(
-                *sigma_a,
-                [&](float3 constant) { pHairMaterial->setBaseColor(float4(HairMaterial::colorFromSigmaA(constant, beta_n), 1.f)); },
-                [&](Falcor::ref<Texture> pTexture)
-                { logWarning(entity.loc, "Non-constant 'sigma_a' is currently not supported. Using default color instead."); }
-            );
+            if (sigma_a->isConstant())
+            {
+                float3 constant = spectrumToRGB(sigma_a->getConstant(), sigma_a->spectrumType);
+                pHairMaterial->setBaseColor(float4(HairMaterial::colorFromSigmaA(constant, beta_n), 1.f));
+            }
+            else if (!std::holds_alternative<std::monostate>(sigma_a->texture))
+            {
+                logWarning(entity.loc, "Non-constant 'sigma_a' is currently not supported. Using default color instead.");
+            }
         }
         else if (reflectance)
         {
@@ -1290,7 +1314,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
 
             assignSpectrumTexture(
                 *reflectance, [&](float3 constant) { pHairMaterial->setBaseColor(float4(constant, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pHairMaterial->setBaseColorTexture(pTexture); }
+                *pHairMaterial, Material::TextureSlot::BaseColor
             );
         }
         else if (eumelanin || pheomelanin)
@@ -1308,15 +1332,22 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
         // Parameters:
         // String filename
         auto path = ctx.resolver(params.getString("filename", ""));
-        try
+        if (ctx.builder.isHeadless())
         {
-            auto pRGLMaterial = RGLMaterial::create(ctx.builder.getDevice(), entity.name, path);
-            pRGLMaterial->setCastShadow(true);
-            pMaterial = pRGLMaterial;
+            logWarning(entity.loc, "Measured materials are not supported without a device. Ignoring material.");
         }
-        catch (const RuntimeError& e)
+        else
         {
-            logWarning(entity.loc, "Failed to load 'measured' material: {}", e.what());
+            try
+            {
+                auto pRGLMaterial = RGLMaterial::create(ctx.builder.getDevice(), entity.name, path);
+                pRGLMaterial->setCastShadow(true);
+                pMaterial = pRGLMaterial;
+            }
+            catch (const RuntimeError& e)
+            {
+                logWarning(entity.loc, "Failed to load 'measured' material: {}", e.what());
+            }
         }
     }
     else if (type == "subsurface")
@@ -1338,8 +1369,15 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
         auto normalmap = params.getString("normalmap", "");
         if (!normalmap.empty())
         {
-            auto pNormalMap = Texture::createFromFile(ctx.builder.getDevice(), ctx.resolver(normalmap), true, false);
-            pMaterial->setTexture(Material::TextureSlot::Normal, pNormalMap);
+            if (ctx.builder.isHeadless())
+            {
+                pMaterial->setDeferredTexture(Material::TextureSlot::Normal, ctx.resolver(normalmap));
+            }
+            else
+            {
+                auto pNormalMap = Texture::createFromFile(ctx.builder.getDevice(), ctx.resolver(normalmap), true, false);
+                pMaterial->setTexture(Material::TextureSlot::Normal, pNormalMap);
+            }
         }
     }
 
@@ -1585,11 +1623,10 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         warnUnsupportedParameters(params, {"displacement", "displacement.edgelength"});
 
         auto filename = params.getString("filename", "");
-        auto path = ctx.resolver(filename);
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
-        if (shape.pTriangleMesh)
-            shape.pTriangleMesh->setName(filename);
+        // The mesh file is loaded later, in parallel with the other shapes.
+        shape.meshPath = ctx.resolver(filename);
+        shape.meshName = filename;
         shape.transform = entity.transform;
     }
     else if (type == "loopsubdiv")
@@ -1630,7 +1667,8 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
     }
 
     // Reverse orientation.
-    if (entity.reverseOrientation && shape.pTriangleMesh)
+    shape.reverseOrientation = entity.reverseOrientation;
+    if (shape.reverseOrientation && shape.pTriangleMesh)
         shape.pTriangleMesh->setFrontFaceCW(!shape.pTriangleMesh->getFrontFaceCW());
 
     // Get the material.
@@ -1661,6 +1699,59 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
     return shape;
 }
 
+/**
+ * Add the triangle meshes of a list of shapes to the scene builder.
+ * Mesh files of plymesh shapes are loaded in parallel and all meshes are pre-processed in parallel.
+ * The meshes are added in the order of the shapes to keep mesh IDs deterministic.
+ * Returns the mesh ID for each shape, or an invalid ID if the shape has no triangle mesh.
+ */
+std::vector<Falcor::MeshID> addShapeMeshes(BuilderContext& ctx, std::vector<Shape>& shapes)
+{
+    // Load mesh files.
+    std::vector<size_t> fileShapeIndices;
+    std::vector<std::filesystem::path> paths;
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+        if (!shapes[i].meshPath.empty())
+        {
+            fileShapeIndices.push_back(i);
+            paths.push_back(shapes[i].meshPath);
+        }
+    }
+
+    auto triangleMeshes = Falcor::TriangleMesh::createFromFiles(paths);
+    for (size_t i = 0; i < fileShapeIndices.size(); ++i)
+    {
+        auto& shape = shapes[fileShapeIndices[i]];
+        shape.pTriangleMesh = triangleMeshes[i];
+        if (!shape.pTriangleMesh)
+            continue;
+        shape.pTriangleMesh->setName(shape.meshName);
+        if (shape.reverseOrientation)
+            shape.pTriangleMesh->setFrontFaceCW(!shape.pTriangleMesh->getFrontFaceCW());
+    }
+
+    // Pre-process and add meshes.
+    std::vector<size_t> meshShapeIndices;
+    std::vector<std::pair<Falcor::ref<Falcor::TriangleMesh>, Falcor::ref<Falcor::Material>>> meshes;
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+        if (shapes[i].pTriangleMesh)
+        {
+            meshShapeIndices.push_back(i);
+            meshes.emplace_back(shapes[i].pTriangleMesh, shapes[i].pMaterial);
+        }
+    }
+
+    auto addedMeshIDs = ctx.builder.addTriangleMeshes(meshes);
+
+    std::vector<Falcor::MeshID> meshIDs(shapes.size(), Falcor::MeshID::Invalid());
+    for (size_t i = 0; i < meshShapeIndices.size(); ++i)
+        meshIDs[meshShapeIndices[i]] = addedMeshIDs[i];
+
+    return meshIDs;
+}
+
 /**
  * Create curve geometry from a curve aggregate.
  * This can either result in mesh or curve geometry depending on the tesselation mode.
@@ -1735,34 +1826,46 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
 {
     InstanceDefinition instanceDefinition;
 
-    for (const auto& shapeEntity : entity.shapes)
+    // Shapes are processed in batches like top-level shapes (see buildScene) to limit the number of meshes held in memory.
+    const auto& shapeEntities = entity.shapes;
+    for (size_t batchStart = 0; batchStart < shapeEntities.size(); batchStart += kShapeBatchSize)
     {
-        // Process shapes and create meshes.
-        auto shape = createShape(ctx, shapeEntity);
-        if (shape.pTriangleMesh)
-        {
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-            instanceDefinition.meshes.emplace_back(meshID, shape.transform);
-        }
+        size_t batchEnd = std::min(batchStart + kShapeBatchSize, shapeEntities.size());
 
-        // Create curves from curve aggregates assembled during the processing step above.
-        for (const auto& [_, curveAggregate] : ctx.curveAggregates)
+        std::vector<Shape> shapes;
+        shapes.reserve(batchEnd - batchStart);
+        for (size_t i = batchStart; i < batchEnd; ++i)
         {
-            auto meshOrCurveID = createCurveGeometry(ctx, curveAggregate);
-            if (auto meshID = std::get_if<Falcor::MeshID>(&meshOrCurveID))
-            {
-                instanceDefinition.meshes.emplace_back(*meshID, curveAggregate.transform);
-            }
-            else if (auto curveID = std::get_if<Falcor::CurveID>(&meshOrCurveID))
-            {
-                instanceDefinition.curves.emplace_back(*curveID, curveAggregate.transform);
-            }
-            else
+            // Process shapes. Meshes are created below once all shapes of the batch are processed.
+            shapes.push_back(createShape(ctx, shapeEntities[i]));
+
+            // Create curves from curve aggregates assembled during the processing step above.
+            for (const auto& [_, curveAggregate] : ctx.curveAggregates)
             {
-                FALCOR_UNREACHABLE();
+                auto meshOrCurveID = createCurveGeometry(ctx, curveAggregate);
+                if (auto meshID = std::get_if<Falcor::MeshID>(&meshOrCurveID))
+                {
+                    instanceDefinition.meshes.emplace_back(*meshID, curveAggregate.transform);
+                }
+                else if (auto curveID = std::get_if<Falcor::CurveID>(&meshOrCurveID))
+                {
+                    instanceDefinition.curves.emplace_back(*curveID, curveAggregate.transform);
+                }
+                else
+                {
+                    FALCOR_UNREACHABLE();
+                }
             }
+            ctx.curveAggregates.clear();
+        }
+
+        // Create meshes.
+        auto meshIDs = addShapeMeshes(ctx, shapes);
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            if (meshIDs[i].isValid())
+                instanceDefinition.meshes.emplace_back(meshIDs[i], shapes[i].transform);
         }
-        ctx.curveAggregates.clear();
     }
 
     return instanceDefinition;
@@ -1820,14 +1923,26 @@ void buildScene(BuilderContext& ctx)
     }
 
     // Process shapes and create meshes.
-    for (const auto& entity : ctx.scene.getShapes())
+    // Shapes are processed sequentially, then meshes are loaded and pre-processed in parallel.
+    // This is done in batches to limit the number of meshes held in memory at the same time.
+    const auto& shapeEntities = ctx.scene.getShapes();
+    for (size_t batchStart = 0; batchStart < shapeEntities.size(); batchStart += kShapeBatchSize)
     {
-        auto shape = createShape(ctx, entity);
-        if (shape.pTriangleMesh)
+        size_t batchEnd = std::min(batchStart + kShapeBatchSize, shapeEntities.size());
+
+        std::vector<Shape> shapes;
+        shapes.reserve(batchEnd - batchStart);
+        for (size_t i = batchStart; i < batchEnd; ++i)
+            shapes.push_back(createShape(ctx, shapeEntities[i]));
+
+        auto meshIDs = addShapeMeshes(ctx, shapes);
+        for (size_t i = 0; i < shapes.size(); ++i)
         {
-            auto nodeID = ctx.builder.addNode({entity.name, shape.transform});
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-            ctx.builder.addMeshInstance(nodeID, meshID);
+            if (meshIDs[i].isValid())
+            {
+                auto nodeID = ctx.builder.addNode({shapeEntities[batchStart + i].name, shapes[i].transform});
+                ctx.builder.addMeshInstance(nodeID, meshIDs[i]);
+            }
         }
     }
 
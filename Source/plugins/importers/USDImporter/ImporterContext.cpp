@@ -1427,6 +1427,12 @@ namespace Falcor
         float intensity = getAuthoredAttribute(domeLight.GetIntensityAttr(), lightPrim.GetAttribute(TfToken("intensity")), 1.f);
         GfVec3f color = getAuthoredAttribute(domeLight.GetColorAttr(), lightPrim.GetAttribute(TfToken("color")), GfVec3f(1.f, 1.f, 1.f));
 
+        if (builder.isHeadless())
+        {
+            logWarning("Environment maps are not supported without a device. Ignoring light '{}'.", lightPrim.GetPath().GetString());
+            return;
+        }
+
         ref<EnvMap> pEnvMap = EnvMap::createFromFile(builder.getDevice(), envMapPath);
 
         if (pEnvMap == nullptr)
@@ -1799,7 +1805,8 @@ namespace Falcor
         , builder(builder)
         , useInstanceProxies(useInstanceProxies)
     {
-        mpPreviewSurfaceConverter = std::make_unique<PreviewSurfaceConverter>(builder.getDevice());
+        // Converting preview surfaces requires GPU texture processing. Headless builders use default materials instead.
+        if (!builder.isHeadless()) mpPreviewSurfaceConverter = std::make_unique<PreviewSurfaceConverter>(builder.getDevice());
     }
 
 
@@ -1807,7 +1814,7 @@ namespace Falcor
     {
         ref<Material> pMaterial;
 
-        if (material)
+        if (material && mpPreviewSurfaceConverter)
         {
             // Note that this call will block if another thread is in the process of converting the same material.
             pMaterial = mpPreviewSurfaceConverter->convert(material, primName, builder.getDevice()->getRenderContext());
@@ -0,0 +1,14 @@
+from falcor import *
+
+def render_graph_CameraPath():
+    g = RenderGraph('CameraPath')
+    g.addPass(createPass('CameraPath', {'replay': True, 'framesPerSegment': 8}), 'CameraPath')
+    g.addPass(createPass('SceneDebugger'), 'SceneDebugger')
+    # CameraPath has no outputs, so an execution edge is needed to run it before the scene is rendered.
+    g.addEdge('CameraPath', 'SceneDebugger')
+    g.markOutput('SceneDebugger.output')
+    return g
+
+CameraPath = render_graph_CameraPath()
+try: m.addGraph(CameraPath)
+except NameError: None
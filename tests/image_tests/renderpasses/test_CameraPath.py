@@ -0,0 +1,46 @@
+import sys
+sys.path.append('..')
+import os
+import tempfile
+from helpers import render_frames
+from graphs.CameraPath import CameraPath as g
+from falcor import *
+
+# Unevenly spaced path nodes given as position, target and the time since the previous node.
+nodes = [
+    [-3.0, 1.5, 3.0, 0.0, 0.5, 0.0, 0.0],
+    [0.0, 1.8, 4.0, 0.0, 0.5, 0.0, 0.5],
+    [1.0, 1.6, 3.5, 0.0, 0.6, 0.0, 0.2],
+    [3.5, 1.2, 1.0, 0.2, 0.5, 0.0, 1.0],
+]
+path = os.path.join(tempfile.mkdtemp(), 'CameraPath.fcp')
+with open(path, 'w') as f:
+    for node in nodes:
+        f.write(','.join(str(v) for v in node) + '\n')
+
+m.addGraph(g)
+m.loadScene('Arcade/Arcade.pyscene')
+
+cameraPath = g.getPass('CameraPath')
+cameraPath.loadPath(path)
+assert cameraPath.replayFrameCount == 25
+
+# The scene is updated before CameraPath executes, so the animation time of the next replay frame is locked one frame ahead.
+# The geometry then matches the camera of the same frame. Frame 8 starts the second segment, frame 12 is halfway through it.
+cameraPath.start()
+assert abs(m.scene.animationTimeOverride) < 1e-6
+for frame, time in [(8, 0.5), (12, 0.6)]:
+    while cameraPath.replayFrame < frame:
+        m.renderFrame()
+    assert abs(m.scene.animationTimeOverride - time) < 1e-6
+cameraPath.stop()
+assert m.scene.animationTimeOverride is None
+
+# Fixed-step replay renders the same frames on every run.
+for name in ['replay0', 'replay1']:
+    cameraPath.start()
+    render_frames(m, name, frames=[1, 8, 12, 25])
+    assert cameraPath.replayFrame == 25
+    cameraPath.stop()
+
+exit()